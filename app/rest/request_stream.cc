@@ -0,0 +1,71 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app/rest/request_stream.h"
+
+#include <cassert>
+#include <cstddef>
+
+namespace firebase {
+namespace rest {
+
+RequestStream::RequestStream(ReadCallback callback, void* callback_data,
+                             size_t stream_size)
+    : callback_(callback),
+      callback_data_(callback_data),
+      stream_size_(stream_size),
+      bytes_read_(0),
+      end_of_stream_(callback == nullptr) {
+  options_.stream_post_fields = true;
+}
+
+// This object will assert if post fields are set.
+void RequestStream::set_post_fields(const char* /*data*/, size_t /*size*/) {
+  assert(false);
+}
+
+void RequestStream::set_post_fields(const char* /*data*/) { assert(false); }
+
+size_t RequestStream::ReadBody(char* buffer, size_t length, bool* abort) {
+  *abort = false;
+  if (end_of_stream_) return 0;
+  // Never read past the advertised size, the transport would reject it.
+  if (stream_size_ != kUnknownSize) {
+    size_t remaining = stream_size_ - bytes_read_;
+    if (length > remaining) length = remaining;
+    if (length == 0) {
+      end_of_stream_ = true;
+      return 0;
+    }
+  }
+  size_t data_read = callback_(buffer, length, abort, callback_data_);
+  if (data_read > length) {
+    *abort = true;
+    data_read = 0;
+  }
+  // A known size stream that ends early is truncated, so abort the transfer
+  // rather than sending a short body.
+  if (data_read == 0 && stream_size_ != kUnknownSize &&
+      bytes_read_ != stream_size_) {
+    *abort = true;
+  }
+  if (data_read == 0 || *abort) end_of_stream_ = true;
+  bytes_read_ += data_read;
+  return data_read;
+}
+
+}  // namespace rest
+}  // namespace firebase
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_APP_REST_REQUEST_STREAM_H_
+#define FIREBASE_APP_REST_REQUEST_STREAM_H_
+
+#include <cstddef>
+
+#include "app/rest/request.h"
+
+namespace firebase {
+namespace rest {
+
+// Request that pulls its body from a user supplied callback as the transport
+// asks for it, so the body never needs to be held in memory.
+class RequestStream : public Request {
+ public:
+  // Called to fill buffer with up to length bytes of the request body.
+  // Returns the number of bytes written into buffer, or 0 when the end of the
+  // stream has been reached. Set abort to true to stop the transfer.
+  typedef size_t (*ReadCallback)(char* buffer, size_t length, bool* abort,
+                                 void* callback_data);
+
+  // Size reported by GetPostFieldsSize() when the length of the stream is not
+  // known in advance. In this case the transport uses chunked encoding.
+  static const size_t kUnknownSize = ~static_cast<size_t>(0);
+
+  // Create a request that will read from the specified callback.
+  // callback_data must remain valid while a transfer of this request is in
+  // progress.
+  RequestStream(ReadCallback callback, void* callback_data,
+                size_t stream_size = kUnknownSize);
+
+  // This object will assert if post fields are set.
+  void set_post_fields(const char* data, size_t size) override;
+  void set_post_fields(const char* data) override;
+
+  // Get the size of the stream, or kUnknownSize if it isn't known.
+  size_t GetPostFieldsSize() const override { return stream_size_; }
+
+  // Read the next chunk of the stream from the callback.
+  size_t ReadBody(char* buffer, size_t length, bool* abort) override;
+
+  // Number of bytes read from the stream so far.
+  size_t bytes_read() const { return bytes_read_; }
+
+ private:
+  ReadCallback callback_;
+  void* callback_data_;
+  size_t stream_size_;
+  size_t bytes_read_;
+  bool end_of_stream_;
+};
+
+}  // namespace rest
+}  // namespace firebase
+
+#endif  // FIREBASE_APP_REST_REQUEST_STREAM_H_
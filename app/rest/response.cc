@@ -17,8 +17,11 @@
 #include "app/rest/response.h"
 
 #include <string>
+#include <utility>
 
 #include "app/rest/util.h"
+#include "app/rest/zlibwrapper.h"
+#include "app/src/log.h"
 #include "curl/curl.h"
 
 namespace firebase {
@@ -31,6 +34,19 @@ Response::Response()
       sdk_error_code_(0),
       fetch_time_(0) {}
 
+Response::~Response() {}
+
+Response::Response(Response&& rhs)
+    : status_(std::move(rhs.status_)),                      // NOLINT
+      header_completed_(std::move(rhs.header_completed_)),  // NOLINT
+      body_completed_(std::move(rhs.body_completed_)),      // NOLINT
+      sdk_error_code_(std::move(rhs.sdk_error_code_)),      // NOLINT
+      fetch_time_(std::move(rhs.fetch_time_)),              // NOLINT
+      header_(std::move(rhs.header_)),
+      body_(std::move(rhs.body_)),
+      body_cache_(std::move(rhs.body_cache_)),
+      inflater_(std::move(rhs.inflater_)) {}
+
 bool Response::ProcessHeader(const char* buffer, size_t length) {
   // Since buffer may NOT neccessarily end with \0, pass in length in the init.
   std::string header(buffer, length);
@@ -57,14 +73,53 @@ bool Response::ProcessHeader(const char* buffer, size_t length) {
     if (key == util::kDate) {
       fetch_time_ = curl_getdate(value.c_str(), nullptr /* unused */);
     }
+    // Inflate the body as it arrives if it is gzip encoded. Header names are
+    // case insensitive.
+    if (util::ToUpper(key) == util::ToUpper(util::kContentEncoding) &&
+        util::ToUpper(value) == util::ToUpper(util::kGzip)) {
+      inflater_.reset(new ZLib());
+      inflater_->SetGzipHeaderMode();
+    }
   }
   return true;
 }
 
 bool Response::ProcessBody(const char* buffer, size_t length) {
-  // Since buffer may NOT neccessarily end with \0, pass in length in the init.
-  std::string body(buffer, length);
-  body_.push_back(body);
+  std::string body;
+  if (!DecodeBody(buffer, length, &body)) return false;
+  // Nothing is decoded while the gzip header or footer is being read.
+  if (!body.empty()) body_.push_back(std::move(body));
+  return true;
+}
+
+bool Response::DecodeBody(const char* buffer, size_t length,
+                          std::string* decoded) {
+  if (!inflater_) {
+    // Since buffer may NOT neccessarily end with \0, pass in length.
+    decoded->append(buffer, length);
+    return true;
+  }
+  // Inflate into a fixed size buffer until zlib has nothing more to output
+  // for this piece. Z_BUF_ERROR with a full buffer means there may be more.
+  static const size_t kInflateBufferSize = 16 * 1024;
+  char inflated[kInflateBufferSize];
+  const Bytef* source = reinterpret_cast<const Bytef*>(buffer);
+  uLong source_length = length;
+  int err;
+  do {
+    uLongf inflated_length = kInflateBufferSize;
+    uLong unread_length = source_length;
+    err = inflater_->UncompressAtMost(reinterpret_cast<Bytef*>(inflated),
+                                      &inflated_length, source, &unread_length);
+    if (err != Z_OK && err != Z_BUF_ERROR) {
+      LogError("Failed to inflate gzip encoded response body: %d", err);
+      return false;
+    }
+    decoded->append(inflated, inflated_length);
+    if (err == Z_BUF_ERROR && inflated_length < kInflateBufferSize) break;
+    source += source_length - unread_length;
+    source_length = unread_length;
+  } while (err == Z_BUF_ERROR);
   return true;
 }
 
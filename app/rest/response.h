@@ -20,6 +20,7 @@
 #include <cstddef>
 #include <ctime>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,13 +29,16 @@
 #include "app/rest/util.h"
 
 namespace firebase {
+
+class ZLib;
+
 namespace rest {
 
 // The base class to deal with HTTP/REST response.
 class Response : public Transfer {
  public:
   Response();
-  virtual ~Response() {}
+  virtual ~Response();
 
   // Note: remove if support for Visual Studio <2015 is no longer needed.
   // Prior to version 2015, Visual Studio didn't support implicitly
@@ -42,20 +46,14 @@ class Response : public Transfer {
   // Linter is suppressed because it complains about unnecessary moves. In this
   // case, applying move is more future-proof, in case one of the variables
   // which is now a fundamental gets changed to a user-defined type further on.
-  Response(Response&& rhs)
-      : status_(std::move(rhs.status_)),                      // NOLINT
-        header_completed_(std::move(rhs.header_completed_)),  // NOLINT
-        body_completed_(std::move(rhs.body_completed_)),      // NOLINT
-        sdk_error_code_(std::move(rhs.sdk_error_code_)),      // NOLINT
-        fetch_time_(std::move(rhs.fetch_time_)),              // NOLINT
-        header_(std::move(rhs.header_)),
-        body_(std::move(rhs.body_)),
-        body_cache_(std::move(rhs.body_cache_)) {}
+  Response(Response&& rhs);
 
   // Process headers. Return false when it fails and will interrupt the request.
   virtual bool ProcessHeader(const char* buffer, size_t length);
 
   // Process body. Returns false when it fails and will interrupt the request.
+  // A body sent with "Content-Encoding: gzip" is inflated as it arrives, so
+  // GetBody() returns the uncompressed body.
   virtual bool ProcessBody(const char* buffer, size_t length);
 
   // Mark the response completed for both header and body.
@@ -100,6 +98,12 @@ class Response : public Transfer {
   // Get the body. Use for binary body.
   virtual void GetBody(const char** data, size_t* size) const;
 
+ protected:
+  // Appends a piece of the body as received to `decoded`, inflating it first
+  // if the body is gzip encoded. Returns false if the body can't be inflated.
+  // For subclasses that override ProcessBody() to store the body themselves.
+  bool DecodeBody(const char* buffer, size_t length, std::string* decoded);
+
  private:
   // The status code of the response.
   int status_;
@@ -116,6 +120,8 @@ class Response : public Transfer {
   // Stores body in pieces and as a whole.
   std::vector<std::string> body_;
   mutable std::string body_cache_;
+  // Inflates the body when it is gzip encoded, otherwise null.
+  std::unique_ptr<ZLib> inflater_;
 };
 
 }  // namespace rest
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app/rest/request_stream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "app/rest/tests/request_test.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace rest {
+namespace test {
+
+// Produces data from a string in chunks of at most max_chunk_size bytes.
+struct StringSource {
+  std::string data;
+  size_t offset = 0;
+  size_t max_chunk_size = 7;
+  bool fail_at_end = false;
+
+  static size_t Read(char* buffer, size_t length, bool* abort,
+                     void* callback_data) {
+    StringSource* source = static_cast<StringSource*>(callback_data);
+    size_t read_size = std::min(std::min(length, source->max_chunk_size),
+                                source->data.size() - source->offset);
+    if (read_size == 0 && source->fail_at_end) *abort = true;
+    memcpy(buffer, source->data.data() + source->offset, read_size);
+    source->offset += read_size;
+    return read_size;
+  }
+};
+
+TEST(RequestStreamTest, ReadUnknownSize) {
+  StringSource source;
+  source.data = CreateLargeTextData();
+  RequestStream request(StringSource::Read, &source);
+  EXPECT_EQ(RequestStream::kUnknownSize, request.GetPostFieldsSize());
+  EXPECT_TRUE(request.options().stream_post_fields);
+  EXPECT_EQ(source.data, ReadRequestBody(&request));
+  EXPECT_EQ(source.data.size(), request.bytes_read());
+}
+
+TEST(RequestStreamTest, ReadKnownSize) {
+  StringSource source;
+  source.data = kSmallString;
+  RequestStream request(StringSource::Read, &source, source.data.size());
+  EXPECT_EQ(source.data.size(), request.GetPostFieldsSize());
+  EXPECT_EQ(source.data, ReadRequestBody(&request));
+}
+
+TEST(RequestStreamTest, DoesNotReadPastKnownSize) {
+  StringSource source;
+  source.data = kSmallString;
+  RequestStream request(StringSource::Read, &source, 5);
+  EXPECT_EQ(source.data.substr(0, 5), ReadRequestBody(&request));
+  EXPECT_EQ(5u, source.offset);
+}
+
+TEST(RequestStreamTest, AbortsWhenStreamIsShorterThanKnownSize) {
+  StringSource source;
+  source.data = kSmallString;
+  RequestStream request(StringSource::Read, &source, source.data.size() + 1);
+  std::string output;
+  EXPECT_FALSE(request.ReadBodyIntoString(&output));
+}
+
+TEST(RequestStreamTest, AbortFromCallback) {
+  StringSource source;
+  source.data = kSmallString;
+  source.fail_at_end = true;
+  RequestStream request(StringSource::Read, &source);
+  std::string output;
+  EXPECT_FALSE(request.ReadBodyIntoString(&output));
+}
+
+}  // namespace test
+}  // namespace rest
+}  // namespace firebase
@@ -16,8 +16,12 @@
 
 #include "app/rest/response.h"
 
+#include <algorithm>
 #include <cstring>
+#include <memory>
+#include <string>
 
+#include "app/rest/zlibwrapper.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -98,5 +102,80 @@ TEST(ResponseTest, ProcessDateHeaderMissing) {
   EXPECT_LT(1499270119, response.fetch_time());
 }
 
+std::string Gzip(const std::string& input) {
+  ZLib zlib;
+  zlib.SetGzipHeaderMode();
+  uLongf result_size = ZLib::MinCompressbufSize(input.length());
+  std::unique_ptr<char[]> result(new char[result_size]);
+  int err = zlib.Compress(
+      reinterpret_cast<unsigned char*>(result.get()), &result_size,
+      reinterpret_cast<const unsigned char*>(input.data()), input.length());
+  EXPECT_EQ(err, Z_OK);
+  return std::string(result.get(), result_size);
+}
+
+// Returns a JSON body that is large enough to inflate to several buffers.
+std::string LargeJsonBody() {
+  std::string body = "{";
+  for (int i = 0; i < 10000; ++i) {
+    if (i > 0) body += ",";
+    body += "\"key" + std::to_string(i) + "\":\"value" + std::to_string(i) +
+            "\"";
+  }
+  return body + "}";
+}
+
+TEST(ResponseTest, ProcessBodyWithoutContentEncoding) {
+  Response response;
+  ProcessHeader("HTTP/1.1 200 OK\r\n", &response);
+  ProcessHeader("\r\n", &response);
+  response.ProcessBody("hello ", 6);
+  response.ProcessBody("world", 5);
+  response.MarkCompleted();
+  EXPECT_STREQ("hello world", response.GetBody());
+}
+
+TEST(ResponseTest, ProcessGzipEncodedBody) {
+  std::string body = LargeJsonBody();
+  std::string compressed = Gzip(body);
+  ASSERT_LT(compressed.length(), body.length());
+
+  Response response;
+  ProcessHeader("HTTP/1.1 200 OK\r\n", &response);
+  ProcessHeader("Content-Encoding: gzip\r\n", &response);
+  ProcessHeader("\r\n", &response);
+  EXPECT_TRUE(response.ProcessBody(compressed.data(), compressed.length()));
+  response.MarkCompleted();
+  EXPECT_EQ(body, response.GetBody());
+}
+
+// The body can arrive in pieces of any size, including pieces that split the
+// gzip header and footer.
+TEST(ResponseTest, ProcessGzipEncodedBodyInPieces) {
+  std::string body = LargeJsonBody();
+  std::string compressed = Gzip(body);
+
+  for (size_t piece_size : {1, 7, 4096}) {
+    Response response;
+    ProcessHeader("HTTP/1.1 200 OK\r\n", &response);
+    ProcessHeader("content-encoding: GZIP\r\n", &response);
+    ProcessHeader("\r\n", &response);
+    for (size_t i = 0; i < compressed.length(); i += piece_size) {
+      size_t length = std::min(piece_size, compressed.length() - i);
+      EXPECT_TRUE(response.ProcessBody(compressed.data() + i, length));
+    }
+    response.MarkCompleted();
+    EXPECT_EQ(body, response.GetBody()) << "piece size " << piece_size;
+  }
+}
+
+TEST(ResponseTest, ProcessInvalidGzipEncodedBody) {
+  Response response;
+  ProcessHeader("HTTP/1.1 200 OK\r\n", &response);
+  ProcessHeader("Content-Encoding: gzip\r\n", &response);
+  ProcessHeader("\r\n", &response);
+  EXPECT_FALSE(response.ProcessBody("not gzip", 8));
+}
+
 }  // namespace rest
 }  // namespace firebase
@@ -25,6 +25,8 @@
 #include "app/src/assert.h"
 #include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/include/firebase/internal/platform.h"
+#include "app/src/metrics.h"
+#include "app/src/mutex_profiler.h"
 #include "app/src/semaphore.h"
 #include "app/src/thread.h"
 #include "app/src/util.h"
@@ -150,6 +152,15 @@ struct TransportCurlActionData {
   }
 };
 
+static metrics::Counter g_requests("firebase_rest_requests_total",
+                                   "Number of HTTP requests started.");
+static metrics::Counter g_failed_requests(
+    "firebase_rest_failed_requests_total",
+    "Number of HTTP requests that were canceled or timed out.");
+static metrics::Histogram g_request_latency(
+    "firebase_rest_request_latency_us",
+    "Time from starting an HTTP request until it completes, in microseconds.");
+
 // The data needed to run a curl request in the background. When this class
 // receives a curl handle it takes ownership and is responsible for running the
 // request and deallocating the resources when the request is complete.
@@ -207,6 +218,8 @@ class BackgroundTransportCurl {
   bool canceled_;
   // Whether the operation timed out.
   bool timed_out_;
+  // Times the request from when it's created until it completes.
+  metrics::Span span_;
 };
 
 // The data common to both threads. This is used to communicate when the
@@ -363,7 +376,9 @@ BackgroundTransportCurl::BackgroundTransportCurl(
       complete_(complete),
       complete_data_(complete_data),
       canceled_(false),
-      timed_out_(false) {
+      timed_out_(false),
+      span_("rest_request", &g_request_latency) {
+  g_requests.Increment();
   assert(curl_multi_);
   assert(curl_);
   assert(transport_curl);
@@ -410,6 +425,8 @@ BackgroundTransportCurl::~BackgroundTransportCurl() {
 }
 
 void BackgroundTransportCurl::CompleteOperation() {
+  span_.End();
+  if (canceled_ || timed_out_) g_failed_requests.Increment();
   if (complete_) complete_(this, complete_data_);
   if (canceled_) {
     response_->set_status(rest::util::HttpNoContent);
@@ -597,6 +614,7 @@ TransportCurl::~TransportCurl() {
 const int64_t CurlThread::kPollIntervalMilliseconds = 33;  // ~30Hz
 
 CurlThread::CurlThread() : action_data_signal_(0) {
+  mutex_profiler::NameMutex(&mutex_, "CurlThread");
   // Normally we would use make_new() here, but this is not a std::unique_ptr
   // and make_new() isn't supported by all targets we build for
   // NOLINTNEXTLINE
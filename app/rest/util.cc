@@ -34,12 +34,15 @@ namespace util {
 
 const char kHttpHeaderSeparator = ':';
 const char kAccept[] = "Accept";
+const char kAcceptEncoding[] = "Accept-Encoding";
 const char kAuthorization[] = "Authorization";
+const char kContentEncoding[] = "Content-Encoding";
 const char kContentType[] = "Content-Type";
 const char kApplicationJson[] = "application/json";
 const char kApplicationWwwFormUrlencoded[] =
     "application/x-www-form-urlencoded";
 const char kDate[] = "Date";
+const char kGzip[] = "gzip";
 const char kCrLf[] = "\r\n";
 const char kGet[] = "GET";
 const char kPost[] = "POST";
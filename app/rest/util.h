@@ -31,11 +31,14 @@ namespace util {
 extern const char kHttpHeaderSeparator;
 // String literals for a few common header strings (names and values).
 extern const char kAccept[];
+extern const char kAcceptEncoding[];
 extern const char kAuthorization[];
+extern const char kContentEncoding[];
 extern const char kContentType[];
 extern const char kApplicationJson[];
 extern const char kApplicationWwwFormUrlencoded[];
 extern const char kDate[];
+extern const char kGzip[];
 // The CRLF literal.
 extern const char kCrLf[];
 // String literals for a few common HTTP methods.
@@ -47,6 +50,7 @@ enum HttpStatusCode {
   HttpInvalid = 0,
   HttpSuccess = 200,
   HttpNoContent = 204,
+  HttpNotModified = 304,
   HttpBadRequest = 400,
   HttpPaymentRequired = 402,
   HttpUnauthorized = 401,
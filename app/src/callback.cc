@@ -21,6 +21,8 @@
 
 #include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/log.h"
+#include "app/src/metrics.h"
+#include "app/src/mutex_profiler.h"
 #include "app/src/semaphore.h"
 #include "app/src/thread.h"
 
@@ -29,9 +31,15 @@ namespace callback {
 
 class CallbackEntry;
 
+static metrics::Gauge g_queue_depth(
+    "firebase_callback_queue_depth",
+    "Number of callbacks waiting to be dispatched.");
+static metrics::Counter g_callbacks_dispatched(
+    "firebase_callbacks_dispatched_total", "Number of callbacks dispatched.");
+
 class CallbackQueue : public std::list<std::shared_ptr<CallbackEntry>> {
  public:
-  CallbackQueue() {}
+  CallbackQueue() { mutex_profiler::NameMutex(&mutex_, "CallbackQueue"); }
   ~CallbackQueue() {}
 
   // Get the mutex that controls access to this queue.
@@ -126,6 +134,7 @@ class CallbackDispatcher {
     auto entry = std::make_shared<CallbackEntry>(callback, &execution_mutex_);
     MutexLock lock(*queue_.mutex());
     queue_.push_back(entry);
+    g_queue_depth.Set(static_cast<int64_t>(queue_.size()));
     return entry.get();
   }
 
@@ -152,8 +161,10 @@ class CallbackDispatcher {
       // currently.
       std::shared_ptr<CallbackEntry> callback_entry = queue_.front();
       queue_.pop_front();
+      g_queue_depth.Set(static_cast<int64_t>(queue_.size()));
       queue_mutex->Release();
       callback_entry->Execute();
+      g_callbacks_dispatched.Increment();
       dispatched++;
       queue_mutex->Acquire();
       callback_entry.reset();
@@ -171,6 +182,7 @@ class CallbackDispatcher {
       queue_.pop_front();
       flushed++;
     }
+    g_queue_depth.Set(0);
     return flushed;
   }
 
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "app/src/include/firebase/internal/mutex.h"
+#include "app/src/shared_mutex.h"
 
 namespace firebase {
 
@@ -85,7 +86,8 @@ class CleanupNotifier {
   // Unregister this notifier with all owner objects.
   void UnregisterAllOwners();
 
-  // Unregister a notifier from an owner object.
+  // Unregister a notifier from an owner object. Must be called with
+  // cleanup_notifiers_by_owner_mutex_ held exclusively.
   static void UnregisterOwner(std::map<void *, CleanupNotifier *>::iterator it);
 
  private:
@@ -97,8 +99,9 @@ class CleanupNotifier {
   // This is the inverse of cleanup_notifiers_by_owner_ for a notifier.
   std::vector<void *> owners_;
 
-  // Guards owners_ and cleanup_notifiers_by_owner_.
-  static Mutex *cleanup_notifiers_by_owner_mutex_;
+  // Guards owners_ and cleanup_notifiers_by_owner_. FindByOwner() only takes
+  // it shared, so lookups don't contend with each other.
+  static SharedMutex *cleanup_notifiers_by_owner_mutex_;
   // Global map of cleanup notifiers bucketed by owner object.
   static std::map<void *, CleanupNotifier *> *cleanup_notifiers_by_owner_;
 };
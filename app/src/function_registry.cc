@@ -16,54 +16,33 @@
 
 #include "app/src/function_registry.h"
 
-#include <assert.h>
-
 namespace firebase {
 namespace internal {
 
+FunctionRegistry::FunctionRegistry() {
+  for (int i = 0; i < FnCount; ++i) registered_functions_[i].store(nullptr);
+}
+
 bool FunctionRegistry::RegisterFunction(
     FunctionId id, RegisteredFunction registered_function) {
-  MutexLock lock(map_mutex_);
-  auto itr = registered_functions_.find(id);
-  if (itr != registered_functions_.end()) {
-    return false;
-  } else {
-    registered_functions_[id] = registered_function;
-    return true;
-  }
+  RegisteredFunction expected = nullptr;
+  return registered_functions_[id].compare_exchange_strong(
+      expected, registered_function);
 }
 
 bool FunctionRegistry::UnregisterFunction(FunctionId id) {
-  MutexLock lock(map_mutex_);
-  auto itr = registered_functions_.find(id);
-  if (itr == registered_functions_.end()) {
-    return false;
-  } else {
-    registered_functions_.erase(itr, itr);
-    return true;
-  }
+  return registered_functions_[id].exchange(nullptr) != nullptr;
 }
 
 bool FunctionRegistry::FunctionExists(FunctionId id) {
-  MutexLock lock(map_mutex_);
-  auto itr = registered_functions_.find(id);
-  return itr != registered_functions_.end();
+  return registered_functions_[id].load(std::memory_order_acquire) != nullptr;
 }
 
 bool FunctionRegistry::CallFunction(FunctionId id, App* app, void* args,
                                     void* out) {
-  RegisteredFunction function;
-  {
-    std::map<FunctionId, RegisteredFunction>::iterator itr;
-    MutexLock lock(map_mutex_);
-    itr = registered_functions_.find(id);
-    if (itr != registered_functions_.end()) {
-      function = itr->second;
-    } else {
-      return false;
-    }
-  }
-  return function(app, args, out);
+  RegisteredFunction function =
+      registered_functions_[id].load(std::memory_order_acquire);
+  return function ? function(app, args, out) : false;
 }
 
 }  // namespace internal
@@ -17,9 +17,7 @@
 #ifndef FIREBASE_APP_SRC_FUNCTION_REGISTRY_H_
 #define FIREBASE_APP_SRC_FUNCTION_REGISTRY_H_
 
-#include <map>
-
-#include "app/src/include/firebase/internal/mutex.h"
+#include <atomic>
 
 namespace firebase {
 class App;
@@ -38,12 +36,19 @@ enum FunctionId {
   FnAppCheckGetTokenAsync,
   FnAppCheckAddListener,
   FnAppCheckRemoveListener,
+  // Number of identifiers. Must be last.
+  FnCount,
 };
 
 // Class for providing a generic way for firebase libraries to expose their
 // methods to each other, without requiring a link dependency.
+//
+// Functions are looked up on every request that needs an auth or App Check
+// token, so lookups don't take a lock.
 class FunctionRegistry {
  public:
+  FunctionRegistry();
+
   // Template for the functions we pass around.  They will always accept a
   // pointer to the current app, as well as a pointer that can be used for
   // arbitrary structs, and a pointer indicating where to place the output
@@ -66,8 +71,8 @@ class FunctionRegistry {
   bool CallFunction(FunctionId id, App* app, void* args, void* out);
 
  private:
-  std::map<FunctionId, RegisteredFunction> registered_functions_;
-  Mutex map_mutex_;
+  // Function bound to each identifier, or nullptr.
+  std::atomic<RegisteredFunction> registered_functions_[FnCount];
 };
 
 }  // namespace internal
@@ -22,11 +22,14 @@ FutureManager::FutureManager() {}
 
 FutureManager::~FutureManager() {
   MutexLock lock(future_api_mutex_);
-  // Move all future APIs to the orphaned list.
-  for (auto i = future_apis_.begin(); i != future_apis_.end(); ++i) {
-    orphaned_future_apis_.insert(i->second);
+  {
+    ExclusiveLock apis_lock(future_apis_lock_);
+    // Move all future APIs to the orphaned list.
+    for (auto i = future_apis_.begin(); i != future_apis_.end(); ++i) {
+      orphaned_future_apis_.insert(i->second);
+    }
+    future_apis_.clear();
   }
-  future_apis_.clear();
   CleanupOrphanedFutureApis(/*force_delete_all=*/true);
 }
 
@@ -41,42 +44,60 @@ void FutureManager::InsertFutureApi(void* owner,
                                     ReferenceCountedFutureImpl* api) {
   MutexLock lock(future_api_mutex_);
   orphaned_future_apis_.erase(api);
-  auto found = future_apis_.find(owner);
-  if (found != future_apis_.end()) {
-    // Orphan the existing API, and set the new one.
-    orphaned_future_apis_.insert(found->second);
-    future_apis_[owner] = api;
+  ReferenceCountedFutureImpl* previous_api = nullptr;
+  {
+    ExclusiveLock apis_lock(future_apis_lock_);
+    auto found = future_apis_.find(owner);
+    if (found != future_apis_.end()) {
+      previous_api = found->second;
+      found->second = api;
+    } else {
+      future_apis_.insert(std::make_pair(owner, api));
+    }
+  }
+  if (previous_api) {
+    // Orphan the existing API.
+    orphaned_future_apis_.insert(previous_api);
     CleanupOrphanedFutureApis();
-  } else {
-    future_apis_.insert(std::make_pair(owner, api));
   }
 }
 
 void FutureManager::MoveFutureApi(void* prev_owner, void* new_owner) {
   MutexLock lock(future_api_mutex_);
 
-  auto found = future_apis_.find(prev_owner);
-  if (found != future_apis_.end()) {
-    ReferenceCountedFutureImpl* future_api = found->second;
-    future_apis_.erase(found);
-    InsertFutureApi(new_owner, future_api);
+  ReferenceCountedFutureImpl* future_api = nullptr;
+  {
+    ExclusiveLock apis_lock(future_apis_lock_);
+    auto found = future_apis_.find(prev_owner);
+    if (found != future_apis_.end()) {
+      future_api = found->second;
+      future_apis_.erase(found);
+    }
   }
+  if (future_api) InsertFutureApi(new_owner, future_api);
 }
 
 void FutureManager::ReleaseFutureApi(void* prev_owner) {
   MutexLock lock(future_api_mutex_);
 
-  auto found = future_apis_.find(prev_owner);
-  if (found != future_apis_.end()) {
+  ReferenceCountedFutureImpl* future_api = nullptr;
+  {
+    ExclusiveLock apis_lock(future_apis_lock_);
+    auto found = future_apis_.find(prev_owner);
+    if (found != future_apis_.end()) {
+      future_api = found->second;
+      future_apis_.erase(found);
+    }
+  }
+  if (future_api) {
     // Move the API to the orphaned list.
-    orphaned_future_apis_.insert(found->second);
-    future_apis_.erase(found);
+    orphaned_future_apis_.insert(future_api);
     CleanupOrphanedFutureApis();
   }
 }
 
 ReferenceCountedFutureImpl* FutureManager::GetFutureApi(void* owner) {
-  MutexLock lock(future_api_mutex_);
+  SharedLock lock(future_apis_lock_);
 
   auto found = future_apis_.find(owner);
   if (found != future_apis_.end()) {
@@ -23,6 +23,7 @@
 #include "app/src/include/firebase/future.h"
 #include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/reference_counted_future_impl.h"
+#include "app/src/shared_mutex.h"
 
 namespace firebase {
 
@@ -75,8 +76,13 @@ class FutureManager {
   //   LastResult list have one reference, and any others have zero references.)
   bool IsSafeToDeleteFutureApi(ReferenceCountedFutureImpl* api);
 
-  // For handling Future APIs.
+  // For handling Future APIs. Serializes changes to the APIs, and is
+  // recursive, as deleting an orphaned API can release other APIs.
   Mutex future_api_mutex_;
+  // Guards future_apis_, which is read for every Future the SDK returns, so
+  // that GetFutureApi() only takes it shared. It is only held exclusively,
+  // with future_api_mutex_ held, while future_apis_ is changed.
+  SharedMutex future_apis_lock_;
   std::map<void*, ReferenceCountedFutureImpl*> future_apis_;
   std::set<ReferenceCountedFutureImpl*> orphaned_future_apis_;
 };
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app/src/future_util.h"
+
+namespace firebase {
+namespace detail {
+
+ReferenceCountedFutureImpl* GetFutureUtilApi() {
+  // Never deleted, since the futures it returns can be kept by the app
+  // indefinitely.
+  static auto* api = new ReferenceCountedFutureImpl(/*last_result_count=*/0);
+  return api;
+}
+
+FutureHandle AllocFuture(ReferenceCountedFutureImpl* api, void* data,
+                         void (*delete_data)(void* data)) {
+  return api->AllocWithData(data, delete_data);
+}
+
+void CompleteFuture(ReferenceCountedFutureImpl* api, const FutureHandle& handle,
+                    int error, const char* error_message,
+                    void (*populate_data)(void* data, void* context),
+                    void* context) {
+  api->Complete(SafeFutureHandle<void>(handle), error, error_message,
+                [populate_data, context](void* data) {
+                  if (populate_data) populate_data(data, context);
+                });
+}
+
+}  // namespace detail
+// NOLINTNEXTLINE - allow namespace overridden
+}  // namespace firebase
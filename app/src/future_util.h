@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_APP_SRC_FUTURE_UTIL_H_
+#define FIREBASE_APP_SRC_FUTURE_UTIL_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "app/src/include/firebase/future.h"
+#include "app/src/include/firebase/future_util.h"
+#include "app/src/reference_counted_future_impl.h"
+
+// Overloads of the combinators in firebase/future_util.h that allocate the
+// futures they return from an SDK's own API, so that they are tracked and
+// cleaned up with its other futures:
+//
+//   Future<Token> token = GetToken();
+//   Future<Response> response =
+//       Then(api, token, [](const Token& token) { return Send(token); });
+//
+// `api` must outlive every pending continuation.
+
+namespace firebase {
+
+// Same as Then(future, continuation), allocating the returned future from
+// `api`.
+template <typename T, typename F,
+          typename R = typename detail::ThenResult<
+              detail::ContinuationResult<T, F>>::type>
+Future<R> Then(ReferenceCountedFutureImpl* api, const Future<T>& future,
+               F continuation) {
+  return detail::ThenImpl(api, future, std::move(continuation));
+}
+
+// Same as WhenAll(futures), allocating the returned future from `api`.
+template <typename FutureType>
+Future<void> WhenAll(ReferenceCountedFutureImpl* api,
+                     const std::vector<FutureType>& futures) {
+  return detail::WhenAllImpl(api, futures);
+}
+
+// Same as WhenAny(futures), allocating the returned future from `api`.
+template <typename FutureType>
+Future<size_t> WhenAny(ReferenceCountedFutureImpl* api,
+                       const std::vector<FutureType>& futures) {
+  return detail::WhenAnyImpl(api, futures);
+}
+
+// NOLINTNEXTLINE - allow namespace overridden
+}  // namespace firebase
+
+#endif  // FIREBASE_APP_SRC_FUTURE_UTIL_H_
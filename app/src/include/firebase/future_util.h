@@ -0,0 +1,448 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_APP_SRC_INCLUDE_FIREBASE_FUTURE_UTIL_H_
+#define FIREBASE_APP_SRC_INCLUDE_FIREBASE_FUTURE_UTIL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "firebase/future.h"
+#include "firebase/internal/mutex.h"
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif  // defined(__cpp_impl_coroutine)
+
+namespace firebase {
+
+/// @brief Error of a future returned by Then(), WhenAll() or WhenAny() that
+/// completes because one of its inputs was invalid.
+const int kFutureErrorInvalid = -1;
+
+// The combinators register lambdas as completion callbacks.
+#if defined(FIREBASE_USE_STD_FUNCTION) || defined(DOXYGEN)
+
+/// @cond FIREBASE_APP_INTERNAL
+class ReferenceCountedFutureImpl;
+
+namespace detail {
+
+// Returns the API that allocates the futures returned by the combinators
+// below.
+ReferenceCountedFutureImpl* GetFutureUtilApi();
+
+// Allocates a pending future from `api`. Its result is `data`, which is
+// deleted with `delete_data`, or nothing if `data` is null.
+FutureHandle AllocFuture(ReferenceCountedFutureImpl* api, void* data,
+                         void (*delete_data)(void* data));
+
+// Completes a future allocated by AllocFuture(). If `populate_data` isn't
+// null, it is called with the result data of the future and `context` first.
+void CompleteFuture(ReferenceCountedFutureImpl* api, const FutureHandle& handle,
+                    int error, const char* error_message,
+                    void (*populate_data)(void* data, void* context),
+                    void* context);
+
+// Allocates and completes futures with a result of type T.
+template <typename T>
+struct FutureData {
+  static FutureHandle Alloc(ReferenceCountedFutureImpl* api) {
+    return AllocFuture(api, new T(), Delete);
+  }
+
+  static void CompleteWithResult(ReferenceCountedFutureImpl* api,
+                                 const FutureHandle& handle, T result) {
+    CompleteFuture(api, handle, 0, nullptr, Populate, &result);
+  }
+
+ private:
+  static void Delete(void* data) { delete static_cast<T*>(data); }
+
+  static void Populate(void* data, void* result) {
+    *static_cast<T*>(data) = std::move(*static_cast<T*>(result));
+  }
+};
+
+template <>
+struct FutureData<void> {
+  static FutureHandle Alloc(ReferenceCountedFutureImpl* api) {
+    return AllocFuture(api, nullptr, nullptr);
+  }
+};
+
+// Calls a continuation with the result of a successfully completed future.
+template <typename T>
+struct Invoker {
+  template <typename F>
+  static auto Invoke(F& continuation, const Future<T>& future)
+      -> decltype(continuation(*future.result())) {
+    return continuation(*future.result());
+  }
+};
+
+template <>
+struct Invoker<void> {
+  template <typename F>
+  static auto Invoke(F& continuation, const Future<void>&)
+      -> decltype(continuation()) {
+    return continuation();
+  }
+};
+
+template <typename T, typename F>
+using ContinuationResult = decltype(Invoker<T>::Invoke(
+    std::declval<F&>(), std::declval<const Future<T>&>()));
+
+// Result type of the future returned by Then(), which unwraps a continuation
+// that returns a Future.
+template <typename R>
+struct ThenResult {
+  typedef R type;
+};
+
+template <typename U>
+struct ThenResult<Future<U>> {
+  typedef U type;
+};
+
+// Completes `handle` with the error of a failed or invalid future.
+inline void CompleteWithError(ReferenceCountedFutureImpl* api,
+                              const FutureHandle& handle,
+                              const FutureBase& future) {
+  if (future.status() == kFutureStatusInvalid) {
+    CompleteFuture(api, handle, kFutureErrorInvalid, "Future is invalid.",
+                   nullptr, nullptr);
+  } else {
+    CompleteFuture(api, handle, future.error(), future.error_message(),
+                   nullptr, nullptr);
+  }
+}
+
+// Completes `handle` with the result of a successfully completed future.
+template <typename T>
+struct Forwarder {
+  static void Complete(ReferenceCountedFutureImpl* api,
+                       const FutureHandle& handle, const FutureBase& future) {
+    const T* result = static_cast<const Future<T>&>(future).result();
+    FutureData<T>::CompleteWithResult(api, handle, *result);
+  }
+};
+
+template <>
+struct Forwarder<void> {
+  static void Complete(ReferenceCountedFutureImpl* api,
+                       const FutureHandle& handle, const FutureBase&) {
+    CompleteFuture(api, handle, 0, nullptr, nullptr, nullptr);
+  }
+};
+
+// Completes `handle` the same way as `future` once it completes.
+template <typename T>
+void ForwardWhenComplete(ReferenceCountedFutureImpl* api,
+                         const FutureHandle& handle, const Future<T>& future) {
+  if (future.status() == kFutureStatusInvalid) {
+    CompleteWithError(api, handle, future);
+    return;
+  }
+  future.AddOnCompletion([api, handle](const FutureBase& completed) {
+    if (completed.error() != 0) {
+      CompleteWithError(api, handle, completed);
+    } else {
+      Forwarder<T>::Complete(api, handle, completed);
+    }
+  });
+}
+
+// Runs a continuation and completes `handle` with what it returns.
+template <typename R>
+struct ContinuationRunner {
+  template <typename F, typename T>
+  static void Run(ReferenceCountedFutureImpl* api, const FutureHandle& handle,
+                  F& continuation, const Future<T>& future) {
+    FutureData<R>::CompleteWithResult(api, handle,
+                                      Invoker<T>::Invoke(continuation, future));
+  }
+};
+
+template <>
+struct ContinuationRunner<void> {
+  template <typename F, typename T>
+  static void Run(ReferenceCountedFutureImpl* api, const FutureHandle& handle,
+                  F& continuation, const Future<T>& future) {
+    Invoker<T>::Invoke(continuation, future);
+    CompleteFuture(api, handle, 0, nullptr, nullptr, nullptr);
+  }
+};
+
+template <typename U>
+struct ContinuationRunner<Future<U>> {
+  template <typename F, typename T>
+  static void Run(ReferenceCountedFutureImpl* api, const FutureHandle& handle,
+                  F& continuation, const Future<T>& future) {
+    ForwardWhenComplete(api, handle, Invoker<T>::Invoke(continuation, future));
+  }
+};
+
+// Shared by the completion callbacks registered by WhenAll().
+class WhenAllState {
+ public:
+  WhenAllState(ReferenceCountedFutureImpl* api, const FutureHandle& handle,
+               size_t count)
+      : api_(api),
+        handle_(handle),
+        remaining_(count),
+        failed_index_(count),
+        error_(0) {}
+
+  void OnComplete(size_t index, const FutureBase& future) {
+    if (future.status() != kFutureStatusComplete || future.error() != 0) {
+      MutexLock lock(mutex_);
+      if (index < failed_index_) {
+        failed_index_ = index;
+        if (future.status() == kFutureStatusComplete) {
+          error_ = future.error();
+          const char* message = future.error_message();
+          error_message_ = message ? message : "";
+        } else {
+          error_ = kFutureErrorInvalid;
+          error_message_ = "Future is invalid.";
+        }
+      }
+    }
+    // The last input to complete sees the errors recorded by the others.
+    if (remaining_.fetch_sub(1) != 1) return;
+    CompleteFuture(api_, handle_, error_, error_message_.c_str(), nullptr,
+                   nullptr);
+  }
+
+ private:
+  ReferenceCountedFutureImpl* api_;
+  FutureHandle handle_;
+  std::atomic<size_t> remaining_;
+  Mutex mutex_;
+  // Index of the first input that failed, or the number of inputs if none
+  // have, and its error.
+  size_t failed_index_;
+  int error_;
+  std::string error_message_;
+};
+
+// Shared by the completion callbacks registered by WhenAny().
+class WhenAnyState {
+ public:
+  WhenAnyState(ReferenceCountedFutureImpl* api, const FutureHandle& handle)
+      : api_(api), handle_(handle), done_(false) {}
+
+  void OnComplete(size_t index) {
+    if (done_.exchange(true)) return;
+    FutureData<size_t>::CompleteWithResult(api_, handle_, index);
+  }
+
+ private:
+  ReferenceCountedFutureImpl* api_;
+  FutureHandle handle_;
+  std::atomic<bool> done_;
+};
+
+template <typename T, typename F,
+          typename R = typename ThenResult<ContinuationResult<T, F>>::type>
+Future<R> ThenImpl(ReferenceCountedFutureImpl* api,
+                   const Future<T>& future, F continuation) {
+  FutureHandle handle = FutureData<R>::Alloc(api);
+  Future<R> result(handle.api(), handle);
+  if (future.status() == kFutureStatusInvalid) {
+    CompleteWithError(api, handle, future);
+    return result;
+  }
+  future.AddOnCompletion(
+      [api, handle, continuation](const FutureBase& completed) mutable {
+        if (completed.error() != 0) {
+          CompleteWithError(api, handle, completed);
+          return;
+        }
+        ContinuationRunner<ContinuationResult<T, F>>::Run(
+            api, handle, continuation,
+            static_cast<const Future<T>&>(completed));
+      });
+  return result;
+}
+
+template <typename FutureType>
+Future<void> WhenAllImpl(ReferenceCountedFutureImpl* api,
+                         const std::vector<FutureType>& futures) {
+  static_assert(std::is_base_of<FutureBase, FutureType>::value,
+                "WhenAll() takes a vector of Futures.");
+  FutureHandle handle = FutureData<void>::Alloc(api);
+  Future<void> result(handle.api(), handle);
+  if (futures.empty()) {
+    CompleteFuture(api, handle, 0, nullptr, nullptr, nullptr);
+    return result;
+  }
+  auto state = std::make_shared<WhenAllState>(api, handle, futures.size());
+  for (size_t i = 0; i < futures.size(); ++i) {
+    const FutureBase& future = futures[i];
+    if (future.status() == kFutureStatusInvalid) {
+      state->OnComplete(i, future);
+    } else {
+      future.AddOnCompletion([state, i](const FutureBase& completed) {
+        state->OnComplete(i, completed);
+      });
+    }
+  }
+  return result;
+}
+
+template <typename FutureType>
+Future<size_t> WhenAnyImpl(ReferenceCountedFutureImpl* api,
+                           const std::vector<FutureType>& futures) {
+  static_assert(std::is_base_of<FutureBase, FutureType>::value,
+                "WhenAny() takes a vector of Futures.");
+  FutureHandle handle = FutureData<size_t>::Alloc(api);
+  Future<size_t> result(handle.api(), handle);
+  if (futures.empty()) {
+    CompleteFuture(api, handle, kFutureErrorInvalid, "No futures to wait for.",
+                   nullptr, nullptr);
+    return result;
+  }
+  auto state = std::make_shared<WhenAnyState>(api, handle);
+  for (size_t i = 0; i < futures.size(); ++i) {
+    const FutureBase& future = futures[i];
+    if (future.status() == kFutureStatusInvalid) {
+      state->OnComplete(i);
+      break;
+    }
+    future.AddOnCompletion(
+        [state, i](const FutureBase&) { state->OnComplete(i); });
+  }
+  return result;
+}
+
+}  // namespace detail
+/// @endcond
+
+/// @brief Returns a future for the value of a continuation applied to the
+/// result of another future.
+///
+/// The continuation runs on the thread that completes `future`, or right away
+/// if it has already completed, so it should return quickly:
+///
+/// @code{.cpp}
+///   firebase::Future<std::string> name = firebase::Then(
+///       user.Reload(), [&user]() { return user.display_name(); });
+/// @endcode
+///
+/// If `future` fails, the returned future fails with the same error and the
+/// continuation is not called. If the continuation returns a Future, the
+/// returned future completes when that one does, so calls can be chained.
+///
+/// @param[in] future Future to wait for.
+/// @param[in] continuation Function called with the result of `future`, or
+/// with no arguments if it is a Future<void>.
+///
+/// @return A future for the value returned by `continuation`.
+template <typename T, typename F,
+          typename R = typename detail::ThenResult<
+              detail::ContinuationResult<T, F>>::type>
+Future<R> Then(const Future<T>& future, F continuation) {
+  return detail::ThenImpl(detail::GetFutureUtilApi(), future,
+                      std::move(continuation));
+}
+
+/// @brief Returns a future that completes once all of the given futures have
+/// completed.
+///
+/// The returned future fails with the error of the first of `futures`, in
+/// order, that failed or is invalid. The results are read from `futures`
+/// themselves.
+///
+/// @param[in] futures Futures to wait for, of any result type.
+template <typename FutureType>
+Future<void> WhenAll(const std::vector<FutureType>& futures) {
+  return detail::WhenAllImpl(detail::GetFutureUtilApi(), futures);
+}
+
+/// @brief Returns a future for the index of the first of the given futures to
+/// complete, whether or not it succeeded.
+///
+/// Invalid futures count as complete. The returned future fails with
+/// kFutureErrorInvalid if `futures` is empty.
+///
+/// @param[in] futures Futures to wait for, of any result type.
+template <typename FutureType>
+Future<size_t> WhenAny(const std::vector<FutureType>& futures) {
+  return detail::WhenAnyImpl(detail::GetFutureUtilApi(), futures);
+}
+
+#if defined(__cpp_impl_coroutine)
+
+/// @brief Suspends a coroutine until a future completes, then resumes it on
+/// the thread that completed the future.
+///
+/// co_await returns the completed future:
+///
+/// @code{.cpp}
+///   firebase::Future<void> reloaded = co_await user.Reload();
+/// @endcode
+template <typename T>
+class FutureAwaiter {
+ public:
+  /// @brief Waits for `future`.
+  explicit FutureAwaiter(const Future<T>& future) : future_(future) {}
+
+  /// @cond FIREBASE_APP_INTERNAL
+  bool await_ready() const {
+    return future_.status() != kFutureStatusPending;
+  }
+
+  bool await_suspend(std::coroutine_handle<> coroutine) {
+    // The callback runs inline if the future completed after await_ready(),
+    // while future_ is still locked. Whichever of the callback and this
+    // function gets here second decides how the coroutine continues, so it is
+    // never resumed from inside AddOnCompletion().
+    auto completed = std::make_shared<std::atomic<bool>>(false);
+    future_.AddOnCompletion([completed, coroutine](const FutureBase&) {
+      if (completed->exchange(true)) coroutine.resume();
+    });
+    return !completed->exchange(true);
+  }
+
+  Future<T> await_resume() { return std::move(future_); }
+  /// @endcond
+
+ private:
+  Future<T> future_;
+};
+
+/// @brief Allows a Future to be co_awaited.
+template <typename T>
+FutureAwaiter<T> operator co_await(const Future<T>& future) {
+  return FutureAwaiter<T>(future);
+}
+
+#endif  // defined(__cpp_impl_coroutine)
+
+#endif  // defined(FIREBASE_USE_STD_FUNCTION) || defined(DOXYGEN)
+
+// NOLINTNEXTLINE - allow namespace overridden
+}  // namespace firebase
+
+#endif  // FIREBASE_APP_SRC_INCLUDE_FIREBASE_FUTURE_UTIL_H_
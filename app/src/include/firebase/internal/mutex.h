@@ -25,6 +25,19 @@
 #include <pthread.h>
 #endif  // FIREBASE_PLATFORM_WINDOWS
 
+#if FIREBASE_MUTEX_PROFILING
+// The mutex profile records each acquisition under the code that took the
+// lock, which is the return address of the function using these.
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FIREBASE_MUTEX_CALL_SITE() _ReturnAddress()
+#define FIREBASE_MUTEX_NOINLINE __declspec(noinline)
+#else
+#define FIREBASE_MUTEX_CALL_SITE() __builtin_return_address(0)
+#define FIREBASE_MUTEX_NOINLINE __attribute__((noinline))
+#endif  // defined(_MSC_VER)
+#endif  // FIREBASE_MUTEX_PROFILING
+
 namespace firebase {
 
 #if !defined(DOXYGEN)
@@ -47,6 +60,12 @@ class Mutex {
   // Acquires the lock for this mutex, blocking until it is available.
   void Acquire();
 
+#if FIREBASE_MUTEX_PROFILING
+  // Same as Acquire(), recording the acquisition under `call_site` in the
+  // mutex profile.
+  void Acquire(const void* call_site);
+#endif  // FIREBASE_MUTEX_PROFILING
+
   // Releases the lock for this mutex acquired by a previous `Acquire()` call.
   void Release();
 
@@ -82,7 +101,15 @@ class Mutex {
 ///   \endcode
 class MutexLock {
  public:
+#if FIREBASE_MUTEX_PROFILING
+  // Never inlined, so that its return address is the code taking the lock
+  // even when the caller is inlined into another function.
+  FIREBASE_MUTEX_NOINLINE explicit MutexLock(Mutex& mutex) : mutex_(&mutex) {
+    mutex_->Acquire(FIREBASE_MUTEX_CALL_SITE());
+  }
+#else
   explicit MutexLock(Mutex& mutex) : mutex_(&mutex) { mutex_->Acquire(); }
+#endif  // FIREBASE_MUTEX_PROFILING
   ~MutexLock() { mutex_->Release(); }
 
  private:
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_APP_SRC_INCLUDE_FIREBASE_METRICS_H_
+#define FIREBASE_APP_SRC_INCLUDE_FIREBASE_METRICS_H_
+
+#include <cstdint>
+#include <string>
+
+namespace firebase {
+
+/// @brief Namespace for reading the SDK's internal metrics.
+///
+/// The SDK counts requests, cache hits, write sizes and other events, and
+/// times the sections of code that handle them. Recording is disabled by
+/// default, in which case it costs almost nothing. Once enabled, the values
+/// recorded can be read with a MetricsListener or dumped as text.
+namespace metrics {
+
+/// @brief Starts or stops recording metrics.
+///
+/// Values recorded so far are kept when recording stops.
+///
+/// @param[in] enabled Whether to record metrics. Disabled by default.
+void SetEnabled(bool enabled);
+
+/// @brief Receives the values of metrics and the spans that are timed.
+///
+/// Override the methods for the kinds of values you are interested in.
+class MetricsListener {
+ public:
+  virtual ~MetricsListener();
+
+  /// @brief Called by Collect() with the value of a counter, which only goes
+  /// up, like the number of requests sent.
+  ///
+  /// @param[in] name Name of the metric, e.g. "firebase_foo_total".
+  /// @param[in] help Description of the metric.
+  /// @param[in] value Current value of the counter.
+  virtual void OnCounter(const char* name, const char* help, uint64_t value) {}
+
+  /// @brief Called by Collect() with the value of a gauge, which goes up and
+  /// down, like the length of a queue.
+  ///
+  /// @param[in] name Name of the metric.
+  /// @param[in] help Description of the metric.
+  /// @param[in] value Current value of the gauge.
+  virtual void OnGauge(const char* name, const char* help, int64_t value) {}
+
+  /// @brief Called by Collect() with the values of a histogram, which counts
+  /// the values recorded in buckets.
+  ///
+  /// Bucket 0 holds values of 0, and bucket i holds values from 2^(i-1) up to
+  /// 2^i - 1. The last bucket also holds every larger value.
+  ///
+  /// @param[in] name Name of the metric.
+  /// @param[in] help Description of the metric.
+  /// @param[in] bucket_counts Number of values recorded in each bucket.
+  /// @param[in] num_buckets Number of buckets.
+  /// @param[in] count Number of values recorded.
+  /// @param[in] sum Sum of the values recorded.
+  virtual void OnHistogram(const char* name, const char* help,
+                           const uint64_t* bucket_counts, int num_buckets,
+                           uint64_t count, uint64_t sum) {}
+
+  /// @brief Called when a timed section of code ends, while this listener is
+  /// set with SetTraceListener().
+  ///
+  /// This is called on the thread that ran the code, so it must be thread
+  /// safe and should return quickly.
+  ///
+  /// @param[in] name Name of the section of code.
+  /// @param[in] start_microseconds When the section started, on a monotonic
+  /// clock.
+  /// @param[in] duration_microseconds How long the section took.
+  virtual void OnSpan(const char* name, int64_t start_microseconds,
+                      int64_t duration_microseconds) {}
+};
+
+/// @brief Passes the current value of every metric to a listener.
+///
+/// @param[in] listener Listener to call on this thread before returning.
+void Collect(MetricsListener* listener);
+
+/// @brief Sets the listener that receives each timed section of code as it
+/// ends.
+///
+/// @param[in] listener Listener to receive the sections, or nullptr to stop
+/// tracing. It must remain valid until it is replaced.
+void SetTraceListener(MetricsListener* listener);
+
+/// @brief Returns the values of all metrics in the Prometheus text exposition
+/// format.
+std::string DumpPrometheus();
+
+/// @brief Returns the values of all metrics as a JSON object, keyed by metric
+/// name.
+std::string DumpJson();
+
+}  // namespace metrics
+// NOLINTNEXTLINE - allow namespace overridden
+}  // namespace firebase
+
+#endif  // FIREBASE_APP_SRC_INCLUDE_FIREBASE_METRICS_H_
@@ -20,10 +20,19 @@
 #include <stdio.h>
 
 #include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "app/src/assert.h"
 #include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/include/firebase/internal/platform.h"
+#include "app/src/semaphore.h"
+#include "app/src/thread.h"
+
+#if !FIREBASE_PLATFORM_WINDOWS
+#include <unistd.h>
+#endif  // !FIREBASE_PLATFORM_WINDOWS
 
 #if !defined(FIREBASE_LOG_DEBUG)
 #define FIREBASE_LOG_DEBUG 0
@@ -35,6 +44,15 @@
 #define FIREBASE_LOG_TO_FILE 0
 #endif  // FIREBASE_LOG_DEBUG
 #endif  // !defined(FIREBASE_LOG_TO_FILE)
+// Whether messages for the default log callback and the log file are written
+// from a background thread.
+#if !defined(FIREBASE_LOG_ASYNC)
+#if FIREBASE_PLATFORM_DESKTOP
+#define FIREBASE_LOG_ASYNC 1
+#else
+#define FIREBASE_LOG_ASYNC 0
+#endif  // FIREBASE_PLATFORM_DESKTOP
+#endif  // !defined(FIREBASE_LOG_ASYNC)
 
 namespace firebase {
 
@@ -83,13 +101,178 @@ static void DefaultLogCallback(LogLevel log_level, const char* message,
   }
 }
 
+#if FIREBASE_LOG_TO_FILE
+// File messages are logged to, once it has been opened.
+static FILE* g_log_file = nullptr;
+#endif  // FIREBASE_LOG_TO_FILE
+
+#if FIREBASE_LOG_ASYNC
+// How long the process waits on exit for queued messages to be written by
+// the writer's thread.
+static const int kExitFlushTimeoutMilliseconds = 1000;
+
+// Writes messages for the default log callback and the log file on a
+// background thread, so that logging only formats a message and queues it
+// rather than waiting on the console or the disk.
+//
+// Messages are written in the order they are queued, and the log file is
+// flushed once per batch of messages rather than once per message.
+class AsyncLogWriter {
+ public:
+  // Returns the writer, starting it on first use. The writer is never
+  // destroyed so that it can be used while the process exits.
+  //
+  // Returns nullptr in a process forked after the writer was started, as the
+  // writer's thread only exists in the parent.
+  static AsyncLogWriter* Get() {
+    static AsyncLogWriter* writer = new AsyncLogWriter();
+#if !FIREBASE_PLATFORM_WINDOWS
+    if (getpid() != writer->process_id_) return nullptr;
+#endif  // !FIREBASE_PLATFORM_WINDOWS
+    return writer;
+  }
+
+  // Queue a message for the default log callback.
+  void WriteToCallback(LogLevel log_level, const char* message) {
+    Queue(Message(log_level, false, message, nullptr));
+  }
+
+#if FIREBASE_LOG_TO_FILE
+  // Queue a line for the log file.
+  void WriteToFile(std::string line) {
+    Queue(Message(kLogLevelVerbose, true, std::move(line), nullptr));
+  }
+#endif  // FIREBASE_LOG_TO_FILE
+
+  // Block until all messages queued so far have been written.
+  void Flush() {
+    if (Thread::IsCurrentThread(thread_id_)) return;
+    Semaphore written(0);
+    Queue(Message(kLogLevelVerbose, false, std::string(), &written));
+    written.Wait();
+  }
+
+ private:
+  struct Message {
+    Message(LogLevel log_level_, bool to_file_, std::string text_,
+            Semaphore* written_)
+        : log_level(log_level_),
+          to_file(to_file_),
+          text(std::move(text_)),
+          written(written_) {}
+
+    LogLevel log_level;
+    bool to_file;
+    std::string text;
+    // If set, this is not a message but a request to be notified when all
+    // previous messages have been written.
+    Semaphore* written;
+  };
+
+  AsyncLogWriter() : pending_(0), started_(0) {
+#if !FIREBASE_PLATFORM_WINDOWS
+    process_id_ = getpid();
+#endif  // !FIREBASE_PLATFORM_WINDOWS
+    Thread thread(&AsyncLogWriter::RunThread, this);
+    thread.Detach();
+    // Wait for the thread to record its id.
+    started_.Wait();
+    atexit(FlushAtExit);
+  }
+
+  void Queue(Message message) {
+    bool was_empty;
+    {
+      MutexLock lock(mutex_);
+      was_empty = queue_.empty();
+      queue_.push_back(std::move(message));
+    }
+    // The writer takes the whole queue each time it wakes up, so it only
+    // needs to be woken when the queue stops being empty.
+    if (was_empty) pending_.Post();
+  }
+
+  static void RunThread(AsyncLogWriter* writer) { writer->Run(); }
+
+  // The writer's thread may already be gone when the process exits, e.g. in
+  // a Windows DLL, so it is only waited for briefly before the messages it
+  // hasn't taken are written on the exiting thread.
+  static void FlushAtExit() {
+    AsyncLogWriter* writer = Get();
+    if (!writer) return;
+    // Leaked if the wait times out, as the thread may still post it.
+    Semaphore* written = new Semaphore(0);
+    writer->Queue(Message(kLogLevelVerbose, false, std::string(), written));
+    if (written->TimedWait(kExitFlushTimeoutMilliseconds)) {
+      delete written;
+      return;
+    }
+    std::vector<Message> batch;
+    {
+      MutexLock lock(writer->mutex_);
+      batch.swap(writer->queue_);
+    }
+    WriteBatch(&batch);
+  }
+
+  void Run() {
+    thread_id_ = Thread::CurrentId();
+    started_.Post();
+    LogInitialize();
+    std::vector<Message> batch;
+    for (;;) {
+      pending_.Wait();
+      {
+        MutexLock lock(mutex_);
+        batch.swap(queue_);
+      }
+      WriteBatch(&batch);
+    }
+  }
+
+  // Write a batch of messages and clear it.
+  static void WriteBatch(std::vector<Message>* batch) {
+    for (Message& message : *batch) {
+      if (message.written) {
+        FlushFile();
+        message.written->Post();
+      } else if (message.to_file) {
+#if FIREBASE_LOG_TO_FILE
+        fputs(message.text.c_str(), g_log_file);
+#endif  // FIREBASE_LOG_TO_FILE
+      } else {
+        InternalLogMessage(message.log_level, "%s", message.text.c_str());
+      }
+    }
+    FlushFile();
+    batch->clear();
+  }
+
+  static void FlushFile() {
+#if FIREBASE_LOG_TO_FILE
+    if (g_log_file) fflush(g_log_file);
+#endif  // FIREBASE_LOG_TO_FILE
+  }
+
+  Mutex mutex_;
+  std::vector<Message> queue_;
+  // Posted when queue_ becomes non-empty.
+  Semaphore pending_;
+  // Posted once the thread has started.
+  Semaphore started_;
+  Thread::Id thread_id_;
+#if !FIREBASE_PLATFORM_WINDOWS
+  pid_t process_id_;
+#endif  // !FIREBASE_PLATFORM_WINDOWS
+};
+#endif  // FIREBASE_LOG_ASYNC
+
 #if FIREBASE_LOG_TO_FILE
 // Log a message to a log file.
 static void LogToFile(LogLevel log_level, const char* format, va_list args) {
 #define FIREBASE_LOG_FILENAME "firebase.log"
 // Wide string version for Windows.
 #define FIREBASE_LOG_FILENAME_W L"firebase.log"
-  static FILE* log_file = nullptr;
   static bool attempted_to_open_log_file = false;
   static const char* kLogLevelToPrefixString[] = {
       "V",  // kLogLevelVerbose
@@ -100,24 +283,47 @@ static void LogToFile(LogLevel log_level, const char* format, va_list args) {
       "A",  // kLogLevelAssert
   };
   if (attempted_to_open_log_file) {
-    if (log_file) {
-      fprintf(log_file,
-              "%s: ", log_level ? kLogLevelToPrefixString[log_level] : "?");
-      vfprintf(log_file, format, args);
-      fprintf(log_file, "\n");
+    if (g_log_file) {
+      std::string text = log_level ? kLogLevelToPrefixString[log_level] : "?";
+      text += ": ";
+      char buffer[512];
+      va_list args_copy;
+      va_copy(args_copy, args);
+      int length = vsnprintf(buffer, sizeof(buffer), format, args_copy);
+      va_end(args_copy);
+      if (length < 0) length = 0;
+      if (static_cast<size_t>(length) < sizeof(buffer)) {
+        text.append(buffer, length);
+      } else {
+        // Too long for the buffer, so format it again at its full length.
+        size_t prefix_length = text.size();
+        text.resize(prefix_length + length + 1);
+        vsnprintf(&text[prefix_length], length + 1, format, args);
+        text.resize(prefix_length + length);
+      }
+      text += '\n';
+#if FIREBASE_LOG_ASYNC
+      AsyncLogWriter* writer = AsyncLogWriter::Get();
+      if (writer) {
+        writer->WriteToFile(std::move(text));
+        return;
+      }
+#endif  // FIREBASE_LOG_ASYNC
+      MutexLock lock(*g_log_mutex);
+      fputs(text.c_str(), g_log_file);
       // Since we could crash at some point (possibly why we have logging on),
       // flush to disk.
-      fflush(log_file);
+      fflush(g_log_file);
     }
   } else {
     MutexLock lock(*g_log_mutex);
-    if (!log_file) {
+    if (!g_log_file) {
 #if FIREBASE_PLATFORM_WINDOWS
-      log_file = _wfopen(FIREBASE_LOG_FILENAME_W, L"wt");
+      g_log_file = _wfopen(FIREBASE_LOG_FILENAME_W, L"wt");
 #else
-      log_file = fopen(FIREBASE_LOG_FILENAME, "wt");
+      g_log_file = fopen(FIREBASE_LOG_FILENAME, "wt");
 #endif
-      if (!log_file) {
+      if (!g_log_file) {
         g_log_callback(kLogLevelError,
                        "Unable to open log file " FIREBASE_LOG_FILENAME,
                        g_log_callback_data);
@@ -137,18 +343,36 @@ void LogMessageWithCallbackV(LogLevel log_level, const char* format,
   // safe but the first time this is called on any platform it will be from
   // a single thread to initialize the API.
   if (!g_log_mutex) g_log_mutex = new Mutex();
-  MutexLock lock(*g_log_mutex);
 
-  LogInitialize();
 #if FIREBASE_LOG_TO_FILE
   va_list log_to_file_args;
   va_copy(log_to_file_args, args);
   LogToFile(log_level, format, log_to_file_args);
+  va_end(log_to_file_args);
 #endif  // FIREBASE_LOG_TO_FILE
+  // Check the level before formatting the message or taking the lock.
   if (log_level < GetLogLevel()) return;
 
-  static char log_buffer[512] = {0};
-  vsnprintf(log_buffer, sizeof(log_buffer) - 1, format, args);
+  // Each thread formats into its own buffer, so the lock is only needed to
+  // deliver the message.
+  char log_buffer[512];
+  vsnprintf(log_buffer, sizeof(log_buffer), format, args);
+
+#if FIREBASE_LOG_ASYNC
+  AsyncLogWriter* writer = AsyncLogWriter::Get();
+  if (writer) {
+    if (g_log_callback == DefaultLogCallback && log_level < kLogLevelError) {
+      writer->WriteToCallback(log_level, log_buffer);
+      return;
+    }
+    // Errors are logged synchronously so they are not lost if the application
+    // stops, after any messages that are still queued.
+    writer->Flush();
+  }
+#endif  // FIREBASE_LOG_ASYNC
+
+  MutexLock lock(*g_log_mutex);
+  LogInitialize();
   g_log_callback(log_level, log_buffer, g_log_callback_data);
 }
 
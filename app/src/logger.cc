@@ -20,6 +20,10 @@ namespace firebase {
 
 LoggerBase::~LoggerBase() {}
 
+bool LoggerBase::IsLogLevelEnabled(LogLevel log_level) const {
+  return log_level >= GetLogLevel();
+}
+
 void LoggerBase::LogDebug(const char* format, ...) const {
   va_list list;
   va_start(list, format);
@@ -93,6 +97,11 @@ void Logger::SetLogLevel(LogLevel log_level) { log_level_ = log_level; }
 
 LogLevel Logger::GetLogLevel() const { return log_level_; }
 
+bool Logger::IsLogLevelEnabled(LogLevel log_level) const {
+  return log_level >= log_level_ &&
+         parent_logger_->IsLogLevelEnabled(log_level);
+}
+
 void Logger::LogMessageImplV(LogLevel log_level, const char* format,
                              va_list args) const {
   parent_logger_->LogMessageV(log_level, format, args);
@@ -37,6 +37,12 @@ class LoggerBase {
   // Implementations of LoggerBase are responsible for tracking the log level.
   virtual LogLevel GetLogLevel() const = 0;
 
+  // Returns whether a message at the given level would be logged.
+  //
+  // Use this, or the FIREBASE_LOGGER_* macros below, to avoid building the
+  // arguments of a message that would be filtered out.
+  virtual bool IsLogLevelEnabled(LogLevel log_level) const;
+
   // Log a debug message to the system log.
   void LogDebug(const char* format, ...) const;
 
@@ -109,6 +115,9 @@ class Logger : public LoggerBase {
 
   LogLevel GetLogLevel() const override;
 
+  // Also checks whether the parent logger would log the message.
+  bool IsLogLevelEnabled(LogLevel log_level) const override;
+
  private:
   // Passes messages to the parent logger to be displayed.
   void LogMessageImplV(LogLevel log_level, const char* format,
@@ -120,4 +129,22 @@ class Logger : public LoggerBase {
 
 }  // namespace firebase
 
+// Log a message with a LoggerBase, only evaluating the format arguments if
+// the message would be logged. For example:
+//   FIREBASE_LOGGER_DEBUG(logger_, "Received: %s",
+//                         util::VariantToJson(message).c_str());
+#define FIREBASE_LOGGER_LOG(logger, log_level, ...)           \
+  do {                                                        \
+    const ::firebase::LoggerBase* firebase_logger = (logger); \
+    if (firebase_logger->IsLogLevelEnabled(log_level)) {      \
+      firebase_logger->LogMessage(log_level, __VA_ARGS__);    \
+    }                                                         \
+  } while (false)
+
+#define FIREBASE_LOGGER_DEBUG(logger, ...) \
+  FIREBASE_LOGGER_LOG(logger, ::firebase::kLogLevelDebug, __VA_ARGS__)
+
+#define FIREBASE_LOGGER_INFO(logger, ...) \
+  FIREBASE_LOGGER_LOG(logger, ::firebase::kLogLevelInfo, __VA_ARGS__)
+
 #endif  // FIREBASE_APP_SRC_LOGGER_H_
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app/src/metrics.h"
+
+#include <chrono>  // NOLINT
+#include <limits>
+#include <sstream>
+
+#include "app/src/include/firebase/internal/mutex.h"
+
+namespace firebase {
+namespace metrics {
+
+namespace internal {
+std::atomic<bool> g_enabled(false);
+}  // namespace internal
+
+// Sink that receives spans, if any.
+static std::atomic<Sink*> g_trace_sink(nullptr);
+
+// Listener set with SetTraceListener(), if any.
+static std::atomic<MetricsListener*> g_trace_listener(nullptr);
+
+// Linked list of all metrics.
+class Registry {
+ public:
+  // The registry is never destroyed, as metrics with static storage duration
+  // may be destroyed after it would be.
+  static Registry* Get() {
+    static Registry* registry = new Registry();
+    return registry;
+  }
+
+  void Add(Metric* metric) {
+    MutexLock lock(mutex_);
+    metric->next_ = head_;
+    head_ = metric;
+  }
+
+  void Remove(Metric* metric) {
+    MutexLock lock(mutex_);
+    for (Metric** it = &head_; *it; it = &(*it)->next_) {
+      if (*it == metric) {
+        *it = metric->next_;
+        break;
+      }
+    }
+  }
+
+  void Collect(Sink* sink) {
+    MutexLock lock(mutex_);
+    for (Metric* metric = head_; metric; metric = metric->next_) {
+      metric->Collect(sink);
+    }
+  }
+
+ private:
+  Registry() : head_(nullptr) {}
+
+  Mutex mutex_;
+  Metric* head_;
+};
+
+void SetEnabled(bool enabled) {
+  internal::g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+Metric::Metric(const char* name, const char* help)
+    : name_(name), help_(help), next_(nullptr) {
+  Registry::Get()->Add(this);
+}
+
+Metric::~Metric() { Registry::Get()->Remove(this); }
+
+void Counter::Collect(Sink* sink) const { sink->OnCounter(*this); }
+
+void Gauge::Collect(Sink* sink) const { sink->OnGauge(*this); }
+
+void Histogram::Collect(Sink* sink) const { sink->OnHistogram(*this); }
+
+Histogram::Histogram(const char* name, const char* help)
+    : Metric(name, help), count_(0), sum_(0) {
+  for (int i = 0; i < kBuckets; ++i) buckets_[i].store(0);
+}
+
+uint64_t Histogram::BucketUpperBound(int bucket) {
+  if (bucket >= kBuckets - 1) return std::numeric_limits<uint64_t>::max();
+  return (static_cast<uint64_t>(1) << bucket) - 1;
+}
+
+void Histogram::RecordEnabled(uint64_t value) {
+  // The bucket is the number of significant bits in the value.
+  int bucket = 0;
+  for (uint64_t remaining = value; remaining; remaining >>= 1) ++bucket;
+  if (bucket >= kBuckets) bucket = kBuckets - 1;
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+Sink::~Sink() {}
+
+void Collect(Sink* sink) { Registry::Get()->Collect(sink); }
+
+void SetTraceSink(Sink* sink) { g_trace_sink.store(sink); }
+
+int64_t Span::NowMicroseconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Span::EndEnabled() {
+  int64_t duration = NowMicroseconds() - start_microseconds_;
+  if (histogram_) histogram_->Record(static_cast<uint64_t>(duration));
+  Sink* sink = g_trace_sink.load();
+  if (sink) sink->OnSpan(name_, start_microseconds_, duration);
+  start_microseconds_ = -1;
+}
+
+namespace {
+
+// Writes metrics in the Prometheus text exposition format.
+class PrometheusSink : public Sink {
+ public:
+  void OnCounter(const Counter& counter) override {
+    WriteHeader(counter, "counter");
+    out_ << counter.name() << " " << counter.value() << "\n";
+  }
+
+  void OnGauge(const Gauge& gauge) override {
+    WriteHeader(gauge, "gauge");
+    out_ << gauge.name() << " " << gauge.value() << "\n";
+  }
+
+  void OnHistogram(const Histogram& histogram) override {
+    WriteHeader(histogram, "histogram");
+    // Buckets are cumulative. Only buckets up to the largest value recorded
+    // are written, as the rest would all hold the total count.
+    uint64_t cumulative = 0;
+    for (int i = 0; i < Histogram::kBuckets - 1; ++i) {
+      if (cumulative == histogram.count()) break;
+      cumulative += histogram.bucket_count(i);
+      out_ << histogram.name() << "_bucket{le=\""
+           << Histogram::BucketUpperBound(i) << "\"} " << cumulative << "\n";
+    }
+    out_ << histogram.name() << "_bucket{le=\"+Inf\"} " << histogram.count()
+         << "\n";
+    out_ << histogram.name() << "_sum " << histogram.sum() << "\n";
+    out_ << histogram.name() << "_count " << histogram.count() << "\n";
+  }
+
+  std::string str() const { return out_.str(); }
+
+ private:
+  void WriteHeader(const Metric& metric, const char* type) {
+    out_ << "# HELP " << metric.name() << " " << metric.help() << "\n";
+    out_ << "# TYPE " << metric.name() << " " << type << "\n";
+  }
+
+  std::ostringstream out_;
+};
+
+// Writes metrics as the members of a JSON object.
+class JsonSink : public Sink {
+ public:
+  JsonSink() : first_(true) {}
+
+  void OnCounter(const Counter& counter) override {
+    WriteName(counter);
+    out_ << counter.value();
+  }
+
+  void OnGauge(const Gauge& gauge) override {
+    WriteName(gauge);
+    out_ << gauge.value();
+  }
+
+  void OnHistogram(const Histogram& histogram) override {
+    WriteName(histogram);
+    out_ << "{\"count\":" << histogram.count() << ",\"sum\":" << histogram.sum()
+         << ",\"buckets\":[";
+    // Only non-empty buckets are written.
+    bool first_bucket = true;
+    for (int i = 0; i < Histogram::kBuckets; ++i) {
+      uint64_t count = histogram.bucket_count(i);
+      if (count == 0) continue;
+      if (!first_bucket) out_ << ",";
+      first_bucket = false;
+      out_ << "{\"le\":";
+      if (i == Histogram::kBuckets - 1) {
+        out_ << "\"+Inf\"";
+      } else {
+        out_ << Histogram::BucketUpperBound(i);
+      }
+      out_ << ",\"count\":" << count << "}";
+    }
+    out_ << "]}";
+  }
+
+  std::string str() const { return "{" + out_.str() + "}"; }
+
+ private:
+  // Metric names only contain characters that don't need escaping.
+  void WriteName(const Metric& metric) {
+    if (!first_) out_ << ",";
+    first_ = false;
+    out_ << "\"" << metric.name() << "\":";
+  }
+
+  std::ostringstream out_;
+  bool first_;
+};
+
+}  // namespace
+
+MetricsListener::~MetricsListener() {}
+
+namespace {
+
+// Passes metrics and spans on to a MetricsListener.
+class ListenerSink : public Sink {
+ public:
+  explicit ListenerSink(MetricsListener* listener) : listener_(listener) {}
+
+  void OnCounter(const Counter& counter) override {
+    listener_->OnCounter(counter.name(), counter.help(), counter.value());
+  }
+
+  void OnGauge(const Gauge& gauge) override {
+    listener_->OnGauge(gauge.name(), gauge.help(), gauge.value());
+  }
+
+  void OnHistogram(const Histogram& histogram) override {
+    uint64_t bucket_counts[Histogram::kBuckets];
+    for (int i = 0; i < Histogram::kBuckets; ++i) {
+      bucket_counts[i] = histogram.bucket_count(i);
+    }
+    listener_->OnHistogram(histogram.name(), histogram.help(), bucket_counts,
+                           Histogram::kBuckets, histogram.count(),
+                           histogram.sum());
+  }
+
+ private:
+  MetricsListener* listener_;
+};
+
+// Passes spans on to the listener set with SetTraceListener().
+class TraceListenerSink : public Sink {
+ public:
+  void OnSpan(const char* name, int64_t start_microseconds,
+              int64_t duration_microseconds) override {
+    MetricsListener* listener = g_trace_listener.load();
+    if (listener) {
+      listener->OnSpan(name, start_microseconds, duration_microseconds);
+    }
+  }
+};
+
+}  // namespace
+
+void Collect(MetricsListener* listener) {
+  ListenerSink sink(listener);
+  Collect(&sink);
+}
+
+void SetTraceListener(MetricsListener* listener) {
+  static TraceListenerSink* sink = new TraceListenerSink();
+  g_trace_listener.store(listener);
+  SetTraceSink(listener ? sink : nullptr);
+}
+
+std::string DumpPrometheus() {
+  PrometheusSink sink;
+  Collect(&sink);
+  return sink.str();
+}
+
+std::string DumpJson() {
+  JsonSink sink;
+  Collect(&sink);
+  return sink.str();
+}
+
+}  // namespace metrics
+}  // namespace firebase
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_APP_SRC_METRICS_H_
+#define FIREBASE_APP_SRC_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "app/src/include/firebase/metrics.h"
+
+namespace firebase {
+namespace metrics {
+
+// Lightweight instrumentation for SDK internals.
+//
+// Metrics are declared as objects with static storage duration, which register
+// themselves when they are constructed:
+//
+//   static metrics::Counter g_requests("firebase_requests_total",
+//                                      "Number of requests sent.");
+//   ...
+//   g_requests.Increment();
+//
+// Recording is disabled by default, in which case recording a value costs a
+// single relaxed atomic load. Once enabled with SetEnabled(true), the
+// registered metrics can be read through a Sink or dumped as Prometheus text
+// or JSON. Apps read them through the public API in firebase/metrics.h.
+
+namespace internal {
+// Whether metrics are recorded. Use IsEnabled() rather than reading this.
+extern std::atomic<bool> g_enabled;
+}  // namespace internal
+
+// Returns whether metrics are being recorded.
+inline bool IsEnabled() {
+  return internal::g_enabled.load(std::memory_order_relaxed);
+}
+
+class Sink;
+
+// Base class of all metrics, which links each metric into the registry.
+class Metric {
+ public:
+  // Metrics must outlive every use, so they are usually never destroyed. A
+  // destroyed metric is removed from the registry.
+  virtual ~Metric();
+
+  // Name of the metric, in Prometheus format, e.g. "firebase_foo_total".
+  const char* name() const { return name_; }
+
+  // Description of the metric.
+  const char* help() const { return help_; }
+
+ protected:
+  Metric(const char* name, const char* help);
+
+ private:
+  Metric(const Metric&) = delete;
+  Metric& operator=(const Metric&) = delete;
+
+  friend class Registry;
+
+  // Pass this metric to the matching method of the sink.
+  virtual void Collect(Sink* sink) const = 0;
+
+  const char* name_;
+  const char* help_;
+  // Next metric in the registry.
+  Metric* next_;
+};
+
+// A value that only goes up, like the number of requests sent.
+class Counter : public Metric {
+ public:
+  Counter(const char* name, const char* help) : Metric(name, help), value_(0) {}
+
+  void Increment(uint64_t amount = 1) {
+    if (IsEnabled()) value_.fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  void Collect(Sink* sink) const override;
+
+  std::atomic<uint64_t> value_;
+};
+
+// A value that goes up and down, like the length of a queue.
+//
+// Gauges are set to absolute values rather than adjusted, so that they are
+// correct no matter when recording was enabled.
+class Gauge : public Metric {
+ public:
+  Gauge(const char* name, const char* help) : Metric(name, help), value_(0) {}
+
+  void Set(int64_t value) {
+    if (IsEnabled()) value_.store(value, std::memory_order_relaxed);
+  }
+
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  void Collect(Sink* sink) const override;
+
+  std::atomic<int64_t> value_;
+};
+
+// A distribution of values, like request latency or message sizes.
+//
+// Values are counted in buckets with power of two upper bounds: bucket 0
+// holds values of 0, and bucket i holds values from 2^(i-1) up to 2^i - 1.
+class Histogram : public Metric {
+ public:
+  // Number of buckets. The last one holds every value of 2^(kBuckets-2) or
+  // more.
+  static const int kBuckets = 40;
+
+  Histogram(const char* name, const char* help);
+
+  void Record(uint64_t value) {
+    if (IsEnabled()) RecordEnabled(value);
+  }
+
+  // Upper bound (inclusive) of a bucket, or UINT64_MAX for the last bucket.
+  static uint64_t BucketUpperBound(int bucket);
+
+  // Number of values recorded in a bucket.
+  uint64_t bucket_count(int bucket) const {
+    return buckets_[bucket].load(std::memory_order_relaxed);
+  }
+
+  // Number of values recorded.
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+  // Sum of the values recorded.
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+ private:
+  void Collect(Sink* sink) const override;
+  void RecordEnabled(uint64_t value);
+
+  std::atomic<uint64_t> buckets_[kBuckets];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+};
+
+// Receives the values of metrics and the spans that complete.
+class Sink {
+ public:
+  virtual ~Sink();
+
+  // Called by Collect() for each registered metric.
+  virtual void OnCounter(const Counter& counter) {}
+  virtual void OnGauge(const Gauge& gauge) {}
+  virtual void OnHistogram(const Histogram& histogram) {}
+
+  // Called when a Span ends while this sink is set with SetTraceSink().
+  //
+  // This is called on the thread that ended the span, so it must be thread
+  // safe and should return quickly.
+  virtual void OnSpan(const char* name, int64_t start_microseconds,
+                      int64_t duration_microseconds) {}
+};
+
+// Pass the current value of every registered metric to a sink.
+void Collect(Sink* sink);
+
+// Set the sink that receives each Span as it ends, or nullptr to stop tracing.
+// The sink must remain valid until it is replaced.
+void SetTraceSink(Sink* sink);
+
+// Times a section of code, recording its duration in microseconds in a
+// histogram, and reporting it to the trace sink if one is set.
+//
+//   static metrics::Histogram g_latency("firebase_request_latency_us", "...");
+//   {
+//     metrics::Span span("request", &g_latency);
+//     ...
+//   }
+//
+// Nothing is timed if metrics are disabled when the span starts.
+class Span {
+ public:
+  Span(const char* name, Histogram* histogram)
+      : name_(name), histogram_(histogram), start_microseconds_(-1) {
+    if (IsEnabled()) start_microseconds_ = NowMicroseconds();
+  }
+
+  ~Span() { End(); }
+
+  // End the span before it is destroyed. Does nothing if it already ended.
+  void End() {
+    if (start_microseconds_ >= 0) EndEnabled();
+  }
+
+ private:
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+  static int64_t NowMicroseconds();
+  void EndEnabled();
+
+  const char* name_;
+  Histogram* histogram_;
+  // When the span started, or -1 if it isn't being timed.
+  int64_t start_microseconds_;
+};
+
+}  // namespace metrics
+}  // namespace firebase
+
+#endif  // FIREBASE_APP_SRC_METRICS_H_
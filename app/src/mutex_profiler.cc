@@ -0,0 +1,550 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app/src/mutex_profiler.h"
+
+#if FIREBASE_MUTEX_PROFILING
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <map>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#endif  // FIREBASE_MUTEX_PROFILING
+
+namespace firebase {
+namespace mutex_profiler {
+
+#if FIREBASE_MUTEX_PROFILING
+
+namespace {
+
+// Number of histogram buckets. Bucket 0 counts durations under a microsecond,
+// and bucket i durations from 2^(i-1) up to 2^i - 1 microseconds, as with
+// metrics::Histogram. The last bucket counts everything longer.
+const int kBuckets = 24;
+
+// Number of (mutex, call site) pairs that can be profiled. Must be a power of
+// two.
+const size_t kMaxSites = 1024;
+
+// Maximum number of mutexes a thread can hold at once and still have their
+// hold times recorded.
+const int kMaxHeldLocks = 32;
+
+// States of a Site. A tombstone is the site of a destroyed mutex, which can
+// be reused but doesn't end a probe sequence as an empty site does.
+enum SiteState { kSiteEmpty = 0, kSiteReady, kSiteTombstone };
+
+// Statistics of one mutex acquired from one call site.
+//
+// Sites live in a fixed size hash table so that recording doesn't allocate,
+// and only takes a lock the first time a mutex is acquired from a call site,
+// which also keeps the profiler out of its own profile. The key of a site only
+// changes while SitesMutex() is held, and is read by other threads as a
+// seqlock: `sequence` is odd while the key is being written.
+struct Site {
+  std::atomic<uint32_t> sequence;
+  std::atomic<int> state;
+  std::atomic<const Mutex*> mutex;
+  std::atomic<const void*> call_site;
+  std::atomic<uint64_t> acquisitions;
+  std::atomic<uint64_t> contended;
+  std::atomic<uint64_t> wait_nanoseconds;
+  std::atomic<uint64_t> max_wait_nanoseconds;
+  std::atomic<uint64_t> hold_nanoseconds;
+  std::atomic<uint64_t> max_hold_nanoseconds;
+  std::atomic<uint64_t> wait_buckets[kBuckets];
+  std::atomic<uint64_t> hold_buckets[kBuckets];
+};
+
+// Zero initialized, as it has static storage duration, so it can be used
+// before any constructor runs.
+Site g_sites[kMaxSites];
+
+// Number of acquisitions that weren't recorded because the table was full.
+std::atomic<uint64_t> g_dropped;
+
+// A mutex held by the current thread.
+struct HeldLock {
+  const Mutex* mutex;
+  const void* call_site;
+  Site* site;
+  uint64_t acquired_nanoseconds;
+};
+
+thread_local HeldLock g_held_locks[kMaxHeldLocks];
+thread_local int g_held_lock_count;
+
+// Guards changes to the keys of the sites and the statistics of destroyed
+// mutexes. This and NamesMutex() use std::mutex as a firebase::Mutex would
+// profile itself. When both are held, this one is acquired first.
+std::mutex* SitesMutex() {
+  static std::mutex* mutex = new std::mutex();
+  return mutex;
+}
+
+// Names of mutexes.
+std::mutex* NamesMutex() {
+  static std::mutex* mutex = new std::mutex();
+  return mutex;
+}
+
+std::map<const Mutex*, const char*>* Names() {
+  static std::map<const Mutex*, const char*>* names =
+      new std::map<const Mutex*, const char*>();
+  return names;
+}
+
+size_t Hash(const Mutex* mutex, const void* call_site) {
+  uintptr_t key = reinterpret_cast<uintptr_t>(mutex) * 31 +
+                  reinterpret_cast<uintptr_t>(call_site);
+  key ^= key >> 17;
+  key *= 0x9E3779B1u;
+  return static_cast<size_t>(key ^ (key >> 15));
+}
+
+// The key of a site.
+struct SiteKey {
+  int state;
+  const Mutex* mutex;
+  const void* call_site;
+
+  bool Is(const Mutex* other_mutex, const void* other_call_site) const {
+    return state == kSiteReady && mutex == other_mutex &&
+           call_site == other_call_site;
+  }
+};
+
+// Reads the key of a site without holding SitesMutex().
+SiteKey ReadKey(const Site& site) {
+  for (;;) {
+    uint32_t sequence = site.sequence.load(std::memory_order_acquire);
+    if (sequence & 1) continue;
+    SiteKey key;
+    key.state = site.state.load(std::memory_order_relaxed);
+    key.mutex = site.mutex.load(std::memory_order_relaxed);
+    key.call_site = site.call_site.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (site.sequence.load(std::memory_order_relaxed) == sequence) return key;
+  }
+}
+
+// Changes the key of a site. SitesMutex() must be held.
+void WriteKey(Site* site, int state, const Mutex* mutex,
+              const void* call_site) {
+  uint32_t sequence = site->sequence.load(std::memory_order_relaxed);
+  site->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  site->state.store(state, std::memory_order_relaxed);
+  site->mutex.store(mutex, std::memory_order_relaxed);
+  site->call_site.store(call_site, std::memory_order_relaxed);
+  site->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void ClearStatistics(Site* site) {
+  site->acquisitions.store(0, std::memory_order_relaxed);
+  site->contended.store(0, std::memory_order_relaxed);
+  site->wait_nanoseconds.store(0, std::memory_order_relaxed);
+  site->max_wait_nanoseconds.store(0, std::memory_order_relaxed);
+  site->hold_nanoseconds.store(0, std::memory_order_relaxed);
+  site->max_hold_nanoseconds.store(0, std::memory_order_relaxed);
+  for (int i = 0; i < kBuckets; ++i) {
+    site->wait_buckets[i].store(0, std::memory_order_relaxed);
+    site->hold_buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+// Adds the site of a mutex and call site, or returns the one another thread
+// added first. Returns nullptr if the table is full.
+Site* AddSite(const Mutex* mutex, const void* call_site) {
+  std::lock_guard<std::mutex> lock(*SitesMutex());
+  size_t hash = Hash(mutex, call_site);
+  Site* free_site = nullptr;
+  for (size_t probe = 0; probe < kMaxSites; ++probe) {
+    Site& site = g_sites[(hash + probe) & (kMaxSites - 1)];
+    int state = site.state.load(std::memory_order_relaxed);
+    if (state == kSiteReady) {
+      if (site.mutex.load(std::memory_order_relaxed) == mutex &&
+          site.call_site.load(std::memory_order_relaxed) == call_site) {
+        return &site;
+      }
+      continue;
+    }
+    if (!free_site) free_site = &site;
+    if (state == kSiteEmpty) break;
+  }
+  if (free_site) {
+    ClearStatistics(free_site);
+    WriteKey(free_site, kSiteReady, mutex, call_site);
+  }
+  return free_site;
+}
+
+// Returns the site of a mutex and call site, adding it if necessary, or
+// nullptr if the table is full.
+Site* FindSite(const Mutex* mutex, const void* call_site) {
+  size_t hash = Hash(mutex, call_site);
+  for (size_t probe = 0; probe < kMaxSites; ++probe) {
+    Site& site = g_sites[(hash + probe) & (kMaxSites - 1)];
+    SiteKey key = ReadKey(site);
+    if (key.Is(mutex, call_site)) return &site;
+    if (key.state == kSiteEmpty) break;
+  }
+  return AddSite(mutex, call_site);
+}
+
+void UpdateMax(std::atomic<uint64_t>* max, uint64_t value) {
+  uint64_t current = max->load(std::memory_order_relaxed);
+  while (value > current &&
+         !max->compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+int Bucket(uint64_t nanoseconds) {
+  // The bucket is the number of significant bits in the microseconds.
+  int bucket = 0;
+  for (uint64_t remaining = nanoseconds / 1000; remaining; remaining >>= 1) {
+    ++bucket;
+  }
+  return std::min(bucket, kBuckets - 1);
+}
+
+uint64_t BucketUpperBound(int bucket) {
+  return (static_cast<uint64_t>(1) << bucket) - 1;
+}
+
+uint64_t Load(const std::atomic<uint64_t>& value) {
+  return value.load(std::memory_order_relaxed);
+}
+
+// A copy of the statistics of a site, with the name of its mutex.
+struct Snapshot {
+  const Mutex* mutex;
+  const char* name;
+  const void* call_site;
+  uint64_t acquisitions;
+  uint64_t contended;
+  uint64_t wait_nanoseconds;
+  uint64_t max_wait_nanoseconds;
+  uint64_t hold_nanoseconds;
+  uint64_t max_hold_nanoseconds;
+  uint64_t wait_buckets[kBuckets];
+  uint64_t hold_buckets[kBuckets];
+};
+
+// Statistics of the call sites of destroyed mutexes, by the name of the
+// mutex and the call site, so the table only grows with the code that takes
+// locks. Guarded by SitesMutex().
+typedef std::map<std::pair<const char*, const void*>, Snapshot> RetiredSites;
+
+RetiredSites* Retired() {
+  static RetiredSites* retired = new RetiredSites();
+  return retired;
+}
+
+// Copies the statistics of a site that has been acquired since the last
+// reset. SitesMutex() must be held.
+bool CopyStatistics(const Site& site, Snapshot* snapshot) {
+  if (site.state.load(std::memory_order_relaxed) != kSiteReady) return false;
+  snapshot->acquisitions = Load(site.acquisitions);
+  if (snapshot->acquisitions == 0) return false;
+  snapshot->mutex = site.mutex.load(std::memory_order_relaxed);
+  snapshot->name = nullptr;
+  snapshot->call_site = site.call_site.load(std::memory_order_relaxed);
+  snapshot->contended = Load(site.contended);
+  snapshot->wait_nanoseconds = Load(site.wait_nanoseconds);
+  snapshot->max_wait_nanoseconds = Load(site.max_wait_nanoseconds);
+  snapshot->hold_nanoseconds = Load(site.hold_nanoseconds);
+  snapshot->max_hold_nanoseconds = Load(site.max_hold_nanoseconds);
+  for (int i = 0; i < kBuckets; ++i) {
+    snapshot->wait_buckets[i] = Load(site.wait_buckets[i]);
+    snapshot->hold_buckets[i] = Load(site.hold_buckets[i]);
+  }
+  return true;
+}
+
+void AddStatistics(const Snapshot& from, Snapshot* to) {
+  to->acquisitions += from.acquisitions;
+  to->contended += from.contended;
+  to->wait_nanoseconds += from.wait_nanoseconds;
+  to->max_wait_nanoseconds =
+      std::max(to->max_wait_nanoseconds, from.max_wait_nanoseconds);
+  to->hold_nanoseconds += from.hold_nanoseconds;
+  to->max_hold_nanoseconds =
+      std::max(to->max_hold_nanoseconds, from.max_hold_nanoseconds);
+  for (int i = 0; i < kBuckets; ++i) {
+    to->wait_buckets[i] += from.wait_buckets[i];
+    to->hold_buckets[i] += from.hold_buckets[i];
+  }
+}
+
+// Returns the sites that have been acquired since the last reset.
+std::vector<Snapshot> TakeSnapshots() {
+  std::vector<Snapshot> snapshots;
+  std::lock_guard<std::mutex> sites_lock(*SitesMutex());
+  for (size_t i = 0; i < kMaxSites; ++i) {
+    Snapshot snapshot;
+    if (CopyStatistics(g_sites[i], &snapshot)) snapshots.push_back(snapshot);
+  }
+  std::lock_guard<std::mutex> names_lock(*NamesMutex());
+  std::map<const Mutex*, const char*>& names = *Names();
+  for (Snapshot& snapshot : snapshots) {
+    auto it = names.find(snapshot.mutex);
+    if (it != names.end()) snapshot.name = it->second;
+  }
+  for (const auto& retired : *Retired()) snapshots.push_back(retired.second);
+  return snapshots;
+}
+
+void WriteMutexName(std::ostream& out, const Snapshot& snapshot) {
+  if (snapshot.name) {
+    out << snapshot.name;
+  } else if (snapshot.mutex) {
+    out << static_cast<const void*>(snapshot.mutex);
+  } else {
+    out << "(destroyed)";
+  }
+}
+
+void WriteJsonString(std::ostream& out, const char* value) {
+  out << "\"";
+  for (const char* c = value; *c; ++c) {
+    if (*c == '"' || *c == '\\') out << "\\";
+    out << *c;
+  }
+  out << "\"";
+}
+
+void WriteJsonBuckets(std::ostream& out, const uint64_t* buckets) {
+  out << "[";
+  bool first = true;
+  for (int i = 0; i < kBuckets; ++i) {
+    if (buckets[i] == 0) continue;
+    if (!first) out << ",";
+    first = false;
+    out << "{\"le_us\":";
+    if (i == kBuckets - 1) {
+      out << "\"+Inf\"";
+    } else {
+      out << BucketUpperBound(i);
+    }
+    out << ",\"count\":" << buckets[i] << "}";
+  }
+  out << "]";
+}
+
+}  // namespace
+
+void NameMutex(const Mutex* mutex, const char* name) {
+  std::lock_guard<std::mutex> lock(*NamesMutex());
+  (*Names())[mutex] = name;
+}
+
+void ForgetMutex(const Mutex* mutex) {
+  std::lock_guard<std::mutex> sites_lock(*SitesMutex());
+  const char* name = nullptr;
+  {
+    std::lock_guard<std::mutex> names_lock(*NamesMutex());
+    auto it = Names()->find(mutex);
+    if (it != Names()->end()) {
+      name = it->second;
+      Names()->erase(it);
+    }
+  }
+  // Nothing can acquire the mutex anymore, so its sites are moved out of the
+  // table for other mutexes to use.
+  for (size_t i = 0; i < kMaxSites; ++i) {
+    Site& site = g_sites[i];
+    if (site.state.load(std::memory_order_relaxed) != kSiteReady ||
+        site.mutex.load(std::memory_order_relaxed) != mutex) {
+      continue;
+    }
+    Snapshot snapshot;
+    if (CopyStatistics(site, &snapshot)) {
+      snapshot.mutex = nullptr;
+      snapshot.name = name;
+      auto inserted = Retired()->insert(std::make_pair(
+          std::make_pair(name, snapshot.call_site), snapshot));
+      if (!inserted.second) AddStatistics(snapshot, &inserted.first->second);
+    }
+    WriteKey(&site, kSiteTombstone, nullptr, nullptr);
+  }
+}
+
+std::string DumpMutexProfile() {
+  std::vector<Snapshot> snapshots = TakeSnapshots();
+  std::sort(snapshots.begin(), snapshots.end(),
+            [](const Snapshot& a, const Snapshot& b) {
+              return a.wait_nanoseconds > b.wait_nanoseconds;
+            });
+  std::ostringstream out;
+  out << "mutex call_site acquisitions contended wait_us max_wait_us hold_us "
+         "max_hold_us\n";
+  for (const Snapshot& snapshot : snapshots) {
+    WriteMutexName(out, snapshot);
+    out << " " << snapshot.call_site << " " << snapshot.acquisitions << " "
+        << snapshot.contended << " " << snapshot.wait_nanoseconds / 1000 << " "
+        << snapshot.max_wait_nanoseconds / 1000 << " "
+        << snapshot.hold_nanoseconds / 1000 << " "
+        << snapshot.max_hold_nanoseconds / 1000 << "\n";
+  }
+  uint64_t dropped = g_dropped.load(std::memory_order_relaxed);
+  if (dropped) out << "dropped " << dropped << "\n";
+  return out.str();
+}
+
+std::string DumpMutexProfileJson() {
+  std::vector<Snapshot> snapshots = TakeSnapshots();
+  // Group the call sites of each mutex together. Destroyed mutexes are
+  // grouped by name.
+  std::stable_sort(snapshots.begin(), snapshots.end(),
+                   [](const Snapshot& a, const Snapshot& b) {
+                     return std::make_pair(a.mutex, a.name) <
+                            std::make_pair(b.mutex, b.name);
+                   });
+  std::ostringstream out;
+  out << "{\"mutexes\":[";
+  for (size_t i = 0; i < snapshots.size(); ++i) {
+    const Snapshot& snapshot = snapshots[i];
+    bool first_site = i == 0 || snapshots[i - 1].mutex != snapshot.mutex ||
+                      snapshots[i - 1].name != snapshot.name;
+    if (first_site) {
+      if (i > 0) out << "]},";
+      out << "{\"mutex\":";
+      if (snapshot.mutex) {
+        out << "\"" << static_cast<const void*>(snapshot.mutex) << "\"";
+      } else {
+        out << "null";
+      }
+      out << ",";
+      if (snapshot.name) {
+        out << "\"name\":";
+        WriteJsonString(out, snapshot.name);
+        out << ",";
+      }
+      out << "\"call_sites\":[";
+    } else {
+      out << ",";
+    }
+    out << "{\"call_site\":\"" << snapshot.call_site << "\""
+        << ",\"acquisitions\":" << snapshot.acquisitions
+        << ",\"contended\":" << snapshot.contended
+        << ",\"wait_us\":" << snapshot.wait_nanoseconds / 1000
+        << ",\"max_wait_us\":" << snapshot.max_wait_nanoseconds / 1000
+        << ",\"hold_us\":" << snapshot.hold_nanoseconds / 1000
+        << ",\"max_hold_us\":" << snapshot.max_hold_nanoseconds / 1000
+        << ",\"wait_buckets\":";
+    WriteJsonBuckets(out, snapshot.wait_buckets);
+    out << ",\"hold_buckets\":";
+    WriteJsonBuckets(out, snapshot.hold_buckets);
+    out << "}";
+  }
+  if (!snapshots.empty()) out << "]}";
+  out << "],\"dropped\":" << g_dropped.load(std::memory_order_relaxed) << "}";
+  return out.str();
+}
+
+void ResetMutexProfile() {
+  // Threads may be recording while this runs, so an acquisition in progress
+  // may be counted against the site that reuses its slot.
+  std::lock_guard<std::mutex> lock(*SitesMutex());
+  for (size_t i = 0; i < kMaxSites; ++i) {
+    WriteKey(&g_sites[i], kSiteEmpty, nullptr, nullptr);
+    ClearStatistics(&g_sites[i]);
+  }
+  Retired()->clear();
+  g_dropped.store(0, std::memory_order_relaxed);
+}
+
+namespace internal {
+
+uint64_t NowNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void OnAcquired(const Mutex* mutex, const void* call_site,
+                uint64_t wait_nanoseconds, bool contended) {
+  Site* site = FindSite(mutex, call_site);
+  if (!site) {
+    g_dropped.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    site->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (contended) site->contended.fetch_add(1, std::memory_order_relaxed);
+    site->wait_nanoseconds.fetch_add(wait_nanoseconds,
+                                     std::memory_order_relaxed);
+    UpdateMax(&site->max_wait_nanoseconds, wait_nanoseconds);
+    site->wait_buckets[Bucket(wait_nanoseconds)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+  if (g_held_lock_count < kMaxHeldLocks) {
+    HeldLock& held = g_held_locks[g_held_lock_count++];
+    held.mutex = mutex;
+    held.call_site = call_site;
+    held.site = site;
+    held.acquired_nanoseconds = NowNanoseconds();
+  }
+}
+
+void OnReleasing(const Mutex* mutex) {
+  // Locks are usually released in the reverse order they were acquired, so
+  // search from the most recent.
+  for (int i = g_held_lock_count - 1; i >= 0; --i) {
+    if (g_held_locks[i].mutex != mutex) continue;
+    Site* site = g_held_locks[i].site;
+    // The site is reused if the profile was reset while the mutex was held.
+    if (site && ReadKey(*site).Is(mutex, g_held_locks[i].call_site)) {
+      uint64_t hold_nanoseconds =
+          NowNanoseconds() - g_held_locks[i].acquired_nanoseconds;
+      site->hold_nanoseconds.fetch_add(hold_nanoseconds,
+                                       std::memory_order_relaxed);
+      UpdateMax(&site->max_hold_nanoseconds, hold_nanoseconds);
+      site->hold_buckets[Bucket(hold_nanoseconds)].fetch_add(
+          1, std::memory_order_relaxed);
+    }
+    for (int j = i + 1; j < g_held_lock_count; ++j) {
+      g_held_locks[j - 1] = g_held_locks[j];
+    }
+    --g_held_lock_count;
+    return;
+  }
+  // The mutex was acquired by another thread, or while this thread held too
+  // many others, so its hold time is unknown.
+}
+
+}  // namespace internal
+
+#else  // !FIREBASE_MUTEX_PROFILING
+
+std::string DumpMutexProfile() { return std::string(); }
+
+std::string DumpMutexProfileJson() { return std::string(); }
+
+void ResetMutexProfile() {}
+
+#endif  // FIREBASE_MUTEX_PROFILING
+
+}  // namespace mutex_profiler
+// NOLINTNEXTLINE - allow namespace overridden
+}  // namespace firebase
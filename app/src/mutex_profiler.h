@@ -0,0 +1,93 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_APP_SRC_MUTEX_PROFILER_H_
+#define FIREBASE_APP_SRC_MUTEX_PROFILER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "app/src/include/firebase/internal/mutex.h"
+
+// Lock contention profiling for firebase::Mutex.
+//
+// When the SDK is built with FIREBASE_MUTEX_PROFILING=1 (the CMake option of
+// the same name), every Mutex::Acquire() records, for each mutex and the code
+// that acquired it, how often it was acquired, how often it had to wait, and
+// histograms of the time spent waiting for and holding it. Mutexes can be
+// given a name so they are recognizable in the output:
+//
+//   mutex_profiler::NameMutex(&mutex_, "Scheduler");
+//
+// The profile can be dumped at any time with DumpMutexProfile().
+//
+// Without the build option, naming a mutex compiles to nothing and the dumps
+// are empty.
+
+namespace firebase {
+namespace mutex_profiler {
+
+#if FIREBASE_MUTEX_PROFILING
+
+// Name a mutex in the profile. `name` is not copied, so it must outlive the
+// mutex, which is the case for string literals.
+void NameMutex(const Mutex* mutex, const char* name);
+
+// Called when a mutex is destroyed. Its call sites are removed from the
+// profile, so their slots can be reused, and their statistics are kept under
+// the name of the mutex until the next reset.
+void ForgetMutex(const Mutex* mutex);
+
+#else
+
+inline void NameMutex(const Mutex*, const char*) {}
+inline void ForgetMutex(const Mutex*) {}
+
+#endif  // FIREBASE_MUTEX_PROFILING
+
+// Returns a human readable table of every profiled call site, with the ones
+// that spent the most time waiting first.
+std::string DumpMutexProfile();
+
+// Returns the profile as a JSON object, with the call sites grouped by mutex
+// and the non-empty histogram buckets of each.
+std::string DumpMutexProfileJson();
+
+// Clear the statistics recorded so far, including those of destroyed
+// mutexes, and free every call site. Names are kept.
+void ResetMutexProfile();
+
+#if FIREBASE_MUTEX_PROFILING
+namespace internal {
+
+// Monotonic clock used for wait and hold times.
+uint64_t NowNanoseconds();
+
+// Called by Mutex::Acquire() once `mutex` has been locked.
+void OnAcquired(const Mutex* mutex, const void* call_site,
+                uint64_t wait_nanoseconds, bool contended);
+
+// Called by Mutex::Release() before `mutex` is unlocked.
+void OnReleasing(const Mutex* mutex);
+
+}  // namespace internal
+#endif  // FIREBASE_MUTEX_PROFILING
+
+}  // namespace mutex_profiler
+// NOLINTNEXTLINE - allow namespace overridden
+}  // namespace firebase
+
+#endif  // FIREBASE_APP_SRC_MUTEX_PROFILER_H_
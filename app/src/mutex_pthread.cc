@@ -18,9 +18,26 @@
 
 #include "app/src/assert.h"
 #include "app/src/include/firebase/internal/mutex.h"
+#include "app/src/mutex_profiler.h"
 
 namespace firebase {
 
+// Locks mutex, returning false if it can't be used yet.
+static bool Lock(pthread_mutex_t* mutex) {
+  int ret = pthread_mutex_lock(mutex);
+  if (ret == EINVAL) {
+    return false;
+  }
+#if defined(__APPLE__)
+  // Lock / unlock will fail in a static initializer on OSX and iOS.
+  FIREBASE_ASSERT(ret == 0 || ret == EINVAL);
+#else
+  FIREBASE_ASSERT(ret == 0);
+#endif  // defined(__APPLE__)
+  (void)ret;
+  return true;
+}
+
 Mutex::Mutex(Mode mode) {
   pthread_mutexattr_t attr;
   int ret = pthread_mutexattr_init(&attr);
@@ -36,26 +53,39 @@ Mutex::Mutex(Mode mode) {
 }
 
 Mutex::~Mutex() {
+  mutex_profiler::ForgetMutex(this);
   int ret = pthread_mutex_destroy(&mutex_);
   FIREBASE_ASSERT(ret == 0);
   (void)ret;
 }
 
-void Mutex::Acquire() {
-  int ret = pthread_mutex_lock(&mutex_);
-  if (ret == EINVAL) {
+#if FIREBASE_MUTEX_PROFILING
+FIREBASE_MUTEX_NOINLINE void Mutex::Acquire() {
+  Acquire(FIREBASE_MUTEX_CALL_SITE());
+}
+
+void Mutex::Acquire(const void* call_site) {
+  // Try the lock first, so that only contended acquisitions are timed.
+  if (pthread_mutex_trylock(&mutex_) == 0) {
+    mutex_profiler::internal::OnAcquired(this, call_site, 0, false);
     return;
   }
-#if defined(__APPLE__)
-  // Lock / unlock will fail in a static initializer on OSX and iOS.
-  FIREBASE_ASSERT(ret == 0 || ret == EINVAL);
-#else
-  FIREBASE_ASSERT(ret == 0);
-#endif  // defined(__APPLE__)
-  (void)ret;
+  uint64_t wait_start = mutex_profiler::internal::NowNanoseconds();
+  if (!Lock(&mutex_)) {
+    return;
+  }
+  mutex_profiler::internal::OnAcquired(
+      this, call_site, mutex_profiler::internal::NowNanoseconds() - wait_start,
+      true);
 }
+#else
+void Mutex::Acquire() { Lock(&mutex_); }
+#endif  // FIREBASE_MUTEX_PROFILING
 
 void Mutex::Release() {
+#if FIREBASE_MUTEX_PROFILING
+  mutex_profiler::internal::OnReleasing(this);
+#endif  // FIREBASE_MUTEX_PROFILING
   int ret = pthread_mutex_unlock(&mutex_);
 #if defined(__APPLE__)
   // Lock / unlock will fail in a static initializer on OSX and iOS.
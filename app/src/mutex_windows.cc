@@ -18,6 +18,7 @@
 #include "app/src/assert.h"
 #include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/include/firebase/internal/platform.h"
+#include "app/src/mutex_profiler.h"
 
 namespace firebase {
 
@@ -29,15 +30,43 @@ Mutex::Mutex(Mode mode) : mode_(mode) {
   }
 }
 
-Mutex::~Mutex() { CloseHandle(synchronization_object_); }
+Mutex::~Mutex() {
+  mutex_profiler::ForgetMutex(this);
+  CloseHandle(synchronization_object_);
+}
 
-void Mutex::Acquire() {
-  DWORD ret = WaitForSingleObject(synchronization_object_, INFINITE);
+// Waits until handle is signaled.
+static void Lock(HANDLE handle) {
+  DWORD ret = WaitForSingleObject(handle, INFINITE);
   FIREBASE_ASSERT(ret == WAIT_OBJECT_0);
   (void)ret;
 }
 
+#if FIREBASE_MUTEX_PROFILING
+FIREBASE_MUTEX_NOINLINE void Mutex::Acquire() {
+  Acquire(FIREBASE_MUTEX_CALL_SITE());
+}
+
+void Mutex::Acquire(const void* call_site) {
+  // Try the lock first, so that only contended acquisitions are timed.
+  if (WaitForSingleObject(synchronization_object_, 0) == WAIT_OBJECT_0) {
+    mutex_profiler::internal::OnAcquired(this, call_site, 0, false);
+    return;
+  }
+  uint64_t wait_start = mutex_profiler::internal::NowNanoseconds();
+  Lock(synchronization_object_);
+  mutex_profiler::internal::OnAcquired(
+      this, call_site, mutex_profiler::internal::NowNanoseconds() - wait_start,
+      true);
+}
+#else
+void Mutex::Acquire() { Lock(synchronization_object_); }
+#endif  // FIREBASE_MUTEX_PROFILING
+
 void Mutex::Release() {
+#if FIREBASE_MUTEX_PROFILING
+  mutex_profiler::internal::OnReleasing(this);
+#endif  // FIREBASE_MUTEX_PROFILING
   if (mode_ & kModeRecursive) {
     ReleaseMutex(synchronization_object_);
   } else {
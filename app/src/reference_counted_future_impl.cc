@@ -25,6 +25,7 @@
 #include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/intrusive_list.h"
 #include "app/src/log.h"
+#include "app/src/metrics.h"
 
 // Set this to 1 to enable verbose logging in this module.
 #if !defined(FIREBASE_FUTURE_TRACE_ENABLE)
@@ -39,6 +40,9 @@
 
 namespace firebase {
 
+static metrics::Counter g_futures_allocated("firebase_futures_allocated_total",
+                                            "Number of futures allocated.");
+
 // See warning at the top of FutureBase's declaration for details.
 static_assert(sizeof(FutureBase) == sizeof(Future<int>),
               "Future should not introduce virtual functions or data members.");
@@ -357,6 +361,7 @@ FutureHandle ReferenceCountedFutureImpl::AllocInternal(
     int fn_idx, void* data, void (*delete_data_fn)(void* data_to_delete)) {
   // Backings get deleted in ReleaseFuture() and ~ReferenceCountedFutureImpl().
   FutureBackingData* backing = new FutureBackingData(data, delete_data_fn);
+  g_futures_allocated.Increment();
 
   // Allocate a unique handle and insert the new backing into the map.
   // Note that it's theoretically possible to have a handle collision if we
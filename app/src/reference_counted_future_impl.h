@@ -26,6 +26,7 @@
 #include "app/src/include/firebase/future.h"
 #include "app/src/include/firebase/internal/common.h"
 #include "app/src/include/firebase/internal/mutex.h"
+#include "app/src/mutex_profiler.h"
 
 namespace firebase {
 
@@ -114,7 +115,9 @@ class ReferenceCountedFutureImpl : public detail::FutureApiInterface {
 
   explicit ReferenceCountedFutureImpl(size_t last_result_count)
       : next_future_handle_(kInvalidFutureHandle + 1),
-        last_results_(last_result_count) {}
+        last_results_(last_result_count) {
+    mutex_profiler::NameMutex(&mutex_, "ReferenceCountedFutureImpl");
+  }
   ~ReferenceCountedFutureImpl() override;
 
   // Implementation of detail::FutureApiInterface.
@@ -224,6 +227,14 @@ class ReferenceCountedFutureImpl : public detail::FutureApiInterface {
     return SafeFutureHandle<T>(AllocInternal<T>(kNoFunctionIndex));
   }
 
+  /// Same as above, for code that can't name the result type. The result is
+  /// `data`, which is deleted with `delete_data_fn` along with the Future, or
+  /// nothing if `data` is null.
+  FutureHandle AllocWithData(void* data,
+                             void (*delete_data_fn)(void* data_to_delete)) {
+    return AllocInternal(kNoFunctionIndex, data, delete_data_fn);
+  }
+
   /// Call when the asynchronous process completes.
   /// Marks the Future as complete and calls the completion callback, if one is
   /// registered.
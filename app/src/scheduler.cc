@@ -19,11 +19,19 @@
 #include <cassert>
 #include <utility>
 
+#include "app/src/metrics.h"
+#include "app/src/mutex_profiler.h"
 #include "app/src/time.h"
 
 namespace firebase {
 namespace scheduler {
 
+static metrics::Histogram g_queue_depth(
+    "firebase_scheduler_queue_depth",
+    "Number of requests queued in a scheduler when a request is added.");
+static metrics::Counter g_callbacks_run("firebase_scheduler_callbacks_total",
+                                        "Number of scheduled callbacks run.");
+
 bool RequestHandle::Cancel() {
   assert(status_);
 
@@ -66,7 +74,9 @@ Scheduler::Scheduler()
       next_request_id_(0),
       terminating_(false),
       request_mutex_(Mutex::kModeRecursive),
-      sleep_sem_(0) {}
+      sleep_sem_(0) {
+  mutex_profiler::NameMutex(&request_mutex_, "Scheduler");
+}
 
 Scheduler::~Scheduler() { CancelAllAndShutdownWorkerThread(); }
 
@@ -190,6 +200,7 @@ void Scheduler::AddToQueue(RequestDataPtr request, uint64_t current,
 
   // Push the request to the priority queue
   request_queue_.push(std::move(request));
+  g_queue_depth.Record(request_queue_.size());
 }
 
 bool Scheduler::TriggerCallback(const RequestDataPtr& request) {
@@ -197,6 +208,7 @@ bool Scheduler::TriggerCallback(const RequestDataPtr& request) {
   if (request->cb && !request->status->cancelled) {
     request->cb->Run();
     request->status->triggered = true;
+    g_callbacks_run.Increment();
 
     // return true if this callback repeats and should be push back to the queue
     if (request->repeat_ms > 0) {
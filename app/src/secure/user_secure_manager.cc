@@ -57,7 +57,11 @@ scheduler::Scheduler* UserSecureManager::s_scheduler_;
 int32_t UserSecureManager::s_scheduler_ref_count_;
 
 UserSecureManager::UserSecureManager(const char* domain, const char* app_id)
-    : future_api_(kUserSecureFnCount), safe_this_(this) {
+    : future_api_(kUserSecureFnCount),
+      write_scheduled_(false),
+      save_delay_ms_(0),
+      all_data_deleted_(false),
+      safe_this_(this) {
   user_secure_ = std::make_unique<USER_SECURE_TYPE>(domain, app_id);
   CreateScheduler();
 }
@@ -66,15 +70,21 @@ UserSecureManager::UserSecureManager(
     std::unique_ptr<UserSecureInternal> user_secure_internal)
     : user_secure_(std::move(user_secure_internal)),
       future_api_(kUserSecureFnCount),
+      write_scheduled_(false),
+      save_delay_ms_(0),
+      all_data_deleted_(false),
       safe_this_(this) {
   CreateScheduler();
 }
 
 UserSecureManager::~UserSecureManager() {
-  CancelScheduledTasks();
+  // Cancelling waits for a write that is running to finish.
+  if (write_handle_.IsValid()) write_handle_.Cancel();
   // Clear safe reference immediately so that scheduled callback can skip
   // executing code which requires reference to this.
   safe_this_.ClearReference();
+  // Write what is still waiting for the save delay, so that it isn't lost.
+  WritePending();
   DestroyScheduler();
 }
 
@@ -82,107 +92,169 @@ Future<std::string> UserSecureManager::LoadUserData(
     const std::string& app_name) {
   const auto future_handle =
       future_api_.SafeAlloc<std::string>(kUserSecureFnLoad);
+  Future<std::string> future = MakeFuture(&future_api_, future_handle);
+
+  std::string cached_data;
+  {
+    MutexLock lock(mutex_);
+    auto cached = cache_.find(app_name);
+    if (cached == cache_.end() && !all_data_deleted_) {
+      auto data_handle = std::make_shared<UserSecureDataHandle<std::string>>(
+          app_name, "", &future_api_, future_handle);
+      auto callback = NewCallback(
+          [](ThisRef ref,
+             std::shared_ptr<UserSecureDataHandle<std::string>> handle) {
+            ThisRefLock lock(&ref);
+            if (lock.GetReference() != nullptr) {
+              lock.GetReference()->LoadFromStorage(handle->app_name,
+                                                   handle->future_handle);
+            }
+          },
+          safe_this_, data_handle);
+      s_scheduler_->Schedule(callback);
+      return future;
+    }
+    if (cached != cache_.end()) cached_data = cached->second;
+  }
+  CompleteLoad(app_name, cached_data, future_handle);
+  return future;
+}
 
-  auto data_handle = std::make_shared<UserSecureDataHandle<std::string>>(
-      app_name, "", &future_api_, future_handle);
-
-  auto callback = NewCallback(
-      [](ThisRef ref, std::shared_ptr<UserSecureDataHandle<std::string>> handle,
-         UserSecureInternal* internal) {
-        FIREBASE_ASSERT(internal);
-        ThisRefLock lock(&ref);
-        if (lock.GetReference() != nullptr) {
-          std::string result = internal->LoadUserData(handle->app_name);
-          std::string empty_str("");
-          if (result.empty()) {
-            std::string message(
-                "Failed to read user data for app (" + handle->app_name +
-                ").  This could happen if the current user doesn't have access "
-                "to the keystore, the keystore has been corrupted or the app "
-                "intentionally deleted the stored data.");
-            handle->future_api->CompleteWithResult(
-                handle->future_handle, kNoEntry, message.c_str(), empty_str);
-          } else {
-            handle->future_api->CompleteWithResult(handle->future_handle,
-                                                   kSuccess, "", result);
-          }
-        }
-      },
-      safe_this_, data_handle, user_secure_.get());
+void UserSecureManager::LoadFromStorage(
+    const std::string& app_name,
+    const SafeFutureHandle<std::string>& future_handle) {
+  FIREBASE_ASSERT(user_secure_);
+  std::string user_data;
+  bool cached;
+  {
+    MutexLock lock(mutex_);
+    auto it = cache_.find(app_name);
+    cached = it != cache_.end();
+    if (cached) user_data = it->second;
+  }
+  if (!cached) {
+    user_data = user_secure_->LoadUserData(app_name);
+    MutexLock lock(mutex_);
+    // Data saved while this was loading is newer than what was loaded.
+    auto it = cache_.find(app_name);
+    if (it != cache_.end()) {
+      user_data = it->second;
+    } else if (!user_data.empty()) {
+      // Nothing read can be a transient failure, e.g. a locked keyring, so
+      // it isn't cached and the next load reads storage again.
+      cache_.insert(std::make_pair(app_name, user_data));
+    }
+  }
+  CompleteLoad(app_name, user_data, future_handle);
+}
 
-  CancelOperation(kLoadUserData);
-  operation_handles_[kLoadUserData] = s_scheduler_->Schedule(callback);
-  return MakeFuture(&future_api_, future_handle);
+void UserSecureManager::CompleteLoad(
+    const std::string& app_name, const std::string& user_data,
+    const SafeFutureHandle<std::string>& future_handle) {
+  if (user_data.empty()) {
+    std::string message(
+        "Failed to read user data for app (" + app_name +
+        ").  This could happen if the current user doesn't have access "
+        "to the keystore, the keystore has been corrupted or the app "
+        "intentionally deleted the stored data.");
+    future_api_.CompleteWithResult(future_handle, kNoEntry, message.c_str(),
+                                   std::string());
+  } else {
+    future_api_.CompleteWithResult(future_handle, kSuccess, "", user_data);
+  }
 }
 
 Future<void> UserSecureManager::SaveUserData(const std::string& app_name,
                                              const std::string& user_data) {
-  const auto future_handle = future_api_.SafeAlloc<void>(kUserSecureFnSave);
-
-  auto data_handle = std::make_shared<UserSecureDataHandle<void>>(
-      app_name, user_data, &future_api_, future_handle);
-
-  auto callback = NewCallback(
-      [](ThisRef ref, std::shared_ptr<UserSecureDataHandle<void>> handle,
-         UserSecureInternal* internal) {
-        FIREBASE_ASSERT(internal);
-        ThisRefLock lock(&ref);
-        if (lock.GetReference() != nullptr) {
-          internal->SaveUserData(handle->app_name, handle->user_data);
-          handle->future_api->Complete(handle->future_handle, kSuccess);
-        }
-      },
-      safe_this_, data_handle, user_secure_.get());
-
-  CancelOperation(kSaveUserData);
-  operation_handles_[kSaveUserData] = s_scheduler_->Schedule(callback);
-  return MakeFuture(&future_api_, future_handle);
+  return QueueWrite(app_name, user_data, false);
 }
 
 Future<void> UserSecureManager::DeleteUserData(const std::string& app_name) {
-  const auto future_handle = future_api_.SafeAlloc<void>(kUserSecureFnDelete);
-
-  auto data_handle = std::make_shared<UserSecureDataHandle<void>>(
-      app_name, "", &future_api_, future_handle);
-
-  auto callback = NewCallback(
-      [](ThisRef ref, std::shared_ptr<UserSecureDataHandle<void>> handle,
-         UserSecureInternal* internal) {
-        FIREBASE_ASSERT(internal);
-        ThisRefLock lock(&ref);
-        if (lock.GetReference() != nullptr) {
-          internal->DeleteUserData(handle->app_name);
-          handle->future_api->Complete(handle->future_handle, kSuccess);
-        }
-      },
-      safe_this_, data_handle, user_secure_.get());
+  return QueueWrite(app_name, "", true);
+}
 
-  CancelOperation(kDeleteUserData);
-  operation_handles_[kDeleteUserData] = s_scheduler_->Schedule(callback);
+Future<void> UserSecureManager::QueueWrite(const std::string& app_name,
+                                           const std::string& user_data,
+                                           bool is_delete) {
+  const auto future_handle = future_api_.SafeAlloc<void>(
+      is_delete ? kUserSecureFnDelete : kUserSecureFnSave);
+
+  MutexLock lock(mutex_);
+  cache_[app_name] = user_data;
+  PendingWrite& write = pending_writes_[app_name];
+  write.is_delete = is_delete;
+  write.user_data = user_data;
+  write.future_handles.push_back(future_handle);
+  ScheduleWriteLocked();
   return MakeFuture(&future_api_, future_handle);
 }
 
 Future<void> UserSecureManager::DeleteAllData() {
   auto future_handle = future_api_.SafeAlloc<void>(kUserSecureFnDeleteAll);
 
-  auto data_handle = std::make_shared<UserSecureDataHandle<void>>(
-      "", "", &future_api_, future_handle);
+  MutexLock lock(mutex_);
+  // Writes waiting to be written are replaced by this one.
+  for (auto& entry : pending_writes_) {
+    pending_delete_all_handles_.insert(pending_delete_all_handles_.end(),
+                                       entry.second.future_handles.begin(),
+                                       entry.second.future_handles.end());
+  }
+  pending_writes_.clear();
+  pending_delete_all_handles_.push_back(future_handle);
+  cache_.clear();
+  all_data_deleted_ = true;
+  ScheduleWriteLocked();
+  return MakeFuture(&future_api_, future_handle);
+}
 
+void UserSecureManager::set_save_delay_ms(scheduler::ScheduleTimeMs delay_ms) {
+  MutexLock lock(mutex_);
+  save_delay_ms_ = delay_ms;
+}
+
+void UserSecureManager::ScheduleWriteLocked() {
+  if (write_scheduled_) return;
+  write_scheduled_ = true;
   auto callback = NewCallback(
-      [](ThisRef ref, std::shared_ptr<UserSecureDataHandle<void>> handle,
-         UserSecureInternal* internal) {
-        FIREBASE_ASSERT(internal);
+      [](ThisRef ref) {
         ThisRefLock lock(&ref);
         if (lock.GetReference() != nullptr) {
-          internal->DeleteAllData();
-          handle->future_api->Complete(handle->future_handle, kSuccess);
+          lock.GetReference()->WritePending();
         }
       },
-      safe_this_, data_handle, user_secure_.get());
+      safe_this_);
+  write_handle_ = s_scheduler_->Schedule(callback, save_delay_ms_);
+}
 
-  CancelOperation(kDeleteAllData);
-  operation_handles_[kDeleteAllData] = s_scheduler_->Schedule(callback);
-  return MakeFuture(&future_api_, future_handle);
+void UserSecureManager::WritePending() {
+  std::vector<SafeFutureHandle<void>> delete_all_handles;
+  std::map<std::string, PendingWrite> writes;
+  {
+    MutexLock lock(mutex_);
+    delete_all_handles.swap(pending_delete_all_handles_);
+    writes.swap(pending_writes_);
+    // Writes queued from now on are written by the next call.
+    write_scheduled_ = false;
+  }
+  if (!delete_all_handles.empty()) {
+    FIREBASE_ASSERT(user_secure_);
+    user_secure_->DeleteAllData();
+    for (const auto& handle : delete_all_handles) {
+      future_api_.Complete(handle, kSuccess);
+    }
+  }
+  for (const auto& entry : writes) {
+    FIREBASE_ASSERT(user_secure_);
+    const PendingWrite& write = entry.second;
+    if (write.is_delete) {
+      user_secure_->DeleteUserData(entry.first);
+    } else {
+      user_secure_->SaveUserData(entry.first, write.user_data);
+    }
+    for (const auto& handle : write.future_handles) {
+      future_api_.Complete(handle, kSuccess);
+    }
+  }
 }
 
 void UserSecureManager::CreateScheduler() {
@@ -280,23 +352,6 @@ void UserSecureManager::BinaryToAscii(const std::string& original,
   }
 }
 
-void UserSecureManager::CancelScheduledTasks() {
-  for (auto it = operation_handles_.begin(); it != operation_handles_.end();
-       ++it) {
-    it->second.Cancel();
-  }
-  operation_handles_.clear();
-}
-
-void UserSecureManager::CancelOperation(SecureOperationType operation_type) {
-  // Cancel and remove existing handle.
-  auto it = operation_handles_.find(operation_type);
-  if (it != operation_handles_.end()) {
-    it->second.Cancel();
-    operation_handles_.erase(it);
-  }
-}
-
 }  // namespace secure
 }  // namespace app
 }  // namespace firebase
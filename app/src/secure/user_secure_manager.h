@@ -18,8 +18,10 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "app/src/include/firebase/future.h"
+#include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/reference_counted_future_impl.h"
 #include "app/src/safe_reference.h"
 #include "app/src/secure/user_secure_data_handle.h"
@@ -29,13 +31,13 @@ namespace firebase {
 namespace app {
 namespace secure {
 
-enum SecureOperationType {
-  kLoadUserData,
-  kSaveUserData,
-  kDeleteUserData,
-  kDeleteAllData,
-};
-
+// Loads and stores user data in the platform's secure storage, on a background
+// thread.
+//
+// Saves and deletes are written in batches. Each one waits for the save delay,
+// and if the same app is saved or deleted again before it is written, only the
+// last write goes to secure storage. Data that was loaded or saved is cached,
+// so loading it again doesn't read secure storage.
 class UserSecureManager {
  public:
   explicit UserSecureManager(const char* domain, const char* app_id);
@@ -58,16 +60,50 @@ class UserSecureManager {
   // Delete all user data.
   Future<void> DeleteAllData();
 
+  // Set how long saves and deletes wait, in milliseconds, before they are
+  // written, so that more writes of the same app can replace them. Defaults to
+  // 0, which only coalesces writes made while others are being written.
+  //
+  // Writes that are still waiting when this is destroyed are written by the
+  // destructor.
+  void set_save_delay_ms(scheduler::ScheduleTimeMs delay_ms);
+
   // Decode the given ASCII string into binary data.
   static bool AsciiToBinary(const std::string& encoded, std::string* decoded);
   // Encode the given binary string into ASCII-friendly data.
   static void BinaryToAscii(const std::string& original, std::string* encoded);
 
  private:
-  // Cancel already scheduled tasks in destruction.
-  void CancelScheduledTasks();
+  // The last save or delete of an app that hasn't been written yet.
+  struct PendingWrite {
+    PendingWrite() : is_delete(false) {}
+
+    bool is_delete;
+    std::string user_data;
+    // Futures of every write of the app that this one replaced, which complete
+    // when it is written.
+    std::vector<SafeFutureHandle<void>> future_handles;
+  };
+
+  // Queue a save, or a delete if `is_delete` is true, and schedule the pending
+  // writes to be written.
+  Future<void> QueueWrite(const std::string& app_name,
+                          const std::string& user_data, bool is_delete);
+
+  // Schedule WritePending() if it isn't already. mutex_ must be held.
+  void ScheduleWriteLocked();
+
+  // Write all the pending writes to secure storage and complete their futures.
+  void WritePending();
+
+  // Load user data from secure storage, unless it was cached since the load
+  // was scheduled, and complete the future of the load.
+  void LoadFromStorage(const std::string& app_name,
+                       const SafeFutureHandle<std::string>& future_handle);
 
-  void CancelOperation(SecureOperationType operation_type);
+  // Complete the future of a load with the data that was loaded.
+  void CompleteLoad(const std::string& app_name, const std::string& user_data,
+                    const SafeFutureHandle<std::string>& future_handle);
 
   std::unique_ptr<UserSecureInternal> user_secure_;
   ReferenceCountedFutureImpl future_api_;
@@ -80,9 +116,22 @@ class UserSecureManager {
   static scheduler::Scheduler* s_scheduler_;
   static int32_t s_scheduler_ref_count_;
 
-  // map from operation type to scheduled request handle. Make sure only one
-  // request exist in scheduler for each type.
-  std::map<SecureOperationType, scheduler::RequestHandle> operation_handles_;
+  // Guards the members below.
+  Mutex mutex_;
+  // Writes waiting to be written, by app name.
+  std::map<std::string, PendingWrite> pending_writes_;
+  // Futures of DeleteAllData() calls waiting to be written, which are written
+  // before pending_writes_.
+  std::vector<SafeFutureHandle<void>> pending_delete_all_handles_;
+  bool write_scheduled_;
+  scheduler::RequestHandle write_handle_;
+  scheduler::ScheduleTimeMs save_delay_ms_;
+  // The user data of each app as of the last successful load or write, or an
+  // empty string if it was deleted.
+  std::map<std::string, std::string> cache_;
+  // Whether DeleteAllData() was called, in which case apps missing from
+  // cache_ have no data.
+  bool all_data_deleted_;
 
   // Safe reference to this.  Set in constructor and cleared in destructor
   // Should be safe to be copied in any thread because the std::shared_ptr never
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_APP_SRC_SHARED_MUTEX_H_
+#define FIREBASE_APP_SRC_SHARED_MUTEX_H_
+
+#include "app/src/assert.h"
+#include "app/src/include/firebase/internal/platform.h"
+
+#if FIREBASE_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif  // FIREBASE_PLATFORM_WINDOWS
+
+namespace firebase {
+
+// A reader-writer lock, for state that is read far more often than it is
+// changed. Any number of threads can hold it shared, or one thread can hold it
+// exclusively.
+//
+// Unlike Mutex, it is never recursive: a thread must not acquire it again,
+// shared or exclusively, while it holds it. Keep the sections it guards short
+// and don't call out of them.
+//
+// std::shared_timed_mutex isn't used as it isn't available on every platform
+// the SDK supports.
+class SharedMutex {
+ public:
+  SharedMutex() {
+#if FIREBASE_PLATFORM_WINDOWS
+    InitializeSRWLock(&lock_);
+#else
+    int ret = pthread_rwlock_init(&lock_, nullptr);
+    FIREBASE_ASSERT(ret == 0);
+    (void)ret;
+#endif  // FIREBASE_PLATFORM_WINDOWS
+  }
+
+  ~SharedMutex() {
+#if !FIREBASE_PLATFORM_WINDOWS
+    pthread_rwlock_destroy(&lock_);
+#endif  // !FIREBASE_PLATFORM_WINDOWS
+  }
+
+  void Acquire() {
+#if FIREBASE_PLATFORM_WINDOWS
+    AcquireSRWLockExclusive(&lock_);
+#else
+    int ret = pthread_rwlock_wrlock(&lock_);
+    FIREBASE_ASSERT(ret == 0);
+    (void)ret;
+#endif  // FIREBASE_PLATFORM_WINDOWS
+  }
+
+  void Release() {
+#if FIREBASE_PLATFORM_WINDOWS
+    ReleaseSRWLockExclusive(&lock_);
+#else
+    pthread_rwlock_unlock(&lock_);
+#endif  // FIREBASE_PLATFORM_WINDOWS
+  }
+
+  void AcquireShared() {
+#if FIREBASE_PLATFORM_WINDOWS
+    AcquireSRWLockShared(&lock_);
+#else
+    int ret = pthread_rwlock_rdlock(&lock_);
+    FIREBASE_ASSERT(ret == 0);
+    (void)ret;
+#endif  // FIREBASE_PLATFORM_WINDOWS
+  }
+
+  void ReleaseShared() {
+#if FIREBASE_PLATFORM_WINDOWS
+    ReleaseSRWLockShared(&lock_);
+#else
+    pthread_rwlock_unlock(&lock_);
+#endif  // FIREBASE_PLATFORM_WINDOWS
+  }
+
+ private:
+  SharedMutex(const SharedMutex&) = delete;
+  SharedMutex& operator=(const SharedMutex&) = delete;
+
+#if FIREBASE_PLATFORM_WINDOWS
+  SRWLOCK lock_;
+#else
+  pthread_rwlock_t lock_;
+#endif  // FIREBASE_PLATFORM_WINDOWS
+};
+
+// Holds a SharedMutex exclusively for the lifetime of the lock, for writers.
+class ExclusiveLock {
+ public:
+  explicit ExclusiveLock(SharedMutex& mutex) : mutex_(&mutex) {
+    mutex_->Acquire();
+  }
+  ~ExclusiveLock() { mutex_->Release(); }
+
+ private:
+  ExclusiveLock(const ExclusiveLock&) = delete;
+  ExclusiveLock& operator=(const ExclusiveLock&) = delete;
+
+  SharedMutex* mutex_;
+};
+
+// Holds a SharedMutex shared for the lifetime of the lock, for readers.
+class SharedLock {
+ public:
+  explicit SharedLock(SharedMutex& mutex) : mutex_(&mutex) {
+    mutex_->AcquireShared();
+  }
+  ~SharedLock() { mutex_->ReleaseShared(); }
+
+ private:
+  SharedLock(const SharedLock&) = delete;
+  SharedLock& operator=(const SharedLock&) = delete;
+
+  SharedMutex* mutex_;
+};
+
+// NOLINTNEXTLINE - allow namespace overridden
+}  // namespace firebase
+
+#endif  // FIREBASE_APP_SRC_SHARED_MUTEX_H_
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app/src/future_util.h"
+
+#include <string>
+#include <vector>
+
+#include "app/src/reference_counted_future_impl.h"
+#include "app/src/thread.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace {
+
+using ::testing::Eq;
+using ::testing::StrEq;
+
+const int kError = 42;
+
+class FutureUtilTest : public ::testing::Test {
+ protected:
+  FutureUtilTest() : api_(0) {}
+
+  ReferenceCountedFutureImpl api_;
+};
+
+TEST_F(FutureUtilTest, ThenRunsWhenFutureCompletes) {
+  SafeFutureHandle<int> handle = api_.SafeAlloc<int>();
+  Future<std::string> result = Then(
+      &api_, MakeFuture(&api_, handle),
+      [](const int& value) { return std::to_string(value * 2); });
+  EXPECT_THAT(result.status(), Eq(kFutureStatusPending));
+
+  api_.CompleteWithResult(handle, 0, 21);
+  ASSERT_THAT(result.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(result.error(), Eq(0));
+  EXPECT_THAT(*result.result(), StrEq("42"));
+}
+
+TEST_F(FutureUtilTest, ThenRunsInlineIfFutureIsComplete) {
+  SafeFutureHandle<void> handle = api_.SafeAlloc<void>();
+  api_.Complete(handle, 0);
+  bool called = false;
+  Future<void> result =
+      Then(&api_, MakeFuture(&api_, handle), [&called] { called = true; });
+  EXPECT_TRUE(called);
+  EXPECT_THAT(result.status(), Eq(kFutureStatusComplete));
+}
+
+TEST_F(FutureUtilTest, ThenPropagatesErrors) {
+  SafeFutureHandle<int> handle = api_.SafeAlloc<int>();
+  bool called = false;
+  Future<int> result =
+      Then(&api_, MakeFuture(&api_, handle), [&called](const int& value) {
+        called = true;
+        return value;
+      });
+
+  api_.Complete(handle, kError, "failed");
+  EXPECT_FALSE(called);
+  ASSERT_THAT(result.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(result.error(), Eq(kError));
+  EXPECT_THAT(result.error_message(), StrEq("failed"));
+}
+
+TEST_F(FutureUtilTest, ThenUnwrapsReturnedFutures) {
+  SafeFutureHandle<int> first = api_.SafeAlloc<int>();
+  SafeFutureHandle<int> second = api_.SafeAlloc<int>();
+  Future<int> result =
+      Then(&api_, MakeFuture(&api_, first),
+           [this, second](const int&) { return MakeFuture(&api_, second); });
+
+  api_.CompleteWithResult(first, 0, 1);
+  EXPECT_THAT(result.status(), Eq(kFutureStatusPending));
+  api_.CompleteWithResult(second, 0, 2);
+  ASSERT_THAT(result.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(*result.result(), Eq(2));
+}
+
+TEST_F(FutureUtilTest, ThenFailsForInvalidFuture) {
+  Future<void> result = Then(&api_, Future<void>(), [] {});
+  ASSERT_THAT(result.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(result.error(), Eq(kFutureErrorInvalid));
+}
+
+TEST_F(FutureUtilTest, WhenAllWaitsForEveryFuture) {
+  std::vector<SafeFutureHandle<int>> handles;
+  std::vector<Future<int>> futures;
+  for (int i = 0; i < 100; ++i) {
+    handles.push_back(api_.SafeAlloc<int>());
+    futures.push_back(MakeFuture(&api_, handles.back()));
+  }
+  Future<void> result = WhenAll(&api_, futures);
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(result.status(), Eq(kFutureStatusPending));
+    api_.CompleteWithResult(handles[i], 0, i);
+  }
+  ASSERT_THAT(result.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(result.error(), Eq(0));
+}
+
+TEST_F(FutureUtilTest, WhenAllFailsWithFirstError) {
+  SafeFutureHandle<void> first = api_.SafeAlloc<void>();
+  SafeFutureHandle<void> second = api_.SafeAlloc<void>();
+  SafeFutureHandle<void> third = api_.SafeAlloc<void>();
+  std::vector<FutureBase> futures = {MakeFuture(&api_, first),
+                                     MakeFuture(&api_, second),
+                                     MakeFuture(&api_, third)};
+  Future<void> result = WhenAll(&api_, futures);
+
+  api_.Complete(third, kError + 1, "third");
+  api_.Complete(second, kError, "second");
+  EXPECT_THAT(result.status(), Eq(kFutureStatusPending));
+  api_.Complete(first, 0);
+  ASSERT_THAT(result.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(result.error(), Eq(kError));
+  EXPECT_THAT(result.error_message(), StrEq("second"));
+}
+
+TEST_F(FutureUtilTest, WhenAllOfNothingIsComplete) {
+  Future<void> result = WhenAll(&api_, std::vector<Future<int>>());
+  ASSERT_THAT(result.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(result.error(), Eq(0));
+}
+
+struct Completion {
+  ReferenceCountedFutureImpl* api;
+  SafeFutureHandle<int> handle;
+};
+
+void Complete(Completion* completion) {
+  completion->api->CompleteWithResult(completion->handle, 0, 1);
+}
+
+TEST_F(FutureUtilTest, WhenAllCompletesFromOtherThreads) {
+  std::vector<Completion> completions;
+  std::vector<Future<int>> futures;
+  for (int i = 0; i < 8; ++i) {
+    completions.push_back(Completion{&api_, api_.SafeAlloc<int>()});
+    futures.push_back(MakeFuture(&api_, completions.back().handle));
+  }
+  Future<void> result = WhenAll(&api_, futures);
+
+  std::vector<Thread> threads;
+  for (Completion& completion : completions) {
+    threads.emplace_back(Complete, &completion);
+  }
+  for (Thread& thread : threads) thread.Join();
+  EXPECT_THAT(result.status(), Eq(kFutureStatusComplete));
+}
+
+TEST_F(FutureUtilTest, WhenAnyReturnsFirstToComplete) {
+  SafeFutureHandle<int> first = api_.SafeAlloc<int>();
+  SafeFutureHandle<int> second = api_.SafeAlloc<int>();
+  std::vector<Future<int>> futures = {MakeFuture(&api_, first),
+                                      MakeFuture(&api_, second)};
+  Future<size_t> result = WhenAny(&api_, futures);
+  EXPECT_THAT(result.status(), Eq(kFutureStatusPending));
+
+  api_.Complete(second, kError);
+  ASSERT_THAT(result.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(result.error(), Eq(0));
+  EXPECT_THAT(*result.result(), Eq(1u));
+
+  api_.CompleteWithResult(first, 0, 1);
+  EXPECT_THAT(*result.result(), Eq(1u));
+}
+
+TEST_F(FutureUtilTest, WhenAnyOfNothingFails) {
+  Future<size_t> result = WhenAny(&api_, std::vector<FutureBase>());
+  ASSERT_THAT(result.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(result.error(), Eq(kFutureErrorInvalid));
+}
+
+TEST_F(FutureUtilTest, PublicCombinatorsUseTheSharedApi) {
+  SafeFutureHandle<int> first = api_.SafeAlloc<int>();
+  SafeFutureHandle<void> second = api_.SafeAlloc<void>();
+  Future<int> doubled = Then(MakeFuture(&api_, first),
+                             [](const int& value) { return value * 2; });
+  std::vector<FutureBase> futures = {doubled, MakeFuture(&api_, second)};
+  Future<void> all = WhenAll(futures);
+  Future<size_t> any = WhenAny(futures);
+
+  api_.CompleteWithResult(first, 0, 21);
+  ASSERT_THAT(doubled.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(*doubled.result(), Eq(42));
+  ASSERT_THAT(any.status(), Eq(kFutureStatusComplete));
+  EXPECT_THAT(*any.result(), Eq(0u));
+  EXPECT_THAT(all.status(), Eq(kFutureStatusPending));
+
+  api_.Complete(second, 0);
+  EXPECT_THAT(all.status(), Eq(kFutureStatusComplete));
+}
+
+#if defined(__cpp_impl_coroutine)
+
+// Minimal coroutine type that runs eagerly and can't be awaited.
+struct Task {
+  struct promise_type {
+    Task get_return_object() { return Task(); }
+    std::suspend_never initial_suspend() { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() {}
+  };
+};
+
+Task AddResults(Future<int> first, Future<int> second, int* sum) {
+  Future<int> first_result = co_await first;
+  Future<int> second_result = co_await second;
+  *sum = *first_result.result() + *second_result.result();
+}
+
+TEST_F(FutureUtilTest, CoAwaitResumesWhenFutureCompletes) {
+  SafeFutureHandle<int> first = api_.SafeAlloc<int>();
+  SafeFutureHandle<int> second = api_.SafeAlloc<int>();
+  api_.CompleteWithResult(first, 0, 1);
+  int sum = 0;
+  AddResults(MakeFuture(&api_, first), MakeFuture(&api_, second), &sum);
+  EXPECT_THAT(sum, Eq(0));
+
+  api_.CompleteWithResult(second, 0, 2);
+  EXPECT_THAT(sum, Eq(3));
+}
+
+#endif  // defined(__cpp_impl_coroutine)
+
+}  // namespace
+}  // namespace firebase
@@ -278,6 +278,41 @@ TEST(LoggerTest, ChainedFilteringMorePermissiveChildLogger) {
   EXPECT_EQ(parent_logger.logged_message(), "Assert log");
 }
 
+TEST(LoggerTest, ChainedIsLogLevelEnabled) {
+  FakeLogger parent_logger;
+  Logger child_logger(&parent_logger);
+
+  parent_logger.SetLogLevel(kLogLevelWarning);
+  child_logger.SetLogLevel(kLogLevelDebug);
+
+  EXPECT_FALSE(child_logger.IsLogLevelEnabled(kLogLevelDebug));
+  EXPECT_FALSE(child_logger.IsLogLevelEnabled(kLogLevelInfo));
+  EXPECT_TRUE(child_logger.IsLogLevelEnabled(kLogLevelWarning));
+
+  parent_logger.SetLogLevel(kLogLevelVerbose);
+  EXPECT_FALSE(child_logger.IsLogLevelEnabled(kLogLevelVerbose));
+  EXPECT_TRUE(child_logger.IsLogLevelEnabled(kLogLevelDebug));
+}
+
+TEST(LoggerTest, MacroSkipsArgumentsOfFilteredMessages) {
+  FakeLogger logger;
+  logger.SetLogLevel(kLogLevelInfo);
+
+  int evaluated = 0;
+  auto argument = [&evaluated]() {
+    ++evaluated;
+    return "argument";
+  };
+
+  FIREBASE_LOGGER_DEBUG(&logger, "Debug %s", argument());
+  EXPECT_EQ(evaluated, 0);
+  EXPECT_EQ(logger.logged_message(), "");
+
+  FIREBASE_LOGGER_INFO(&logger, "Info %s", argument());
+  EXPECT_EQ(evaluated, 1);
+  EXPECT_EQ(logger.logged_message(), "Info argument");
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace firebase
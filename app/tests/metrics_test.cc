@@ -0,0 +1,197 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app/src/metrics.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace metrics {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+class MetricsTest : public ::testing::Test {
+ protected:
+  void SetUp() override { SetEnabled(true); }
+  void TearDown() override {
+    SetEnabled(false);
+    SetTraceSink(nullptr);
+    SetTraceListener(nullptr);
+  }
+};
+
+TEST_F(MetricsTest, CounterOnlyCountsWhileEnabled) {
+  Counter counter("test_counter_total", "A test counter.");
+  counter.Increment();
+  counter.Increment(2);
+  EXPECT_EQ(counter.value(), 3);
+
+  SetEnabled(false);
+  counter.Increment();
+  EXPECT_EQ(counter.value(), 3);
+}
+
+TEST_F(MetricsTest, HistogramBuckets) {
+  Histogram histogram("test_histogram", "A test histogram.");
+  histogram.Record(0);
+  histogram.Record(1);
+  histogram.Record(5);
+  histogram.Record(7);
+  histogram.Record(8);
+
+  EXPECT_EQ(histogram.count(), 5);
+  EXPECT_EQ(histogram.sum(), 21);
+  EXPECT_EQ(histogram.bucket_count(0), 1);  // 0
+  EXPECT_EQ(histogram.bucket_count(1), 1);  // 1
+  EXPECT_EQ(histogram.bucket_count(2), 0);  // 2 - 3
+  EXPECT_EQ(histogram.bucket_count(3), 2);  // 4 - 7
+  EXPECT_EQ(histogram.bucket_count(4), 1);  // 8 - 15
+  EXPECT_EQ(Histogram::BucketUpperBound(3), 7);
+}
+
+TEST_F(MetricsTest, DumpPrometheus) {
+  Counter counter("test_dump_total", "Counts things.");
+  Gauge gauge("test_dump_depth", "Depth of things.");
+  Histogram histogram("test_dump_bytes", "Size of things.");
+  counter.Increment(4);
+  gauge.Set(-2);
+  histogram.Record(3);
+
+  std::string dump = DumpPrometheus();
+  EXPECT_THAT(dump, HasSubstr("# HELP test_dump_total Counts things.\n"
+                              "# TYPE test_dump_total counter\n"
+                              "test_dump_total 4\n"));
+  EXPECT_THAT(dump, HasSubstr("# TYPE test_dump_depth gauge\n"
+                              "test_dump_depth -2\n"));
+  EXPECT_THAT(dump, HasSubstr("test_dump_bytes_bucket{le=\"1\"} 0\n"
+                              "test_dump_bytes_bucket{le=\"3\"} 1\n"
+                              "test_dump_bytes_bucket{le=\"+Inf\"} 1\n"
+                              "test_dump_bytes_sum 3\n"
+                              "test_dump_bytes_count 1\n"));
+}
+
+TEST_F(MetricsTest, DumpJson) {
+  Counter counter("test_json_total", "Counts things.");
+  Histogram histogram("test_json_bytes", "Size of things.");
+  counter.Increment(4);
+  histogram.Record(3);
+
+  std::string dump = DumpJson();
+  EXPECT_THAT(dump, HasSubstr("\"test_json_total\":4"));
+  EXPECT_THAT(dump,
+              HasSubstr("\"test_json_bytes\":{\"count\":1,\"sum\":3,"
+                        "\"buckets\":[{\"le\":3,\"count\":1}]}"));
+}
+
+TEST_F(MetricsTest, DestroyedMetricsAreUnregistered) {
+  {
+    Counter counter("test_destroyed_total", "Gone.");
+  }
+  EXPECT_THAT(DumpJson(), Not(HasSubstr("test_destroyed_total")));
+}
+
+class RecordingListener : public MetricsListener {
+ public:
+  void OnCounter(const char* name, const char* help, uint64_t value) override {
+    if (std::string(name) == "test_listener_total") counter_value = value;
+  }
+
+  void OnHistogram(const char* name, const char* help,
+                   const uint64_t* bucket_counts, int num_buckets,
+                   uint64_t count, uint64_t sum) override {
+    if (std::string(name) != "test_listener_bytes") return;
+    histogram_buckets.assign(bucket_counts, bucket_counts + num_buckets);
+    histogram_sum = sum;
+  }
+
+  void OnSpan(const char* name, int64_t start_microseconds,
+              int64_t duration_microseconds) override {
+    spans.push_back(name);
+  }
+
+  uint64_t counter_value = 0;
+  std::vector<uint64_t> histogram_buckets;
+  uint64_t histogram_sum = 0;
+  std::vector<std::string> spans;
+};
+
+TEST_F(MetricsTest, CollectWithListener) {
+  Counter counter("test_listener_total", "A test counter.");
+  Histogram histogram("test_listener_bytes", "A test histogram.");
+  counter.Increment(4);
+  histogram.Record(3);
+
+  RecordingListener listener;
+  Collect(&listener);
+  EXPECT_EQ(listener.counter_value, 4);
+  ASSERT_EQ(listener.histogram_buckets.size(),
+            static_cast<size_t>(Histogram::kBuckets));
+  EXPECT_EQ(listener.histogram_buckets[2], 1);
+  EXPECT_EQ(listener.histogram_sum, 3);
+}
+
+TEST_F(MetricsTest, TraceListenerReceivesSpans) {
+  RecordingListener listener;
+  SetTraceListener(&listener);
+  { Span span("traced", nullptr); }
+  SetTraceListener(nullptr);
+  { Span span("untraced", nullptr); }
+  EXPECT_THAT(listener.spans, ::testing::ElementsAre("traced"));
+}
+
+class RecordingSink : public Sink {
+ public:
+  void OnSpan(const char* name, int64_t start_microseconds,
+              int64_t duration_microseconds) override {
+    names.push_back(name);
+    EXPECT_GE(duration_microseconds, 0);
+  }
+
+  std::vector<std::string> names;
+};
+
+TEST_F(MetricsTest, SpanRecordsDurationAndTraces) {
+  Histogram histogram("test_span_us", "Span durations.");
+  RecordingSink sink;
+  SetTraceSink(&sink);
+  {
+    Span span("outer", &histogram);
+    Span inner("inner", &histogram);
+    inner.End();
+  }
+  EXPECT_EQ(histogram.count(), 2);
+  EXPECT_THAT(sink.names, ::testing::ElementsAre("inner", "outer"));
+}
+
+TEST_F(MetricsTest, SpanStartedWhileDisabledIsNotRecorded) {
+  Histogram histogram("test_disabled_span_us", "Span durations.");
+  SetEnabled(false);
+  {
+    Span span("span", &histogram);
+    SetEnabled(true);
+  }
+  EXPECT_EQ(histogram.count(), 0);
+}
+
+}  // namespace
+}  // namespace metrics
+}  // namespace firebase
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app/src/mutex_profiler.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "app/src/include/firebase/internal/mutex.h"
+#include "app/src/semaphore.h"
+#include "app/src/thread.h"
+#include "app/src/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace mutex_profiler {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+class MutexProfilerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { ResetMutexProfile(); }
+};
+
+#if FIREBASE_MUTEX_PROFILING
+
+// Returns the sum of `key` over the call sites of the mutex named `name` in
+// the JSON profile.
+uint64_t StatisticOf(const char* name, const char* key) {
+  std::string dump = DumpMutexProfileJson();
+  size_t begin = dump.find(std::string("\"name\":\"") + name + "\"");
+  if (begin == std::string::npos) return 0;
+  size_t end = dump.find("{\"mutex\":", begin);
+  std::string quoted_key = std::string("\"") + key + "\":";
+  uint64_t total = 0;
+  for (size_t value = dump.find(quoted_key, begin); value < end;
+       value = dump.find(quoted_key, value + 1)) {
+    total += std::strtoull(dump.c_str() + value + quoted_key.size(), nullptr,
+                           10);
+  }
+  return total;
+}
+
+TEST_F(MutexProfilerTest, CountsAcquisitionsOfNamedMutex) {
+  Mutex mutex;
+  NameMutex(&mutex, "test_counted_mutex");
+  for (int i = 0; i < 3; ++i) {
+    MutexLock lock(mutex);
+  }
+
+  std::string dump = DumpMutexProfileJson();
+  EXPECT_THAT(dump, HasSubstr("\"name\":\"test_counted_mutex\""));
+  EXPECT_THAT(dump, HasSubstr("\"acquisitions\":3,\"contended\":0"));
+  EXPECT_THAT(DumpMutexProfile(), HasSubstr("test_counted_mutex "));
+}
+
+TEST_F(MutexProfilerTest, RecordsHoldTime) {
+  Mutex mutex;
+  NameMutex(&mutex, "test_held_mutex");
+  {
+    MutexLock lock(mutex);
+    firebase::internal::Sleep(5);
+  }
+
+  EXPECT_EQ(StatisticOf("test_held_mutex", "acquisitions"), 1);
+  EXPECT_GE(StatisticOf("test_held_mutex", "hold_us"), 4000);
+}
+
+struct Holder {
+  Mutex* mutex;
+  // Posted once the mutex is held.
+  Semaphore* acquired;
+};
+
+void HoldBriefly(Holder* holder) {
+  MutexLock lock(*holder->mutex);
+  holder->acquired->Post();
+  firebase::internal::Sleep(20);
+}
+
+TEST_F(MutexProfilerTest, RecordsContention) {
+  Mutex mutex;
+  NameMutex(&mutex, "test_contended_mutex");
+  Semaphore acquired(0);
+  Holder holder = {&mutex, &acquired};
+  Thread thread(HoldBriefly, &holder);
+  acquired.Wait();
+  {
+    MutexLock lock(mutex);
+  }
+  thread.Join();
+
+  EXPECT_EQ(StatisticOf("test_contended_mutex", "acquisitions"), 2);
+  EXPECT_EQ(StatisticOf("test_contended_mutex", "contended"), 1);
+  EXPECT_GE(StatisticOf("test_contended_mutex", "wait_us"), 1000);
+}
+
+TEST_F(MutexProfilerTest, ResetClearsStatistics) {
+  Mutex mutex;
+  NameMutex(&mutex, "test_reset_mutex");
+  {
+    MutexLock lock(mutex);
+  }
+  ResetMutexProfile();
+  EXPECT_THAT(DumpMutexProfileJson(), Not(HasSubstr("test_reset_mutex")));
+}
+
+void LockFromHere(Mutex* mutex) { MutexLock lock(*mutex); }
+
+void LockFromThere(Mutex* mutex) { MutexLock lock(*mutex); }
+
+TEST_F(MutexProfilerTest, RecordsEachCallSiteOfMutexLock) {
+  Mutex mutex;
+  NameMutex(&mutex, "test_call_site_mutex");
+  // Called through pointers, so they aren't inlined into more call sites.
+  void (*volatile lock_from_here)(Mutex*) = LockFromHere;
+  void (*volatile lock_from_there)(Mutex*) = LockFromThere;
+  lock_from_here(&mutex);
+  lock_from_here(&mutex);
+  lock_from_there(&mutex);
+
+  std::string dump = DumpMutexProfileJson();
+  size_t begin = dump.find("\"name\":\"test_call_site_mutex\"");
+  ASSERT_NE(begin, std::string::npos);
+  size_t end = dump.find("{\"mutex\":", begin);
+  int call_sites = 0;
+  for (size_t site = dump.find("\"call_site\":", begin); site < end;
+       site = dump.find("\"call_site\":", site + 1)) {
+    ++call_sites;
+  }
+  EXPECT_EQ(call_sites, 2);
+  EXPECT_EQ(StatisticOf("test_call_site_mutex", "acquisitions"), 3);
+}
+
+TEST_F(MutexProfilerTest, KeepsStatisticsOfDestroyedMutexesUntilReset) {
+  for (int i = 0; i < 2; ++i) {
+    Mutex mutex;
+    NameMutex(&mutex, "test_destroyed_mutex");
+    MutexLock lock(mutex);
+  }
+
+  EXPECT_EQ(StatisticOf("test_destroyed_mutex", "acquisitions"), 2);
+  EXPECT_THAT(DumpMutexProfileJson(),
+              HasSubstr("{\"mutex\":null,\"name\":\"test_destroyed_mutex\""));
+  ResetMutexProfile();
+  EXPECT_THAT(DumpMutexProfileJson(), Not(HasSubstr("test_destroyed_mutex")));
+}
+
+TEST_F(MutexProfilerTest, DestroyedMutexesFreeTheirSites) {
+  // More mutexes than the profile has room for, if their sites were kept.
+  for (int i = 0; i < 4096; ++i) {
+    Mutex mutex;
+    MutexLock lock(mutex);
+  }
+
+  EXPECT_THAT(DumpMutexProfileJson(), HasSubstr("\"dropped\":0}"));
+}
+
+#else  // !FIREBASE_MUTEX_PROFILING
+
+TEST_F(MutexProfilerTest, DumpsAreEmptyWithoutProfiling) {
+  Mutex mutex;
+  NameMutex(&mutex, "test_unprofiled_mutex");
+  {
+    MutexLock lock(mutex);
+  }
+  EXPECT_EQ(DumpMutexProfile(), "");
+  EXPECT_EQ(DumpMutexProfileJson(), "");
+}
+
+#endif  // FIREBASE_MUTEX_PROFILING
+
+}  // namespace
+}  // namespace mutex_profiler
+}  // namespace firebase
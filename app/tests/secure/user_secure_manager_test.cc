@@ -27,7 +27,9 @@ using ::testing::Return;
 using ::testing::StrEq;
 
 const char kAppName1[] = "app_name_1";
+const char kAppName2[] = "app_name_2";
 const char kUserData1[] = "123456";
+const char kUserData2[] = "654321";
 
 TEST(UserSecureManager, Constructor) {
   std::unique_ptr<UserSecureInternal> user_secure;
@@ -60,6 +62,12 @@ class UserSecureManagerTest : public ::testing::Test {
 
   void TearDown() override { delete manager_; }
 
+  // Destroys the manager, which writes pending writes.
+  void DestroyManager() {
+    delete manager_;
+    manager_ = nullptr;
+  }
+
   // Busy waits until |response_future| has completed.
   void WaitForResponse(const FutureBase& response_future) {
     ASSERT_THAT(response_future.status(),
@@ -107,6 +115,77 @@ TEST_F(UserSecureManagerTest, DeleteAllData) {
   EXPECT_EQ(delete_all_future.status(), FutureStatus::kFutureStatusComplete);
 }
 
+TEST_F(UserSecureManagerTest, SavesOfTheSameAppAreCoalesced) {
+  EXPECT_CALL(*user_secure_, SaveUserData(kAppName1, kUserData2)).Times(1);
+  EXPECT_CALL(*user_secure_, SaveUserData(kAppName2, kUserData1)).Times(1);
+  manager_->set_save_delay_ms(100);
+  Future<void> first = manager_->SaveUserData(kAppName1, kUserData1);
+  Future<void> second = manager_->SaveUserData(kAppName2, kUserData1);
+  Future<void> last = manager_->SaveUserData(kAppName1, kUserData2);
+  WaitForResponse(first);
+  WaitForResponse(second);
+  WaitForResponse(last);
+  EXPECT_EQ(first.status(), FutureStatus::kFutureStatusComplete);
+  EXPECT_EQ(last.status(), FutureStatus::kFutureStatusComplete);
+}
+
+TEST_F(UserSecureManagerTest, DeleteReplacesPendingSave) {
+  EXPECT_CALL(*user_secure_, DeleteUserData(kAppName1)).Times(1);
+  manager_->set_save_delay_ms(100);
+  Future<void> save_future = manager_->SaveUserData(kAppName1, kUserData1);
+  Future<void> delete_future = manager_->DeleteUserData(kAppName1);
+  WaitForResponse(save_future);
+  WaitForResponse(delete_future);
+  EXPECT_EQ(delete_future.status(), FutureStatus::kFutureStatusComplete);
+}
+
+TEST_F(UserSecureManagerTest, LoadReturnsSavedDataWithoutReadingStorage) {
+  EXPECT_CALL(*user_secure_, SaveUserData(kAppName1, kUserData1)).Times(1);
+  manager_->set_save_delay_ms(100);
+  manager_->SaveUserData(kAppName1, kUserData1);
+  Future<std::string> load_future = manager_->LoadUserData(kAppName1);
+  EXPECT_EQ(load_future.status(), FutureStatus::kFutureStatusComplete);
+  EXPECT_THAT(load_future.result(), Pointee(StrEq(kUserData1)));
+}
+
+TEST_F(UserSecureManagerTest, LoadedDataIsCached) {
+  EXPECT_CALL(*user_secure_, LoadUserData(kAppName1))
+      .WillOnce(Return(kUserData1));
+  WaitForResponse(manager_->LoadUserData(kAppName1));
+  Future<std::string> load_future = manager_->LoadUserData(kAppName1);
+  EXPECT_EQ(load_future.status(), FutureStatus::kFutureStatusComplete);
+  EXPECT_THAT(load_future.result(), Pointee(StrEq(kUserData1)));
+}
+
+TEST_F(UserSecureManagerTest, FailedLoadIsNotCached) {
+  EXPECT_CALL(*user_secure_, LoadUserData(kAppName1))
+      .WillOnce(Return(""))
+      .WillOnce(Return(kUserData1));
+  Future<std::string> failed_future = manager_->LoadUserData(kAppName1);
+  WaitForResponse(failed_future);
+  EXPECT_EQ(failed_future.error(), kNoEntry);
+
+  Future<std::string> load_future = manager_->LoadUserData(kAppName1);
+  WaitForResponse(load_future);
+  EXPECT_EQ(load_future.error(), kSuccess);
+  EXPECT_THAT(load_future.result(), Pointee(StrEq(kUserData1)));
+}
+
+TEST_F(UserSecureManagerTest, LoadAfterDeleteAllDataHasNoEntry) {
+  EXPECT_CALL(*user_secure_, DeleteAllData()).Times(1);
+  manager_->DeleteAllData();
+  Future<std::string> load_future = manager_->LoadUserData(kAppName1);
+  EXPECT_EQ(load_future.status(), FutureStatus::kFutureStatusComplete);
+  EXPECT_EQ(load_future.error(), kNoEntry);
+}
+
+TEST_F(UserSecureManagerTest, DestructorWritesPendingSaves) {
+  EXPECT_CALL(*user_secure_, SaveUserData(kAppName1, kUserData1)).Times(1);
+  manager_->set_save_delay_ms(60 * 1000);
+  manager_->SaveUserData(kAppName1, kUserData1);
+  DestroyManager();
+}
+
 TEST_F(UserSecureManagerTest, TestHexEncodingAndDecoding) {
   const char kBinaryData[] =
       "\x00\x05\x20\x3C\x40\x45\x50\x60\x70\x80\x90\x00\xA0\xB5\xC2\xD1\xF0"
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app/src/shared_mutex.h"
+
+#include <atomic>
+
+#include "app/src/semaphore.h"
+#include "app/src/thread.h"
+#include "app/src/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+struct SharedState {
+  firebase::SharedMutex mutex;
+  // Posted by the reader once it holds the mutex shared.
+  firebase::Semaphore acquired{0};
+  // Posted by the test to let the reader release the mutex.
+  firebase::Semaphore release{0};
+  std::atomic<bool> written{false};
+};
+
+void ReadUntilReleased(SharedState* state) {
+  firebase::SharedLock lock(state->mutex);
+  state->acquired.Post();
+  state->release.Wait();
+}
+
+void Write(SharedState* state) {
+  firebase::ExclusiveLock lock(state->mutex);
+  state->written = true;
+}
+
+// Readers don't block each other.
+TEST(SharedMutexTest, ReadersShareTheLock) {
+  SharedState state;
+  firebase::Thread reader(ReadUntilReleased, &state);
+  state.acquired.Wait();
+  {
+    firebase::SharedLock lock(state.mutex);
+  }
+  state.release.Post();
+  reader.Join();
+}
+
+// A writer waits for readers to release the lock.
+TEST(SharedMutexTest, WriterWaitsForReaders) {
+  SharedState state;
+  firebase::Thread reader(ReadUntilReleased, &state);
+  state.acquired.Wait();
+  firebase::Thread writer(Write, &state);
+  firebase::internal::Sleep(100);
+  EXPECT_FALSE(state.written);
+
+  state.release.Post();
+  reader.Join();
+  writer.Join();
+  EXPECT_TRUE(state.written);
+}
+
+}  // namespace
@@ -15,18 +15,21 @@
 #include <inttypes.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <functional>
 #include <future>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "app_framework.h"  // NOLINT
 #include "firebase/app.h"
@@ -516,6 +519,132 @@ TEST_F(FirebaseAppCheckTest, TestGetTokenLastResult) {
             future2.result()->expire_time_millis);
 }
 
+#if FIREBASE_PLATFORM_DESKTOP
+// Provider that counts its requests, and answers them from another thread.
+class CountingAppCheckProvider : public firebase::app_check::AppCheckProvider {
+ public:
+  CountingAppCheckProvider() : num_requests_(0) {}
+
+  void GetToken(std::function<void(firebase::app_check::AppCheckToken, int,
+                                   const std::string&)>
+                    completion_callback) override {
+    num_requests_++;
+    std::thread([completion_callback]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      firebase::app_check::AppCheckToken token;
+      token.token = "counted-token";
+      token.expire_time_millis =
+          (static_cast<int64_t>(std::time(nullptr)) + 3600) * 1000;
+      completion_callback(token, firebase::app_check::kAppCheckErrorNone, "");
+    }).detach();
+  }
+
+  std::atomic<int> num_requests_;
+};
+
+class CountingAppCheckProviderFactory
+    : public firebase::app_check::AppCheckProviderFactory {
+ public:
+  firebase::app_check::AppCheckProvider* CreateProvider(
+      firebase::App* app) override {
+    return &provider_;
+  }
+
+  CountingAppCheckProvider provider_;
+};
+
+TEST_F(FirebaseAppCheckTest, TestConcurrentGetTokenSharesOneRequest) {
+  // The factory must outlive App Check, which is deleted in TearDown().
+  static CountingAppCheckProviderFactory* factory =
+      new CountingAppCheckProviderFactory();
+  factory->provider_.num_requests_ = 0;
+  firebase::app_check::AppCheck::SetAppCheckProviderFactory(factory);
+  InitializeApp();
+  ::firebase::app_check::AppCheck* app_check =
+      ::firebase::app_check::AppCheck::GetInstance(app_);
+  ASSERT_NE(app_check, nullptr);
+
+  std::vector<firebase::Future<::firebase::app_check::AppCheckToken>> futures;
+  for (int i = 0; i < 10; ++i) {
+    futures.push_back(app_check->GetAppCheckToken(false));
+  }
+  for (const auto& future : futures) {
+    EXPECT_TRUE(WaitForCompletion(future, "GetToken"));
+    EXPECT_EQ(future.result()->token, "counted-token");
+  }
+  EXPECT_EQ(factory->provider_.num_requests_, 1);
+
+  // The cached token is used until it is close to expiring.
+  firebase::Future<::firebase::app_check::AppCheckToken> cached =
+      app_check->GetAppCheckToken(false);
+  EXPECT_TRUE(WaitForCompletion(cached, "GetToken cached"));
+  EXPECT_EQ(factory->provider_.num_requests_, 1);
+}
+
+// Provider of tokens that expire two seconds after they are issued, so that
+// their background refresh is due a second later.
+class ShortLivedAppCheckProvider
+    : public firebase::app_check::AppCheckProvider {
+ public:
+  ShortLivedAppCheckProvider() : num_requests_(0) {}
+
+  void GetToken(std::function<void(firebase::app_check::AppCheckToken, int,
+                                   const std::string&)>
+                    completion_callback) override {
+    num_requests_++;
+    std::thread([completion_callback]() {
+      firebase::app_check::AppCheckToken token;
+      token.token = "short-lived-token";
+      token.expire_time_millis =
+          (static_cast<int64_t>(std::time(nullptr)) + 2) * 1000;
+      completion_callback(token, firebase::app_check::kAppCheckErrorNone, "");
+    }).detach();
+  }
+
+  std::atomic<int> num_requests_;
+};
+
+class ShortLivedAppCheckProviderFactory
+    : public firebase::app_check::AppCheckProviderFactory {
+ public:
+  firebase::app_check::AppCheckProvider* CreateProvider(
+      firebase::App* app) override {
+    return &provider_;
+  }
+
+  ShortLivedAppCheckProvider provider_;
+};
+
+TEST_F(FirebaseAppCheckTest, TestForcedRefreshRacesBackgroundRefresh) {
+  // The factory must outlive App Check, which is deleted in TearDown().
+  static ShortLivedAppCheckProviderFactory* factory =
+      new ShortLivedAppCheckProviderFactory();
+  factory->provider_.num_requests_ = 0;
+  firebase::app_check::AppCheck::SetAppCheckProviderFactory(factory);
+  InitializeApp();
+  ::firebase::app_check::AppCheck* app_check =
+      ::firebase::app_check::AppCheck::GetInstance(app_);
+  ASSERT_NE(app_check, nullptr);
+
+  firebase::Future<::firebase::app_check::AppCheckToken> future =
+      app_check->GetAppCheckToken(true);
+  ASSERT_TRUE(WaitForCompletion(future, "GetToken"));
+
+  // Force fetches around the time the background refresh of the last token
+  // is due, so that replacing the refresh races with running it.
+  const int kForcedFetches = 6;
+  for (int i = 0; i < kForcedFetches; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(900 + 50 * i));
+    future = app_check->GetAppCheckToken(true);
+    ASSERT_TRUE(WaitForCompletion(future, "GetToken forced"));
+    EXPECT_EQ(future.result()->token, "short-lived-token");
+    app_check->SetTokenAutoRefreshEnabled(true);
+  }
+  // Some of the background refreshes ran.
+  EXPECT_GT(factory->provider_.num_requests_, kForcedFetches + 1);
+}
+#endif  // FIREBASE_PLATFORM_DESKTOP
+
 TEST_F(FirebaseAppCheckTest, TestAddTokenChangedListener) {
   InitializeAppCheckWithDebug();
   InitializeApp();
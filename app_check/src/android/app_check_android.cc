@@ -425,6 +425,11 @@ void AppCheckInternal::SetTokenAutoRefreshEnabled(
   FIREBASE_ASSERT(!util::CheckAndClearJniExceptions(env));
 }
 
+void AppCheckInternal::SetTokenPersistenceEnabled(
+    bool is_token_persistence_enabled) {
+  // The Android SDK always persists tokens.
+}
+
 Future<AppCheckToken> AppCheckInternal::GetAppCheckToken(bool force_refresh) {
   JNIEnv* env = app_->GetJNIEnv();
   auto handle = future()->SafeAlloc<AppCheckToken>(kAppCheckFnGetAppCheckToken);
@@ -41,6 +41,8 @@ class AppCheckInternal {
 
   void SetTokenAutoRefreshEnabled(bool is_token_auto_refresh_enabled);
 
+  void SetTokenPersistenceEnabled(bool is_token_persistence_enabled);
+
   Future<AppCheckToken> GetAppCheckToken(bool force_refresh);
 
   Future<AppCheckToken> GetAppCheckTokenLastResult();
@@ -139,6 +139,11 @@ void AppCheck::SetTokenAutoRefreshEnabled(bool is_token_auto_refresh_enabled) {
   internal_->SetTokenAutoRefreshEnabled(is_token_auto_refresh_enabled);
 }
 
+void AppCheck::SetTokenPersistenceEnabled(bool is_token_persistence_enabled) {
+  if (!internal_) return;
+  internal_->SetTokenPersistenceEnabled(is_token_persistence_enabled);
+}
+
 Future<AppCheckToken> AppCheck::GetAppCheckToken(bool force_refresh) {
   return internal_ ? internal_->GetAppCheckToken(force_refresh)
                    : Future<AppCheckToken>();
@@ -15,8 +15,10 @@
 #include "app_check/src/desktop/app_check_desktop.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <ctime>
 #include <string>
+#include <vector>
 
 #include "app/src/function_registry.h"
 #include "app/src/log.h"
@@ -28,17 +30,57 @@ namespace internal {
 
 static AppCheckProviderFactory* g_provider_factory = nullptr;
 
+// How long before a token expires it is refreshed in the background. Tokens
+// that are valid for less than twice this are refreshed halfway through.
+static const int64_t kTokenRefreshMarginMillis = 5 * 60 * 1000;
+// How long to wait before retrying a failed background refresh.
+static const int64_t kTokenRefreshRetryMillis = 30 * 1000;
+// Domain of the secure storage used to persist tokens.
+static const char kTokenStorageDomain[] = "app_check";
+
+static int64_t CurrentTimeMillis() {
+  // Get the current time, in milliseconds (Done in two lines because of x86)
+  int64_t current_time = std::time(nullptr);
+  current_time *= 1000;
+  return current_time;
+}
+
+// Tokens are persisted as the expiration time, a newline, and the token.
+static std::string EncodeToken(const AppCheckToken& token) {
+  return std::to_string(token.expire_time_millis) + "\n" + token.token;
+}
+
+static bool DecodeToken(const std::string& encoded, AppCheckToken* token) {
+  size_t newline = encoded.find('\n');
+  if (newline == std::string::npos || newline == 0) return false;
+  char* end = nullptr;
+  std::string expire_time = encoded.substr(0, newline);
+  token->expire_time_millis = std::strtoll(expire_time.c_str(), &end, 10);
+  if (*end != '\0') return false;
+  token->token = encoded.substr(newline + 1);
+  return !token->token.empty();
+}
+
 AppCheckInternal::AppCheckInternal(App* app)
     : app_(app),
       cached_token_(),
       cached_provider_(),
-      is_token_auto_refresh_enabled_(true) {
+      is_token_auto_refresh_enabled_(true),
+      fetch_in_flight_(false),
+      refresh_generation_(0),
+      is_token_persistence_enabled_(false),
+      safe_this_(this) {
   future_manager().AllocFutureApi(this, kAppCheckFnCount);
   AddAppCheckListener(&internal_listener_);
   InitRegistryCalls();
 }
 
 AppCheckInternal::~AppCheckInternal() {
+  // Wait for any provider or scheduler callback that is running, and ignore
+  // the ones that run later.
+  safe_this_.ClearReference();
+  scheduler_.CancelAllAndShutdownWorkerThread();
+  token_store_.reset();
   future_manager().ReleaseFutureApi(this);
   CleanupRegistryCalls();
   app_ = nullptr;
@@ -53,17 +95,16 @@ ReferenceCountedFutureImpl* AppCheckInternal::future() {
 }
 
 bool AppCheckInternal::HasValidCacheToken() const {
-  // Get the current time, in milliseconds (Done in two lines because of x86)
-  int64_t current_time = std::time(nullptr);
-  current_time *= 1000;
-  // TODO(amaurice): Add some additional time to the check
-  return cached_token_.expire_time_millis > current_time;
+  return cached_token_.expire_time_millis > CurrentTimeMillis();
 }
 
-void AppCheckInternal::UpdateCachedToken(AppCheckToken token) {
-  cached_token_ = token;
-  // Call the token listeners
-  for (AppCheckListener* listener : token_listeners_) {
+void AppCheckInternal::NotifyTokenChanged(const AppCheckToken& token) {
+  std::list<AppCheckListener*> listeners;
+  {
+    MutexLock lock(mutex_);
+    listeners = token_listeners_;
+  }
+  for (AppCheckListener* listener : listeners) {
     listener->OnAppCheckTokenChanged(token);
   }
 }
@@ -83,35 +124,200 @@ void AppCheckInternal::SetAppCheckProviderFactory(
 
 void AppCheckInternal::SetTokenAutoRefreshEnabled(
     bool is_token_auto_refresh_enabled) {
-  is_token_auto_refresh_enabled_ = is_token_auto_refresh_enabled;
+  scheduler::RequestHandle replaced;
+  {
+    MutexLock lock(mutex_);
+    is_token_auto_refresh_enabled_ = is_token_auto_refresh_enabled;
+    if (is_token_auto_refresh_enabled_) {
+      ScheduleRefreshLocked(&replaced);
+    } else {
+      replaced = refresh_handle_;
+      refresh_handle_ = scheduler::RequestHandle();
+      ++refresh_generation_;
+    }
+  }
+  CancelRefresh(&replaced);
+}
+
+void AppCheckInternal::SetTokenPersistenceEnabled(
+    bool is_token_persistence_enabled) {
+  app::secure::UserSecureManager* token_store;
+  AppCheckToken token;
+  {
+    MutexLock lock(mutex_);
+    if (is_token_persistence_enabled == is_token_persistence_enabled_) return;
+    is_token_persistence_enabled_ = is_token_persistence_enabled;
+    if (!token_store_) {
+      token_store_.reset(new app::secure::UserSecureManager(
+          kTokenStorageDomain, app_->options().app_id()));
+    }
+    token_store = token_store_.get();
+    token = cached_token_;
+  }
+
+  if (!is_token_persistence_enabled) {
+    token_store->DeleteUserData(app_->name());
+    return;
+  }
+  if (token.expire_time_millis > CurrentTimeMillis()) {
+    // Save the token we already have rather than loading an older one.
+    token_store->SaveUserData(app_->name(), EncodeToken(token));
+    return;
+  }
+  ThisRef ref = safe_this_;
+  token_store->LoadUserData(app_->name())
+      .OnCompletion([ref](const Future<std::string>& result) mutable {
+        ThisRefLock lock(&ref);
+        AppCheckInternal* app_check = lock.GetReference();
+        AppCheckToken loaded;
+        if (app_check && result.error() == 0 && result.result() &&
+            DecodeToken(*result.result(), &loaded)) {
+          app_check->OnTokenLoaded(loaded);
+        }
+      });
+}
+
+void AppCheckInternal::OnTokenLoaded(const AppCheckToken& token) {
+  scheduler::RequestHandle replaced;
+  {
+    MutexLock lock(mutex_);
+    if (token.expire_time_millis <= CurrentTimeMillis() ||
+        token.expire_time_millis <= cached_token_.expire_time_millis) {
+      return;
+    }
+    cached_token_ = token;
+    ScheduleRefreshLocked(&replaced);
+  }
+  CancelRefresh(&replaced);
+  NotifyTokenChanged(token);
+}
+
+void AppCheckInternal::ScheduleRefreshLocked(
+    scheduler::RequestHandle* replaced) {
+  if (!HasValidCacheToken()) return;
+  int64_t remaining = cached_token_.expire_time_millis - CurrentTimeMillis();
+  ScheduleRefreshLocked(
+      remaining - std::min(kTokenRefreshMarginMillis, remaining / 2),
+      replaced);
+}
+
+void AppCheckInternal::ScheduleRefreshLocked(
+    int64_t delay_millis, scheduler::RequestHandle* replaced) {
+  *replaced = refresh_handle_;
+  refresh_handle_ = scheduler::RequestHandle();
+  uint64_t generation = ++refresh_generation_;
+  if (!is_token_auto_refresh_enabled_) return;
+  ThisRef ref = safe_this_;
+  refresh_handle_ = scheduler_.Schedule(
+      [ref, generation]() mutable {
+        ThisRefLock lock(&ref);
+        if (lock.GetReference()) lock.GetReference()->RefreshToken(generation);
+      },
+      static_cast<scheduler::ScheduleTimeMs>(delay_millis));
+}
+
+void AppCheckInternal::CancelRefresh(scheduler::RequestHandle* refresh) {
+  if (refresh->IsValid()) refresh->Cancel();
+}
+
+void AppCheckInternal::RefreshToken(uint64_t generation) {
+  {
+    MutexLock lock(mutex_);
+    // The refresh may have been replaced just before it was cancelled.
+    if (generation != refresh_generation_) return;
+  }
+  FetchToken();
+}
+
+void AppCheckInternal::FetchToken() {
+  AppCheckProvider* provider;
+  {
+    MutexLock lock(mutex_);
+    if (fetch_in_flight_) return;
+    provider = GetProvider();
+    fetch_in_flight_ = provider != nullptr;
+  }
+  if (provider == nullptr) {
+    OnTokenFetched(AppCheckToken(), kAppCheckErrorInvalidConfiguration,
+                   "No AppCheckProvider installed.");
+    return;
+  }
+  ThisRef ref = safe_this_;
+  provider->GetToken([ref](firebase::app_check::AppCheckToken token,
+                           int error_code,
+                           const std::string& error_message) mutable {
+    ThisRefLock lock(&ref);
+    if (lock.GetReference()) {
+      lock.GetReference()->OnTokenFetched(token, error_code, error_message);
+    }
+  });
+}
+
+void AppCheckInternal::OnTokenFetched(const AppCheckToken& token,
+                                      int error_code,
+                                      const std::string& error_message) {
+  std::vector<SafeFutureHandle<AppCheckToken>> token_handles;
+  std::vector<SafeFutureHandle<std::string>> string_handles;
+  app::secure::UserSecureManager* token_store = nullptr;
+  scheduler::RequestHandle replaced;
+  {
+    MutexLock lock(mutex_);
+    fetch_in_flight_ = false;
+    token_handles.swap(pending_token_handles_);
+    string_handles.swap(pending_string_handles_);
+    if (error_code == kAppCheckErrorNone) {
+      cached_token_ = token;
+      ScheduleRefreshLocked(&replaced);
+      if (is_token_persistence_enabled_) token_store = token_store_.get();
+    } else if (HasValidCacheToken()) {
+      // A background refresh failed. Try again while the cached token is
+      // still valid, after which callers fetch a token themselves.
+      ScheduleRefreshLocked(kTokenRefreshRetryMillis, &replaced);
+    }
+  }
+  CancelRefresh(&replaced);
+
+  if (error_code == kAppCheckErrorNone) {
+    NotifyTokenChanged(token);
+    if (token_store) {
+      token_store->SaveUserData(app_->name(), EncodeToken(token));
+    }
+    for (const auto& handle : token_handles) {
+      future()->CompleteWithResult(handle, 0, token);
+    }
+    for (const auto& handle : string_handles) {
+      future()->CompleteWithResult(handle, 0, token.token);
+    }
+  } else {
+    for (const auto& handle : token_handles) {
+      future()->Complete(handle, error_code, error_message.c_str());
+    }
+    for (const auto& handle : string_handles) {
+      future()->Complete(handle, error_code, error_message.c_str());
+    }
+  }
 }
 
 Future<AppCheckToken> AppCheckInternal::GetAppCheckToken(bool force_refresh) {
   auto handle = future()->SafeAlloc<AppCheckToken>(kAppCheckFnGetAppCheckToken);
-  if (!force_refresh && HasValidCacheToken()) {
-    // If the cached token is valid, and not told to refresh, return the cache
-    future()->CompleteWithResult(handle, 0, cached_token_);
-  } else {
-    // Get a new token, and pass the result into the future.
-    AppCheckProvider* provider = GetProvider();
-    if (provider != nullptr) {
-      auto token_callback{
-          [this, handle](firebase::app_check::AppCheckToken token,
-                         int error_code, const std::string& error_message) {
-            if (error_code == firebase::app_check::kAppCheckErrorNone) {
-              UpdateCachedToken(token);
-              future()->CompleteWithResult(handle, 0, token);
-            } else {
-              future()->Complete(handle, error_code, error_message.c_str());
-            }
-          }};
-      provider->GetToken(token_callback);
+  AppCheckToken token;
+  bool cached = false;
+  {
+    MutexLock lock(mutex_);
+    if (!force_refresh && HasValidCacheToken()) {
+      // If the cached token is valid, and not told to refresh, return the cache
+      token = cached_token_;
+      cached = true;
     } else {
-      future()->Complete(
-          handle, firebase::app_check::kAppCheckErrorInvalidConfiguration,
-          "No AppCheckProvider installed.");
+      // Get a new token, and pass the result into the future.
+      pending_token_handles_.push_back(handle);
     }
   }
+  if (cached) {
+    future()->CompleteWithResult(handle, 0, token);
+  } else {
+    FetchToken();
+  }
   return MakeFuture(future(), handle);
 }
 
@@ -123,31 +329,26 @@ Future<AppCheckToken> AppCheckInternal::GetAppCheckTokenLastResult() {
 Future<std::string> AppCheckInternal::GetAppCheckTokenStringInternal() {
   auto handle =
       future()->SafeAlloc<std::string>(kAppCheckFnGetAppCheckStringInternal);
-  if (HasValidCacheToken()) {
-    future()->CompleteWithResult(handle, 0, cached_token_.token);
-  } else if (is_token_auto_refresh_enabled_) {
-    // Only refresh the token if it is enabled
-    AppCheckProvider* provider = GetProvider();
-    if (provider != nullptr) {
-      // Get a new token, and pass the result into the future.
-      // Note that this is slightly different from the one above, as the
-      // Future result is just the string token, and not the full struct.
-      auto token_callback{
-          [this, handle](firebase::app_check::AppCheckToken token,
-                         int error_code, const std::string& error_message) {
-            if (error_code == firebase::app_check::kAppCheckErrorNone) {
-              UpdateCachedToken(token);
-              future()->CompleteWithResult(handle, 0, token.token);
-            } else {
-              future()->Complete(handle, error_code, error_message.c_str());
-            }
-          }};
-      provider->GetToken(token_callback);
-    } else {
-      future()->Complete(
-          handle, firebase::app_check::kAppCheckErrorInvalidConfiguration,
-          "No AppCheckProvider installed.");
+  std::string token;
+  bool cached = false;
+  bool fetch = false;
+  {
+    MutexLock lock(mutex_);
+    if (HasValidCacheToken()) {
+      token = cached_token_.token;
+      cached = true;
+    } else if (is_token_auto_refresh_enabled_) {
+      // Only refresh the token if it is enabled. Note that this is slightly
+      // different from the one above, as the Future result is just the string
+      // token, and not the full struct.
+      pending_string_handles_.push_back(handle);
+      fetch = true;
     }
+  }
+  if (cached) {
+    future()->CompleteWithResult(handle, 0, token);
+  } else if (fetch) {
+    FetchToken();
   } else {
     future()->Complete(
         handle, kAppCheckErrorUnknown,
@@ -158,18 +359,26 @@ Future<std::string> AppCheckInternal::GetAppCheckTokenStringInternal() {
 
 void AppCheckInternal::AddAppCheckListener(AppCheckListener* listener) {
   if (listener) {
-    token_listeners_.push_back(listener);
+    AppCheckToken token;
+    bool has_token;
+    {
+      MutexLock lock(mutex_);
+      token_listeners_.push_back(listener);
+      has_token = HasValidCacheToken();
+      token = cached_token_;
+    }
 
     // Following the Android pattern, if there is a cached token, call the
     // listener. Note that the iOS implementation does not do this.
-    if (HasValidCacheToken()) {
-      listener->OnAppCheckTokenChanged(cached_token_);
+    if (has_token) {
+      listener->OnAppCheckTokenChanged(token);
     }
   }
 }
 
 void AppCheckInternal::RemoveAppCheckListener(AppCheckListener* listener) {
   if (listener) {
+    MutexLock lock(mutex_);
     token_listeners_.remove(listener);
   }
 }
@@ -255,9 +464,13 @@ bool AppCheckInternal::AddAppCheckListenerForRegistry(App* app, void* callback,
     app_check->internal_->internal_listener_.AddListener(typed_callback,
                                                          context);
     // If there is a cached token, pass it along to the callback
-    if (app_check->internal_->HasValidCacheToken()) {
-      typed_callback(app_check->internal_->cached_token_.token, context);
+    AppCheckInternal* internal = app_check->internal_;
+    std::string token;
+    {
+      MutexLock lock(internal->mutex_);
+      if (internal->HasValidCacheToken()) token = internal->cached_token_.token;
     }
+    if (!token.empty()) typed_callback(token, context);
     return true;
   }
   return false;
@@ -16,6 +16,7 @@
 #define FIREBASE_APP_CHECK_SRC_DESKTOP_APP_CHECK_DESKTOP_H_
 
 #include <list>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,6 +24,10 @@
 #include "app/src/future_manager.h"
 #include "app/src/include/firebase/app.h"
 #include "app/src/include/firebase/future.h"
+#include "app/src/include/firebase/internal/mutex.h"
+#include "app/src/safe_reference.h"
+#include "app/src/scheduler.h"
+#include "app/src/secure/user_secure_manager.h"
 #include "app_check/src/include/firebase/app_check.h"
 
 namespace firebase {
@@ -58,6 +63,8 @@ class AppCheckInternal {
 
   void SetTokenAutoRefreshEnabled(bool is_token_auto_refresh_enabled);
 
+  void SetTokenPersistenceEnabled(bool is_token_persistence_enabled);
+
   Future<AppCheckToken> GetAppCheckToken(bool force_refresh);
 
   Future<AppCheckToken> GetAppCheckTokenLastResult();
@@ -75,11 +82,46 @@ class AppCheckInternal {
   ReferenceCountedFutureImpl* future();
 
  private:
+  typedef firebase::internal::SafeReference<AppCheckInternal> ThisRef;
+  typedef firebase::internal::SafeReferenceLock<AppCheckInternal> ThisRefLock;
+
   // Is the cached token valid
   bool HasValidCacheToken() const;
 
-  // Update the cached Token, and call the listeners
-  void UpdateCachedToken(AppCheckToken token);
+  // Ask the provider for a new token, unless a request is already in flight,
+  // in which case its result is shared by every caller waiting for a token.
+  void FetchToken();
+
+  // Called with the result of the provider request started by FetchToken().
+  void OnTokenFetched(const AppCheckToken& token, int error_code,
+                      const std::string& error_message);
+
+  // Called with a token read from disk, which is used if it is still valid
+  // and newer than the cached token.
+  void OnTokenLoaded(const AppCheckToken& token);
+
+  // Call the listeners with a new token.
+  void NotifyTokenChanged(const AppCheckToken& token);
+
+  // Schedule a background refresh of the cached token shortly before it
+  // expires, replacing any that is already scheduled. Must be called with
+  // mutex_ held.
+  //
+  // The refresh that is replaced is moved to replaced, and must be cancelled
+  // with CancelRefresh() after mutex_ is released: a refresh that is running
+  // holds the scheduler's lock on its handle while it waits for mutex_.
+  void ScheduleRefreshLocked(scheduler::RequestHandle* replaced);
+
+  // Schedule a background refresh after the given delay, as above.
+  void ScheduleRefreshLocked(int64_t delay_millis,
+                             scheduler::RequestHandle* replaced);
+
+  // Cancel a refresh replaced by ScheduleRefreshLocked().
+  static void CancelRefresh(scheduler::RequestHandle* refresh);
+
+  // Run by the background refresh scheduled as the given generation. Does
+  // nothing if the refresh has been replaced since.
+  void RefreshToken(uint64_t generation);
 
   // Get the Provider associated with the stored App used to create this.
   AppCheckProvider* GetProvider();
@@ -115,8 +157,33 @@ class AppCheckInternal {
   // Internal listener used by the function registry to track Token changes.
   FunctionRegistryAppCheckListener internal_listener_;
   // Should it automatically get an App Check token if there is not a valid
-  // cached token.
+  // cached token, and refresh the cached token before it expires.
   bool is_token_auto_refresh_enabled_;
+
+  // Guards the cached token and the state of token requests below.
+  Mutex mutex_;
+  // Whether a provider request started by FetchToken() is in flight.
+  bool fetch_in_flight_;
+  // Futures waiting for the token request that is in flight.
+  std::vector<SafeFutureHandle<AppCheckToken>> pending_token_handles_;
+  std::vector<SafeFutureHandle<std::string>> pending_string_handles_;
+
+  // Runs background refreshes of the cached token.
+  scheduler::Scheduler scheduler_;
+  // The background refresh that is scheduled, if any.
+  scheduler::RequestHandle refresh_handle_;
+  // Incremented whenever the background refresh is replaced.
+  uint64_t refresh_generation_;
+
+  // Whether tokens are saved to token_store_.
+  bool is_token_persistence_enabled_;
+  // Secure storage used to persist tokens. Created the first time persistence
+  // is enabled, and kept so that disabling it can delete the saved token.
+  std::unique_ptr<app::secure::UserSecureManager> token_store_;
+
+  // Reference to this that is shared with provider and scheduler callbacks,
+  // which are ignored once this has been deleted.
+  ThisRef safe_this_;
 };
 
 }  // namespace internal
@@ -135,6 +135,15 @@ class AppCheck {
   /// Sets the isTokenAutoRefreshEnabled flag.
   void SetTokenAutoRefreshEnabled(bool is_token_auto_refresh_enabled);
 
+  /// Sets whether App Check tokens are saved between runs of the app, so that
+  /// requests made soon after a restart can use a token that is still valid
+  /// instead of waiting for a new one.
+  ///
+  /// On desktop, tokens are kept in the system's secure storage, and this is
+  /// disabled by default. Disabling it deletes the saved token. On Android and
+  /// iOS, the platform SDKs manage token storage, and this has no effect.
+  void SetTokenPersistenceEnabled(bool is_token_persistence_enabled);
+
   /// Requests a Firebase App Check token. This method should be used ONLY if
   /// you need to authorize requests to a non-Firebase backend. Requests to
   /// Firebase backends are authorized automatically if configured.
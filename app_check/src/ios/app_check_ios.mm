@@ -175,6 +175,10 @@ void AppCheckInternal::SetTokenAutoRefreshEnabled(bool is_token_auto_refresh_ena
   impl().isTokenAutoRefreshEnabled = is_token_auto_refresh_enabled;
 }
 
+void AppCheckInternal::SetTokenPersistenceEnabled(bool is_token_persistence_enabled) {
+  // The iOS SDK always persists tokens.
+}
+
 Future<AppCheckToken> AppCheckInternal::GetAppCheckToken(bool force_refresh) {
   __block SafeFutureHandle<AppCheckToken> handle =
       future()->SafeAlloc<AppCheckToken>(kAppCheckFnGetAppCheckToken);
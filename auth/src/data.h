@@ -176,9 +176,6 @@ struct AuthData {
   /// This is also protecting persistent_cache_load_pending flag.
   Mutex listeners_mutex;
 
-  // Mutex for changes to the internal token listener state.
-  Mutex token_listener_mutex;
-
   // Tracks if the Id Token listener is expecting a callback to occur.
   bool expect_id_token_listener_callback;
 
@@ -125,7 +125,11 @@ void LogHeartbeat(Auth* const auth) {
   }
 }
 
-IdTokenRefreshListener::IdTokenRefreshListener() : token_timestamp_(0) {}
+IdTokenRefreshListener::IdTokenRefreshListener()
+    : token_timestamp_(0),
+      current_token_(std::make_shared<const std::string>()),
+      token_expiration_(0),
+      refresh_jitter_ms_(0) {}
 
 IdTokenRefreshListener::~IdTokenRefreshListener() {}
 
@@ -141,30 +145,38 @@ void IdTokenRefreshListener::OnIdTokenChanged(Auth* auth) {
     {
       UserView::Reader reader = UserView::GetReader(auth->auth_data_);
       assert(reader.IsValid());
-      current_token_ = reader->id_token;
+      std::atomic_store(&current_token_, std::make_shared<const std::string>(
+                                             reader->id_token));
+      token_expiration_ = reader->access_token_expiration_date;
     }
     token_timestamp_ = internal::GetTimestampEpoch();
+    std::uniform_int_distribution<uint64_t> jitter(0,
+                                                   kMsMaxTokenRefreshJitter);
+    refresh_jitter_ms_ = jitter(random_device_);
   } else {
-    current_token_ = "";
+    std::atomic_store(&current_token_, std::make_shared<const std::string>());
+    token_expiration_ = 0;
   }
 }
 
 std::string IdTokenRefreshListener::GetCurrentToken() {
-  std::string current_token;
-  {
-    MutexLock lock(mutex_);
-    current_token = current_token_;
-  }
-  return current_token;
+  return *std::atomic_load(&current_token_);
 }
 
 uint64_t IdTokenRefreshListener::GetTokenTimestamp() {
-  uint64_t token_timestamp;
-  {
-    MutexLock lock(mutex_);
-    token_timestamp = token_timestamp_;
+  return token_timestamp_.load();
+}
+
+uint64_t IdTokenRefreshListener::GetRefreshTimestamp() {
+  MutexLock lock(mutex_);
+  if (token_expiration_ <= 0) {
+    // We don't know when the token expires, so refresh it at a fixed interval.
+    return token_timestamp_ + kMsPerTokenRefresh;
   }
-  return token_timestamp;
+  const uint64_t expiration_ms = static_cast<uint64_t>(token_expiration_) *
+                                 internal::kMillisecondsPerSecond;
+  const uint64_t lead_time_ms = kMsTokenRefreshMargin + refresh_jitter_ms_;
+  return expiration_ms > lead_time_ms ? expiration_ms - lead_time_ms : 0;
 }
 
 // This is the static version of GetAuthToken, with a function signature
@@ -177,7 +189,6 @@ bool Auth::GetAuthTokenForRegistry(App* app, void* /*unused*/, void* out) {
     auth->current_user_DEPRECATED();
 
     auto result = static_cast<std::string*>(out);
-    MutexLock lock(auth->auth_data_->token_listener_mutex);
     auto auth_impl = static_cast<AuthImpl*>(auth->auth_data_->auth_impl);
     *result = auth_impl->token_refresh_thread.CurrentAuthToken();
     return true;
@@ -818,15 +829,13 @@ void IdTokenRefreshThread::Initialize(AuthData* auth_data) {
           refresh_thread->ref_count_mutex_.Acquire();
           auth->auth_data_->future_impl.mutex().Acquire();
           if (auth->auth_data_->user_impl && refresh_thread->ref_count_ > 0) {
-            // The internal identifier kInternalFn_GetTokenForRefresher,
-            // ensures that we won't mess with the LastResult for the
-            // user-facing one.
-
-            uint64_t ms_since_last_refresh =
-                internal::GetTimestampEpoch() -
-                refresh_thread->token_refresh_listener_.GetTokenTimestamp();
-
-            if (ms_since_last_refresh >= kMsPerTokenRefresh) {
+            // Tokens are refreshed shortly before they expire, so that callers
+            // never have to wait for a refresh themselves.
+            if (internal::GetTimestampEpoch() >=
+                refresh_thread->token_refresh_listener_.GetRefreshTimestamp()) {
+              // The internal identifier kInternalFn_GetTokenForRefresher,
+              // ensures that we won't mess with the LastResult for the
+              // user-facing one.
               Future<std::string> future =
                   refresh_thread->auth->auth_data_->current_user
                       .GetTokenInternal(true, kInternalFn_GetTokenForRefresher);
@@ -859,15 +868,23 @@ void IdTokenRefreshThread::Initialize(AuthData* auth_data) {
                 if (refresh_thread->ref_count_ <= 0) break;
               }
 
-              ms_since_last_refresh =
-                  internal::GetTimestampEpoch() -
-                  refresh_thread->token_refresh_listener_.GetTokenTimestamp();
+              const uint64_t now = internal::GetTimestampEpoch();
+              const uint64_t refresh_timestamp =
+                  refresh_thread->token_refresh_listener_.GetRefreshTimestamp();
+              // If the refresh time has already passed, the last refresh
+              // failed, so back off before trying again.
+              uint64_t ms_until_refresh =
+                  refresh_timestamp > now ? refresh_timestamp - now
+                                          : kMsTokenRefreshRetryDelay;
+              if (ms_until_refresh > kMsPerTokenRefresh) {
+                ms_until_refresh = kMsPerTokenRefresh;
+              }
 
               // If the timed-wait returns true, then it means we were
               // interrupted early - either it's time to shut down, or we
               // got a new token and should restart the clock.
               if (!refresh_thread->wakeup_sem_.TimedWait(
-                      kMsPerTokenRefresh - ms_since_last_refresh)) {
+                      static_cast<int>(ms_until_refresh))) {
                 break;
               }
             }
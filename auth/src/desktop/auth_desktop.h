@@ -15,8 +15,13 @@
 #ifndef FIREBASE_AUTH_SRC_DESKTOP_AUTH_DESKTOP_H_
 #define FIREBASE_AUTH_SRC_DESKTOP_AUTH_DESKTOP_H_
 
+#include <atomic>
+#include <ctime>
+#include <map>
 #include <memory>
+#include <random>
 #include <string>
+#include <vector>
 
 #include "app/rest/request.h"
 #include "app/src/scheduler.h"
@@ -24,6 +29,7 @@
 #include "app/src/thread.h"
 #include "app/src/time.h"
 #include "auth/src/data.h"
+#include "auth/src/desktop/promise.h"
 #include "auth/src/desktop/user_desktop.h"
 #include "auth/src/include/firebase/auth.h"
 #include "auth/src/include/firebase/auth/credential.h"
@@ -33,7 +39,8 @@ namespace auth {
 
 // Token listener used by the IdTokenRefreshThread object.  Basically just
 // listens for changes, and when one occurs, caches the result, along with a
-// timestamp.  All functions are thread-safe and locked with the mutex.
+// timestamp and the token's expiration time.  All functions are thread-safe
+// and locked with the mutex.
 class IdTokenRefreshListener : public IdTokenListener {
  public:
   IdTokenRefreshListener();
@@ -43,11 +50,28 @@ class IdTokenRefreshListener : public IdTokenListener {
   std::string GetCurrentToken();
   uint64_t GetTokenTimestamp();
 
+  // Returns the time, in milliseconds since the epoch, at which the current
+  // token should be refreshed by the IdTokenRefreshThread.
+  uint64_t GetRefreshTimestamp();
+
  private:
-  // Guards all members of this class.
+  // Guards the members of this class that are changed together. The token and
+  // its timestamp, which are read for every request that needs a token, are
+  // read without it.
   Mutex mutex_;
-  uint64_t token_timestamp_;
-  std::string current_token_;
+  std::atomic<uint64_t> token_timestamp_;
+  // The current token, which is replaced rather than changed so readers can
+  // take a reference to it without a lock. Access with std::atomic_load() and
+  // std::atomic_store().
+  std::shared_ptr<const std::string> current_token_;
+  // Expiration time of current_token_, in seconds since the epoch, or 0 if it
+  // is unknown.
+  std::time_t token_expiration_;
+  // Random delay, picked for each new token, by which the refresh is brought
+  // forward so that tokens issued at the same time aren't all refreshed at
+  // once.
+  uint64_t refresh_jitter_ms_;
+  std::random_device random_device_;
 };
 
 // This class handles the full lifecycle of the token refresh thread.  It
@@ -182,6 +206,14 @@ struct AuthImpl {
   // Serializes all REST call from this object.
   scheduler::Scheduler scheduler_;
 
+  // Promises waiting for the token refresh that is currently scheduled on
+  // scheduler_, keyed by the uid of the user they asked on behalf of. Callers
+  // that need a new token while a refresh is pending for the same user are
+  // added here and completed with its result, rather than each sending their
+  // own request. Guarded by the AuthData's future_impl.mutex().
+  std::map<std::string, std::vector<Promise<std::string>>>
+      pending_token_refreshes;
+
   // Synchronization primative for tracking sate of FederatedAuth futures.
   Mutex provider_mutex;
 
@@ -198,6 +230,16 @@ const int kMinutesPerTokenRefresh = 58;
 const int kMsPerTokenRefresh =
     kMinutesPerTokenRefresh * internal::kMillisecondsPerMinute;
 
+// How long before a token expires the refresh thread fetches a new one. This
+// is longer than the 5 minutes within which GetToken() considers a token
+// stale, so callers are served the cached token instead of waiting on the
+// network.
+const int kMsTokenRefreshMargin = 6 * internal::kMillisecondsPerMinute;
+// Upper bound of the random jitter subtracted from the refresh time.
+const int kMsMaxTokenRefreshJitter = 3 * internal::kMillisecondsPerMinute;
+// How long the refresh thread waits before retrying a failed refresh.
+const int kMsTokenRefreshRetryDelay = 30 * internal::kMillisecondsPerSecond;
+
 void InitializeUserDataPersist(AuthData* auth_data);
 void DestroyUserDataPersist(AuthData* auth_data);
 void LoadFinishTriggerListeners(AuthData* auth_data);
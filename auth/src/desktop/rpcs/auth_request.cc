@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 
+#include "app/rest/util.h"
 #include "app/src/app_common.h"
 #include "app/src/heartbeat/heartbeat_controller_desktop.h"
 #include "app/src/include/firebase/app.h"
@@ -37,6 +38,8 @@ AuthRequest::AuthRequest(::firebase::App& app, const char* schema,
                          bool deliver_heartbeat)
     : RequestJson(schema), app(app) {
   CheckEnvEmulator();
+  // Responses are JSON, which compresses well.
+  add_header(rest::util::kAcceptEncoding, rest::util::kGzip);
 
   if (deliver_heartbeat) {
     std::shared_ptr<heartbeat::HeartbeatController> heartbeat_controller =
@@ -15,8 +15,10 @@
 #include "auth/src/desktop/user_desktop.h"
 
 #include <fstream>
+#include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "app/rest/transport_builder.h"
 #include "app/rest/util.h"
@@ -601,8 +603,13 @@ Future<ResultT> DoReauthenticate_DEPRECATED(Promise<ResultT> promise,
 
 }  // namespace
 
+// How long saves of the user wait to be written, so that the several changes
+// made by a token refresh or sign in are written once.
+const scheduler::ScheduleTimeMs kUserSaveDelayMs = 100;
+
 UserDataPersist::UserDataPersist(const char* app_id) {
   user_secure_manager_ = std::make_unique<UserSecureManager>("auth", app_id);
+  user_secure_manager_->set_save_delay_ms(kUserSaveDelayMs);
 }
 
 UserDataPersist::UserDataPersist(
@@ -821,9 +828,11 @@ Future<std::string> User::GetTokenInternal(const bool force_refresh,
   }
 
   GetTokenResult current_token(kAuthErrorFailure);
+  std::string uid;
   const bool is_user_logged_in =
       UserView::TryRead(auth_data_, [&](const UserView::Reader& user) {
         current_token = GetTokenIfFresh(user, force_refresh);
+        uid = user->uid;
       });
 
   if (!is_user_logged_in) {
@@ -836,16 +845,54 @@ Future<std::string> User::GetTokenInternal(const bool force_refresh,
     return promise.future();
   }
 
+  // If a refresh is already scheduled for this user, share its result rather
+  // than sending another request.
+  auto auth_impl = static_cast<AuthImpl*>(auth_data_->auth_impl);
+  {
+    MutexLock lock(auth_data_->future_impl.mutex());
+    auto& waiting_promises = auth_impl->pending_token_refreshes[uid];
+    waiting_promises.push_back(promise);
+    if (waiting_promises.size() > 1) {
+      return promise.future();
+    }
+  }
+
   const auto callback =
       [](AuthDataHandle<std::string, rest::Request>* const handle) {
+        std::string uid;
+        UserView::TryRead(handle->auth_data, [&](const UserView::Reader& user) {
+          uid = user->uid;
+        });
         const GetTokenResult get_token_result =
             EnsureFreshToken(handle->auth_data, true);
-        if (!get_token_result.IsValid()) {
-          FailPromise(&handle->promise, get_token_result.error());
-          return;
+        std::string refreshed_uid;
+        UserView::TryRead(handle->auth_data, [&](const UserView::Reader& user) {
+          refreshed_uid = user->uid;
+        });
+
+        // Complete everyone who asked for a token while this refresh was
+        // pending, including handle->promise. The token is only handed to
+        // callers who asked on behalf of the user it was fetched for; callers
+        // waiting on a user who has since signed out or been replaced fail.
+        auto auth_impl = static_cast<AuthImpl*>(handle->auth_data->auth_impl);
+        std::map<std::string, std::vector<Promise<std::string>>> waiting;
+        {
+          MutexLock lock(handle->auth_data->future_impl.mutex());
+          waiting.swap(auth_impl->pending_token_refreshes);
+        }
+        for (auto& entry : waiting) {
+          const bool is_refreshed_user =
+              !uid.empty() && entry.first == uid && uid == refreshed_uid;
+          for (auto& waiting_promise : entry.second) {
+            if (!is_refreshed_user) {
+              FailPromise(&waiting_promise, kAuthErrorNoSignedInUser);
+            } else if (get_token_result.IsValid()) {
+              waiting_promise.CompleteWithResult(get_token_result.token());
+            } else {
+              FailPromise(&waiting_promise, get_token_result.error());
+            }
+          }
         }
-
-        handle->promise.CompleteWithResult(get_token_result.token());
       };
 
   // Note: request is deliberately null because EnsureFreshToken will create it.
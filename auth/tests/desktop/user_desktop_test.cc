@@ -19,6 +19,7 @@
 #include "app/rest/transport_mock.h"
 #include "app/src/include/firebase/app.h"
 #include "app/src/include/firebase/internal/mutex.h"
+#include "app/src/semaphore.h"
 #include "app/tests/include/firebase/app_for_testing.h"
 #include "auth/src/desktop/auth_desktop.h"
 #include "auth/src/include/firebase/auth.h"
@@ -246,6 +247,45 @@ bool WaitOnLoadPersistence(AuthData* auth_data) {
   return load_finished;
 }
 
+// Counts the requests sent to one URL and holds them until it is opened, so
+// that callers can queue up behind a request that is still in flight.
+struct RequestGate {
+  explicit RequestGate(const std::string& set_url)
+      : url(set_url), request_count(0), opened(0) {}
+
+  int GetRequestCount() {
+    MutexLock lock(mutex);
+    return request_count;
+  }
+
+  const std::string url;
+  Mutex mutex;
+  int request_count;
+  Semaphore opened;
+};
+
+RequestGate* g_request_gate = nullptr;
+
+// Mock transport that passes requests through g_request_gate, if it is set.
+class GatedTransportMock : public rest::TransportMock {
+ public:
+  void PerformInternal(
+      rest::Request* request, rest::Response* response,
+      flatbuffers::unique_ptr<rest::Controller>* controller_out) override {
+    RequestGate* gate = g_request_gate;
+    if (gate && request->options().url == gate->url) {
+      {
+        MutexLock lock(gate->mutex);
+        ++gate->request_count;
+      }
+      gate->opened.Wait();
+      // Let any later request through as well.
+      gate->opened.Post();
+    }
+    rest::TransportMock::PerformInternal(request, response, controller_out);
+  }
+};
+
 }  // namespace
 
 class UserDesktopTest : public ::testing::Test {
@@ -255,7 +295,7 @@ class UserDesktopTest : public ::testing::Test {
   void SetUp() override {
     rest::SetTransportBuilder([]() -> flatbuffers::unique_ptr<rest::Transport> {
       return flatbuffers::unique_ptr<rest::Transport>(
-          new rest::TransportMock());
+          new GatedTransportMock());
     });
     AppOptions options = testing::MockAppOptions();
     options.set_api_key(API_KEY);
@@ -382,6 +422,39 @@ TEST_F(UserDesktopTest, TestGetToken) {
   EXPECT_EQ("new idtoken123", new_token);
 }
 
+TEST_F(UserDesktopTest, TestGetToken_ConcurrentRefreshesShareResult) {
+  const auto api_url =
+      std::string("https://securetoken.googleapis.com/v1/token?key=") + API_KEY;
+  InitializeConfigWithAFake(
+      api_url,
+      FakeSuccessfulResponse("\"access_token\": \"new accesstoken123\","
+                             "\"expires_in\": \"3600\","
+                             "\"token_type\": \"Bearer\","
+                             "\"refresh_token\": \"new refreshtoken123\","
+                             "\"id_token\": \"new idtoken123\","
+                             "\"user_id\": \"localid123\","
+                             "\"project_id\": \"53101460582\""));
+
+  id_token_listener.ExpectChanges(1);
+  auth_state_listener.ExpectChanges(0);
+
+  // Hold the refresh request until every caller has asked for a token, so
+  // they all arrive while it is pending.
+  RequestGate gate(api_url);
+  g_request_gate = &gate;
+  Future<std::string> first = firebase_user_->GetToken(true);
+  Future<std::string> second = firebase_user_->GetToken(true);
+  Future<std::string> third = firebase_user_->GetToken(true);
+  gate.opened.Post();
+
+  // They all complete with the result of a single request.
+  EXPECT_EQ("new idtoken123", WaitForFuture(first));
+  EXPECT_EQ("new idtoken123", WaitForFuture(second));
+  EXPECT_EQ("new idtoken123", WaitForFuture(third));
+  EXPECT_EQ(1, gate.GetRequestCount());
+  g_request_gate = nullptr;
+}
+
 TEST_F(UserDesktopTest, TestDelete) {
   InitializeConfigWithAFake(
       GetUrlForApi(API_KEY, "deleteAccount"),
@@ -196,6 +196,33 @@ void Database::set_persistence_enabled(bool enabled) {
   if (internal_) internal_->SetPersistenceEnabled(enabled);
 }
 
+void Database::set_persistence_query_indexing_enabled(bool enabled) {
+#if defined(FIREBASE_TARGET_DESKTOP)
+  if (internal_) internal_->SetPersistenceQueryIndexingEnabled(enabled);
+#else
+  (void)enabled;
+  LogWarning("Persistence query indexing is only supported on desktop.");
+#endif  // defined(FIREBASE_TARGET_DESKTOP)
+}
+
+void Database::set_max_in_flight_writes(int max_in_flight_writes) {
+#if defined(FIREBASE_TARGET_DESKTOP)
+  if (internal_) internal_->SetMaxInFlightWrites(max_in_flight_writes);
+#else
+  (void)max_in_flight_writes;
+  LogWarning("Limiting in-flight writes is only supported on desktop.");
+#endif  // defined(FIREBASE_TARGET_DESKTOP)
+}
+
+void Database::ImportPersistenceCache(const char* path, const char* file_path) {
+  FIREBASE_ASSERT_RETURN_VOID(path != nullptr && file_path != nullptr);
+#if defined(FIREBASE_TARGET_DESKTOP)
+  if (internal_) internal_->AddPersistenceCacheImport(path, file_path);
+#else
+  LogWarning("Importing the persistence cache is only supported on desktop.");
+#endif  // defined(FIREBASE_TARGET_DESKTOP)
+}
+
 void Database::set_log_level(LogLevel log_level) {
   if (internal_) internal_->set_log_level(log_level);
 }
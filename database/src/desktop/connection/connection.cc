@@ -14,12 +14,14 @@
 
 #include "database/src/desktop/connection/connection.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <string>
 
 #include "app/src/assert.h"
 #include "app/src/log.h"
+#include "app/src/metrics.h"
 #include "app/src/variant_util.h"
 #include "database/src/desktop/connection/util_connection.h"
 #include "database/src/desktop/connection/web_socket_client_impl.h"
@@ -32,6 +34,15 @@ namespace connection {
 const int Connection::kKeepAliveTimeoutMs = 45 * 1000;  // 45 seconds
 const int Connection::kConnectTimeoutMs = 30 * 1000;    // 30 seconds
 const int Connection::kMaxFrameSize = 16384;
+const uint32_t Connection::kMaxReservedFrames = 1024;
+
+static metrics::Histogram g_sent_message_bytes(
+    "firebase_database_sent_message_bytes",
+    "Size of each message sent to the database server, in bytes.");
+static metrics::Histogram g_received_frame_bytes(
+    "firebase_database_received_frame_bytes",
+    "Size of each WebSocket frame received from the database server, in "
+    "bytes.");
 
 const char* const Connection::kRequestType = "t";
 const char* const Connection::kRequestTypeData = "d";
@@ -152,23 +163,27 @@ void Connection::Send(const Variant& message, bool is_sensitive) {
   logger_->LogDebug("%s Sending data: %s", log_id_.c_str(),
                     is_sensitive ? "(contents hidden)" : to_send.c_str());
 
+  g_sent_message_bytes.Record(to_send.length());
+
   // Split info frames if the length is larger than kMaxFrameSize
-  int num_of_frame = to_send.length() / kMaxFrameSize + 1;
+  const size_t frame_size = static_cast<size_t>(kMaxFrameSize);
+  size_t num_of_frame = to_send.length() / frame_size + 1;
   if (num_of_frame > 1) {
     logger_->LogDebug("%s Split data into %d frames (size: %d)",
-                      log_id_.c_str(), num_of_frame, to_send.length());
+                      log_id_.c_str(), static_cast<int>(num_of_frame),
+                      static_cast<int>(to_send.length()));
 
     // Send number of frames
-    std::stringstream frame_size_str;
-    frame_size_str << num_of_frame;
-    client_->Send(frame_size_str.str().c_str());
+    std::string frame_size_str = std::to_string(num_of_frame);
+    client_->Send(frame_size_str.data(), frame_size_str.length());
 
     // Send individual frame
-    for (int i = 0; i < to_send.length(); i += kMaxFrameSize) {
-      client_->Send(to_send.substr(i, kMaxFrameSize).c_str());
+    for (size_t i = 0; i < to_send.length(); i += frame_size) {
+      client_->Send(to_send.data() + i,
+                    std::min(frame_size, to_send.length() - i));
     }
   } else {
-    client_->Send(to_send.c_str());
+    client_->Send(to_send.data(), to_send.length());
   }
 }
 
@@ -197,12 +212,12 @@ void Connection::OnOpen() {
       kKeepAliveTimeoutMs, kKeepAliveTimeoutMs);
 }
 
-void Connection::OnMessage(const char* msg) {
+void Connection::OnMessage(const char* msg, size_t length) {
   SAFE_REFERENCE_RETURN_VOID_IF_INVALID(ConnectionRefLock, lock, safe_this_);
 
   logger_->LogDebug("%s websocket message received", log_id_.c_str());
 
-  HandleIncomingFrame(msg);
+  HandleIncomingFrame(msg, length);
 }
 
 void Connection::OnClose() {
@@ -243,10 +258,11 @@ void Connection::OnError(const WebSocketClientErrorData& error_data) {
       }));
 }
 
-void Connection::HandleIncomingFrame(const char* msg) {
+void Connection::HandleIncomingFrame(const char* msg, size_t length) {
   if (state_ == kStateDisconnected) {
     return;
   }
+  g_received_frame_bytes.Record(length);
 
   // Firebase server splits large message into multiple frames, the same way
   // how client split large message into frames before sending.  If the received
@@ -254,22 +270,25 @@ void Connection::HandleIncomingFrame(const char* msg) {
   // future.
   if (expected_incoming_frames_ > 0) {
     // Add msg to buffer
-    incoming_buffer_ << msg;
+    incoming_buffer_.append(msg, length);
     --expected_incoming_frames_;
 
     logger_->LogDebug("%s Received a frame (length: %d), %d more to come",
-                      log_id_.c_str(), strlen(msg), expected_incoming_frames_);
+                      log_id_.c_str(), static_cast<int>(length),
+                      expected_incoming_frames_);
 
-    // If buffer is complete, process it
+    // If buffer is complete, process it, then release the buffer since large
+    // messages are rare.
     if (expected_incoming_frames_ == 0) {
-      ProcessMessage(incoming_buffer_.str().c_str());
+      ProcessMessage(incoming_buffer_.c_str(), incoming_buffer_.length());
+      std::string().swap(incoming_buffer_);
     }
   } else {
     uint32_t num_of_frame = 0;
     // The server is only supposed to send up to 9999 frames (i.e. length
     // <= 4), but that isn't being enforced currently.  So allowing larger frame
     // counts (length <= 6).
-    if (std::strlen(msg) <= 6) {
+    if (length <= 6) {
       int32_t parse_value = strtol(msg, nullptr, 10);  // NOLINT
       if (parse_value > 0) {
         num_of_frame = parse_value;
@@ -280,20 +299,22 @@ void Connection::HandleIncomingFrame(const char* msg) {
       logger_->LogDebug("%s Received a frame count. Expecting %d frames later",
                         log_id_.c_str(), num_of_frame);
 
-      // Start the buffer
+      // Start the buffer.  All but the last frame are expected to be full.
       expected_incoming_frames_ = num_of_frame;
-      incoming_buffer_.str("");
+      incoming_buffer_.clear();
+      incoming_buffer_.reserve(std::min(num_of_frame, kMaxReservedFrames) *
+                               static_cast<size_t>(kMaxFrameSize));
     } else {
       // Process it
-      ProcessMessage(msg);
+      ProcessMessage(msg, length);
     }
   }
 }
 
-void Connection::ProcessMessage(const char* message) {
+void Connection::ProcessMessage(const char* message, size_t length) {
   Variant message_data = util::JsonToVariant(message);
   logger_->LogDebug("%s ProcessMessage (length: %d)", log_id_.c_str(),
-                    strlen(message));
+                    static_cast<int>(length));
 
   FIREBASE_DEV_ASSERT(!message_data.is_null());
 
@@ -318,13 +339,14 @@ void Connection::ProcessMessage(const char* message) {
                           log_id_.c_str(), type.c_str());
       }
     } else {
-      logger_->LogDebug("%s Fail to parse server message: %s", log_id_.c_str(),
-                        util::VariantToJson(message_data).c_str());
+      FIREBASE_LOGGER_DEBUG(logger_, "%s Fail to parse server message: %s",
+                            log_id_.c_str(),
+                            util::VariantToJson(message_data).c_str());
       Close(kDisconnectReasonProtocolError);
     }
   } else {
-    logger_->LogDebug(
-        "%s Failed to parse server message: missing message type: %s",
+    FIREBASE_LOGGER_DEBUG(
+        logger_, "%s Failed to parse server message: missing message type: %s",
         log_id_.c_str(), util::VariantToJson(message_data).c_str());
     Close(kDisconnectReasonProtocolError);
   }
@@ -338,8 +360,8 @@ void Connection::OnDataMessage(const Variant& data) {
 }
 
 void Connection::OnControlMessage(const Variant& data) {
-  logger_->LogDebug("%s received control message: %s", log_id_.c_str(),
-                    util::VariantToJson(data).c_str());
+  FIREBASE_LOGGER_DEBUG(logger_, "%s received control message: %s",
+                        log_id_.c_str(), util::VariantToJson(data).c_str());
 
   FIREBASE_DEV_ASSERT(!data.is_null());
 
@@ -363,8 +385,10 @@ void Connection::OnControlMessage(const Variant& data) {
         if (itHost != data_map.end() && itHost->second.is_string()) {
           OnReset(itHost->second.string_value());
         } else {
-          logger_->LogDebug("%s Reset connection with unknown host: %s",
-                            log_id_.c_str(), util::VariantToJson(data).c_str());
+          FIREBASE_LOGGER_DEBUG(logger_,
+                                "%s Reset connection with unknown host: %s",
+                                log_id_.c_str(),
+                                util::VariantToJson(data).c_str());
           OnReset("");
         }
       } else if (messageType == kServerControlMessageHello) {
@@ -372,8 +396,10 @@ void Connection::OnControlMessage(const Variant& data) {
         if (itHandshake != data_map.end()) {
           OnHandshake(itHandshake->second);
         } else {
-          logger_->LogDebug("%s Handshake received with no data: %s",
-                            log_id_.c_str(), util::VariantToJson(data).c_str());
+          FIREBASE_LOGGER_DEBUG(logger_,
+                                "%s Handshake received with no data: %s",
+                                log_id_.c_str(),
+                                util::VariantToJson(data).c_str());
           OnHandshake(Variant());
         }
       } else if (messageType == kServerControlMessageError) {
@@ -390,13 +416,13 @@ void Connection::OnControlMessage(const Variant& data) {
                           log_id_.c_str(), messageType.c_str());
       }
     } else {
-      logger_->LogDebug("%s Fail to parse control message: %s", log_id_.c_str(),
-                        util::VariantToJson(data).c_str());
+      FIREBASE_LOGGER_DEBUG(logger_, "%s Fail to parse control message: %s",
+                            log_id_.c_str(), util::VariantToJson(data).c_str());
       Close(kDisconnectReasonProtocolError);
     }
   } else {
-    logger_->LogDebug("%s Got invalid control message: %s", log_id_.c_str(),
-                      util::VariantToJson(data).c_str());
+    FIREBASE_LOGGER_DEBUG(logger_, "%s Got invalid control message: %s",
+                          log_id_.c_str(), util::VariantToJson(data).c_str());
     Close(kDisconnectReasonProtocolError);
   }
 }
@@ -18,6 +18,7 @@
 #include <atomic>
 #include <memory>
 #include <sstream>
+#include <string>
 
 #include "app/src/include/firebase/variant.h"
 #include "app/src/logger.h"
@@ -100,7 +101,7 @@ class Connection : public WebSocketClientEventHandler {
 
   // BEGIN WebSocketClientEventHandler
   void OnOpen() override;
-  void OnMessage(const char* msg) override;
+  void OnMessage(const char* msg, size_t length) override;
   void OnClose() override;
   void OnError(const WebSocketClientErrorData& error_data) override;
   // END WebSocketClientEventHandler
@@ -125,10 +126,11 @@ class Connection : public WebSocketClientEventHandler {
   };
 
   // Combine incoming frames into one message, if the message is too large
-  void HandleIncomingFrame(const char* msg);
+  void HandleIncomingFrame(const char* msg, size_t length);
 
-  // Parse the message into data message or control message
-  void ProcessMessage(const char* message);
+  // Parse the message into data message or control message.  message must be
+  // null-terminated.
+  void ProcessMessage(const char* message, size_t length);
 
   // Forward the data message to higher-level
   void OnDataMessage(const Variant& data);
@@ -158,6 +160,10 @@ class Connection : public WebSocketClientEventHandler {
   // Maximum size of a frame for outgoing message
   static const int kMaxFrameSize;
 
+  // Maximum number of frames to reserve space for when a frame count is
+  // received, so that a bogus count can't allocate an arbitrary amount.
+  static const uint32_t kMaxReservedFrames;
+
   // Wire protocol keys and values
   static const char* const kRequestType;
   static const char* const kRequestTypeData;
@@ -211,8 +217,9 @@ class Connection : public WebSocketClientEventHandler {
   // to access in scheduler thread.
   scheduler::RequestHandle keep_alive_handler_;
 
-  // Incoming message buffer
-  std::stringstream incoming_buffer_;
+  // Incoming message buffer.  Reserved for the expected number of frames when
+  // the frame count is received and passed to the JSON parser in place.
+  std::string incoming_buffer_;
   uint32_t expected_incoming_frames_;
 
   Logger* logger_;
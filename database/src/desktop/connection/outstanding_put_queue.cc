@@ -0,0 +1,292 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "database/src/desktop/connection/outstanding_put_queue.h"
+
+#include <iterator>
+#include <utility>
+
+namespace firebase {
+namespace database {
+namespace internal {
+namespace connection {
+
+// Wire protocol actions of overwrites and merges.
+static const char kActionPut[] = "p";
+static const char kActionMerge[] = "m";
+
+// Returns whether the children of two merges at the same path can be sent as
+// a single merge, after removing the earlier children the later ones replace.
+static bool CanCombineMerges(const Variant& earlier, const Variant& later) {
+  if (!earlier.is_map() || !later.is_map()) return false;
+  for (const auto& later_child : later.map()) {
+    Path later_path(later_child.first.AsString().string_value());
+    for (const auto& earlier_child : earlier.map()) {
+      Path earlier_path(earlier_child.first.AsString().string_value());
+      // The server rejects merges where one child is the ancestor of another,
+      // unless the later child replaces the earlier one entirely.
+      if (earlier_path != later_path && earlier_path.IsParent(later_path)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Returns whether a write at path can change the data written at one of the
+// paths, or the other way around.
+static bool Overlaps(const Path& path, const std::vector<Path>& paths) {
+  for (const Path& other : paths) {
+    if (path.IsParent(other) || other.IsParent(path)) return true;
+  }
+  return false;
+}
+
+OutstandingPutQueue::OutstandingPutQueue() : next_write_id_(0), in_flight_(0) {}
+
+uint64_t OutstandingPutQueue::Add(OutstandingPutPtr put) {
+  if (put->IsTransaction()) {
+    // Transactions depend on the exact data written before them, so they are
+    // never compacted, and the writes before them can't be either.
+    compactable_puts_.clear();
+    return Queue(std::move(put));
+  }
+  if (put->action == kActionPut) {
+    CompactOverwrite(put.get());
+  } else if (put->action == kActionMerge) {
+    CompactMerge(put.get());
+  }
+  std::string key = CompactionKey(put->path);
+  uint64_t write_id = Queue(std::move(put));
+  compactable_puts_.insert(std::make_pair(key, write_id));
+  return write_id;
+}
+
+OutstandingPut* OutstandingPutQueue::Find(uint64_t write_id) const {
+  auto it = puts_.find(write_id);
+  return it != puts_.end() ? it->second.get() : nullptr;
+}
+
+std::vector<uint64_t> OutstandingPutQueue::StartSending(int max_in_flight) {
+  std::vector<uint64_t> write_ids;
+  while (!to_send_.empty() &&
+         (max_in_flight <= 0 || in_flight_ < max_in_flight)) {
+    uint64_t write_id = *to_send_.begin();
+    to_send_.erase(to_send_.begin());
+    OutstandingPut& put = *puts_[write_id];
+    if (!put.WasSent()) {
+      // Writes are sent in order, so the ones that can be compacted are all
+      // after this one.
+      auto range = compactable_puts_.equal_range(CompactionKey(put.path));
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == write_id) {
+          compactable_puts_.erase(it);
+          break;
+        }
+      }
+    }
+    put.sent = true;
+    put.in_flight = true;
+    ++in_flight_;
+    write_ids.push_back(write_id);
+  }
+  return write_ids;
+}
+
+OutstandingPutPtr OutstandingPutQueue::Acknowledge(uint64_t write_id) {
+  auto it = puts_.find(write_id);
+  if (it == puts_.end()) return nullptr;
+  OutstandingPutPtr put = std::move(it->second);
+  puts_.erase(it);
+  if (put->in_flight) --in_flight_;
+  return put;
+}
+
+OutstandingPutPtr OutstandingPutQueue::Reject(
+    uint64_t write_id, std::vector<OutstandingPutPtr>* aborted_transactions) {
+  OutstandingPutPtr put = Acknowledge(write_id);
+  if (!put) return nullptr;
+  if (put->compacted_puts.empty()) return put;
+
+  // Queue the compacted writes again at their own write ids, so they are sent
+  // next, in the order they were written.
+  std::vector<Path> requeued_paths;
+  for (auto& compacted : put->compacted_puts) {
+    requeued_paths.push_back(compacted.second->path);
+    to_send_.insert(compacted.first);
+    puts_.insert(std::move(compacted));
+  }
+  put->compacted_puts.clear();
+  if (put->uncombined_data.has_value()) {
+    put->data = std::move(put->uncombined_data.value());
+    put->uncombined_data.reset();
+    put->sent = false;
+    put->in_flight = false;
+    requeued_paths.push_back(put->path);
+    to_send_.insert(write_id);
+    puts_[write_id] = std::move(put);
+  }
+
+  // The writes after the rejected one have to be applied after the writes
+  // queued again.  Those already in flight are sent again, and those that
+  // aren't are moved to the end of the queue.
+  uint64_t end_write_id = next_write_id_;
+  for (auto it = puts_.upper_bound(write_id);
+       it != puts_.end() && it->first < end_write_id;) {
+    OutstandingPut& later = *it->second;
+    if (!Overlaps(later.path, requeued_paths)) {
+      ++it;
+      continue;
+    }
+    requeued_paths.push_back(later.path);
+    if (later.in_flight && later.IsTransaction()) {
+      // Without its hash a copy would be an unconditional overwrite, so the
+      // transaction is aborted, and its response ignored, to run it again on
+      // the data written by the writes queued again.
+      --in_flight_;
+      to_send_.erase(it->first);
+      aborted_transactions->push_back(std::move(it->second));
+      it = puts_.erase(it);
+    } else if (later.in_flight) {
+      // The response to the copy isn't needed.
+      Queue(std::make_unique<OutstandingPut>(later.action.c_str(), later.path,
+                                             later.data,
+                                             Optional<std::string>(), nullptr));
+      ++it;
+    } else {
+      to_send_.erase(it->first);
+      Queue(std::move(it->second));
+      it = puts_.erase(it);
+    }
+  }
+
+  // The writes queued again are sent before any write still in the queue,
+  // so those can no longer be compacted.
+  compactable_puts_.clear();
+  return put;
+}
+
+void OutstandingPutQueue::OnDisconnect() {
+  for (auto& it_put : puts_) {
+    if (it_put.second->in_flight) {
+      it_put.second->in_flight = false;
+      to_send_.insert(it_put.first);
+    }
+  }
+  in_flight_ = 0;
+}
+
+std::vector<OutstandingPutPtr> OutstandingPutQueue::RemoveSentTransactions() {
+  std::vector<OutstandingPutPtr> transactions;
+  for (auto it_put = puts_.begin(); it_put != puts_.end();) {
+    OutstandingPut& put = *it_put->second;
+    if (put.IsTransaction() && put.WasSent()) {
+      if (put.in_flight) --in_flight_;
+      to_send_.erase(it_put->first);
+      transactions.push_back(std::move(it_put->second));
+      it_put = puts_.erase(it_put);
+    } else {
+      ++it_put;
+    }
+  }
+  return transactions;
+}
+
+std::map<uint64_t, OutstandingPutPtr> OutstandingPutQueue::RemoveAll() {
+  std::map<uint64_t, OutstandingPutPtr> puts;
+  puts.swap(puts_);
+  to_send_.clear();
+  compactable_puts_.clear();
+  in_flight_ = 0;
+  return puts;
+}
+
+void OutstandingPutQueue::GetResponses(const OutstandingPut& put,
+                                       std::vector<ResponsePtr>* responses) {
+  for (const auto& compacted : put.compacted_puts) {
+    GetResponses(*compacted.second, responses);
+  }
+  responses->push_back(put.response);
+}
+
+std::string OutstandingPutQueue::CompactionKey(const Path& path) {
+  return path.empty() ? "/" : "/" + path.str() + "/";
+}
+
+void OutstandingPutQueue::CompactOverwrite(OutstandingPut* put) {
+  // The keys of the paths below put's path start with its key, so they sort
+  // before the key with the final separator replaced by the next character.
+  std::string key = CompactionKey(put->path);
+  std::string end_key = key;
+  end_key.back() = static_cast<char>('/' + 1);
+  auto begin = compactable_puts_.lower_bound(key);
+  auto end = compactable_puts_.lower_bound(end_key);
+  for (auto it = begin; it != end; ++it) {
+    auto it_put = puts_.find(it->second);
+    to_send_.erase(it_put->first);
+    put->compacted_puts.insert(std::move(*it_put));
+    puts_.erase(it_put);
+  }
+  compactable_puts_.erase(begin, end);
+}
+
+void OutstandingPutQueue::CompactMerge(OutstandingPut* put) {
+  if (puts_.empty()) return;
+  auto it_queued = std::prev(puts_.end());
+  OutstandingPut& queued = *it_queued->second;
+  if (queued.action != kActionMerge || queued.path != put->path ||
+      !CanCombineMerges(queued.data, put->data)) {
+    return;
+  }
+  auto range = compactable_puts_.equal_range(CompactionKey(queued.path));
+  auto it_compactable = range.first;
+  while (it_compactable != range.second &&
+         it_compactable->second != it_queued->first) {
+    ++it_compactable;
+  }
+  if (it_compactable == range.second) return;
+
+  Variant combined = Variant::EmptyMap();
+  for (const auto& queued_child : queued.data.map()) {
+    Path queued_path(queued_child.first.AsString().string_value());
+    bool replaced = false;
+    for (const auto& child : put->data.map()) {
+      if (Path(child.first.AsString().string_value()).IsParent(queued_path)) {
+        replaced = true;
+        break;
+      }
+    }
+    if (!replaced) combined.map().insert(queued_child);
+  }
+  for (const auto& child : put->data.map()) combined.map().insert(child);
+  put->uncombined_data = std::move(put->data);
+  put->data = std::move(combined);
+
+  compactable_puts_.erase(it_compactable);
+  to_send_.erase(it_queued->first);
+  put->compacted_puts.insert(std::move(*it_queued));
+  puts_.erase(it_queued);
+}
+
+uint64_t OutstandingPutQueue::Queue(OutstandingPutPtr put) {
+  uint64_t write_id = next_write_id_++;
+  puts_[write_id] = std::move(put);
+  to_send_.insert(write_id);
+  return write_id;
+}
+
+}  // namespace connection
+}  // namespace internal
+}  // namespace database
+}  // namespace firebase
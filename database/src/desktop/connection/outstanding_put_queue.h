@@ -0,0 +1,191 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_DATABASE_SRC_DESKTOP_CONNECTION_OUTSTANDING_PUT_QUEUE_H_
+#define FIREBASE_DATABASE_SRC_DESKTOP_CONNECTION_OUTSTANDING_PUT_QUEUE_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "app/src/include/firebase/variant.h"
+#include "app/src/optional.h"
+#include "app/src/path.h"
+
+namespace firebase {
+namespace database {
+namespace internal {
+namespace connection {
+
+class Response;
+typedef std::shared_ptr<Response> ResponsePtr;
+
+// A put or merge request that has not been acknowledged by the server yet.
+struct OutstandingPut {
+  OutstandingPut(const char* action, const Path& path, const Variant& data,
+                 const Optional<std::string>& hash, ResponsePtr response)
+      : action(action),
+        path(path),
+        data(data),
+        hash(hash),
+        response(std::move(response)),
+        sent(false),
+        in_flight(false) {}
+
+  // Action of the request such as PUT, MERGE and CANCEL
+  std::string action;
+
+  // Database path
+  Path path;
+
+  // Data to be used for the action.  Null for CANCEL action
+  Variant data;
+
+  // Hash of the data the write expects at path, for transactions.
+  Optional<std::string> hash;
+
+  // Response pointer to be triggered once the response is received
+  ResponsePtr response;
+
+  // Earlier writes that were compacted into this one, by write id.  If this
+  // write succeeds they succeed with it.  If it fails they are queued again
+  // on their own, since they may not have failed.
+  std::map<uint64_t, std::unique_ptr<OutstandingPut>> compacted_puts;
+
+  // The data of a merge before the merge right before it was combined into
+  // it, to send again on its own if the combined merge fails.
+  Optional<Variant> uncombined_data;
+
+  // Whether the put request is sent or not
+  bool sent;
+
+  // Whether the put request is sent on the current connection and is
+  // waiting for the response
+  bool in_flight;
+
+  bool WasSent() const { return sent; }
+
+  bool IsTransaction() const { return hash.has_value(); }
+};
+typedef std::unique_ptr<OutstandingPut> OutstandingPutPtr;
+
+// The puts and merges that have not been acknowledged by the server, in the
+// order they were written.
+//
+// Writes that have not been sent yet are compacted as new writes are added:
+// an overwrite replaces the writes at or below its path, and a merge absorbs
+// the merge right before it at the same path.  Compaction never goes past a
+// write that was sent, since the server may have applied it, or past a
+// transaction, since its hash depends on the writes before it.
+class OutstandingPutQueue {
+ public:
+  OutstandingPutQueue();
+
+  // Add a write after the ones queued so far, compacting the writes it
+  // replaces into it.  Returns the write id of the write.
+  uint64_t Add(OutstandingPutPtr put);
+
+  // Returns the write with the given id, or nullptr if there is none.
+  OutstandingPut* Find(uint64_t write_id) const;
+
+  // Mark the writes that have not been sent on the current connection as
+  // sent, in order, until max_in_flight writes are in flight (or all of them
+  // if max_in_flight is 0).  Returns the ids of the writes to send.
+  std::vector<uint64_t> StartSending(int max_in_flight);
+
+  // Remove a write the server accepted, along with every write compacted into
+  // it, and return it.
+  OutstandingPutPtr Acknowledge(uint64_t write_id);
+
+  // Handle a write the server rejected.  The writes compacted into it may not
+  // have failed on their own, so they are queued again to be sent on their
+  // own, and a combined merge is queued again as it was written.  Writes
+  // after it that were already sent and that the writes queued again would
+  // overwrite are sent again after them.  Transactions among those can't be
+  // sent again as their hash no longer matches, so they are removed and
+  // added to aborted_transactions, to be run again.
+  //
+  // Returns the write, to report it failed, or nullptr if it was queued
+  // again itself.
+  OutstandingPutPtr Reject(
+      uint64_t write_id, std::vector<OutstandingPutPtr>* aborted_transactions);
+
+  // The connection was lost, so the writes in flight are sent again once it
+  // is restored.
+  void OnDisconnect();
+
+  // Remove the transactions that were sent, as they can't be sent again
+  // after a disconnect, and return them.
+  std::vector<OutstandingPutPtr> RemoveSentTransactions();
+
+  // Remove all the writes and return them.
+  std::map<uint64_t, OutstandingPutPtr> RemoveAll();
+
+  // Number of writes sent on the current connection and waiting for a
+  // response.
+  int in_flight() const { return in_flight_; }
+
+  // Whether there are writes that have not been sent on the current
+  // connection.
+  bool HasWritesToSend() const { return !to_send_.empty(); }
+
+  // Get the responses of a write and of the writes compacted into it, in the
+  // order they were written.
+  static void GetResponses(const OutstandingPut& put,
+                           std::vector<ResponsePtr>* responses);
+
+ private:
+  // Key of a path in compactable_puts_.  The keys of the paths below a path
+  // start with its key.
+  static std::string CompactionKey(const Path& path);
+
+  // Move the compactable writes at or below put's path into put.
+  void CompactOverwrite(OutstandingPut* put);
+
+  // Combine the newest write into put if it is a compactable merge at the
+  // same path.
+  void CompactMerge(OutstandingPut* put);
+
+  // Queue a write that is sent after the current ones.
+  uint64_t Queue(OutstandingPutPtr put);
+
+  // Writes by write id.
+  std::map<uint64_t, OutstandingPutPtr> puts_;
+
+  // Ids of the writes that have not been sent on the current connection.
+  std::set<uint64_t> to_send_;
+
+  // Ids of the writes that can be compacted, by CompactionKey() of their
+  // path.  These are the writes that haven't been sent, after the last write
+  // that was sent or queued again and after the last transaction.
+  std::multimap<std::string, uint64_t> compactable_puts_;
+
+  // Next write id.
+  uint64_t next_write_id_;
+
+  // Number of writes sent on the current connection and waiting for a
+  // response.
+  int in_flight_;
+};
+
+}  // namespace connection
+}  // namespace internal
+}  // namespace database
+}  // namespace firebase
+
+#endif  // FIREBASE_DATABASE_SRC_DESKTOP_CONNECTION_OUTSTANDING_PUT_QUEUE_H_
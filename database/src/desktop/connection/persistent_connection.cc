@@ -116,7 +116,8 @@ PersistentConnection::PersistentConnection(
       next_request_id_(0),
       force_auth_refresh_(false),
       next_listen_id_(0),
-      next_write_id_(0),
+      max_in_flight_writes_(0),
+      send_queued_puts_scheduled_(false),
       logger_(logger) {
   FIREBASE_DEV_ASSERT(app);
   FIREBASE_DEV_ASSERT(scheduler);
@@ -290,8 +291,9 @@ void PersistentConnection::OnDataMessage(const Variant& message) {
       OnDataPush(action->string_value(), *body);
     }
   } else {
-    logger_->LogDebug("%s Ignoring unknown message: %s", log_id_.c_str(),
-                      util::VariantToJson(message).c_str());
+    FIREBASE_LOGGER_DEBUG(logger_, "%s Ignoring unknown message: %s",
+                          log_id_.c_str(),
+                          util::VariantToJson(message).c_str());
   }
 }
 
@@ -306,6 +308,10 @@ void PersistentConnection::OnDisconnect(Connection::DisconnectReason reason) {
 
   request_map_.clear();
 
+  // Responses to puts sent on this connection will never arrive, so they are
+  // sent again once reconnected.
+  outstanding_puts_.OnDisconnect();
+
   // TODO(chkuang): Implement Idle Check
   // this.hasOnDisconnects = false;
   //  if (inactivityTimer != null) {
@@ -359,8 +365,8 @@ void PersistentConnection::ScheduleShutdown() {
 void PersistentConnection::Listen(const QuerySpec& query_spec, const Tag& tag,
                                   ResponsePtr response) {
   CheckAuthTokenAndSendOnChange();
-  logger_->LogDebug("%s Listening on %s", log_id_.c_str(),
-                    GetDebugQuerySpecString(query_spec).c_str());
+  FIREBASE_LOGGER_DEBUG(logger_, "%s Listening on %s", log_id_.c_str(),
+                        GetDebugQuerySpecString(query_spec).c_str());
 
   FIREBASE_DEV_ASSERT_MESSAGE(listens_.find(query_spec) == listens_.end(),
                               "Listen() called twice for same QuerySpec. %s",
@@ -384,8 +390,8 @@ void PersistentConnection::Listen(const QuerySpec& query_spec, const Tag& tag,
 
 void PersistentConnection::Unlisten(const QuerySpec& query_spec) {
   CheckAuthTokenAndSendOnChange();
-  logger_->LogDebug("%s Unlisten on %s", log_id_.c_str(),
-                    GetDebugQuerySpecString(query_spec).c_str());
+  FIREBASE_LOGGER_DEBUG(logger_, "%s Unlisten on %s", log_id_.c_str(),
+                        GetDebugQuerySpecString(query_spec).c_str());
 
   OutstandingListenPtr listen = std::move(RemoveListen(query_spec));
 
@@ -418,10 +424,9 @@ void PersistentConnection::Merge(const Path& path, const Variant& data,
 
 void PersistentConnection::PurgeOutstandingWrites(Error error) {
   // Purge outstanding put requests
-  for (auto& put : outstanding_puts_) {
-    TriggerResponse(put.second->response, error, GetErrorMessage(error));
+  for (auto& put : outstanding_puts_.RemoveAll()) {
+    TriggerPutResponses(*put.second, error, GetErrorMessage(error));
   }
-  outstanding_puts_.clear();
 
   // Purge outstanding OnDisconnect requests
   while (!outstanding_ondisconnects_.empty()) {
@@ -751,23 +756,24 @@ void PersistentConnection::HandleListenResponse(const Variant& message,
                                                 uint64_t listen_id) {
   auto it_spec = listen_id_to_query_.find(listen_id);
   if (it_spec == listen_id_to_query_.end()) {
-    logger_->LogDebug(
-        "%s Listen Id has been removed.  Do nothing. response: %s",
+    FIREBASE_LOGGER_DEBUG(
+        logger_, "%s Listen Id has been removed.  Do nothing. response: %s",
         log_id_.c_str(), util::VariantToJson(message).c_str());
     return;
   }
 
   auto it_listen = listens_.find(it_spec->second);
   if (it_listen == listens_.end()) {
-    logger_->LogDebug(
+    FIREBASE_LOGGER_DEBUG(
+        logger_,
         "%s Listen Request for %s has been removed.  Do nothing. response: %s",
         log_id_.c_str(), GetDebugQuerySpecString(it_spec->second).c_str(),
         util::VariantToJson(message).c_str());
     return;
   }
 
-  logger_->LogDebug("%s Listen response: %s", log_id_.c_str(),
-                    util::VariantToJson(message).c_str());
+  FIREBASE_LOGGER_DEBUG(logger_, "%s Listen response: %s", log_id_.c_str(),
+                        util::VariantToJson(message).c_str());
 
   std::string status_string = GetStringValue(message, kRequestStatus);
   Error error_code = StatusStringToErrorCode(status_string);
@@ -818,12 +824,13 @@ void PersistentConnection::WarnOnListenerWarnings(const Variant& warnings,
 
 PersistentConnection::OutstandingListenPtr PersistentConnection::RemoveListen(
     const QuerySpec& query_spec) {
-  logger_->LogDebug("%s Removing query %s", log_id_.c_str(),
-                    GetDebugQuerySpecString(query_spec).c_str());
+  FIREBASE_LOGGER_DEBUG(logger_, "%s Removing query %s", log_id_.c_str(),
+                        GetDebugQuerySpecString(query_spec).c_str());
 
   auto it_listen = listens_.find(query_spec);
   if (it_listen == listens_.end()) {
-    logger_->LogDebug(
+    FIREBASE_LOGGER_DEBUG(
+        logger_,
         "%s Trying to remove listener for QuerySpec %s but no listener exists.",
         log_id_.c_str(), GetDebugQuerySpecString(query_spec).c_str());
     return OutstandingListenPtr();
@@ -837,8 +844,9 @@ PersistentConnection::OutstandingListenPtr PersistentConnection::RemoveListen(
 
 void PersistentConnection::OnDataPush(const std::string& action,
                                       const Variant& body) {
-  logger_->LogDebug("%s handleServerMessage %s %s", log_id_.c_str(),
-                    action.c_str(), util::VariantToJson(body).c_str());
+  FIREBASE_LOGGER_DEBUG(logger_, "%s handleServerMessage %s %s",
+                        log_id_.c_str(), action.c_str(),
+                        util::VariantToJson(body).c_str());
 
   if (action == kServerAsyncDataUpdate || action == kServerAsyncDataMerge) {
     bool is_merge = action.compare(kServerAsyncDataMerge) == 0;
@@ -885,8 +893,8 @@ void PersistentConnection::OnDataPush(const std::string& action,
                        util::VariantToJson(*msg).c_str());
     }
   } else {
-    logger_->LogDebug("%s Unrecognized action from server: %s", log_id_.c_str(),
-                      util::VariantToJson(action).c_str());
+    FIREBASE_LOGGER_DEBUG(logger_, "%s Unrecognized action from server: %s",
+                          log_id_.c_str(), util::VariantToJson(action).c_str());
   }
 }
 
@@ -922,51 +930,93 @@ void PersistentConnection::PutInternal(const char* action, const Path& path,
     return;
   }
 
-  Variant request = Variant::EmptyMap();
-  request.map()[kRequestPath] = path.str();
-  request.map()[kRequestDataPayload] = data;
-  if (hash != nullptr) {
-    request.map()[kRequestDataHash] = std::string(hash);
-  }
-
-  uint64_t write_id = next_write_id_++;
-  outstanding_puts_[write_id] =
-      std::make_unique<OutstandingPut>(action, request, response);
+  Optional<std::string> put_hash;
+  if (hash != nullptr) put_hash = std::string(hash);
+  // Writes that have not been sent are compacted with the writes queued
+  // before them, which only exist while offline or when the number of writes
+  // in flight is limited.
+  outstanding_puts_.Add(std::make_unique<OutstandingPut>(
+      action, path, data, put_hash, std::move(response)));
 
   if (CanSendWrites()) {
-    SendPut(write_id);
+    if (max_in_flight_writes_ > 0) {
+      ScheduleSendQueuedPuts();
+    } else {
+      SendQueuedPuts();
+    }
   }
 }
 
 void PersistentConnection::SendPut(uint64_t write_id) {
   FIREBASE_DEV_ASSERT(CanSendWrites());
 
-  auto it_put = outstanding_puts_.find(write_id);
-  FIREBASE_DEV_ASSERT(it_put != outstanding_puts_.end());
+  OutstandingPut* put = outstanding_puts_.Find(write_id);
+  FIREBASE_DEV_ASSERT(put != nullptr);
 
-  it_put->second->MarkSent();
-  SendSensitive(it_put->second->action.c_str(), false, it_put->second->data,
-                it_put->second->response,
+  Variant request = Variant::EmptyMap();
+  request.map()[kRequestPath] = put->path.str();
+  request.map()[kRequestDataPayload] = put->data;
+  if (put->hash.has_value()) {
+    request.map()[kRequestDataHash] = put->hash.value();
+  }
+  SendSensitive(put->action.c_str(), false, request, put->response,
                 &PersistentConnection::HandlePutResponse, write_id);
 }
 
+void PersistentConnection::SendQueuedPuts() {
+  FIREBASE_DEV_ASSERT(CanSendWrites());
+
+  for (uint64_t write_id :
+       outstanding_puts_.StartSending(max_in_flight_writes_)) {
+    SendPut(write_id);
+  }
+}
+
+void PersistentConnection::ScheduleSendQueuedPuts() {
+  if (send_queued_puts_scheduled_) return;
+  send_queued_puts_scheduled_ = true;
+  scheduler_->Schedule(
+      new callback::CallbackValue1<ThisRef>(safe_this_, [](ThisRef ref) {
+        ThisRefLock lock(&ref);
+        auto* connection = lock.GetReference();
+        if (connection != nullptr) {
+          connection->send_queued_puts_scheduled_ = false;
+          if (connection->CanSendWrites()) connection->SendQueuedPuts();
+        }
+      }));
+}
+
 void PersistentConnection::HandlePutResponse(const Variant& message,
                                              const ResponsePtr& response,
                                              uint64_t outstanding_id) {
-  auto it_put = outstanding_puts_.find(outstanding_id);
-  if (it_put != outstanding_puts_.end()) {
-    auto& put_ptr = it_put->second;
-    logger_->LogDebug("%s %s response: %s", log_id_.c_str(),
-                      put_ptr->action.c_str(),
-                      util::VariantToJson(message).c_str());
+  OutstandingPut* put = outstanding_puts_.Find(outstanding_id);
+  if (put != nullptr) {
+    FIREBASE_LOGGER_DEBUG(logger_, "%s %s response: %s", log_id_.c_str(),
+                          put->action.c_str(),
+                          util::VariantToJson(message).c_str());
     std::string status_string = GetStringValue(message, kRequestStatus);
     Error error_code = StatusStringToErrorCode(status_string);
     bool is_ok = error_code == kErrorNone;
 
-    TriggerResponse(
-        response, error_code,
-        is_ok ? "" : GetStringValue(message, kServerDataUpdateBody, true));
-    outstanding_puts_.erase(it_put);
+    // Writes compacted into a write that failed are sent again on their own
+    // rather than failed with it.
+    std::vector<OutstandingPutPtr> aborted_transactions;
+    OutstandingPutPtr done =
+        is_ok ? outstanding_puts_.Acknowledge(outstanding_id)
+              : outstanding_puts_.Reject(outstanding_id, &aborted_transactions);
+    if (done) {
+      TriggerPutResponses(
+          *done, error_code,
+          is_ok ? "" : GetStringValue(message, kServerDataUpdateBody, true));
+    }
+    // Transactions that expected the data of the writes sent again are run
+    // again after them.
+    for (auto& transaction : aborted_transactions) {
+      TriggerPutResponses(*transaction, kErrorDataStale, "");
+    }
+    if (outstanding_puts_.HasWritesToSend() && CanSendWrites()) {
+      SendQueuedPuts();
+    }
   } else {
     logger_->LogDebug(
         "%s Ignore on complete for put (%llu) because it was removed already.",
@@ -975,21 +1025,9 @@ void PersistentConnection::HandlePutResponse(const Variant& message,
 }
 
 void PersistentConnection::CancelSentTransactions() {
-  std::vector<OutstandingPutPtr> cancelled_transaction_writes;
-  for (auto it_put = outstanding_puts_.begin();
-       it_put != outstanding_puts_.end();) {
-    if (it_put->second->data.map().find(kRequestDataHash) !=
-            it_put->second->data.map().end() &&
-        it_put->second->WasSent()) {
-      cancelled_transaction_writes.push_back(std::move(it_put->second));
-      outstanding_puts_.erase(it_put);
-    } else {
-      ++it_put;
-    }
-  }
-  for (auto& put : cancelled_transaction_writes) {
-    TriggerResponse(put->response, kErrorDisconnected,
-                    GetErrorMessage(kErrorDisconnected));
+  for (auto& put : outstanding_puts_.RemoveSentTransactions()) {
+    TriggerPutResponses(*put, kErrorDisconnected,
+                        GetErrorMessage(kErrorDisconnected));
   }
 }
 
@@ -1045,16 +1083,14 @@ void PersistentConnection::RestoreOutstandingRequests() {
   // Restore listens
   logger_->LogDebug("%s Restoring outstanding listens", log_id_.c_str());
   for (auto& it_listen : listens_) {
-    logger_->LogDebug(
-        "%s Restoring listen %s", log_id_.c_str(),
+    FIREBASE_LOGGER_DEBUG(
+        logger_, "%s Restoring listen %s", log_id_.c_str(),
         GetDebugQuerySpecString(it_listen.second->query_spec).c_str());
     SendListen(*it_listen.second);
   }
 
   // Restore puts
-  for (auto& it_put : outstanding_puts_) {
-    SendPut(it_put.first);
-  }
+  SendQueuedPuts();
 
   // Restore disconnect operations
   while (!outstanding_ondisconnects_.empty()) {
@@ -1251,6 +1287,16 @@ void PersistentConnection::TriggerResponse(const ResponsePtr& response_ptr,
   }
 }
 
+void PersistentConnection::TriggerPutResponses(
+    const OutstandingPut& put, Error error_code,
+    const std::string& error_message) {
+  std::vector<ResponsePtr> responses;
+  OutstandingPutQueue::GetResponses(put, &responses);
+  for (const auto& response : responses) {
+    TriggerResponse(response, error_code, error_message);
+  }
+}
+
 static const struct ErrorMap {
   const char* error_string;
   Error error_code;
@@ -35,6 +35,7 @@
 #include "database/src/common/query_spec.h"
 #include "database/src/desktop/connection/connection.h"
 #include "database/src/desktop/connection/host_info.h"
+#include "database/src/desktop/connection/outstanding_put_queue.h"
 #include "database/src/desktop/core/tag.h"
 #include "database/src/include/firebase/database/common.h"
 
@@ -188,6 +189,14 @@ class PersistentConnection : public ConnectionEventHandler {
 
   void RefreshAppCheckToken(const std::string& token);
 
+  // Limit the number of writes sent to the server that have not been
+  // acknowledged yet, or 0 for no limit.  When limited, writes are queued and
+  // sent in batches from the scheduler, and writes that wait in the queue are
+  // compacted.  Should be called before ScheduleInitialize().
+  void set_max_in_flight_writes(int max_in_flight_writes) {
+    max_in_flight_writes_ = max_in_flight_writes;
+  }
+
  private:
   // Enum of all the reason to interrupt the connection.
   // There can be multiple reason to interrupt.  Only when all reason is
@@ -286,34 +295,6 @@ class PersistentConnection : public ConnectionEventHandler {
   };
   typedef std::unique_ptr<OutstandingOnDisconnect> OutstandingOnDisconnectPtr;
 
-  // Capture the outstanding Put requests when the connection is not
-  // established yet.
-  struct OutstandingPut {
-    explicit OutstandingPut(const char* action, const Variant& data,
-                            ResponsePtr response)
-        : action(action),
-          data(data),
-          response(std::move(response)),
-          sent(false) {}
-
-    // Action of the request such as PUT, MERGE and CANCEL
-    std::string action;
-
-    // Data to be used for the action.  Null for CANCEL action
-    Variant data;
-
-    // Response pointer to be triggered once the response is received
-    ResponsePtr response;
-
-    // Whether the put request is sent or not
-    bool sent;
-
-    void MarkSent() { sent = true; }
-
-    bool WasSent() { return sent; }
-  };
-  typedef std::unique_ptr<OutstandingPut> OutstandingPutPtr;
-
   void InterruptInternal(InterruptReason reason);
   void ResumeInternal(InterruptReason reason);
   bool IsInterruptedInternal(InterruptReason reason) {
@@ -390,6 +371,13 @@ class PersistentConnection : public ConnectionEventHandler {
 
   void SendPut(uint64_t write_id);
 
+  // Send queued puts in order, as long as the in-flight window allows.
+  void SendQueuedPuts();
+
+  // Schedule SendQueuedPuts(), so that the writes made until it runs are
+  // compacted and sent together.
+  void ScheduleSendQueuedPuts();
+
   void HandlePutResponse(const Variant& message, const ResponsePtr& response,
                          uint64_t outstanding_id);
 
@@ -442,6 +430,10 @@ class PersistentConnection : public ConnectionEventHandler {
   static void TriggerResponse(const ResponsePtr& response_ptr, Error error_code,
                               const std::string& error_message);
 
+  // Trigger the response of a put and of every write compacted into it.
+  static void TriggerPutResponses(const OutstandingPut& put, Error error_code,
+                                  const std::string& error_message);
+
   static Error StatusStringToErrorCode(const std::string& status);
 
   // Wire protocol data message keys and values
@@ -567,10 +559,13 @@ class PersistentConnection : public ConnectionEventHandler {
   std::queue<OutstandingOnDisconnectPtr> outstanding_ondisconnects_;
 
   // Outstanding puts
-  std::map<uint64_t, OutstandingPutPtr> outstanding_puts_;
+  OutstandingPutQueue outstanding_puts_;
+
+  // Maximum number of puts in flight, or 0 for no limit.
+  int max_in_flight_writes_;
 
-  // Next write id for put requests
-  uint64_t next_write_id_;
+  // Whether SendQueuedPuts() is scheduled to run.
+  bool send_queued_puts_scheduled_;
 
   Logger* logger_;
 };
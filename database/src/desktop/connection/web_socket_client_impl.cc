@@ -16,6 +16,9 @@
 
 #include <cassert>
 #include <map>
+#include <memory>
+#include <queue>
+#include <utility>
 
 #include "app/src/app_common.h"
 #include "app/src/assert.h"
@@ -29,30 +32,94 @@ namespace database {
 namespace internal {
 namespace connection {
 
-WebSocketClientImpl::WebSocketClientImpl(
-    const std::string& uri, const std::string& user_agent, Logger* logger,
-    scheduler::Scheduler* scheduler, const std::string& app_check_token,
-    WebSocketClientEventHandler* handler /*=nullptr*/)
-    : uri_(uri),
-      handler_(handler),
-      thread_(nullptr),
-      hub_(),
+// How long a client being destroyed waits for the event loop to close its
+// connection before giving up on the loop.
+static const int kDetachTimeoutMs = 10000;
+
+// The uWebSockets hub and the thread running its event loop, shared by all
+// WebSocketClientImpl instances.
+class WebSocketClientImpl::EventLoop {
+ public:
+  EventLoop();
+  ~EventLoop();
+
+  // Returns the event loop, starting it if no client is using it or the
+  // current one was abandoned.
+  static std::shared_ptr<EventLoop> Acquire();
+
+  uWS::Hub& hub() { return hub_; }
+
+  // Queue a callback to run in the event loop thread.  Thread-safe.
+  void Post(CallbackData data);
+
+  // Give up on an event loop that stopped responding.  The loop is leaked
+  // rather than joined, and no longer delivers any event or callback, so that
+  // clients attached to it can be destroyed.  Thread-safe.
+  void Abandon();
+
+  bool abandoned() const { return abandoned_.load(); }
+
+ private:
+  // The thread routine to host the event loop of hub_
+  static void EventLoopRoutine(void* data);
+
+  // Process callback queue in event loop thread
+  static void ProcessCallbackQueue(uS::Async* async);
+
+  // The access point for uWebSockets which contains event loops and
+  // different sockets.
+  uWS::Hub hub_;
+
+  // The handler to keep the event loop of hub_ alive even there is no
+  // connection at all.  Otherwise the loop would stop when there is nothing to
+  // handle anymore.  Also used to asynchronously close all async handles in
+  // destructor.
+  uS::Async* keep_loop_alive_;
+
+  // Async handler to process callback queue in event look thread.
+  uS::Async* process_queue_async_;
+
+  // A queue of callback to be triggered in event loop thread.
+  std::queue<CallbackData> callback_queue_;
+
+  // Mutex to guard callback_queue_
+  Mutex callback_queue_mutex_;
+
+  // The thread to host the event loop of hub_
+  std::unique_ptr<Thread> thread_;
+
+  // Set by Abandon().
+  std::atomic<bool> abandoned_;
+};
+
+WebSocketClientImpl::EventLoop::EventLoop()
+    : hub_(),
       keep_loop_alive_(nullptr),
       process_queue_async_(nullptr),
       callback_queue_(),
       callback_queue_mutex_(Mutex::kModeNonRecursive),
-      is_destructing_(0),
-      websocket_(nullptr),
-      user_agent_(user_agent),
-      logger_(logger),
-      scheduler_(scheduler),
-      safe_this_(this),
-      app_check_token_(app_check_token) {
-  // Bind callback function
-  hub_.onError(WebSocketClientImpl::OnError);
-  hub_.onConnection(WebSocketClientImpl::OnConnection);
-  hub_.onMessage(WebSocketClientImpl::OnMessage);
-  hub_.onDisconnection(WebSocketClientImpl::OnDisconnection);
+      thread_(nullptr),
+      abandoned_(false) {
+  // Bind callback function.  Each connection carries the client it belongs to
+  // as user data, which may have been destroyed once the loop is abandoned.
+  hub_.onError([this](void* data) {
+    if (!abandoned()) WebSocketClientImpl::OnError(data);
+  });
+  hub_.onConnection([this](ClientWebSocket* ws, uWS::HttpRequest req) {
+    if (!abandoned()) WebSocketClientImpl::OnConnection(ws, req);
+  });
+  hub_.onMessage([this](ClientWebSocket* ws, char* message, size_t length,
+                        uWS::OpCode op_code) {
+    if (!abandoned()) {
+      WebSocketClientImpl::OnMessage(ws, message, length, op_code);
+    }
+  });
+  hub_.onDisconnection([this](ClientWebSocket* ws, int code, char* message,
+                              size_t length) {
+    if (!abandoned()) {
+      WebSocketClientImpl::OnDisconnection(ws, code, message, length);
+    }
+  });
 
   // Create a async object to keep the loop alive and close all async handler
   // during destruction.
@@ -62,18 +129,14 @@ WebSocketClientImpl::WebSocketClientImpl(
     assert(async);
     assert(async->getData());
 
-    WebSocketClientImpl* client =
-        static_cast<WebSocketClientImpl*>(async->getData());
-
-    // Close all async process
-    if (client) {
-      client->CloseSync();
+    EventLoop* loop = static_cast<EventLoop*>(async->getData());
 
-      client->keep_loop_alive_->close();
-      client->keep_loop_alive_ = nullptr;
-      client->process_queue_async_->close();
-      client->process_queue_async_ = nullptr;
-    }
+    // Close all async process.  Every client has already detached, so the
+    // loop ends once these are closed.
+    loop->keep_loop_alive_->close();
+    loop->keep_loop_alive_ = nullptr;
+    loop->process_queue_async_->close();
+    loop->process_queue_async_ = nullptr;
   });
 
   // Initiate async handler to process callback queue.  The callback will only
@@ -86,16 +149,99 @@ WebSocketClientImpl::WebSocketClientImpl(
   thread_ = std::make_unique<Thread>(EventLoopRoutine, this);
 }
 
-void WebSocketClientImpl::EventLoopRoutine(void* data) {
+WebSocketClientImpl::EventLoop::~EventLoop() {
+  // Remove the handler to keep event loop alive
+  if (keep_loop_alive_ != nullptr) {
+    keep_loop_alive_->send();
+  }
+
+  // Wait for the thread to end.
+  if (thread_) {
+    thread_->Join();
+    thread_.reset(nullptr);
+  }
+}
+
+std::shared_ptr<WebSocketClientImpl::EventLoop>
+WebSocketClientImpl::EventLoop::Acquire() {
+  // Intentionally leaked to avoid destruction order issues at exit.
+  static Mutex* mutex = new Mutex(Mutex::kModeNonRecursive);
+  static std::weak_ptr<EventLoop>* current = new std::weak_ptr<EventLoop>();
+
+  MutexLock lock(*mutex);
+  std::shared_ptr<EventLoop> loop = current->lock();
+  if (!loop || loop->abandoned()) {
+    // An abandoned loop is leaked instead of being joined.
+    loop = std::shared_ptr<EventLoop>(new EventLoop(), [](EventLoop* loop) {
+      if (!loop->abandoned()) delete loop;
+    });
+    *current = loop;
+  }
+  return loop;
+}
+
+void WebSocketClientImpl::EventLoop::Abandon() {
+  if (!abandoned_.exchange(true)) {
+    LogWarning("The WebSocket event loop is not responding; abandoning it.");
+  }
+}
+
+void WebSocketClientImpl::EventLoop::Post(CallbackData data) {
+  MutexLock lock(callback_queue_mutex_);
+  callback_queue_.push(std::move(data));
+
+  // Signal the event loop to trigger the async callback.
+  process_queue_async_->send();
+}
+
+void WebSocketClientImpl::EventLoop::EventLoopRoutine(void* data) {
   assert(data != nullptr);
-  WebSocketClientImpl* client = static_cast<WebSocketClientImpl*>(data);
-  Logger* logger = client->logger_;
+  EventLoop* loop = static_cast<EventLoop*>(data);
 
-  logger->LogDebug("=== uWebSockets Event Loop Start ===");
-  client->hub_.run();
-  logger->LogDebug("=== uWebSockets Event Loop End ===");
+  LogDebug("=== uWebSockets Event Loop Start ===");
+  loop->hub_.run();
+  LogDebug("=== uWebSockets Event Loop End ===");
 }
 
+void WebSocketClientImpl::EventLoop::ProcessCallbackQueue(uS::Async* async) {
+  assert(async);
+  assert(async->getData());
+
+  EventLoop* loop = static_cast<EventLoop*>(async->getData());
+
+  // Run the callbacks without holding the lock, so that other threads can
+  // keep queueing work while they run.
+  std::queue<CallbackData> callbacks;
+  {
+    MutexLock lock(loop->callback_queue_mutex_);
+    callbacks.swap(loop->callback_queue_);
+  }
+  while (!callbacks.empty() && !loop->abandoned()) {
+    auto& callback_data = callbacks.front();
+    callback_data.callback(callback_data.client, callback_data.int_value,
+                           callback_data.string_value);
+    callbacks.pop();
+  }
+}
+
+WebSocketClientImpl::WebSocketClientImpl(
+    const std::string& uri, const std::string& user_agent, Logger* logger,
+    scheduler::Scheduler* scheduler, const std::string& app_check_token,
+    WebSocketClientEventHandler* handler /*=nullptr*/)
+    : uri_(uri),
+      handler_(handler),
+      loop_(EventLoop::Acquire()),
+      is_destructing_(0),
+      websocket_(nullptr),
+      connecting_(false),
+      detached_(0),
+      detached_posted_(false),
+      user_agent_(user_agent),
+      logger_(logger),
+      scheduler_(scheduler),
+      safe_this_(this),
+      app_check_token_(app_check_token) {}
+
 WebSocketClientImpl::~WebSocketClientImpl() {
   // Clear safe reference immediately so that scheduled callback can skip
   // executing code which requires reference to this.
@@ -103,22 +249,31 @@ WebSocketClientImpl::~WebSocketClientImpl() {
 
   is_destructing_.store(1);
 
-  // Remove the handler to keep event loop alive
-  if (keep_loop_alive_ != nullptr) {
-    keep_loop_alive_->send();
+  // Close the connection, then wait until the event loop no longer has any
+  // event to deliver to this client.  If the loop doesn't get there in time,
+  // it is abandoned so that it can never use this client again.
+  if (!loop_->abandoned()) {
+    ScheduleOnce(
+        [](WebSocketClientImpl* client, int, const std::string&) {
+          client->CloseSync();
+          client->DetachIfIdle();
+        },
+        0, "");
+    if (!detached_.TimedWait(kDetachTimeoutMs)) {
+      loop_->Abandon();
+    }
   }
+  const bool abandoned = loop_->abandoned();
 
-  // Wait for the thread to end.
-  if (thread_) {
-    thread_->Join();
-    thread_.reset(nullptr);
-  }
+  // Stops the event loop if this was the last client using it.
+  loop_.reset();
 
   handler_ = nullptr;
 
   // websocket_ should be cleared now or OnDisconnection() probably is not
   // called properly.
-  assert(websocket_ == nullptr);
+  assert(websocket_ == nullptr || abandoned);
+  (void)abandoned;
 }
 
 void WebSocketClientImpl::Connect(int timeout_ms) {
@@ -132,7 +287,9 @@ void WebSocketClientImpl::Connect(int timeout_ms) {
           if (!client->app_check_token_.empty()) {
             headers["X-Firebase-AppCheck"] = client->app_check_token_;
           }
-          client->hub_.connect(client->uri_, client, headers, timeout_ms);
+          client->connecting_ = true;
+          client->loop_->hub().connect(client->uri_, client, headers,
+                                       timeout_ms);
         } else {
           logger->LogWarning("websocket has already been connected to %s",
                              client->uri_.c_str());
@@ -153,20 +310,20 @@ void WebSocketClientImpl::CloseSync() {
   }
 }
 
-void WebSocketClientImpl::Send(const char* msg) {
+void WebSocketClientImpl::Send(const char* msg, size_t length) {
   assert(msg != nullptr);
 
   ScheduleOnce(
       [](WebSocketClientImpl* client, int, const std::string& msg) {
         Logger* logger = client->logger_;
         if (client->IsWebSocketAvailable()) {
-          client->websocket_->send(msg.c_str());
+          client->websocket_->send(msg.data(), msg.size(), uWS::OpCode::TEXT);
         } else {
           logger->LogWarning(
               "Cannot send message.  websocket is not available");
         }
       },
-      0, msg);
+      0, std::string(msg, length));
 }
 
 void WebSocketClientImpl::RefreshAppCheckToken(const std::string& token) {
@@ -177,6 +334,7 @@ void WebSocketClientImpl::OnError(void* data) {
   assert(data != nullptr);
   WebSocketClientImpl* client = static_cast<WebSocketClientImpl*>(data);
   Logger* logger = client->logger_;
+  client->connecting_ = false;
 
   if (client->handler_) {
     // TODO(b/71873743): Modify uWebSockets to provide more context, ex. reasons
@@ -186,6 +344,8 @@ void WebSocketClientImpl::OnError(void* data) {
 
   logger->LogDebug("Error occurred while establishing connection to %s",
                    client->uri_.c_str());
+
+  client->DetachIfIdle();
 }
 
 void WebSocketClientImpl::OnConnection(ClientWebSocket* ws,
@@ -195,12 +355,13 @@ void WebSocketClientImpl::OnConnection(ClientWebSocket* ws,
   WebSocketClientImpl* client =
       static_cast<WebSocketClientImpl*>(ws->getUserData());
 
-  // There should be only one connection per client.  However, hub_ can have
+  // There should be only one connection per client.  However, the hub can have
   // multiple connnections at a time, and current implementation does not
   // prevent Connect() from  being called when another connection is
   // establishing. Use assert for now to prevent this from happening.
   assert(client->websocket_ == nullptr);
   client->websocket_ = ws;
+  client->connecting_ = false;
 
   if (client->handler_) {
     client->scheduler_->Schedule(new callback::CallbackValue1<ClientRef>(
@@ -230,15 +391,14 @@ void WebSocketClientImpl::OnMessage(ClientWebSocket* ws, char* message,
       static_cast<WebSocketClientImpl*>(ws->getUserData());
 
   if (client->handler_) {
-    std::string message_string(message, length);
     client->scheduler_->Schedule(
         new callback::CallbackValue2<ClientRef, std::string>(
-            client->safe_this_, message_string,
+            client->safe_this_, std::string(message, length),
             [](ClientRef client_ref, std::string msg) {
               ClientRefLock lock(&client_ref);
               auto client = lock.GetReference();
               if (client != nullptr && client->handler_ != nullptr) {
-                client->handler_->OnMessage(msg.c_str());
+                client->handler_->OnMessage(msg.c_str(), msg.size());
               }
             }));
   }
@@ -264,35 +424,24 @@ void WebSocketClientImpl::OnDisconnection(ClientWebSocket* ws, int code,
           }
         }));
   }
-}
 
-void WebSocketClientImpl::ScheduleOnce(Callback cb, int int_value,
-                                       const std::string& string_value) {
-  assert(cb != nullptr);
-
-  MutexLock lock(callback_queue_mutex_);
-  callback_queue_.push(CallbackData(cb, this, int_value, string_value));
-
-  // Signal the event loop to trigger the async callback.
-  process_queue_async_->send();
+  client->DetachIfIdle();
 }
 
-void WebSocketClientImpl::ProcessCallbackQueue(uS::Async* async) {
-  assert(async);
-  assert(async->getData());
-
-  WebSocketClientImpl* client =
-      static_cast<WebSocketClientImpl*>(async->getData());
-
-  MutexLock lock(client->callback_queue_mutex_);
-  while (!client->callback_queue_.empty()) {
-    auto& callback_data = client->callback_queue_.front();
-    callback_data.callback(callback_data.client, callback_data.int_value,
-                           callback_data.string_value);
-    client->callback_queue_.pop();
+void WebSocketClientImpl::DetachIfIdle() {
+  if (is_destructing_.load() > 0 && websocket_ == nullptr && !connecting_ &&
+      !detached_posted_) {
+    detached_posted_ = true;
+    detached_.Post();
   }
 }
 
+void WebSocketClientImpl::ScheduleOnce(Callback cb, int int_value,
+                                       std::string string_value) {
+  assert(cb != nullptr);
+  loop_->Post(CallbackData(cb, this, int_value, std::move(string_value)));
+}
+
 bool WebSocketClientImpl::IsWebSocketAvailable() const {
   return websocket_ != nullptr && !websocket_->isClosed() &&
          !websocket_->isShuttingDown();
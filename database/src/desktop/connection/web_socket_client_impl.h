@@ -17,14 +17,14 @@
 
 #include <atomic>
 #include <memory>
-#include <queue>
 #include <string>
+#include <utility>
 
 #include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/logger.h"
 #include "app/src/safe_reference.h"
 #include "app/src/scheduler.h"
-#include "app/src/thread.h"
+#include "app/src/semaphore.h"
 #include "database/src/desktop/connection/web_socket_client_interface.h"
 #include "uWebSockets/src/uWS.h"
 
@@ -33,6 +33,15 @@ namespace database {
 namespace internal {
 namespace connection {
 
+// WebSocket client for the Realtime Database.
+//
+// All clients in the process share a single uWebSockets event loop, which is
+// started when the first client is created and stopped when the last one is
+// destroyed. Each client attaches its connection to the loop and detaches it
+// on destruction. If the loop doesn't let a client detach within a few
+// seconds, the loop is abandoned: it is leaked instead of being stopped, stops
+// delivering events to the clients still attached to it, and the next client
+// starts a new one.
 class WebSocketClientImpl : public WebSocketClientInterface {
  public:
   WebSocketClientImpl(const std::string& uri, const std::string& user_agent,
@@ -48,7 +57,8 @@ class WebSocketClientImpl : public WebSocketClientInterface {
   // BEGIN WebSocketClientInterface
   void Connect(int timeout_ms) override;
   void Close() override;
-  void Send(const char* msg) override;
+  using WebSocketClientInterface::Send;
+  void Send(const char* msg, size_t length) override;
   // END WebSocketClientInterface
 
   // Refresh the stored App Check token being used by the connection.
@@ -62,35 +72,37 @@ class WebSocketClientImpl : public WebSocketClientInterface {
   typedef void (*Callback)(WebSocketClientImpl* client, int int_value,
                            const std::string& string_value);
 
-  // Callback for hub_ when connection error occurs
+  // The event loop shared by all clients.  Defined in the .cc file.
+  class EventLoop;
+
+  // Callback for the hub when connection error occurs
   static void OnError(void* data);
 
-  // Callback for hub_ when connection is established
+  // Callback for the hub when connection is established
   static void OnConnection(ClientWebSocket* ws, uWS::HttpRequest req);
 
-  // Callback for hub_ when a message is received from the server
+  // Callback for the hub when a message is received from the server
   static void OnMessage(ClientWebSocket* ws, char* message, size_t length,
                         uWS::OpCode opCode);
 
-  // Callback for hub_ when the connection is closed
+  // Callback for the hub when the connection is closed
   static void OnDisconnection(ClientWebSocket* ws, int code, char* message,
                               size_t length);
 
-  // The thread routine to host the event loop of hub_
-  static void EventLoopRoutine(void* data);
-
   // Synchronously request to close the websocket.  Should only be called in
   // evnet loop thread.
   void CloseSync();
 
+  // Once this client is being destroyed and has neither a connection nor a
+  // pending connection attempt, signal the destructor that it is detached from
+  // the event loop.  Should only be called in event loop thread, and `this`
+  // must not be used after calling it.
+  void DetachIfIdle();
+
   // Schedule an async callback to be trigger in the next iteration of the event
   // loop.  This call is thread-safe and is to prevent multiple threads fighting
   // for the same resource, such as websocket_
-  void ScheduleOnce(Callback cb, int int_value,
-                    const std::string& string_value);
-
-  // Process callback queue in event loop thread
-  static void ProcessCallbackQueue(uS::Async* async);
+  void ScheduleOnce(Callback cb, int int_value, std::string string_value);
 
   // Check if the websocket is available and not closed.
   // Only call this in event loop.
@@ -103,29 +115,19 @@ class WebSocketClientImpl : public WebSocketClientInterface {
   // The event handler for connection events.
   WebSocketClientEventHandler* handler_;
 
-  // The thread to host the event loop of hub_
-  std::unique_ptr<Thread> thread_;
-
-  // The access point for uWebSockets which contains event loops and
-  // different sockets.
-  uWS::Hub hub_;
-
-  // The handler to keep the event loop of hub_ alive even there is no
-  // connection at all.  Otherwise the loop would stop when there is nothing to
-  // handle anymore.  Also used to asynchronously close all async handles and
-  // WebSocket connection in destructor.
-  uS::Async* keep_loop_alive_;
-
-  // Async handler to process callback queue in event look thread.
-  uS::Async* process_queue_async_;
+  // The event loop this client's connection is attached to.
+  std::shared_ptr<EventLoop> loop_;
 
   // A blob of callback data which is added to callback queue and triggered in
   // the event loop thread.  The callback member is called with a reference to
   // the client, int_value and string_value stored in this data structure.
   struct CallbackData {
     explicit CallbackData(Callback c, WebSocketClientImpl* ws_client, int i,
-                          const std::string& str)
-        : callback(c), client(ws_client), int_value(i), string_value(str) {}
+                          std::string str)
+        : callback(c),
+          client(ws_client),
+          int_value(i),
+          string_value(std::move(str)) {}
 
     Callback callback;
 
@@ -138,12 +140,6 @@ class WebSocketClientImpl : public WebSocketClientInterface {
     std::string string_value;
   };
 
-  // A queue of callback to be triggered in event loop thread.
-  std::queue<CallbackData> callback_queue_;
-
-  // Mutex to guard callback_queue_
-  Mutex callback_queue_mutex_;
-
   // Flagged when this object starts to be destructed.  This helps the other
   // thread to handle situation accordingly, ex. if the connection is
   // established after this object starts to be deleted.  Note that this flag is
@@ -156,6 +152,15 @@ class WebSocketClientImpl : public WebSocketClientInterface {
   // connection.  Should only be used in the event loop.  Not thread safe
   ClientWebSocket* websocket_;
 
+  // Whether a connection attempt is in progress.  Should only be used in the
+  // event loop.
+  bool connecting_;
+
+  // Posted by DetachIfIdle() once the destructor no longer has to wait for
+  // events from the event loop.
+  Semaphore detached_;
+  bool detached_posted_;
+
   // User agent used when opening the connection.
   std::string user_agent_;
 
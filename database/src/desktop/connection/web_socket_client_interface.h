@@ -15,6 +15,8 @@
 #ifndef FIREBASE_DATABASE_SRC_DESKTOP_CONNECTION_WEB_SOCKET_CLIENT_INTERFACE_H_
 #define FIREBASE_DATABASE_SRC_DESKTOP_CONNECTION_WEB_SOCKET_CLIENT_INTERFACE_H_
 
+#include <cstddef>
+#include <cstring>
 #include <string>
 
 namespace firebase {
@@ -35,8 +37,12 @@ class WebSocketClientInterface {
   // Request to close established connection
   virtual void Close() = 0;
 
-  // Request to send message to the connected server
-  virtual void Send(const char* msg) = 0;
+  // Request to send length bytes of msg to the connected server.  msg does not
+  // need to be null-terminated and may contain null characters.
+  virtual void Send(const char* msg, size_t length) = 0;
+
+  // Request to send a null-terminated message to the connected server
+  void Send(const char* msg) { Send(msg, strlen(msg)); }
 };
 
 // Context when OnError occurs.  Currently only contains the uri.
@@ -59,8 +65,9 @@ class WebSocketClientEventHandler {
   // Called when the connection is established
   virtual void OnOpen() = 0;
 
-  // Called when a message from the server is received
-  virtual void OnMessage(const char* msg) = 0;
+  // Called when a message from the server is received.  msg holds length bytes
+  // and is followed by a null terminator.
+  virtual void OnMessage(const char* msg, size_t length) = 0;
 
   // Called when the connection is closed
   virtual void OnClose() = 0;
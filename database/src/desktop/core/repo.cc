@@ -14,6 +14,8 @@
 
 #include "database/src/desktop/core/repo.h"
 
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <utility>
 
@@ -111,6 +113,7 @@ Repo::Repo(App* app, DatabaseInternal* database, const char* url,
 
   connection_.reset(new connection::PersistentConnection(
       app, host_info_, this, s_scheduler_, logger_));
+  connection_->set_max_in_flight_writes(database_->max_in_flight_writes());
   // Kick off any expensive additional initialization
   s_scheduler_->Schedule(NewCallback(
       [](ThisRef ref) {
@@ -440,11 +443,14 @@ void Repo::AckWriteAndRerunTransactions(WriteId write_id, const Path& path,
 }
 
 static std::unique_ptr<PersistenceManagerInterface> CreatePersistenceManager(
-    const char* app_data_path, LoggerBase* logger) {
+    const char* app_data_path, bool query_indexing_enabled,
+    LoggerBase* logger) {
   static const uint64_t kDefaultCacheSize = 10 * 1024 * 1024;
 
   auto persistence_storage_engine =
       std::make_unique<LevelDbPersistenceStorageEngine>(logger);
+  persistence_storage_engine->set_query_indexing_enabled(
+      query_indexing_enabled);
 
   if (!persistence_storage_engine->Initialize(app_data_path)) {
     logger->LogError("Could not initialize persistence");
@@ -460,6 +466,44 @@ static std::unique_ptr<PersistenceManagerInterface> CreatePersistenceManager(
       std::move(cache_policy), logger);
 }
 
+// Read a snapshot to import into the persistent cache from a JSON file, or from
+// a FlexBuffer file if the name doesn't end in ".json".
+static bool ReadPersistenceCacheImport(const std::string& file_path,
+                                       Variant* data, LoggerBase* logger) {
+  std::ifstream file(file_path, std::ios::in | std::ios::binary);
+  if (!file) {
+    logger->LogError("Could not open %s to import into the cache.",
+                     file_path.c_str());
+    return false;
+  }
+  std::string contents((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+
+  static const char kJsonExtension[] = ".json";
+  const size_t extension_size = sizeof(kJsonExtension) - 1;
+  if (file_path.size() >= extension_size &&
+      file_path.compare(file_path.size() - extension_size, extension_size,
+                        kJsonExtension) == 0) {
+    *data = util::JsonToVariant(contents.c_str());
+  } else if (!contents.empty()) {
+    const uint8_t* buffer = reinterpret_cast<const uint8_t*>(contents.data());
+    if (!flexbuffers::VerifyBuffer(buffer, contents.size())) {
+      logger->LogError("%s is not a valid FlexBuffer to import into the cache.",
+                       file_path.c_str());
+      return false;
+    }
+    *data = util::FlexbufferToVariant(
+        flexbuffers::GetRoot(buffer, contents.size()));
+  }
+  if (data->is_null()) {
+    logger->LogError("Could not read data to import into the cache from %s.",
+                     file_path.c_str());
+    return false;
+  }
+  ConvertVectorToMap(data);
+  return true;
+}
+
 // Defers any initialization that is potentially expensive (e.g. disk access).
 void Repo::DeferredInitialization() {
   // Add App Check state listener
@@ -514,8 +558,28 @@ void Repo::DeferredInitialization() {
     // Set up persistence manager
     std::unique_ptr<PersistenceManagerInterface> persistence_manager;
     if (persistence_enabled_) {
-      persistence_manager =
-          CreatePersistenceManager(app_data_path.c_str(), logger_);
+      persistence_manager = CreatePersistenceManager(
+          app_data_path.c_str(),
+          database_->persistence_query_indexing_enabled(), logger_);
+      // Import snapshots before any listener is added, so no events need to
+      // be raised.
+      for (const auto& import : database_->persistence_cache_imports()) {
+        if (!persistence_manager) break;
+        PersistenceManagerInterface* manager = persistence_manager.get();
+        // Don't read the file at all if the data is already cached.
+        if (manager->IsServerCacheComplete(import.first)) {
+          logger_->LogDebug("Skipping import of %s, which is already cached.",
+                            import.first.c_str());
+          continue;
+        }
+        Variant data;
+        if (!ReadPersistenceCacheImport(import.second, &data, logger_)) {
+          continue;
+        }
+        manager->RunInTransaction([manager, &import, &data]() {
+          return manager->ImportServerCache(import.first, data);
+        });
+      }
     } else {
       persistence_manager = std::make_unique<NoopPersistenceManager>();
     }
@@ -16,7 +16,12 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <cassert>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "app/src/include/firebase/internal/common.h"
 #include "app/src/include/firebase/variant.h"
@@ -29,84 +34,172 @@ namespace firebase {
 namespace database {
 namespace internal {
 
+namespace {
+
+std::shared_ptr<const Variant> MakeRoot(const Variant& data) {
+  std::shared_ptr<Variant> root = std::make_shared<Variant>(data);
+  if (HasVector(*root)) {
+    ConvertVectorToMap(root.get());
+  }
+  return root;
+}
+
+}  // namespace
+
 DataSnapshotInternal::DataSnapshotInternal(DatabaseInternal* database,
                                            const Variant& data,
                                            const QuerySpec& query_spec)
-    : database_(database), data_(data), query_spec_(query_spec) {
-  if (HasVector(data_)) {
-    ConvertVectorToMap(&data_);
-  }
-}
+    : database_(database),
+      root_(MakeRoot(data)),
+      data_(root_.get()),
+      query_spec_(query_spec),
+      child_views_(nullptr) {}
+
+DataSnapshotInternal::DataSnapshotInternal(
+    DatabaseInternal* database, const std::shared_ptr<const Variant>& root,
+    const Variant* data, const QuerySpec& query_spec)
+    : database_(database),
+      root_(root),
+      data_(data),
+      query_spec_(query_spec),
+      child_views_(nullptr) {}
 
 DataSnapshotInternal::DataSnapshotInternal(const DataSnapshotInternal& internal)
     : database_(internal.database_),
+      root_(internal.root_),
       data_(internal.data_),
-      query_spec_(internal.query_spec_) {}
+      query_spec_(internal.query_spec_),
+      child_views_(nullptr) {}
 
 DataSnapshotInternal& DataSnapshotInternal::operator=(
     const DataSnapshotInternal& internal) {
+  if (this == &internal) return *this;
+  ClearChildViews();
   database_ = internal.database_;
+  root_ = internal.root_;
   data_ = internal.data_;
   query_spec_ = internal.query_spec_;
   return *this;
 }
 
 #if defined(FIREBASE_USE_MOVE_OPERATORS) || defined(DOXYGEN)
-DataSnapshotInternal::DataSnapshotInternal(DataSnapshotInternal&& internal) {
-  database_ = internal.database_;
-  data_ = std::move(internal.data_);
-  query_spec_ = std::move(internal.query_spec_);
+DataSnapshotInternal::DataSnapshotInternal(DataSnapshotInternal&& internal)
+    : database_(internal.database_),
+      root_(std::move(internal.root_)),
+      data_(internal.data_),
+      query_spec_(std::move(internal.query_spec_)),
+      child_views_(internal.child_views_.exchange(nullptr)) {
+  internal.data_ = &kNullVariant;
 }
 
 DataSnapshotInternal& DataSnapshotInternal::operator=(
     DataSnapshotInternal&& internal) {
+  if (this == &internal) return *this;
+  ClearChildViews();
   database_ = internal.database_;
-  data_ = std::move(internal.data_);
+  root_ = std::move(internal.root_);
+  data_ = internal.data_;
   query_spec_ = std::move(internal.query_spec_);
+  // The views point into root_, so they remain valid after the move.
+  child_views_ = internal.child_views_.exchange(nullptr);
+  internal.data_ = &kNullVariant;
   return *this;
 }
 #endif  // defined(FIREBASE_USE_MOVE_OPERATORS) || defined(DOXYGEN)
 
-DataSnapshotInternal::~DataSnapshotInternal() {}
+DataSnapshotInternal::~DataSnapshotInternal() { ClearChildViews(); }
 
-bool DataSnapshotInternal::Exists() const { return data_ != Variant::Null(); }
+void DataSnapshotInternal::ClearChildViews() {
+  delete child_views_.exchange(nullptr);
+}
+
+bool DataSnapshotInternal::Exists() const {
+  return *data_ != Variant::Null();
+}
 
 DataSnapshotInternal* DataSnapshotInternal::Child(const char* path) const {
-  const Variant& child = VariantGetChild(&data_, Path(path));
-  return new DataSnapshotInternal(database_, child,
+  // The child is either within data_ or kNullVariant, so it can be shared.
+  const Variant& child = VariantGetChild(data_, Path(path));
+  return new DataSnapshotInternal(database_, root_, &child,
                                   QuerySpec(query_spec_.path.GetChild(path)));
 }
 
 std::vector<DataSnapshot> DataSnapshotInternal::GetChildren() {
+  const std::vector<ChildView>& views = GetChildViews();
   std::vector<DataSnapshot> result;
-  std::map<Variant, const Variant*> children;
-  GetEffectiveChildren(data_, &children);
-
-  for (auto& child : children) {
-    assert(child.first.is_string());
-    result.push_back(DataSnapshot(new DataSnapshotInternal(
-        database_, *child.second,
-        QuerySpec(query_spec_.path.GetChild(child.first.string_value())))));
+  result.reserve(views.size());
+  for (const ChildView& view : views) {
+    result.push_back(GetChildSnapshot(view));
   }
+  return result;
+}
+
+const std::vector<DataSnapshotInternal::ChildView>&
+DataSnapshotInternal::GetChildViews() {
+  const std::vector<ChildView>* cached = child_views_.load();
+  if (cached) return *cached;
 
+  // Extract what each child is sorted by once, rather than on every
+  // comparison.
+  typedef std::pair<QueryParamsComparator::SortKey, ChildView> SortableChild;
   QueryParamsComparator cmp(&query_spec_.params);
-  std::sort(result.begin(), result.end(),
-            [&cmp](const DataSnapshot& lhs, const DataSnapshot& rhs) {
-              return cmp.Compare(lhs.internal_->path().c_str(),
-                                 lhs.internal_->data_,
-                                 rhs.internal_->path().c_str(),
-                                 rhs.internal_->data_) < 0;
-            });
+  std::vector<SortableChild> children;
+  if (data_->is_map()) {
+    const auto& map = data_->map();
+    // If the map has ".value", this is a fundamental type with a priority.
+    // i.e. no children
+    if (map.find(kValueKey) == map.end()) {
+      auto it_priority = map.find(kPriorityKey);
+      children.reserve(map.size());
+      for (auto it_child = map.begin(); it_child != map.end(); ++it_child) {
+        if (it_child != it_priority) {
+          assert(it_child->first.is_string());
+          children.push_back(std::make_pair(
+              cmp.MakeSortKey(it_child->first, it_child->second),
+              ChildView(&it_child->first, &it_child->second)));
+        }
+      }
+    }
+  }
 
-  return result;
+  // The map is ordered by key, which often already is the query order, so
+  // only sort when it isn't.
+  auto less = [&cmp](const SortableChild& lhs, const SortableChild& rhs) {
+    return cmp.Compare(lhs.first, rhs.first) < 0;
+  };
+  if (!std::is_sorted(children.begin(), children.end(), less)) {
+    std::sort(children.begin(), children.end(), less);
+  }
+
+  std::vector<ChildView>* views = new std::vector<ChildView>();
+  views->reserve(children.size());
+  for (const SortableChild& child : children) {
+    views->push_back(child.second);
+  }
+
+  // Another thread may have built the same views in the meantime, in which
+  // case use those and discard these.
+  const std::vector<ChildView>* expected = nullptr;
+  if (!child_views_.compare_exchange_strong(expected, views)) {
+    delete views;
+    return *expected;
+  }
+  return *views;
+}
+
+DataSnapshot DataSnapshotInternal::GetChildSnapshot(
+    const ChildView& child) const {
+  return DataSnapshot(new DataSnapshotInternal(
+      database_, root_, child.value_,
+      QuerySpec(query_spec_.path.GetChild(child.key()))));
 }
 
 size_t DataSnapshotInternal::GetChildrenCount() {
-  return CountEffectiveChildren(data_);
+  return CountEffectiveChildren(*data_);
 }
 
 bool DataSnapshotInternal::HasChildren() {
-  return CountEffectiveChildren(data_) != 0;
+  return CountEffectiveChildren(*data_) != 0;
 }
 
 const char* DataSnapshotInternal::GetKey() const {
@@ -118,13 +211,13 @@ std::string DataSnapshotInternal::GetKeyString() const {
 }
 
 Variant DataSnapshotInternal::GetValue() const {
-  Variant result = data_;
+  Variant result = *data_;
   PrunePrioritiesAndConvertVector(&result);
   return result;
 }
 
 Variant DataSnapshotInternal::GetPriority() const {
-  return GetVariantPriority(data_);
+  return GetVariantPriority(*data_);
 }
 
 DatabaseReferenceInternal* DataSnapshotInternal::GetReference() const {
@@ -132,11 +225,11 @@ DatabaseReferenceInternal* DataSnapshotInternal::GetReference() const {
 }
 
 bool DataSnapshotInternal::HasChild(const char* path) const {
-  return !VariantIsEmpty(VariantGetChild(&data_, Path(path)));
+  return !VariantIsEmpty(VariantGetChild(data_, Path(path)));
 }
 
 bool DataSnapshotInternal::operator==(const DataSnapshotInternal& other) const {
-  return database_ == other.database_ && data_ == other.data_ &&
+  return database_ == other.database_ && *data_ == *other.data_ &&
          query_spec_ == other.query_spec_;
 }
 
@@ -17,7 +17,10 @@
 
 #include <stddef.h>
 
+#include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "app/src/include/firebase/variant.h"
 #include "database/src/common/query_spec.h"
@@ -38,6 +41,30 @@ class DatabaseReferenceInternal;
 // Firebase Database location.
 class DataSnapshotInternal {
  public:
+  // A lightweight, non-owning view of an immediate child of a snapshot.  It is
+  // only valid as long as the snapshot it came from is neither modified nor
+  // destroyed.
+  class ChildView {
+   public:
+    // The key of the child.
+    const char* key() const { return key_->string_value(); }
+
+    // The key of the child as a Variant.
+    const Variant& key_variant() const { return *key_; }
+
+    // The raw data of the child, including any priorities.
+    const Variant& value() const { return *value_; }
+
+   private:
+    friend class DataSnapshotInternal;
+
+    ChildView(const Variant* key, const Variant* value)
+        : key_(key), value_(value) {}
+
+    const Variant* key_;
+    const Variant* value_;
+  };
+
   DataSnapshotInternal(DatabaseInternal* database, const Variant& data,
                        const QuerySpec& query_spec);
 
@@ -62,9 +89,20 @@ class DataSnapshotInternal {
   // management.
   DataSnapshotInternal* Child(const char* path) const;
 
-  // Get all the immediate children of this location.
+  // Get all the immediate children of this location.  The children share the
+  // data of this snapshot rather than copying it.
   std::vector<DataSnapshot> GetChildren();
 
+  // Get views of all the immediate children of this location, in the order
+  // specified by the query.  Unlike GetChildren() this doesn't copy any data.
+  // The order is computed the first time this is called and reused by later
+  // calls.  Thread-safe; the views are not modified once computed.
+  const std::vector<ChildView>& GetChildViews();
+
+  // Create a DataSnapshot for a child returned by GetChildViews().  The child
+  // shares the data of this snapshot rather than copying it.
+  DataSnapshot GetChildSnapshot(const ChildView& child) const;
+
   // Get the number of children of this location.
   size_t GetChildrenCount();
 
@@ -107,11 +145,31 @@ class DataSnapshotInternal {
   bool operator!=(const DataSnapshotInternal& other) const;
 
  private:
+  // Create a snapshot of data, which must be owned by root.
+  DataSnapshotInternal(DatabaseInternal* database,
+                       const std::shared_ptr<const Variant>& root,
+                       const Variant* data, const QuerySpec& query_spec);
+
+  // Drop the cached child views, if any.
+  void ClearChildViews();
+
   DatabaseInternal* database_;
 
-  Variant data_;
+  // The immutable data shared by this snapshot, its copies and all of the
+  // snapshots of its children.
+  std::shared_ptr<const Variant> root_;
+
+  // The data of this snapshot, which is either root_ itself, somewhere within
+  // it, or kNullVariant.
+  const Variant* data_;
 
   QuerySpec query_spec_;
+
+  // Children of data_ in query order, built by GetChildViews(), or null if
+  // they have not been built yet.  The public DataSnapshot may be read from
+  // several threads at once, so the first thread to build the views installs
+  // them and the others discard their own.
+  std::atomic<const std::vector<ChildView>*> child_views_;
 };
 
 }  // namespace internal
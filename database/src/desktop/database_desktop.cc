@@ -73,6 +73,8 @@ DatabaseInternal::DatabaseInternal(App* app, const char* url)
       cleanup_(),
       database_url_(url),
       constructor_url_(url),
+      persistence_query_indexing_enabled_(false),
+      max_in_flight_writes_(0),
       logger_(app_common::FindAppLoggerByName(app->name())),
       repo_(nullptr) {
   assert(app);
@@ -186,6 +188,32 @@ void DatabaseInternal::SetPersistenceEnabled(bool enabled) {
   }
 }
 
+void DatabaseInternal::SetPersistenceQueryIndexingEnabled(bool enabled) {
+  MutexLock lock(repo_mutex_);
+  // Only takes effect if the repo has not yet been initialized.
+  if (!repo_) {
+    persistence_query_indexing_enabled_ = enabled;
+  }
+}
+
+void DatabaseInternal::SetMaxInFlightWrites(int max_in_flight_writes) {
+  MutexLock lock(repo_mutex_);
+  // Only takes effect if the repo has not yet been initialized.
+  if (!repo_) {
+    max_in_flight_writes_ = max_in_flight_writes < 0 ? 0 : max_in_flight_writes;
+  }
+}
+
+void DatabaseInternal::AddPersistenceCacheImport(const char* path,
+                                                 const char* file_path) {
+  MutexLock lock(repo_mutex_);
+  // Only takes effect if the repo has not yet been initialized.
+  if (!repo_) {
+    persistence_cache_imports_.push_back(
+        std::make_pair(Path(path), std::string(file_path)));
+  }
+}
+
 void DatabaseInternal::set_log_level(LogLevel log_level) {
   logger_.SetLogLevel(log_level);
 }
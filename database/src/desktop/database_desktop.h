@@ -18,12 +18,15 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "app/src/cleanup_notifier.h"
 #include "app/src/future_manager.h"
 #include "app/src/include/firebase/app.h"
 #include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/logger.h"
+#include "app/src/path.h"
 #include "app/src/safe_reference.h"
 #include "app/src/scheduler.h"
 #include "database/src/common/listener.h"
@@ -92,6 +95,28 @@ class DatabaseInternal {
 
   void SetPersistenceEnabled(bool enabled);
 
+  void SetPersistenceQueryIndexingEnabled(bool enabled);
+
+  // Whether the persistent cache should be indexed for queries.
+  bool persistence_query_indexing_enabled() const {
+    return persistence_query_indexing_enabled_;
+  }
+
+  void SetMaxInFlightWrites(int max_in_flight_writes);
+
+  // Maximum number of writes sent to the server and waiting for an
+  // acknowledgement, or 0 for no limit.
+  int max_in_flight_writes() const { return max_in_flight_writes_; }
+
+  void AddPersistenceCacheImport(const char* path, const char* file_path);
+
+  // Locations and the files to import the data at each location from, into
+  // the persistent cache.
+  const std::vector<std::pair<Path, std::string>>& persistence_cache_imports()
+      const {
+    return persistence_cache_imports_;
+  }
+
   // Set the logging verbosity.
   void set_log_level(LogLevel log_level);
 
@@ -177,6 +202,12 @@ class DatabaseInternal {
 
   bool persistence_enabled_;
 
+  bool persistence_query_indexing_enabled_;
+
+  int max_in_flight_writes_;
+
+  std::vector<std::pair<Path, std::string>> persistence_cache_imports_;
+
   // The logger for this instance of the database.
   Logger logger_;
 
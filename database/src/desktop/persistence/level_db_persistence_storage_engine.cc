@@ -14,14 +14,18 @@
 
 #include "database/src/desktop/persistence/level_db_persistence_storage_engine.h"
 
+#include <cstring>
 #include <functional>
+#include <map>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "app/src/assert.h"
 #include "app/src/include/firebase/variant.h"
 #include "app/src/log.h"
+#include "app/src/metrics.h"
 #include "app/src/path.h"
 #include "app/src/variant_util.h"
 #include "database/src/common/query_spec.h"
@@ -60,6 +64,14 @@ using leveldb::WriteOptions;
 static const char kDbKeyUserWriteRecords[] = "$user_write_records/";
 static const char kDbKeyTrackedQueries[] = "$tracked_queries/";
 static const char kDbKeyTrackedQueryKeys[] = "$tracked_query_keys/";
+static const char kDbKeyServerCacheIndexes[] = "$server_cache_indexes/";
+static const char kDbKeyServerCacheIndexEntries[] =
+    "$server_cache_index_entries/";
+static const char kDbKeyServerCacheIndexKeys[] = "$server_cache_index_keys/";
+
+// Separates the location and child path in the id of a server cache index.
+// Neither can contain this character.
+static const char kIndexIdSeparator = '\x1f';
 
 static const char kSeparator = '/';
 
@@ -69,6 +81,16 @@ namespace firebase {
 namespace database {
 namespace internal {
 
+static metrics::Counter g_leveldb_reads(
+    "firebase_database_leveldb_reads_total",
+    "Number of LevelDB lookups and iterations by the persistence layer.");
+static metrics::Counter g_leveldb_writes(
+    "firebase_database_leveldb_writes_total",
+    "Number of LevelDB write batches written by the persistence layer.");
+static metrics::Histogram g_server_cache_read_latency(
+    "firebase_database_server_cache_read_latency_us",
+    "Time to load data from the persistent server cache, in microseconds.");
+
 // A utility function to get the pointer one character past the end of a string.
 // This is used for finding the sentinal to pass to functions that take pairs of
 // iterators (specifically, vector::insert).
@@ -112,6 +134,7 @@ class ChildrenAtPath {
   };
 
   iterator begin() {
+    g_leveldb_reads.Increment();
     return iterator(std::unique_ptr<leveldb::Iterator>(
                         database_->NewIterator(ReadOptions())),
                     path_);
@@ -235,6 +258,17 @@ class BufferedWriteBatch {
     }
   }
 
+  // Add operations that are written along with the buffered writes on the
+  // next Commit().
+  void Append(const WriteBatch& batch) {
+    batch_.Append(batch);
+    has_operation_to_write_ = true;
+  }
+
+  // Number of bytes of keys and values added since the last commit.
+  size_t buffered_size() const { return buffer_.size(); }
+
+  // Write all operations added so far. The batch can be reused afterwards.
   void Commit() {
     // We should not attempt to commit if an error was detected.
     FIREBASE_ASSERT(error_detected_ == false);
@@ -250,7 +284,13 @@ class BufferedWriteBatch {
     if (has_operation_to_write_) {
       WriteOptions options;
       database_->Write(options, &batch_);
+      g_leveldb_writes.Increment();
     }
+
+    buffer_.clear();
+    offset_slices_.clear();
+    batch_.Clear();
+    has_operation_to_write_ = false;
   }
 
  private:
@@ -292,7 +332,11 @@ class BufferedWriteBatch {
 
 LevelDbPersistenceStorageEngine::LevelDbPersistenceStorageEngine(
     LoggerBase* logger)
-    : database_(nullptr), inside_transaction_(false), logger_(logger) {}
+    : database_(nullptr),
+      inside_transaction_(false),
+      query_indexing_enabled_(false),
+      server_cache_indexes_(),
+      logger_(logger) {}
 
 bool LevelDbPersistenceStorageEngine::Initialize(
     const std::string& level_db_path) {
@@ -307,6 +351,7 @@ bool LevelDbPersistenceStorageEngine::Initialize(
     assert(false);
   }
   database_.reset(database);
+  if (status.ok()) LoadServerCacheIndexes();
   return status.ok();
 }
 
@@ -441,6 +486,7 @@ static void VariantAddCachedValue(Variant* variant, const Path& path,
 }
 
 Variant LevelDbPersistenceStorageEngine::ServerCache(const Path& path) {
+  metrics::Span span("server_cache_read", &g_server_cache_read_latency);
   Variant result;
   std::string full_path;
   if (!path.empty()) {
@@ -553,10 +599,44 @@ static bool VariantVectorToFlexbuffer(const std::vector<Variant>& vector,
   return true;
 }
 
+// Add the write of a single leaf value to the batch. The builder is reused
+// for all values so that we don't keep reallocating each iteration.
+static bool AddLeafWrite(const Path& local_path, const Variant& leaf,
+                         flexbuffers::Builder* builder,
+                         BufferedWriteBatch* buffered_write_batch) {
+  if (leaf.is_null()) return true;  // Skip nulls.
+
+  // Write key bytes to buffer.
+  return buffered_write_batch->AddWrite(
+      // Key
+      [&local_path](std::vector<uint8_t>* buffer) {
+        if (!local_path.empty()) {
+          buffer->insert(buffer->end(), static_cast<uint8_t>(kSeparator));
+          buffer->insert(buffer->end(), local_path.str().begin(),
+                         local_path.str().end());
+        }
+        buffer->insert(buffer->end(), static_cast<uint8_t>(kSeparator));
+        return true;
+      },
+      // Value
+      [&leaf, builder](std::vector<uint8_t>* buffer) {
+        // Build FlexBuffer representation of the value.
+        if (!VariantToFlexbuffer(leaf, builder)) {
+          return false;
+        }
+        // Write FlexBuffer value to buffer.
+        builder->Finish();
+        buffer->insert(buffer->end(), builder->GetBuffer().begin(),
+                       builder->GetBuffer().end());
+        // Prepare for next iteration.
+        builder->Clear();
+
+        return true;
+      });
+}
+
 static bool PrepareBatchOverwrite(const Path& path, const Variant& data,
                                   BufferedWriteBatch* buffered_write_batch) {
-  // Reuse a single builder for all values so that we don't keep reallocating
-  // each iteration.
   flexbuffers::Builder builder;
 
   // Delete the old data at this location.
@@ -567,35 +647,7 @@ static bool PrepareBatchOverwrite(const Path& path, const Variant& data,
       path, data,
       [&buffered_write_batch, &builder](const Path& local_path,
                                         const Variant& leaf) {
-        if (leaf.is_null()) return true;  // Skip nulls.
-
-        // Write key bytes to buffer.
-        return buffered_write_batch->AddWrite(
-            // Key
-            [&local_path](std::vector<uint8_t>* buffer) {
-              if (!local_path.empty()) {
-                buffer->insert(buffer->end(), static_cast<uint8_t>(kSeparator));
-                buffer->insert(buffer->end(), local_path.str().begin(),
-                               local_path.str().end());
-              }
-              buffer->insert(buffer->end(), static_cast<uint8_t>(kSeparator));
-              return true;
-            },
-            // Value
-            [&leaf, &builder](std::vector<uint8_t>* buffer) {
-              // Build FlexBuffer representation of the value.
-              if (!VariantToFlexbuffer(leaf, &builder)) {
-                return false;
-              }
-              // Write FlexBuffer value to buffer.
-              builder.Finish();
-              buffer->insert(buffer->end(), builder.GetBuffer().begin(),
-                             builder.GetBuffer().end());
-              // Prepare for next iteration.
-              builder.Clear();
-
-              return true;
-            });
+        return AddLeafWrite(local_path, leaf, &builder, buffered_write_batch);
       });
 }
 
@@ -607,10 +659,77 @@ void LevelDbPersistenceStorageEngine::OverwriteServerCache(
   bool success = PrepareBatchOverwrite(path, data, &buffered_write_batch);
   if (!success) return;
 
+  // Keep the indexes in the same write as the data they index.
+  WriteBatch index_batch;
+  PrepareServerCacheIndexUpdates({std::make_pair(path, &data)}, &index_batch);
+  buffered_write_batch.Append(index_batch);
+
   // Overwrite prepared successfully, time to commit.
   buffered_write_batch.Commit();
 }
 
+// Size of the keys and values that ImportServerCache() writes at a time, so
+// that large imports don't need a second copy of all of the data in memory.
+static const size_t kImportBatchSize = 4 * 1024 * 1024;
+
+bool LevelDbPersistenceStorageEngine::ImportServerCache(const Path& path,
+                                                        const Variant& data) {
+  VerifyInsideTransaction();
+  BufferedWriteBatch buffered_write_batch(database_.get());
+  flexbuffers::Builder builder;
+
+  // The import may take several writes. Drop the definitions of the indexes
+  // it affects first, so that if it doesn't finish they are rebuilt from the
+  // server cache rather than used while out of date. The index updates are
+  // gathered before any data is written and go in the last write, which puts
+  // the definitions back.
+  std::vector<ServerCacheIndex> affected_indexes;
+  WriteBatch index_batch;
+  for (const ServerCacheIndex& index : server_cache_indexes_) {
+    if (Path::GetRelative(index.first, path).has_value() ||
+        Path::GetRelative(path, index.first).has_value()) {
+      affected_indexes.push_back(index);
+    }
+  }
+  if (!affected_indexes.empty()) {
+    WriteBatch drop_batch;
+    for (const ServerCacheIndex& index : affected_indexes) {
+      std::string id = ServerCacheIndexId(index.first, index.second);
+      drop_batch.Delete(kDbKeyServerCacheIndexes + id);
+      index_batch.Put(kDbKeyServerCacheIndexes + id, id);
+    }
+    database_->Write(WriteOptions(), &drop_batch);
+    g_leveldb_writes.Increment();
+    PrepareServerCacheIndexUpdates({std::make_pair(path, &data)},
+                                   &index_batch);
+  }
+
+  buffered_write_batch.DeleteLocation(kSeparator + path.str() + kSeparator);
+  bool success = CallOnEachLeaf(
+      path, data,
+      [&buffered_write_batch, &builder](const Path& local_path,
+                                        const Variant& leaf) {
+        if (!AddLeafWrite(local_path, leaf, &builder, &buffered_write_batch)) {
+          return false;
+        }
+        if (buffered_write_batch.buffered_size() >= kImportBatchSize) {
+          buffered_write_batch.Commit();
+        }
+        return true;
+      });
+  if (success) {
+    if (!affected_indexes.empty()) buffered_write_batch.Append(index_batch);
+    buffered_write_batch.Commit();
+  } else {
+    // Part of the data may have been written, so the indexes are rebuilt the
+    // next time a query uses them.
+    for (const ServerCacheIndex& index : affected_indexes) {
+      server_cache_indexes_.erase(index);
+    }
+  }
+  return success;
+}
+
 void LevelDbPersistenceStorageEngine::MergeIntoServerCache(
     const Path& path, const Variant& data) {
   VerifyInsideTransaction();
@@ -620,17 +739,24 @@ void LevelDbPersistenceStorageEngine::MergeIntoServerCache(
   }
 
   BufferedWriteBatch buffered_write_batch(database_.get());
+  std::vector<std::pair<Path, const Variant*>> writes;
 
   // Gather the changes in the merge.
   for (const auto& key_value : data.map()) {
     const Variant& key = key_value.first;
     const Variant& value = key_value.second;
     assert(key.is_string());
-    bool success = PrepareBatchOverwrite(path.GetChild(key.string_value()),
-                                         value, &buffered_write_batch);
+    writes.push_back(std::make_pair(path.GetChild(key.string_value()), &value));
+    bool success = PrepareBatchOverwrite(writes.back().first, value,
+                                         &buffered_write_batch);
     if (!success) return;
   }
 
+  // Keep the indexes in the same write as the data they index.
+  WriteBatch index_batch;
+  PrepareServerCacheIndexUpdates(writes, &index_batch);
+  buffered_write_batch.Append(index_batch);
+
   // Merge prepared successfully, time to commit.
   buffered_write_batch.Commit();
 }
@@ -642,19 +768,381 @@ void LevelDbPersistenceStorageEngine::MergeIntoServerCache(
 
   // Gather the changes in the merge.
   bool success = true;
+  std::vector<std::pair<Path, const Variant*>> writes;
   children.write_tree().CallOnEach(
-      Path(), [&path, &buffered_write_batch, &success](const Path& data_path,
-                                                       const Variant& data) {
-        success = PrepareBatchOverwrite(path.GetChild(data_path), data,
+      Path(), [&path, &buffered_write_batch, &success, &writes](
+                  const Path& data_path, const Variant& data) {
+        writes.push_back(std::make_pair(path.GetChild(data_path), &data));
+        success = PrepareBatchOverwrite(writes.back().first, data,
                                         &buffered_write_batch);
         if (!success) return;
       });
   if (!success) return;
 
+  // Keep the indexes in the same write as the data they index.
+  WriteBatch index_batch;
+  PrepareServerCacheIndexUpdates(writes, &index_batch);
+  buffered_write_batch.Append(index_batch);
+
   // Merge prepared successfully, time to commit.
   buffered_write_batch.Commit();
 }
 
+// Server cache indexes
+//
+// An index lists the children of a location ordered by the value of one of
+// their descendants, the same way QueryParamsComparator orders them for
+// kOrderByChild. Each index is identified by the location and the child path,
+// and stores three kinds of keys:
+//   * $server_cache_indexes/<id>: The definition of the index.
+//   * $server_cache_index_entries/<id><value><child key>: An entry for each
+//     child, where <value> is an encoding of the ordered value that sorts the
+//     same way the values do. The entries are therefore in query order.
+//   * $server_cache_index_keys/<id><child key>: The entry key of each child,
+//     used to find the old entry when a child changes.
+
+static std::string ServerCacheIndexId(const Path& path,
+                                      const std::string& child) {
+  std::string id = path.str();
+  id += kIndexIdSeparator;
+  id += child;
+  id += kIndexIdSeparator;
+  return id;
+}
+
+// The order of these matches the order in which QueryParamsComparator sorts
+// values of different types.
+enum IndexValueType {
+  kIndexValueTypeNull = 1,
+  kIndexValueTypeBoolean,
+  kIndexValueTypeNumber,
+  kIndexValueTypeString,
+  kIndexValueTypeMap,
+};
+
+// Append an encoding of a value to out, such that comparing two encodings
+// bytewise orders them the same way QueryParamsComparator orders the values.
+//
+// Numbers are encoded as doubles, so integers that a double can't represent
+// exactly may be out of order relative to their neighbours.
+static void EncodeIndexValue(const Variant& variant, std::string* out) {
+  const Variant* value = GetVariantValue(&variant);
+  switch (value->type()) {
+    case Variant::kTypeBool: {
+      out->push_back(static_cast<char>(kIndexValueTypeBoolean));
+      out->push_back(value->bool_value() ? 1 : 0);
+      break;
+    }
+    case Variant::kTypeInt64:
+    case Variant::kTypeDouble: {
+      out->push_back(static_cast<char>(kIndexValueTypeNumber));
+      double number = value->is_int64()
+                          ? static_cast<double>(value->int64_value())
+                          : value->double_value();
+      // -0.0 and 0.0 compare equal.
+      if (number == 0.0) number = 0.0;
+      uint64_t bits;
+      memcpy(&bits, &number, sizeof(bits));
+      // Flip the sign bit of positive numbers and all bits of negative numbers
+      // so that the bits compare as unsigned integers in numeric order.
+      bits = (bits & (1ULL << 63)) ? ~bits : (bits | (1ULL << 63));
+      for (int shift = 56; shift >= 0; shift -= 8) {
+        out->push_back(static_cast<char>((bits >> shift) & 0xff));
+      }
+      break;
+    }
+    case Variant::kTypeStaticString:
+    case Variant::kTypeMutableString: {
+      out->push_back(static_cast<char>(kIndexValueTypeString));
+      out->append(value->string_value());
+      out->push_back('\0');
+      break;
+    }
+    case Variant::kTypeMap: {
+      out->push_back(static_cast<char>(kIndexValueTypeMap));
+      break;
+    }
+    default: {
+      out->push_back(static_cast<char>(kIndexValueTypeNull));
+      break;
+    }
+  }
+}
+
+// Returns the key of the index entry for a child.
+static std::string ServerCacheIndexEntryKey(const std::string& id,
+                                            const Path& child_path,
+                                            const std::string& child_key,
+                                            const Variant& child) {
+  std::string key = kDbKeyServerCacheIndexEntries + id;
+  EncodeIndexValue(VariantGetChild(&child, child_path), &key);
+  key += child_key;
+  return key;
+}
+
+// Returns the smallest key that is greater than all keys starting with prefix.
+static std::string PrefixSuccessor(std::string prefix) {
+  while (!prefix.empty()) {
+    unsigned char last = static_cast<unsigned char>(prefix.back());
+    if (last != 0xff) {
+      prefix.back() = static_cast<char>(last + 1);
+      return prefix;
+    }
+    prefix.pop_back();
+  }
+  return prefix;
+}
+
+static void DeleteKeysWithPrefix(DB* database, const std::string& prefix,
+                                 WriteBatch* batch) {
+  for (auto& child : ChildrenAtPath(database, prefix)) {
+    batch->Delete(child.key());
+  }
+}
+
+void LevelDbPersistenceStorageEngine::LoadServerCacheIndexes() {
+  server_cache_indexes_.clear();
+  if (!query_indexing_enabled_) {
+    // Indexes aren't kept up to date while indexing is disabled, so remove
+    // any left over from when it was enabled.
+    WriteBatch batch;
+    DeleteKeysWithPrefix(database_.get(), kDbKeyServerCacheIndexes, &batch);
+    DeleteKeysWithPrefix(database_.get(), kDbKeyServerCacheIndexEntries,
+                         &batch);
+    DeleteKeysWithPrefix(database_.get(), kDbKeyServerCacheIndexKeys, &batch);
+    database_->Write(WriteOptions(), &batch);
+    g_leveldb_writes.Increment();
+    return;
+  }
+  for (auto& child :
+       ChildrenAtPath(database_.get(), kDbKeyServerCacheIndexes)) {
+    std::string id = child.value().ToString();
+    size_t separator = id.find(kIndexIdSeparator);
+    if (separator == std::string::npos || id.back() != kIndexIdSeparator) {
+      continue;
+    }
+    server_cache_indexes_.insert(std::make_pair(
+        Path(id.substr(0, separator)),
+        id.substr(separator + 1, id.size() - separator - 2)));
+  }
+}
+
+void LevelDbPersistenceStorageEngine::AddServerCacheIndex(
+    const ServerCacheIndex& index) {
+  logger_->LogDebug("Creating server cache index on %s for %s",
+                    index.first.c_str(), index.second.c_str());
+  // This reads the whole location once, the same as a query that isn't
+  // indexed would. Queries that use the index afterwards don't.
+  WriteBatch batch;
+  PrepareServerCacheIndexRebuild(index, ServerCache(index.first), &batch);
+  database_->Write(WriteOptions(), &batch);
+  g_leveldb_writes.Increment();
+  server_cache_indexes_.insert(index);
+}
+
+void LevelDbPersistenceStorageEngine::PrepareServerCacheIndexRebuild(
+    const ServerCacheIndex& index, const Variant& data, WriteBatch* batch) {
+  std::string id = ServerCacheIndexId(index.first, index.second);
+  batch->Put(kDbKeyServerCacheIndexes + id, id);
+  DeleteKeysWithPrefix(database_.get(), kDbKeyServerCacheIndexEntries + id,
+                       batch);
+  DeleteKeysWithPrefix(database_.get(), kDbKeyServerCacheIndexKeys + id,
+                       batch);
+
+  if (data.is_map() && !VariantIsLeaf(data)) {
+    Path child_path(index.second);
+    for (const auto& key_value : data.map()) {
+      if (!key_value.first.is_string()) continue;
+      std::string child_key = key_value.first.string_value();
+      if (IsPriorityKey(child_key)) continue;
+      std::string entry_key =
+          ServerCacheIndexEntryKey(id, child_path, child_key, key_value.second);
+      batch->Put(entry_key, child_key);
+      batch->Put(kDbKeyServerCacheIndexKeys + id + child_key, entry_key);
+    }
+  }
+}
+
+void LevelDbPersistenceStorageEngine::PrepareServerCacheIndexEntryUpdate(
+    const ServerCacheIndex& index, const std::string& child_key,
+    const Variant& child, WriteBatch* batch) {
+  std::string id = ServerCacheIndexId(index.first, index.second);
+  std::string reverse_key = kDbKeyServerCacheIndexKeys + id + child_key;
+
+  std::string old_entry_key;
+  g_leveldb_reads.Increment();
+  if (database_->Get(ReadOptions(), reverse_key, &old_entry_key).ok()) {
+    batch->Delete(old_entry_key);
+    batch->Delete(reverse_key);
+  }
+
+  if (!VariantIsEmpty(child)) {
+    std::string entry_key =
+        ServerCacheIndexEntryKey(id, Path(index.second), child_key, child);
+    batch->Put(entry_key, child_key);
+    batch->Put(reverse_key, entry_key);
+  }
+}
+
+void LevelDbPersistenceStorageEngine::PrepareServerCacheIndexRemoval(
+    const ServerCacheIndex& index, WriteBatch* batch) {
+  std::string id = ServerCacheIndexId(index.first, index.second);
+  batch->Delete(kDbKeyServerCacheIndexes + id);
+  DeleteKeysWithPrefix(database_.get(), kDbKeyServerCacheIndexEntries + id,
+                       batch);
+  DeleteKeysWithPrefix(database_.get(), kDbKeyServerCacheIndexKeys + id,
+                       batch);
+}
+
+void LevelDbPersistenceStorageEngine::PrepareServerCacheIndexUpdates(
+    const std::vector<std::pair<Path, const Variant*>>& writes,
+    WriteBatch* batch) {
+  for (const ServerCacheIndex& index : server_cache_indexes_) {
+    // The new contents of the indexed location, if a write replaces it, or
+    // else the new values of the children that are written to.
+    bool rebuild = false;
+    Variant location;
+    std::map<std::string, Variant> children;
+    for (const auto& write : writes) {
+      const Path& path = write.first;
+      const Variant& data = *write.second;
+      Optional<Path> relative_path = Path::GetRelative(index.first, path);
+      if (relative_path.has_value() && !relative_path->empty()) {
+        // The write is inside a single child of the indexed location.
+        if (rebuild) {
+          VariantUpdateChild(&location, *relative_path, data);
+          continue;
+        }
+        std::string child_key = relative_path->FrontDirectory().str();
+        if (IsPriorityKey(child_key)) continue;
+        auto it = children.find(child_key);
+        if (it == children.end()) {
+          // Start from the child as it is before this batch is written.
+          it = children
+                   .insert(std::make_pair(
+                       child_key, ServerCache(index.first.GetChild(child_key))))
+                   .first;
+        }
+        VariantUpdateChild(&it->second, relative_path->PopFrontDirectory(),
+                           data);
+      } else {
+        Optional<Path> location_path = Path::GetRelative(path, index.first);
+        if (location_path.has_value()) {
+          // The write replaces the indexed location or one of its parents.
+          rebuild = true;
+          location = VariantGetChild(&data, *location_path);
+          children.clear();
+        }
+      }
+    }
+    if (rebuild) {
+      PrepareServerCacheIndexRebuild(index, location, batch);
+    } else {
+      for (const auto& child : children) {
+        PrepareServerCacheIndexEntryUpdate(index, child.first, child.second,
+                                           batch);
+      }
+    }
+  }
+}
+
+bool LevelDbPersistenceStorageEngine::ServerCacheForQuery(
+    const QuerySpec& query_spec, Variant* result) {
+  const QueryParams& params = query_spec.params;
+  if (!query_indexing_enabled_ ||
+      params.order_by != QueryParams::kOrderByChild ||
+      params.order_by_child.find(kIndexIdSeparator) != std::string::npos) {
+    return false;
+  }
+  // Queries that return every child don't benefit from an index.
+  bool has_start =
+      params.start_at_value.has_value() || params.equal_to_value.has_value();
+  bool has_end =
+      params.end_at_value.has_value() || params.equal_to_value.has_value();
+  if (params.limit_first == 0 && params.limit_last == 0 && !has_start &&
+      !has_end) {
+    return false;
+  }
+
+  ServerCacheIndex index(query_spec.path, params.order_by_child);
+  if (server_cache_indexes_.find(index) == server_cache_indexes_.end()) {
+    AddServerCacheIndex(index);
+  }
+  std::string prefix = kDbKeyServerCacheIndexEntries +
+                       ServerCacheIndexId(index.first, index.second);
+
+  // Entries from lower_bound up to and including upper_bound match the query.
+  // If upper_bound_is_prefix is true, entries that start with upper_bound also
+  // match.
+  std::string lower_bound = prefix;
+  std::string upper_bound = prefix;
+  bool upper_bound_is_prefix = true;
+  const Optional<Variant>& start_value = params.equal_to_value.has_value()
+                                             ? params.equal_to_value
+                                             : params.start_at_value;
+  const Optional<std::string>& start_key =
+      params.equal_to_value.has_value() ? params.equal_to_child_key
+                                        : params.start_at_child_key;
+  const Optional<Variant>& end_value = params.equal_to_value.has_value()
+                                           ? params.equal_to_value
+                                           : params.end_at_value;
+  const Optional<std::string>& end_key = params.equal_to_value.has_value()
+                                             ? params.equal_to_child_key
+                                             : params.end_at_child_key;
+  if (start_value.has_value()) {
+    EncodeIndexValue(*start_value, &lower_bound);
+    if (start_key.has_value()) lower_bound += *start_key;
+  }
+  if (end_value.has_value()) {
+    EncodeIndexValue(*end_value, &upper_bound);
+    if (end_key.has_value()) {
+      upper_bound += *end_key;
+      upper_bound_is_prefix = false;
+    }
+  }
+  auto in_range = [&](const Slice& key) {
+    if (!key.starts_with(prefix) || key.compare(lower_bound) < 0) return false;
+    return key.compare(upper_bound) <= 0 ||
+           (upper_bound_is_prefix && key.starts_with(upper_bound));
+  };
+
+  std::vector<std::string> child_keys;
+  std::unique_ptr<Iterator> it(database_->NewIterator(ReadOptions()));
+  g_leveldb_reads.Increment();
+  if (params.limit_last != 0) {
+    // Walk backwards from the end of the range.
+    std::string end = upper_bound_is_prefix ? PrefixSuccessor(upper_bound)
+                                            : upper_bound + '\0';
+    it->Seek(end);
+    if (it->Valid()) {
+      it->Prev();
+    } else {
+      it->SeekToLast();
+    }
+    for (; it->Valid() && in_range(it->key()) &&
+           child_keys.size() < params.limit_last;
+         it->Prev()) {
+      child_keys.push_back(it->value().ToString());
+    }
+  } else {
+    for (it->Seek(lower_bound);
+         it->Valid() && in_range(it->key()) &&
+         (params.limit_first == 0 || child_keys.size() < params.limit_first);
+         it->Next()) {
+      child_keys.push_back(it->value().ToString());
+    }
+  }
+
+  *result = Variant::EmptyMap();
+  for (const std::string& child_key : child_keys) {
+    Variant child = ServerCache(query_spec.path.GetChild(child_key));
+    if (!child.is_null()) {
+      result->map()[child_key] = std::move(child);
+    }
+  }
+  return true;
+}
+
 uint64_t LevelDbPersistenceStorageEngine::ServerCacheEstimatedSizeInBytes()
     const {
   uint64_t result = 0;
@@ -849,8 +1337,23 @@ void LevelDbPersistenceStorageEngine::PruneCache(
   }
 
   if (has_operation_to_write) {
+    // Remove the indexes of the pruned data in the same write. They are
+    // rebuilt the next time a query uses them.
+    std::vector<ServerCacheIndex> pruned_indexes;
+    for (const ServerCacheIndex& index : server_cache_indexes_) {
+      if (Path::GetRelative(index.first, root).has_value() ||
+          Path::GetRelative(root, index.first).has_value()) {
+        PrepareServerCacheIndexRemoval(index, &batch);
+        pruned_indexes.push_back(index);
+      }
+    }
+
     WriteOptions options;
     database_->Write(options, &batch);
+    g_leveldb_writes.Increment();
+    for (const ServerCacheIndex& index : pruned_indexes) {
+      server_cache_indexes_.erase(index);
+    }
   }
 }
 
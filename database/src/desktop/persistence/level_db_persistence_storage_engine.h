@@ -16,6 +16,10 @@
 #define FIREBASE_DATABASE_SRC_DESKTOP_PERSISTENCE_LEVEL_DB_PERSISTENCE_STORAGE_ENGINE_H_
 
 #include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "app/src/include/firebase/variant.h"
 #include "app/src/logger.h"
@@ -43,6 +47,19 @@ class LevelDbPersistenceStorageEngine : public PersistenceStorageEngine {
   // a separate step.
   bool Initialize(const std::string& level_db_path);
 
+  // Enable secondary indexes of the server cache for queries ordered by a
+  // child. When enabled, the first query ordered by a given child at a given
+  // location builds an index of the children at that location, keyed by the
+  // value of the ordered child. The index is stored in the database and kept
+  // up to date as the server cache changes, in the same writes as the data,
+  // so that later limited or ranged queries only read the children they
+  // return. Building an index loads the whole location once, which costs the
+  // same as a query without an index. Pruning the location or an import into
+  // it that fails removes the index, and the next query builds it again.
+  void set_query_indexing_enabled(bool enabled) {
+    query_indexing_enabled_ = enabled;
+  }
+
   // Write data to the local cache, overwriting the data at the given path.
   // Additionally, log that this write occurred so that when the database is
   // online again it can send updates.
@@ -83,12 +100,30 @@ class LevelDbPersistenceStorageEngine : public PersistenceStorageEngine {
   // @return The data that was loaded.
   Variant ServerCache(const Path& path) override;
 
+  // Loads only the data a query needs using a secondary index. Only queries
+  // ordered by a child are supported, and only while query indexing is
+  // enabled.
+  //
+  // @param query_spec The query to load the data for.
+  // @param result The data that was loaded.
+  // @return Whether the data was loaded from an index.
+  bool ServerCacheForQuery(const QuerySpec& query_spec,
+                           Variant* result) override;
+
   // Overwrite the server cache at the given path with the given data.
   //
   // @param path The path to update.
   // @param data The data to write to the cache.
   void OverwriteServerCache(const Path& path, const Variant& data) override;
 
+  // Overwrite the server cache at the given path with a large snapshot of
+  // data, committing the writes in batches of limited size.
+  //
+  // @param path The path to update.
+  // @param data The data to write to the cache.
+  // @return Whether all of the data was written.
+  bool ImportServerCache(const Path& path, const Variant& data) override;
+
   // Update the server cache at the given path with the given data, merging each
   // child into the cache.
   //
@@ -182,12 +217,53 @@ class LevelDbPersistenceStorageEngine : public PersistenceStorageEngine {
   void SetTransactionSuccessful() override;
 
  private:
+  // An index of the children at a location, ordered by the value of a child.
+  // The first element is the location and the second the child path.
+  typedef std::pair<Path, std::string> ServerCacheIndex;
+
   void VerifyInsideTransaction();
 
+  // Load the indexes saved in the database.
+  void LoadServerCacheIndexes();
+
+  // Create an index and fill it with the current contents of the server cache.
+  // This loads the whole location once.
+  void AddServerCacheIndex(const ServerCacheIndex& index);
+
+  // Add the operations that keep the indexes up to date with writes to the
+  // server cache to a batch. Each write is a path and the data written there.
+  // This reads the state before the writes, so the batch has to be written
+  // along with the writes themselves.
+  void PrepareServerCacheIndexUpdates(
+      const std::vector<std::pair<Path, const Variant*>>& writes,
+      leveldb::WriteBatch* batch);
+
+  // Add the operations that replace all the entries of an index with the
+  // children of the given data to a batch.
+  void PrepareServerCacheIndexRebuild(const ServerCacheIndex& index,
+                                      const Variant& data,
+                                      leveldb::WriteBatch* batch);
+
+  // Add the operations that update the entry of a single child in an index
+  // to a batch.
+  void PrepareServerCacheIndexEntryUpdate(const ServerCacheIndex& index,
+                                          const std::string& child_key,
+                                          const Variant& child,
+                                          leveldb::WriteBatch* batch);
+
+  // Add the operations that remove an index and all its entries to a batch.
+  void PrepareServerCacheIndexRemoval(const ServerCacheIndex& index,
+                                      leveldb::WriteBatch* batch);
+
   std::unique_ptr<leveldb::DB> database_;
 
   bool inside_transaction_;
 
+  bool query_indexing_enabled_;
+
+  // The indexes that are kept up to date.
+  std::set<ServerCacheIndex> server_cache_indexes_;
+
   LoggerBase* logger_;
 };
 
@@ -75,6 +75,16 @@ void NoopPersistenceManager::UpdateServerCache(const Path& path,
   VERIFY_INSIDE_TRANSACTION();
 }
 
+bool NoopPersistenceManager::ImportServerCache(const Path& path,
+                                               const Variant& data) {
+  VERIFY_INSIDE_TRANSACTION();
+  return false;
+}
+
+bool NoopPersistenceManager::IsServerCacheComplete(const Path& path) {
+  return false;
+}
+
 void NoopPersistenceManager::SetQueryActive(const QuerySpec& query_spec) {
   VERIFY_INSIDE_TRANSACTION();
 }
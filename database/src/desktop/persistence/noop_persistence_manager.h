@@ -93,6 +93,18 @@ class NoopPersistenceManager : public PersistenceManagerInterface {
   void UpdateServerCache(const Path& path,
                          const CompoundWrite& children) override;
 
+  // Import a snapshot of the data at a location into the server cache as a
+  // complete tracked query, unless the cache already holds complete data for
+  // the location.
+  //
+  // @param path The location of the snapshot.
+  // @param data The data at the location.
+  // @return Whether the snapshot was imported.
+  bool ImportServerCache(const Path& path, const Variant& data) override;
+
+  // Returns whether the server cache holds complete data for a location.
+  bool IsServerCacheComplete(const Path& path) override;
+
   // Begin tracking the given QuerySpec.
   void SetQueryActive(const QuerySpec& query) override;
 
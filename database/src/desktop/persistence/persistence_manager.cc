@@ -108,6 +108,16 @@ CacheNode PersistenceManager::ServerCache(const QuerySpec& query_spec) {
         tracked_query_manager_->GetKnownCompleteChildren(query_spec.path);
   }
 
+  if (!found_tracked_keys && !QuerySpecLoadsAllData(query_spec)) {
+    // The location is complete but the query has no tracked keys. Let the
+    // storage engine pick out the matching children if it can.
+    Variant query_node;
+    if (storage_engine_->ServerCacheForQuery(query_spec, &query_node)) {
+      return CacheNode(IndexedVariant(query_node, query_spec.params), true,
+                       true);
+    }
+  }
+
   const Variant& server_cache_node =
       storage_engine_->ServerCache(query_spec.path);
   if (found_tracked_keys) {
@@ -141,6 +151,27 @@ void PersistenceManager::UpdateServerCache(const Path& path,
   DoPruneCheckAfterServerUpdate();
 }
 
+bool PersistenceManager::ImportServerCache(const Path& path,
+                                           const Variant& data) {
+  QuerySpec query_spec(path);
+  if (tracked_query_manager_->IsQueryComplete(query_spec)) {
+    logger_->LogDebug("Skipping import of %s, which is already cached.",
+                      path.c_str());
+    return false;
+  }
+  if (!storage_engine_->ImportServerCache(path, data)) {
+    logger_->LogError("Failed to import data at %s into the cache.",
+                      path.c_str());
+    return false;
+  }
+  tracked_query_manager_->EnsureCompleteTrackedQuery(path);
+  return true;
+}
+
+bool PersistenceManager::IsServerCacheComplete(const Path& path) {
+  return tracked_query_manager_->IsQueryComplete(QuerySpec(path));
+}
+
 void PersistenceManager::SetQueryActive(const QuerySpec& query_spec) {
   tracked_query_manager_->SetQueryActiveFlag(query_spec, TrackedQuery::kActive);
 }
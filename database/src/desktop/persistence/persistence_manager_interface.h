@@ -89,6 +89,18 @@ class PersistenceManagerInterface {
   virtual void UpdateServerCache(const Path& path,
                                  const CompoundWrite& children) = 0;
 
+  // Import a snapshot of the data at a location into the server cache as a
+  // complete tracked query, unless the cache already holds complete data for
+  // the location.
+  //
+  // @param path The location of the snapshot.
+  // @param data The data at the location.
+  // @return Whether the snapshot was imported.
+  virtual bool ImportServerCache(const Path& path, const Variant& data) = 0;
+
+  // Returns whether the server cache holds complete data for a location.
+  virtual bool IsServerCacheComplete(const Path& path) = 0;
+
   // Begin tracking the given QuerySpec.
   virtual void SetQueryActive(const QuerySpec& query) = 0;
 
@@ -135,12 +135,40 @@ class PersistenceStorageEngine {
   // @return The data that was loaded.
   virtual Variant ServerCache(const Path& path) = 0;
 
+  // Loads only the data a query needs from the server cache, using an index
+  // of the children at the query's location. The result holds the children
+  // that match the query, but may need further filtering by the query.
+  //
+  // Storage engines that don't keep indexes return false, as does a storage
+  // engine that can't use an index for this query. In that case all data at
+  // the location should be loaded with ServerCache().
+  //
+  // @param query_spec The query to load the data for.
+  // @param result The data that was loaded.
+  // @return Whether the data was loaded from an index.
+  virtual bool ServerCacheForQuery(const QuerySpec& query_spec,
+                                   Variant* result) {
+    return false;
+  }
+
   // Overwrite the server cache at the given path with the given data.
   //
   // @param path The path to update.
   // @param data The data to write to the cache.
   virtual void OverwriteServerCache(const Path& path, const Variant& data) = 0;
 
+  // Overwrite the server cache at the given path with a large snapshot of
+  // data. Storage engines can override this to write the data in several
+  // batches, in which case the data may be partially written on failure.
+  //
+  // @param path The path to update.
+  // @param data The data to write to the cache.
+  // @return Whether all of the data was written.
+  virtual bool ImportServerCache(const Path& path, const Variant& data) {
+    OverwriteServerCache(path, data);
+    return true;
+  }
+
   // Update the server cache at the given path with the given data, merging each
   // child into the cache.
   //
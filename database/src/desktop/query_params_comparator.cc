@@ -16,6 +16,8 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 
 #include "app/src/assert.h"
 #include "app/src/util.h"
@@ -42,60 +44,96 @@ const std::pair<Variant, Variant> QueryParamsComparator::kMinNode =  // NOLINT
 const std::pair<Variant, Variant> QueryParamsComparator::kMaxNode =  // NOLINT
     std::make_pair(QueryParamsComparator::kMaxKey, kMaxVariant);
 
-static int VariantIsSentinel(const Variant& key, const Variant& value) {
-  if (key == QueryParamsComparator::kMinKey && value == kMinVariant) {
-    return -1;
-  } else if (key == QueryParamsComparator::kMaxKey && value == kMaxVariant) {
-    return 1;
-  } else {
-    return 0;
+QueryParamsComparator::QueryParamsComparator(const QueryParams* query_params)
+    : query_params_(query_params) {
+  // Split the path once here rather than on every comparison.
+  if (query_params_ && query_params_->order_by == QueryParams::kOrderByChild) {
+    order_by_child_directories_ = std::make_shared<std::vector<std::string>>(
+        Path(query_params_->order_by_child).GetDirectories());
   }
 }
 
 int QueryParamsComparator::Compare(const Variant& key_a, const Variant& value_a,
                                    const Variant& key_b,
                                    const Variant& value_b) const {
-  assert(key_a.is_string() || key_a.is_int64());
-  assert(key_b.is_string() || key_b.is_int64());
+  return Compare(MakeSortKey(key_a, value_a), MakeSortKey(key_b, value_b));
+}
+
+QueryParamsComparator::SortKey QueryParamsComparator::MakeSortKey(
+    const KeyKey& key, const Variant& value) const {
+  SortKey sort_key;
+  sort_key.key_ = key;
+  // The special min and max nodes pair the min or max key with a sentinel
+  // value.
+  if (key.rank == 0 && value == kMinVariant) {
+    sort_key.sentinel_ = -1;
+  } else if (key.rank == 3 && value == kMaxVariant) {
+    sort_key.sentinel_ = 1;
+  } else {
+    sort_key.sentinel_ = 0;
+  }
+  if (query_params_->order_by != QueryParams::kOrderByKey) {
+    sort_key.value_ = MakeValueKey(GetOrderByValue(value));
+  }
+  return sort_key;
+}
+
+QueryParamsComparator::SortKey QueryParamsComparator::MakeSortKey(
+    const Variant& key, const Variant& value) const {
+  assert(key.is_string() || key.is_int64());
+
+  return MakeSortKey(MakeKeyKey(key), value);
+}
+
+QueryParamsComparator::SortKey QueryParamsComparator::MakeSortKey(
+    const char* key, const Variant& value) const {
+  return MakeSortKey(MakeKeyKey(key), value);
+}
 
+int QueryParamsComparator::Compare(const SortKey& a, const SortKey& b) const {
   // First check if either of our nodes is the special min or max sentinel
   // value. If that's the case, we can short circuit the rest of the comparison.
-  int min_max_a = VariantIsSentinel(key_a, value_a);
-  int min_max_b = VariantIsSentinel(key_b, value_b);
-  if (min_max_a != min_max_b) {
-    return min_max_a - min_max_b;
+  if (a.sentinel_ != b.sentinel_) {
+    return a.sentinel_ - b.sentinel_;
   }
 
   switch (query_params_->order_by) {
-    case QueryParams::kOrderByPriority: {
-      int result = ComparePriorities(value_a, value_b);
-      if (result == 0) {
-        result = CompareKeys(key_a, key_b);
-      }
-      return result;
-    }
-    case QueryParams::kOrderByChild: {
-      int result = CompareChildren(value_a, value_b);
+    case QueryParams::kOrderByPriority:
+      FIREBASE_CASE_FALLTHROUGH;
+    case QueryParams::kOrderByChild:
+      FIREBASE_CASE_FALLTHROUGH;
+    case QueryParams::kOrderByValue: {
+      // Priorities and children are compared following the same rules as
+      // values.
+      int result = CompareValueKeys(a.value_, b.value_);
       if (result == 0) {
-        result = CompareKeys(key_a, key_b);
+        result = CompareKeyKeys(a.key_, b.key_);
       }
       return result;
     }
     case QueryParams::kOrderByKey: {
-      return CompareKeys(key_a, key_b);
-    }
-    case QueryParams::kOrderByValue: {
-      int result = CompareValues(value_a, value_b);
-      if (result == 0) {
-        result = CompareKeys(key_a, key_b);
-      }
-      return result;
+      return CompareKeyKeys(a.key_, b.key_);
     }
   }
   FIREBASE_DEV_ASSERT_MESSAGE(false, "Invalid QueryParams::OrderBy");
   return 0;
 }
 
+const Variant& QueryParamsComparator::GetOrderByValue(
+    const Variant& value) const {
+  switch (query_params_->order_by) {
+    case QueryParams::kOrderByPriority:
+      return GetVariantPriority(value);
+    case QueryParams::kOrderByChild:
+      return VariantGetChild(&value, *order_by_child_directories_);
+    case QueryParams::kOrderByKey:
+      FIREBASE_CASE_FALLTHROUGH;
+    case QueryParams::kOrderByValue:
+      break;
+  }
+  return value;
+}
+
 int QueryParamsComparator::ComparePriorities(const Variant& value_a,
                                              const Variant& value_b) {
   const Variant& priority_a = GetVariantPriority(value_a);
@@ -104,54 +142,72 @@ int QueryParamsComparator::ComparePriorities(const Variant& value_a,
   return CompareValues(priority_a, priority_b);
 }
 
-int QueryParamsComparator::CompareChildren(const Variant& value_a,
-                                           const Variant& value_b) const {
-  const Path path(query_params_->order_by_child);
-  const Variant& descendant_a = VariantGetChild(&value_a, path);
-  const Variant& descendant_b = VariantGetChild(&value_b, path);
-  // Child comparisons follow the same rules as values.
-  return CompareValues(descendant_a, descendant_b);
-}
-
 int QueryParamsComparator::CompareKeys(const Variant& key_a,
                                        const Variant& key_b) {
-  if (key_a == key_b) {
-    return 0;
-  } else if (key_a == kMinKey || key_b == kMaxKey) {
-    return -1;
-  } else if (key_b == kMinKey || key_a == kMaxKey) {
-    return 1;
-  } else if (key_a.is_int64()) {
-    if (key_b.is_int64()) {
-      return key_b.int64_value() - key_a.int64_value();
-    } else {
-      return -1;
-    }
-  } else if (key_b.is_int64()) {
-    return 1;
+  return CompareKeyKeys(MakeKeyKey(key_a), MakeKeyKey(key_b));
+}
+
+QueryParamsComparator::KeyKey QueryParamsComparator::MakeKeyKey(
+    const Variant& key) {
+  KeyKey result;
+  result.int64_value = 0;
+  result.string_value = nullptr;
+  if (key.is_int64()) {
+    result.rank = 1;
+    result.int64_value = key.int64_value();
+  } else if (key == kMinKey) {
+    result.rank = 0;
+  } else if (key == kMaxKey) {
+    result.rank = 3;
+  } else {
+    result.rank = 2;
+    result.string_value = key.string_value();
+  }
+  return result;
+}
+
+QueryParamsComparator::KeyKey QueryParamsComparator::MakeKeyKey(
+    const char* key) {
+  KeyKey result;
+  result.int64_value = 0;
+  result.string_value = nullptr;
+  if (strcmp(key, kMinKey) == 0) {
+    result.rank = 0;
+  } else if (strcmp(key, kMaxKey) == 0) {
+    result.rank = 3;
   } else {
-    return strcmp(key_a.string_value(), key_b.string_value());
+    result.rank = 2;
+    result.string_value = key;
+  }
+  return result;
+}
+
+int QueryParamsComparator::CompareKeyKeys(const KeyKey& a, const KeyKey& b) {
+  // kMinKey sorts before integers, which sort before strings, which sort
+  // before kMaxKey.
+  if (a.rank != b.rank) {
+    return a.rank < b.rank ? -1 : 1;
+  }
+  switch (a.rank) {
+    case 1:
+      return a.int64_value == b.int64_value ? 0
+                                            : b.int64_value - a.int64_value;
+    case 2:
+      return strcmp(a.string_value, b.string_value);
+    default:
+      return 0;
   }
 }
 
 int QueryParamsComparator::CompareValues(const Variant& variant_a,
                                          const Variant& variant_b) {
-  const Variant* value_a = GetVariantValue(&variant_a);
-  const Variant* value_b = GetVariantValue(&variant_b);
+  return CompareValueKeys(MakeValueKey(variant_a), MakeValueKey(variant_b));
+}
+
+QueryParamsComparator::ValueKey QueryParamsComparator::MakeValueKey(
+    const Variant& variant) {
+  const Variant* value = GetVariantValue(&variant);
 
-  // The order of this enum matters. This order matches the order that RTDB
-  // organizes nodes in if they are different types.
-  enum Precedence {
-    kPrecedenceFirst,
-    kPrecedenceNull,
-    kPrecedenceBoolean,
-    kPrecedenceNumber,
-    kPrecedenceString,
-    kPrecedenceMap,
-    kPrecedenceLast,
-    kPrecedenceSentinel,
-    kPrecedenceError,
-  };
   // Map the precedence to the equivalent Variant types.
   // StaticBlob and MutableBlob values get special treatment here - they are
   // used as a speical sentinel values that will always be considered the first
@@ -170,57 +226,68 @@ int QueryParamsComparator::CompareValues(const Variant& variant_a,
       kPrecedenceError,     // kTypeMutableBlob
   };
 
-  Variant::Type type_a = value_a->type();
-  Variant::Type type_b = value_b->type();
-  Precedence precedence_a = kPrecedenceLookupTable[type_a];
-  Precedence precedence_b = kPrecedenceLookupTable[type_b];
+  ValueKey result;
+  result.precedence = kPrecedenceLookupTable[value->type()];
+  result.is_int64 = false;
+  result.bool_value = false;
+  result.int64_value = 0;
+  result.double_value = 0.0;
+  result.string_value = nullptr;
 
-  // If we encounted a special sentinel value, figure out what we actually want
-  // the precendence to be.
-  if (precedence_a == kPrecedenceSentinel) {
-    assert(*value_a == kMinVariant || *value_a == kMaxVariant);
-    precedence_a =
-        (*value_a == kMinVariant) ? kPrecedenceFirst : kPrecedenceLast;
-  }
-  if (precedence_b == kPrecedenceSentinel) {
-    assert(*value_b == kMinVariant || *value_b == kMaxVariant);
-    precedence_b =
-        (*value_b == kMinVariant) ? kPrecedenceFirst : kPrecedenceLast;
+  switch (result.precedence) {
+    case kPrecedenceSentinel: {
+      // If we encounted a special sentinel value, figure out what we actually
+      // want the precendence to be.
+      assert(*value == kMinVariant || *value == kMaxVariant);
+      result.precedence =
+          (*value == kMinVariant) ? kPrecedenceFirst : kPrecedenceLast;
+      break;
+    }
+    case kPrecedenceBoolean: {
+      result.bool_value = value->bool_value();
+      break;
+    }
+    case kPrecedenceNumber: {
+      result.is_int64 = value->is_int64();
+      if (result.is_int64) {
+        result.int64_value = value->int64_value();
+        result.double_value = static_cast<double>(result.int64_value);
+      } else {
+        result.double_value = value->double_value();
+      }
+      break;
+    }
+    case kPrecedenceString: {
+      result.string_value = value->string_value();
+      break;
+    }
+    default:
+      break;
   }
 
   // Values coming down from the server should never contain blobs or vectors.
-  assert(precedence_a != kPrecedenceError);
-  assert(precedence_b != kPrecedenceError);
+  assert(result.precedence != kPrecedenceError);
+  return result;
+}
 
+int QueryParamsComparator::CompareValueKeys(const ValueKey& a,
+                                            const ValueKey& b) {
   // If we have different priorities we don't need to compare the values
   // themselves. Just return the difference between the priorities.
-  if (precedence_a != precedence_b) {
-    return precedence_a - precedence_b;
+  if (a.precedence != b.precedence) {
+    return a.precedence - b.precedence;
   }
 
   // If the priority is the same we need to compare the value of the types.
-  switch (precedence_a) {
-    case kPrecedenceFirst: {
-      // Two first elements are equal. Once can't be more first than the other.
-      return 0;
-    }
-    case kPrecedenceNull: {
-      // Null types are always equal to other null types.
-      return 0;
-    }
+  switch (a.precedence) {
     case kPrecedenceBoolean: {
-      return (value_a->bool_value() == value_b->bool_value())
-                 ? 0
-                 : (value_a->bool_value() ? 1 : -1);
+      return (a.bool_value == b.bool_value) ? 0 : (a.bool_value ? 1 : -1);
     }
     case kPrecedenceNumber: {
       // If they're both integers.
-      if (type_a == Variant::kTypeInt64 && type_b == Variant::kTypeInt64) {
-        int64_t int64_a = value_a->int64_value();
-        int64_t int64_b = value_b->int64_value();
-
-        if (int64_a < int64_b) return -1;
-        if (int64_a > int64_b) return 1;
+      if (a.is_int64 && b.is_int64) {
+        if (a.int64_value < b.int64_value) return -1;
+        if (a.int64_value > b.int64_value) return 1;
         return 0;
       }
 
@@ -229,35 +296,29 @@ int QueryParamsComparator::CompareValues(const Variant& variant_a,
       // certain values int64 values that can't be perfectly cast to doubles.
       // Look into improving this comparison. This is good enough for now
       // though, since it's what the Android imlementation does.
-      assert(type_a == Variant::kTypeDouble || type_b == Variant::kTypeDouble);
-      double double_a = (type_a == Variant::kTypeDouble)
-                            ? value_a->double_value()
-                            : static_cast<double>(value_a->int64_value());
-      double double_b = (type_b == Variant::kTypeDouble)
-                            ? value_b->double_value()
-                            : static_cast<double>(value_b->int64_value());
-
-      if (double_a < double_b) return -1;
-      if (double_a > double_b) return 1;
+      if (a.double_value < b.double_value) return -1;
+      if (a.double_value > b.double_value) return 1;
       return 0;
     }
     case kPrecedenceString: {
-      return strcmp(value_a->string_value(), value_b->string_value());
+      return strcmp(a.string_value, b.string_value);
     }
-    case kPrecedenceMap: {
+    case kPrecedenceFirst:
+      // Two first elements are equal. Once can't be more first than the other.
+    case kPrecedenceNull:
+      // Null types are always equal to other null types.
+    case kPrecedenceMap:
       // Maps are not compared against each other. Treat them as equal.
-      return 0;
-    }
-    case kPrecedenceLast: {
+    case kPrecedenceLast:
       // Two last elements are equal. Once can't be more last than the other.
       return 0;
-    }
     case kPrecedenceSentinel:
       FIREBASE_CASE_FALLTHROUGH;
     case kPrecedenceError: {
       // Assert for this condition should be caught above, but it's included
       // here for completeness sake (and lint).
       assert(0);
+      return 0;
     }
   }
   return 0;
@@ -15,9 +15,14 @@
 #ifndef FIREBASE_DATABASE_SRC_DESKTOP_QUERY_PARAMS_COMPARATOR_H_
 #define FIREBASE_DATABASE_SRC_DESKTOP_QUERY_PARAMS_COMPARATOR_H_
 
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "app/src/include/firebase/variant.h"
+#include "app/src/path.h"
 #include "database/src/common/query_spec.h"
 
 namespace firebase {
@@ -60,17 +65,74 @@ namespace internal {
 //      * If both are maps, return 0.
 //    If the result ended up being 0, the keys are compared using the
 //    kOrderByKey rules.
+//
+// When the same children are compared many times, such as when sorting them,
+// use MakeSortKey() to extract what they are ordered by once and compare the
+// resulting SortKeys instead.
 class QueryParamsComparator {
+ private:
+  // The order of this enum matters. This order matches the order that RTDB
+  // organizes nodes in if they are different types.
+  enum Precedence {
+    kPrecedenceFirst,
+    kPrecedenceNull,
+    kPrecedenceBoolean,
+    kPrecedenceNumber,
+    kPrecedenceString,
+    kPrecedenceMap,
+    kPrecedenceLast,
+    kPrecedenceSentinel,
+    kPrecedenceError,
+  };
+
+  // The parts of a value that are compared using the kOrderByValue rules.
+  struct ValueKey {
+    Precedence precedence;
+    bool is_int64;
+    bool bool_value;
+    int64_t int64_value;
+    double double_value;
+    const char* string_value;
+  };
+
+  // The parts of a key that are compared using the kOrderByKey rules.
+  struct KeyKey {
+    // 0 for kMinKey, 1 for integers, 2 for strings and 3 for kMaxKey.
+    int rank;
+    int64_t int64_value;
+    const char* string_value;
+  };
+
  public:
+  // What a child is ordered by, extracted from its key and value.  A SortKey
+  // points into the key and value it was made from, so they must outlive it.
+  class SortKey {
+   private:
+    friend class QueryParamsComparator;
+
+    // -1 for kMinNode, 1 for kMaxNode and 0 for anything else.
+    int sentinel_;
+    // The value of the child the query orders by.  Unused for kOrderByKey.
+    ValueKey value_;
+    KeyKey key_;
+  };
+
   QueryParamsComparator() : query_params_(nullptr) {}
 
-  explicit QueryParamsComparator(const QueryParams* query_params)
-      : query_params_(query_params) {}
+  explicit QueryParamsComparator(const QueryParams* query_params);
 
   // Compare two database values given their key and value.
   int Compare(const Variant& key_a, const Variant& value_a,
               const Variant& key_b, const Variant& value_b) const;
 
+  // Extract what a child is ordered by.
+  SortKey MakeSortKey(const Variant& key, const Variant& value) const;
+  SortKey MakeSortKey(const char* key, const Variant& value) const;
+
+  // Compare two children given their SortKeys.  Gives the same result as
+  // comparing their keys and values.
+  int Compare(const SortKey& a, const SortKey& b) const;
+
   // Compare two database values given their key and value.
   int Compare(const std::pair<Variant, Variant>& a,
               const std::pair<Variant, Variant>& b) const {
@@ -92,9 +154,23 @@ class QueryParamsComparator {
   static const std::pair<Variant, Variant> kMaxNode;
 
  private:
-  int CompareChildren(const Variant& value_a, const Variant& value_b) const;
+  SortKey MakeSortKey(const KeyKey& key, const Variant& value) const;
+
+  // Returns the value that is compared for the given child value.
+  const Variant& GetOrderByValue(const Variant& value) const;
+
+  static ValueKey MakeValueKey(const Variant& variant);
+  static KeyKey MakeKeyKey(const Variant& key);
+  static KeyKey MakeKeyKey(const char* key);
+
+  static int CompareValueKeys(const ValueKey& a, const ValueKey& b);
+  static int CompareKeyKeys(const KeyKey& a, const KeyKey& b);
 
   const QueryParams* query_params_;
+
+  // query_params_->order_by_child split into directories, for kOrderByChild.
+  // Shared, so that copies of the comparator don't allocate.
+  std::shared_ptr<const std::vector<std::string>> order_by_child_directories_;
 };
 
 // A helper class that allows you to use a QueryParamsComparator in a std::set
@@ -127,6 +127,18 @@ const Variant& VariantGetChild(const Variant* variant, const std::string& key) {
   return VariantGetChild(variant, Path(key));
 }
 
+const Variant& VariantGetChild(const Variant* variant,
+                               const std::vector<std::string>& directories) {
+  for (const std::string& directory : directories) {
+    if (VariantIsLeaf(*variant)) {
+      return IsPriorityKey(directory) ? GetVariantPriority(*variant)
+                                      : kNullVariant;
+    }
+    variant = &VariantGetImmediateChild(variant, directory);
+  }
+  return *variant;
+}
+
 void VariantUpdateChild(Variant* variant, const Path& path,
                         const Variant& value) {
   std::string front = path.FrontDirectory().str();
@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "app/src/include/firebase/variant.h"
 #include "app/src/path.h"
@@ -93,6 +94,12 @@ bool PatchVariant(const Variant& patch_data, Variant* out_data);
 const Variant& VariantGetChild(const Variant* variant, const Path& path);
 const Variant& VariantGetChild(const Variant* variant, const std::string& key);
 
+// Same as VariantGetChild(variant, path), given the result of
+// path.GetDirectories().  Use this when looking up the same path in many
+// variants so that the path is only parsed once.
+const Variant& VariantGetChild(const Variant* variant,
+                               const std::vector<std::string>& directories);
+
 // Update the child of variant at the given path with value. If necessary this
 // will convert the given Variant into a map and recursively add child map
 // Variants as needed.
@@ -18,6 +18,7 @@
 #include <cassert>
 #include <cstring>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "app/src/assert.h"
@@ -79,18 +80,21 @@ std::vector<Event> GenerateEventsForChanges(
   return events;
 }
 
+// A change together with the key it is sorted by.
+typedef std::pair<QueryParamsComparator::SortKey, const Change*>
+    SortableChange;
+
 class ChangeLesser {
  public:
-  ChangeLesser(const QueryParams* query_params) : comparator_(query_params) {}
+  ChangeLesser(const QueryParamsComparator* comparator)
+      : comparator_(comparator) {}
 
-  bool operator()(const Change* a, const Change* b) const {
-    return comparator_.Compare(
-               a->child_key.c_str(), a->indexed_variant.variant(),
-               b->child_key.c_str(), b->indexed_variant.variant()) < 0;
+  bool operator()(const SortableChange& a, const SortableChange& b) const {
+    return comparator_->Compare(a.first, b.first) < 0;
   }
 
  private:
-  QueryParamsComparator comparator_;
+  const QueryParamsComparator* comparator_;
 };
 
 void GenerateEventsForType(
@@ -98,7 +102,8 @@ void GenerateEventsForType(
     const std::vector<Change>& changes,
     const std::vector<std::unique_ptr<EventRegistration>>& event_registrations,
     const IndexedVariant& event_cache, std::vector<Event>* events) {
-  std::vector<const Change*> filtered_changes;
+  QueryParamsComparator comparator(&query_spec.params);
+  std::vector<SortableChange> filtered_changes;
   filtered_changes.reserve(changes.size());
   for (auto iter = changes.begin(); iter != changes.end(); ++iter) {
     const Change& change = *iter;
@@ -107,12 +112,15 @@ void GenerateEventsForType(
                                   "Child changes must have a child_key");
     }
     if (change.event_type == event_type) {
-      filtered_changes.push_back(&change);
+      filtered_changes.push_back(std::make_pair(
+          comparator.MakeSortKey(change.child_key.c_str(),
+                                 change.indexed_variant.variant()),
+          &change));
     }
   }
 
   std::sort(filtered_changes.begin(), filtered_changes.end(),
-            ChangeLesser(&query_spec.params));
+            ChangeLesser(&comparator));
 
   if (event_type == kEventTypeValue) {
     FIREBASE_DEV_ASSERT_MESSAGE(filtered_changes.size() <= 1,
@@ -121,7 +129,7 @@ void GenerateEventsForType(
 
   for (auto change_iter = filtered_changes.begin();
        change_iter != filtered_changes.end(); ++change_iter) {
-    const Change* change = *change_iter;
+    const Change* change = change_iter->second;
     for (auto registration_iter = event_registrations.begin();
          registration_iter != event_registrations.end(); ++registration_iter) {
       const std::unique_ptr<EventRegistration>& registration =
@@ -163,6 +163,65 @@ class Database {
   /// (disk) storage, or false to discard pending writes when the app exists.
   void set_persistence_enabled(bool enabled);
 
+  /// Sets whether queries ordered by child are answered from indexes when
+  /// reading the on-disk cache.
+  ///
+  /// When enabled, the first time a query ordered by child with a limit or a
+  /// range reads a cached location, an index of the location's children
+  /// ordered by that child is built and kept up to date as the cache changes.
+  /// Later reads of such queries only load the matching children rather than
+  /// the whole location. Building an index loads the whole location once,
+  /// the same as a read without an index, so the first such read of a
+  /// location is no faster. The indexes take up additional disk space and
+  /// make writes to indexed locations slower.
+  ///
+  /// @note This is only supported on desktop, and only has an effect if
+  /// persistence is enabled. Like set_persistence_enabled, it must be called
+  /// before creating any instances of DatabaseReference.
+  ///
+  /// @param[in] enabled Set this to true to index the on-disk cache for
+  /// queries, or false to remove any indexes. Disabled by default.
+  void set_persistence_query_indexing_enabled(bool enabled);
+
+  /// Sets the maximum number of writes that can be sent to the server before
+  /// the server acknowledges them.
+  ///
+  /// By default every write is sent as soon as it is made. With a limit,
+  /// writes are sent in batches, and a write that waits to be sent is
+  /// combined with later writes: a write replaced by a later write to the same
+  /// location or to a parent location is not sent, and consecutive
+  /// UpdateChildren calls on the same location are sent as one update. The
+  /// Future returned for every write still completes, in order. This reduces
+  /// network traffic for apps that write to the same locations frequently.
+  ///
+  /// @note This is only supported on desktop. It must be called before
+  /// creating any instances of DatabaseReference.
+  ///
+  /// @param[in] max_in_flight_writes Maximum number of writes waiting for an
+  /// acknowledgement from the server, or 0 for no limit. Defaults to 0.
+  void set_max_in_flight_writes(int max_in_flight_writes);
+
+  /// Imports a snapshot of the data at a location from a file into the
+  /// on-disk cache, so that the data is available before it is first synced
+  /// from the server.
+  ///
+  /// The file holds the data at the location either as JSON, if its name ends
+  /// in ".json", or as a FlexBuffer. The data is imported when the database
+  /// starts, as if a listener at the location had received it from the
+  /// server, without raising any events. The file is not imported if the
+  /// cache already holds complete data for the location, so this can be
+  /// called each time the app starts. Like other cached data, the imported
+  /// data is evicted when the cache grows too large.
+  ///
+  /// @note This is only supported on desktop, and only has an effect if
+  /// persistence is enabled. It must be called before creating any instances
+  /// of DatabaseReference.
+  ///
+  /// @param[in] path Path of the location the snapshot is of, or "" for the
+  /// root of the database.
+  /// @param[in] file_path Path of the file to import.
+  void ImportPersistenceCache(const char* path, const char* file_path);
+
   /// Set the log verbosity of this Database instance.
   ///
   /// The log filtering is cumulative with Firebase App. That is, this library's
@@ -0,0 +1,316 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "database/src/desktop/connection/outstanding_put_queue.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "database/src/desktop/connection/persistent_connection.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+namespace firebase {
+namespace database {
+namespace internal {
+namespace connection {
+
+namespace {
+
+// A response that remembers which write it belongs to.
+class NamedResponse : public Response {
+ public:
+  explicit NamedResponse(const std::string& name)
+      : Response(nullptr), name(name) {}
+
+  std::string name;
+};
+
+class OutstandingPutQueueTest : public ::testing::Test {
+ protected:
+  uint64_t Put(const std::string& name, const char* path,
+               const Variant& data) {
+    return queue_.Add(std::make_unique<OutstandingPut>(
+        "p", Path(path), data, Optional<std::string>(),
+        std::make_shared<NamedResponse>(name)));
+  }
+
+  uint64_t Merge(const std::string& name, const char* path,
+                 const std::map<Variant, Variant>& children) {
+    return queue_.Add(std::make_unique<OutstandingPut>(
+        "m", Path(path), Variant(children), Optional<std::string>(),
+        std::make_shared<NamedResponse>(name)));
+  }
+
+  uint64_t Transaction(const std::string& name, const char* path,
+                       const Variant& data) {
+    return queue_.Add(std::make_unique<OutstandingPut>(
+        "p", Path(path), data, Optional<std::string>("hash"),
+        std::make_shared<NamedResponse>(name)));
+  }
+
+  // Returns the names of the responses of a write, in completion order.
+  static std::vector<std::string> ResponseNames(const OutstandingPut& put) {
+    std::vector<ResponsePtr> responses;
+    OutstandingPutQueue::GetResponses(put, &responses);
+    std::vector<std::string> names;
+    for (const auto& response : responses) {
+      names.push_back(response
+                          ? static_cast<NamedResponse*>(response.get())->name
+                          : "(none)");
+    }
+    return names;
+  }
+
+  // Reject a write, collecting the transactions it aborts in aborted_.
+  OutstandingPutPtr Reject(uint64_t write_id) {
+    return queue_.Reject(write_id, &aborted_);
+  }
+
+  // Returns the paths of the writes sent next.
+  std::vector<std::string> SendPaths(int max_in_flight = 0) {
+    std::vector<std::string> paths;
+    for (uint64_t write_id : queue_.StartSending(max_in_flight)) {
+      paths.push_back(queue_.Find(write_id)->path.str());
+    }
+    return paths;
+  }
+
+  OutstandingPutQueue queue_;
+  std::vector<OutstandingPutPtr> aborted_;
+};
+
+}  // namespace
+
+TEST_F(OutstandingPutQueueTest, OverwriteCompactsWritesBelowIt) {
+  Put("a", "a", 1);
+  Put("b", "a/b", 2);
+  Put("other", "c", 3);
+  uint64_t last = Put("last", "a", 4);
+
+  std::vector<uint64_t> sent = queue_.StartSending(0);
+  ASSERT_THAT(sent.size(), Eq(2));
+  EXPECT_THAT(queue_.Find(sent[0])->path.str(), Eq("c"));
+  EXPECT_THAT(sent[1], Eq(last));
+
+  // The compacted writes complete first, in the order they were written.
+  OutstandingPutPtr put = queue_.Acknowledge(last);
+  ASSERT_THAT(put, NotNull());
+  EXPECT_THAT(ResponseNames(*put), ElementsAre("a", "b", "last"));
+  EXPECT_THAT(queue_.in_flight(), Eq(1));
+}
+
+TEST_F(OutstandingPutQueueTest, OverwriteAtRootCompactsEverything) {
+  Put("a", "a", 1);
+  Put("b", "b/c", 2);
+  uint64_t root = Put("root", "", Variant::Null());
+
+  EXPECT_THAT(queue_.StartSending(0), ElementsAre(root));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(root)),
+              ElementsAre("a", "b", "root"));
+}
+
+TEST_F(OutstandingPutQueueTest, OverwriteDoesNotCompactSiblings) {
+  Put("ab", "a/b", 1);
+  Put("abc", "a/bc", 2);
+  uint64_t overwrite = Put("overwrite", "a/b", 3);
+
+  EXPECT_THAT(SendPaths(), ElementsAre("a/bc", "a/b"));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(overwrite)),
+              ElementsAre("ab", "overwrite"));
+}
+
+TEST_F(OutstandingPutQueueTest, CompactionStopsAtSentWritesAndTransactions) {
+  Put("sent", "a", 1);
+  EXPECT_THAT(SendPaths(), ElementsAre("a"));
+  Put("before transaction", "a", 2);
+  Transaction("transaction", "b", 3);
+  uint64_t last = Put("last", "a", 4);
+
+  EXPECT_THAT(SendPaths(), ElementsAre("a", "b", "a"));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(last)), ElementsAre("last"));
+}
+
+TEST_F(OutstandingPutQueueTest, MergesAtTheSamePathAreCombined) {
+  Merge("first", "a", {{"x", 1}, {"y", 2}});
+  uint64_t second = Merge("second", "a", {{"y", 3}, {"z", 4}});
+
+  std::vector<uint64_t> sent = queue_.StartSending(0);
+  ASSERT_THAT(sent, ElementsAre(second));
+  EXPECT_THAT(queue_.Find(second)->data,
+              Eq(Variant(std::map<Variant, Variant>{
+                  {"x", 1}, {"y", 3}, {"z", 4}})));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(second)),
+              ElementsAre("first", "second"));
+}
+
+TEST_F(OutstandingPutQueueTest, MergesThatOverlapAreNotCombined) {
+  Merge("first", "a", {{"x/y", 1}});
+  Merge("other path", "b", {{"x", 1}});
+  Merge("second", "a", {{"x/y", 2}});
+  // The server rejects merges with a child below another child.
+  Merge("third", "a", {{"x/y/z", 3}});
+
+  EXPECT_THAT(SendPaths(), ElementsAre("a", "b", "a", "a"));
+}
+
+TEST_F(OutstandingPutQueueTest, RejectedOverwriteSendsCompactedWritesAgain) {
+  Put("a", "a", 1);
+  Put("b", "a/b", 2);
+  uint64_t last = Put("last", "a", 3);
+  EXPECT_THAT(SendPaths(), ElementsAre("a"));
+
+  // The overwrite fails on its own, and the writes it replaced are sent
+  // again in their original order.
+  OutstandingPutPtr rejected = Reject(last);
+  ASSERT_THAT(rejected, NotNull());
+  EXPECT_THAT(ResponseNames(*rejected), ElementsAre("last"));
+  EXPECT_THAT(queue_.in_flight(), Eq(0));
+
+  std::vector<uint64_t> sent = queue_.StartSending(0);
+  ASSERT_THAT(sent.size(), Eq(2));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(sent[0])), ElementsAre("a"));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(sent[1])), ElementsAre("b"));
+}
+
+TEST_F(OutstandingPutQueueTest, RejectedMergeIsSentAgainAsWritten) {
+  uint64_t first = Merge("first", "a", {{"x", 1}});
+  uint64_t second = Merge("second", "a", {{"y", 2}});
+  EXPECT_THAT(queue_.StartSending(0), ElementsAre(second));
+
+  // Either merge may have been the one that failed, so both are sent again
+  // and complete on their own.
+  EXPECT_THAT(Reject(second), IsNull());
+  EXPECT_THAT(queue_.StartSending(0), ElementsAre(first, second));
+  EXPECT_THAT(queue_.Find(second)->data,
+              Eq(Variant(std::map<Variant, Variant>{{"y", 2}})));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(first)),
+              ElementsAre("first"));
+  EXPECT_THAT(ResponseNames(*Reject(second)), ElementsAre("second"));
+}
+
+TEST_F(OutstandingPutQueueTest, RejectKeepsLaterWritesLast) {
+  Put("a", "a", 1);
+  uint64_t overwrite = Put("overwrite", "a", 2);
+  EXPECT_THAT(SendPaths(), ElementsAre("a"));
+  uint64_t in_flight = Put("in flight", "a/b", 3);
+  EXPECT_THAT(SendPaths(), ElementsAre("a/b"));
+  Put("queued", "a/c", 4);
+  Put("unrelated", "d", 5);
+
+  Reject(overwrite);
+
+  // The write queued again is sent first, then the later writes it would
+  // overwrite.  The one in flight is sent again without a response.
+  std::vector<uint64_t> sent = queue_.StartSending(0);
+  std::vector<std::string> names;
+  for (uint64_t write_id : sent) {
+    names.push_back(ResponseNames(*queue_.Find(write_id)).back());
+  }
+  EXPECT_THAT(names, ElementsAre("a", "unrelated", "(none)", "queued"));
+
+  // The response of the write in flight is still reported.
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(in_flight)),
+              ElementsAre("in flight"));
+}
+
+TEST_F(OutstandingPutQueueTest, RejectAbortsLaterTransactionsInFlight) {
+  Put("a", "a", 1);
+  uint64_t overwrite = Put("overwrite", "a", 2);
+  EXPECT_THAT(SendPaths(), ElementsAre("a"));
+  uint64_t transaction = Transaction("transaction", "a/b", 3);
+  EXPECT_THAT(SendPaths(), ElementsAre("a/b"));
+  EXPECT_THAT(queue_.in_flight(), Eq(2));
+
+  // The transaction expected the data of the overwrite, so it is aborted to
+  // be run again rather than sent again without its hash.
+  Reject(overwrite);
+  ASSERT_THAT(aborted_.size(), Eq(1));
+  EXPECT_THAT(ResponseNames(*aborted_[0]), ElementsAre("transaction"));
+  EXPECT_THAT(queue_.Find(transaction), IsNull());
+  EXPECT_THAT(queue_.in_flight(), Eq(0));
+  EXPECT_THAT(SendPaths(), ElementsAre("a"));
+
+  // Its response is ignored.
+  EXPECT_THAT(queue_.Acknowledge(transaction), IsNull());
+}
+
+TEST_F(OutstandingPutQueueTest, InFlightWindow) {
+  Put("a", "a", 1);
+  Put("b", "b", 2);
+  Put("c", "c", 3);
+
+  std::vector<uint64_t> sent = queue_.StartSending(2);
+  EXPECT_THAT(sent.size(), Eq(2));
+  EXPECT_THAT(queue_.in_flight(), Eq(2));
+  EXPECT_THAT(queue_.StartSending(2), IsEmpty());
+
+  queue_.Acknowledge(sent[0]);
+  EXPECT_THAT(queue_.in_flight(), Eq(1));
+  EXPECT_THAT(SendPaths(2), ElementsAre("c"));
+  EXPECT_FALSE(queue_.HasWritesToSend());
+}
+
+TEST_F(OutstandingPutQueueTest, WritesWaitingForTheWindowAreCompacted) {
+  uint64_t sent = Put("sent", "a", 1);
+  EXPECT_THAT(SendPaths(1), ElementsAre("a"));
+
+  // The window is full, so these wait and are compacted.
+  Put("waiting", "b/c", 2);
+  Merge("first", "d", {{"x", 1}});
+  uint64_t second = Merge("second", "d", {{"y", 2}});
+  uint64_t overwrite = Put("overwrite", "b", 3);
+  EXPECT_THAT(queue_.StartSending(1), IsEmpty());
+
+  queue_.Acknowledge(sent);
+  EXPECT_THAT(queue_.StartSending(1), ElementsAre(second));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(second)),
+              ElementsAre("first", "second"));
+  EXPECT_THAT(queue_.StartSending(1), ElementsAre(overwrite));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(overwrite)),
+              ElementsAre("waiting", "overwrite"));
+}
+
+TEST_F(OutstandingPutQueueTest, WritesInFlightAreSentAgainAfterReconnecting) {
+  Put("a", "a", 1);
+  Transaction("transaction", "b", 2);
+  Put("c", "c", 3);
+  EXPECT_THAT(SendPaths(2), ElementsAre("a", "b"));
+
+  queue_.OnDisconnect();
+  EXPECT_THAT(queue_.in_flight(), Eq(0));
+
+  // Transactions that were sent fail on a disconnect.
+  std::vector<OutstandingPutPtr> transactions = queue_.RemoveSentTransactions();
+  ASSERT_THAT(transactions.size(), Eq(1));
+  EXPECT_THAT(ResponseNames(*transactions[0]), ElementsAre("transaction"));
+
+  // Writes that were sent are not compacted after reconnecting.
+  uint64_t overwrite = Put("overwrite", "a", 4);
+  EXPECT_THAT(SendPaths(), ElementsAre("a", "c", "a"));
+  EXPECT_THAT(ResponseNames(*queue_.Acknowledge(overwrite)),
+              ElementsAre("overwrite"));
+}
+
+}  // namespace connection
+}  // namespace internal
+}  // namespace database
+}  // namespace firebase
@@ -14,6 +14,9 @@
 
 #include "database/src/desktop/connection/web_socket_client_impl.h"
 
+#include <memory>
+#include <string>
+
 #include "app/src/semaphore.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -157,9 +160,9 @@ class TestClientEventHandler : public WebSocketClientEventHandler {
     semaphore_->Post();
   }
 
-  void OnMessage(const char* msg) override {
+  void OnMessage(const char* msg, size_t length) override {
     is_msg_received_ = true;
-    msg_received_ = msg;
+    msg_received_.assign(msg, length);
     semaphore_->Post();
   }
 
@@ -226,6 +229,44 @@ TEST(WebSocketClientImpl, Test1) {
   server.Stop();
 }
 
+// Test that messages are sent and received with their length, so they may
+// contain null characters.
+TEST(WebSocketClientImpl, TestLengthDelimitedMessage) {
+  TestWebSocketEchoServer server(0);
+  server.Start();
+
+  auto uri = GetLocalHostUri(server.GetPort(true));
+
+  Semaphore semaphore(1);
+  TestClientEventHandler handler(&semaphore);
+  Logger logger(nullptr);
+  scheduler::Scheduler scheduler;
+  WebSocketClientImpl ws_client(uri.c_str(), "", &logger, &scheduler, "",
+                                &handler);
+
+  EXPECT_TRUE(semaphore.TryWait());
+  ws_client.Connect(5000);
+  semaphore.Wait();
+  semaphore.Post();
+  EXPECT_TRUE(handler.is_connected_ && !handler.is_error_);
+
+  const std::string message("Hello\0World", 11);
+  EXPECT_TRUE(semaphore.TryWait());
+  ws_client.Send(message.data(), message.size());
+  semaphore.Wait();
+  semaphore.Post();
+  EXPECT_TRUE(handler.is_msg_received_ && !handler.is_error_);
+  EXPECT_EQ(message, handler.msg_received_);
+
+  EXPECT_TRUE(semaphore.TryWait());
+  ws_client.Close();
+  semaphore.Wait();
+  semaphore.Post();
+  EXPECT_TRUE(handler.is_closed_ && !handler.is_error_);
+
+  server.Stop();
+}
+
 // Test if it is safe to create the client and destroy it immediately.
 // This is to test if the destructor can properly end the event loop.
 // Otherwise, it would block forever and timeout
@@ -264,6 +305,85 @@ TEST(WebSocketClientImpl, TestEdgeCase2) {
   server.Stop();
 }
 
+// Test that clients sharing the event loop each receive their own messages,
+// and that destroying one of them leaves the other connected.
+TEST(WebSocketClientImpl, TestSharedEventLoop) {
+  TestWebSocketEchoServer server(0);
+  server.Start();
+
+  auto uri = GetLocalHostUri(server.GetPort(true));
+
+  Logger logger(nullptr);
+  scheduler::Scheduler scheduler;
+  Semaphore semaphore1(1);
+  TestClientEventHandler handler1(&semaphore1);
+  WebSocketClientImpl ws_client1(uri.c_str(), "", &logger, &scheduler, "",
+                                 &handler1);
+  Semaphore semaphore2(1);
+  TestClientEventHandler handler2(&semaphore2);
+  auto ws_client2 = std::make_unique<WebSocketClientImpl>(
+      uri.c_str(), "", &logger, &scheduler, "", &handler2);
+
+  EXPECT_TRUE(semaphore1.TryWait());
+  EXPECT_TRUE(semaphore2.TryWait());
+  ws_client1.Connect(5000);
+  ws_client2->Connect(5000);
+  semaphore1.Wait();
+  semaphore2.Wait();
+  EXPECT_TRUE(handler1.is_connected_ && !handler1.is_error_);
+  EXPECT_TRUE(handler2.is_connected_ && !handler2.is_error_);
+
+  ws_client1.Send("Hello from 1");
+  ws_client2->Send("Hello from 2");
+  semaphore1.Wait();
+  semaphore2.Wait();
+  EXPECT_EQ("Hello from 1", handler1.msg_received_);
+  EXPECT_EQ("Hello from 2", handler2.msg_received_);
+
+  // Destroying the second client while it is connected must not affect the
+  // first one.
+  ws_client2.reset();
+  handler1.is_msg_received_ = false;
+  ws_client1.Send("Still here");
+  semaphore1.Wait();
+  EXPECT_TRUE(handler1.is_msg_received_ && !handler1.is_error_);
+  EXPECT_EQ("Still here", handler1.msg_received_);
+
+  ws_client1.Close();
+  semaphore1.Wait();
+  EXPECT_TRUE(handler1.is_closed_ && !handler1.is_error_);
+
+  server.Stop();
+}
+
+// Test that a client can be destroyed while connected, and that the event
+// loop, stopped along with the last client, is started again for the next one.
+TEST(WebSocketClientImpl, TestDestroyWhileConnected) {
+  TestWebSocketEchoServer server(0);
+  server.Start();
+
+  auto uri = GetLocalHostUri(server.GetPort(true));
+
+  Logger logger(nullptr);
+  scheduler::Scheduler scheduler;
+  for (int i = 0; i < 2; ++i) {
+    Semaphore semaphore(0);
+    TestClientEventHandler handler(&semaphore);
+    WebSocketClientImpl ws_client(uri.c_str(), "", &logger, &scheduler, "",
+                                  &handler);
+    ws_client.Connect(5000);
+    semaphore.Wait();
+    EXPECT_TRUE(handler.is_connected_ && !handler.is_error_);
+
+    ws_client.Send("Hello World");
+    semaphore.Wait();
+    EXPECT_EQ("Hello World", handler.msg_received_);
+    // ws_client is destroyed with its connection still open.
+  }
+
+  server.Stop();
+}
+
 }  // namespace connection
 }  // namespace internal
 }  // namespace database
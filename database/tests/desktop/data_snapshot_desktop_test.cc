@@ -0,0 +1,171 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "database/src/desktop/data_snapshot_desktop.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "app/src/variant_util.h"
+#include "database/src/common/query_spec.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace firebase {
+namespace database {
+namespace internal {
+
+namespace {
+
+std::vector<std::string> ChildKeys(DataSnapshotInternal* snapshot) {
+  std::vector<std::string> keys;
+  for (const auto& child : snapshot->GetChildViews()) {
+    keys.push_back(child.key());
+  }
+  return keys;
+}
+
+QuerySpec MakeQuerySpec(QueryParams::OrderBy order_by,
+                        const std::string& order_by_child = "") {
+  QueryParams params;
+  params.order_by = order_by;
+  params.order_by_child = order_by_child;
+  return QuerySpec(Path("test"), params);
+}
+
+}  // namespace
+
+TEST(DataSnapshotDesktopTest, ChildViewsWithoutChildren) {
+  DataSnapshotInternal null_snapshot(nullptr, Variant::Null(), QuerySpec());
+  EXPECT_TRUE(null_snapshot.GetChildViews().empty());
+
+  DataSnapshotInternal leaf(nullptr, Variant(10), QuerySpec());
+  EXPECT_TRUE(leaf.GetChildViews().empty());
+
+  // A value with a priority has no children.
+  DataSnapshotInternal leaf_with_priority(
+      nullptr, util::JsonToVariant("{\".value\":10,\".priority\":1}"),
+      QuerySpec());
+  EXPECT_TRUE(leaf_with_priority.GetChildViews().empty());
+}
+
+TEST(DataSnapshotDesktopTest, ChildViewsOrderByKey) {
+  // The priority of the snapshot itself is not a child.
+  DataSnapshotInternal snapshot(
+      nullptr,
+      util::JsonToVariant("{\"c\":1,\"a\":2,\"b\":3,\".priority\":4}"),
+      MakeQuerySpec(QueryParams::kOrderByKey));
+  EXPECT_THAT(ChildKeys(&snapshot), ElementsAre("a", "b", "c"));
+
+  const auto& views = snapshot.GetChildViews();
+  ASSERT_THAT(views.size(), Eq(3));
+  EXPECT_THAT(views[0].value(), Eq(Variant(2)));
+  EXPECT_THAT(views[0].key_variant(), Eq(Variant("a")));
+}
+
+TEST(DataSnapshotDesktopTest, ChildViewsOrderByValue) {
+  DataSnapshotInternal snapshot(
+      nullptr, util::JsonToVariant("{\"a\":3,\"b\":1,\"c\":2,\"d\":1}"),
+      MakeQuerySpec(QueryParams::kOrderByValue));
+  // Equal values are ordered by key.
+  EXPECT_THAT(ChildKeys(&snapshot), ElementsAre("b", "d", "c", "a"));
+}
+
+TEST(DataSnapshotDesktopTest, ChildViewsOrderByPriority) {
+  DataSnapshotInternal snapshot(
+      nullptr,
+      util::JsonToVariant("{\"a\":{\".value\":1,\".priority\":3},"
+                          "\"b\":{\".value\":2,\".priority\":1},"
+                          "\"c\":3}"),
+      MakeQuerySpec(QueryParams::kOrderByPriority));
+  // Children without a priority come first.
+  EXPECT_THAT(ChildKeys(&snapshot), ElementsAre("c", "b", "a"));
+}
+
+TEST(DataSnapshotDesktopTest, ChildViewsOrderByChild) {
+  DataSnapshotInternal snapshot(
+      nullptr,
+      util::JsonToVariant("{\"a\":{\"score\":{\"value\":2}},"
+                          "\"b\":{\"score\":{\"value\":1}},"
+                          "\"c\":{\"other\":0}}"),
+      MakeQuerySpec(QueryParams::kOrderByChild, "score/value"));
+  // Children missing the nested child come first.
+  EXPECT_THAT(ChildKeys(&snapshot), ElementsAre("c", "b", "a"));
+}
+
+TEST(DataSnapshotDesktopTest, ChildViewsAreCached) {
+  DataSnapshotInternal snapshot(
+      nullptr, util::JsonToVariant("{\"a\":2,\"b\":1}"),
+      MakeQuerySpec(QueryParams::kOrderByValue));
+  const auto& views = snapshot.GetChildViews();
+  EXPECT_THAT(&snapshot.GetChildViews(), Eq(&views));
+  EXPECT_THAT(ChildKeys(&snapshot), ElementsAre("b", "a"));
+
+  // Replacing the snapshot's data invalidates the cached views.
+  snapshot = DataSnapshotInternal(nullptr, util::JsonToVariant("{\"c\":1}"),
+                                  MakeQuerySpec(QueryParams::kOrderByValue));
+  EXPECT_THAT(ChildKeys(&snapshot), ElementsAre("c"));
+}
+
+TEST(DataSnapshotDesktopTest, ChildrenOutliveTheirParent) {
+  DataSnapshotInternal* parent = new DataSnapshotInternal(
+      nullptr, util::JsonToVariant("{\"a\":{\"b\":1},\"c\":[2,3]}"),
+      QuerySpec(Path("test")));
+  DataSnapshotInternal* child = parent->Child("a");
+  DataSnapshotInternal* missing = parent->Child("d/e");
+  std::vector<DataSnapshot> children = parent->GetChildren();
+  delete parent;
+
+  EXPECT_THAT(child->GetValue(), Eq(util::JsonToVariant("{\"b\":1}")));
+  EXPECT_THAT(child->GetKeyString(), Eq("a"));
+  EXPECT_FALSE(missing->Exists());
+  ASSERT_THAT(children.size(), Eq(2));
+  EXPECT_THAT(children[0].key_string(), Eq("a"));
+  EXPECT_THAT(children[1].value(), Eq(util::JsonToVariant("[2,3]")));
+  delete child;
+  delete missing;
+}
+
+TEST(DataSnapshotDesktopTest, ChildViewsFromSeveralThreads) {
+  std::string json = "{";
+  for (int i = 0; i < 1000; ++i) {
+    if (i > 0) json += ",";
+    json += "\"key" + std::to_string(i) + "\":" + std::to_string(1000 - i);
+  }
+  json += "}";
+  DataSnapshotInternal snapshot(nullptr, util::JsonToVariant(json.c_str()),
+                                MakeQuerySpec(QueryParams::kOrderByValue));
+
+  std::vector<const std::vector<DataSnapshotInternal::ChildView>*> results(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back(
+        [&snapshot, &results, i]() { results[i] = &snapshot.GetChildViews(); });
+  }
+  for (auto& thread : threads) thread.join();
+
+  for (const auto* result : results) {
+    EXPECT_THAT(result, Eq(results[0]));
+  }
+  ASSERT_THAT(results[0]->size(), Eq(1000));
+  EXPECT_THAT(std::string((*results[0])[0].key()), Eq("key999"));
+}
+
+}  // namespace internal
+}  // namespace database
+}  // namespace firebase
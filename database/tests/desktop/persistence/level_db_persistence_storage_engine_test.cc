@@ -17,6 +17,7 @@
 #include <fstream>
 #include <iostream>
 #include <streambuf>
+#include <string>
 
 #include "app/src/logger.h"
 #include "app/src/variant_util.h"
@@ -281,6 +282,28 @@ TEST_F(LevelDbPersistenceStorageEngineTest, OverwriteServerCache_Overwrite) {
   });
 }
 
+TEST_F(LevelDbPersistenceStorageEngineTest, ImportServerCache) {
+  InitializeLevelDb(test_info_->name());
+
+  // Enough data that the import is written in several batches.
+  Variant data = Variant::EmptyMap();
+  const std::string value(2048, 'x');
+  for (int i = 0; i < 4096; ++i) {
+    data.map()[std::to_string(i)] = value;
+  }
+
+  engine_->BeginTransaction();
+  engine_->OverwriteServerCache(Path("aaa/old"), Variant("old value"));
+  EXPECT_TRUE(engine_->ImportServerCache(Path("aaa"), data));
+  engine_->SetTransactionSuccessful();
+  engine_->EndTransaction();
+
+  RunTwice([this, &data]() {
+    EXPECT_EQ(engine_->ServerCache(Path("aaa/old")), Variant::Null());
+    EXPECT_EQ(engine_->ServerCache(Path("aaa")), data);
+  });
+}
+
 TEST_F(LevelDbPersistenceStorageEngineTest, MergeIntoServerCacheWithVariant) {
   InitializeLevelDb(test_info_->name());
 
@@ -591,6 +614,192 @@ TEST_F(LevelDbPersistenceStorageEngineTest, PruneCache) {
   });
 }
 
+TEST_F(LevelDbPersistenceStorageEngineTest, ServerCacheForQueryDisabled) {
+  InitializeLevelDb(test_info_->name());
+
+  QueryParams params;
+  params.order_by = QueryParams::kOrderByChild;
+  params.order_by_child = "score";
+  params.limit_first = 1;
+
+  Variant result;
+  EXPECT_FALSE(engine_->ServerCacheForQuery(QuerySpec(Path("scores"), params),
+                                            &result));
+}
+
+class LevelDbPersistenceStorageEngineIndexTest
+    : public LevelDbPersistenceStorageEngineTest {
+ protected:
+  void SetUp() override {
+    LevelDbPersistenceStorageEngineTest::SetUp();
+    engine_->set_query_indexing_enabled(true);
+  }
+
+  void OverwriteServerCache(const Path& path, const Variant& data) {
+    engine_->BeginTransaction();
+    engine_->OverwriteServerCache(path, data);
+    engine_->SetTransactionSuccessful();
+    engine_->EndTransaction();
+  }
+
+  Variant ServerCacheForQuery(const QueryParams& params) {
+    Variant result;
+    EXPECT_TRUE(engine_->ServerCacheForQuery(QuerySpec(Path("scores"), params),
+                                             &result));
+    return result;
+  }
+
+  static QueryParams OrderByScore() {
+    QueryParams params;
+    params.order_by = QueryParams::kOrderByChild;
+    params.order_by_child = "score";
+    return params;
+  }
+};
+
+TEST_F(LevelDbPersistenceStorageEngineIndexTest, LimitFirst) {
+  InitializeLevelDb(test_info_->name());
+
+  // clang-format off
+  OverwriteServerCache(Path("scores"), std::map<Variant, Variant>{
+      std::make_pair("a", std::map<Variant, Variant>{
+          std::make_pair("score", 30)}),
+      std::make_pair("b", std::map<Variant, Variant>{
+          std::make_pair("score", -5.5)}),
+      std::make_pair("c", std::map<Variant, Variant>{
+          std::make_pair("score", "high")}),
+      std::make_pair("d", std::map<Variant, Variant>{
+          std::make_pair("name", "no score")}),
+      std::make_pair("e", std::map<Variant, Variant>{
+          std::make_pair("score", 10)}),
+  });
+  // clang-format on
+
+  QueryParams params = OrderByScore();
+  params.limit_first = 3;
+
+  // clang-format off
+  Variant expected = std::map<Variant, Variant>{
+      std::make_pair("b", std::map<Variant, Variant>{
+          std::make_pair("score", -5.5)}),
+      std::make_pair("d", std::map<Variant, Variant>{
+          std::make_pair("name", "no score")}),
+      std::make_pair("e", std::map<Variant, Variant>{
+          std::make_pair("score", 10)}),
+  };
+  // clang-format on
+  EXPECT_EQ(ServerCacheForQuery(params), expected);
+}
+
+TEST_F(LevelDbPersistenceStorageEngineIndexTest, LimitLastWithRange) {
+  InitializeLevelDb(test_info_->name());
+
+  // clang-format off
+  OverwriteServerCache(Path("scores"), std::map<Variant, Variant>{
+      std::make_pair("a", std::map<Variant, Variant>{
+          std::make_pair("score", 1)}),
+      std::make_pair("b", std::map<Variant, Variant>{
+          std::make_pair("score", 2)}),
+      std::make_pair("c", std::map<Variant, Variant>{
+          std::make_pair("score", 3)}),
+      std::make_pair("d", std::map<Variant, Variant>{
+          std::make_pair("score", 4)}),
+  });
+  // clang-format on
+
+  QueryParams params = OrderByScore();
+  params.end_at_value = Variant(3);
+  params.limit_last = 2;
+
+  // clang-format off
+  Variant expected = std::map<Variant, Variant>{
+      std::make_pair("b", std::map<Variant, Variant>{
+          std::make_pair("score", 2)}),
+      std::make_pair("c", std::map<Variant, Variant>{
+          std::make_pair("score", 3)}),
+  };
+  // clang-format on
+  EXPECT_EQ(ServerCacheForQuery(params), expected);
+}
+
+TEST_F(LevelDbPersistenceStorageEngineIndexTest, IndexFollowsWrites) {
+  InitializeLevelDb(test_info_->name());
+
+  // clang-format off
+  OverwriteServerCache(Path("scores"), std::map<Variant, Variant>{
+      std::make_pair("a", std::map<Variant, Variant>{
+          std::make_pair("score", 1)}),
+      std::make_pair("b", std::map<Variant, Variant>{
+          std::make_pair("score", 2)}),
+  });
+  // clang-format on
+
+  QueryParams params = OrderByScore();
+  params.limit_first = 1;
+  // Builds the index.
+  ServerCacheForQuery(params);
+
+  OverwriteServerCache(Path("scores/a/score"), Variant(3));
+  OverwriteServerCache(Path("scores/c/score"), Variant(0));
+
+  // The index is loaded from the database after a restart.
+  RunTwice([this, &params]() {
+    // clang-format off
+    Variant expected = std::map<Variant, Variant>{
+        std::make_pair("c", std::map<Variant, Variant>{
+            std::make_pair("score", 0)}),
+    };
+    // clang-format on
+    EXPECT_EQ(ServerCacheForQuery(params), expected);
+  });
+}
+
+TEST_F(LevelDbPersistenceStorageEngineIndexTest, IndexFollowsMerges) {
+  InitializeLevelDb(test_info_->name());
+
+  // clang-format off
+  OverwriteServerCache(Path("scores"), std::map<Variant, Variant>{
+      std::make_pair("a", std::map<Variant, Variant>{
+          std::make_pair("score", 1)}),
+      std::make_pair("b", std::map<Variant, Variant>{
+          std::make_pair("score", 2)}),
+      std::make_pair("c", std::map<Variant, Variant>{
+          std::make_pair("score", 3)}),
+  });
+  // clang-format on
+
+  QueryParams params = OrderByScore();
+  params.limit_first = 2;
+  // Builds the index.
+  ServerCacheForQuery(params);
+
+  // Change one child, remove one and add one in a single write.
+  engine_->BeginTransaction();
+  // clang-format off
+  engine_->MergeIntoServerCache(Path("scores"), std::map<Variant, Variant>{
+      std::make_pair("a", std::map<Variant, Variant>{
+          std::make_pair("score", 4)}),
+      std::make_pair("b", Variant::Null()),
+      std::make_pair("d", std::map<Variant, Variant>{
+          std::make_pair("score", 0)}),
+  });
+  // clang-format on
+  engine_->SetTransactionSuccessful();
+  engine_->EndTransaction();
+
+  RunTwice([this, &params]() {
+    // clang-format off
+    Variant expected = std::map<Variant, Variant>{
+        std::make_pair("c", std::map<Variant, Variant>{
+            std::make_pair("score", 3)}),
+        std::make_pair("d", std::map<Variant, Variant>{
+            std::make_pair("score", 0)}),
+    };
+    // clang-format on
+    EXPECT_EQ(ServerCacheForQuery(params), expected);
+  });
+}
+
 TEST_F(LevelDbPersistenceStorageEngineTest, BeginTransaction) {
   // BeginTransaction should return true, indicating success.
   EXPECT_TRUE(engine_->BeginTransaction());
@@ -634,6 +843,12 @@ TEST_F(LevelDbPersistenceStorageEngineDeathTest, OverwriteServerCache) {
                DEATHTEST_SIGABRT);
 }
 
+TEST_F(LevelDbPersistenceStorageEngineDeathTest, ImportServerCache) {
+  InitializeLevelDb(test_info_->name());
+  EXPECT_DEATH(engine_->ImportServerCache(Path(), Variant()),
+               DEATHTEST_SIGABRT);
+}
+
 TEST_F(LevelDbPersistenceStorageEngineDeathTest, MergeIntoServerCacheVariant) {
   InitializeLevelDb(test_info_->name());
   EXPECT_DEATH(engine_->MergeIntoServerCache(Path(), Variant()),
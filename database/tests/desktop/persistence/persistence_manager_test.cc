@@ -282,6 +282,54 @@ TEST_F(PersistenceManagerTest, UpdateServerCache_WithCompoundWrite) {
   manager_->UpdateServerCache(path, write);
 }
 
+TEST_F(PersistenceManagerTest, ImportServerCache) {
+  Path path("aaa");
+  Variant variant(std::map<Variant, Variant>{std::make_pair("bbb", 1)});
+
+  EXPECT_CALL(*tracked_query_manager_, IsQueryComplete(QuerySpec(path)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*storage_engine_, ImportServerCache(path, variant))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*tracked_query_manager_, EnsureCompleteTrackedQuery(path));
+
+  EXPECT_TRUE(manager_->ImportServerCache(path, variant));
+}
+
+TEST_F(PersistenceManagerTest, ImportServerCache_AlreadyComplete) {
+  Path path("aaa");
+  Variant variant(std::map<Variant, Variant>{std::make_pair("bbb", 1)});
+
+  EXPECT_CALL(*tracked_query_manager_, IsQueryComplete(QuerySpec(path)))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*storage_engine_, ImportServerCache(_, _)).Times(0);
+  EXPECT_CALL(*tracked_query_manager_, EnsureCompleteTrackedQuery(_)).Times(0);
+
+  EXPECT_FALSE(manager_->ImportServerCache(path, variant));
+}
+
+TEST_F(PersistenceManagerTest, ImportServerCache_Failure) {
+  Path path("aaa");
+  Variant variant(std::map<Variant, Variant>{std::make_pair("bbb", 1)});
+
+  EXPECT_CALL(*tracked_query_manager_, IsQueryComplete(QuerySpec(path)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*storage_engine_, ImportServerCache(path, variant))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*tracked_query_manager_, EnsureCompleteTrackedQuery(_)).Times(0);
+
+  EXPECT_FALSE(manager_->ImportServerCache(path, variant));
+}
+
+TEST_F(PersistenceManagerTest, IsServerCacheComplete) {
+  EXPECT_CALL(*tracked_query_manager_, IsQueryComplete(QuerySpec(Path("aaa"))))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*tracked_query_manager_, IsQueryComplete(QuerySpec(Path("bbb"))))
+      .WillOnce(Return(false));
+
+  EXPECT_TRUE(manager_->IsServerCacheComplete(Path("aaa")));
+  EXPECT_FALSE(manager_->IsServerCacheComplete(Path("bbb")));
+}
+
 TEST_F(PersistenceManagerTest, SetQueryActive) {
   EXPECT_CALL(*tracked_query_manager_,
               SetQueryActiveFlag(QuerySpec(), TrackedQuery::kActive));
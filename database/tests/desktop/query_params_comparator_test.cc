@@ -0,0 +1,130 @@
+// Copyright 2026 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "database/src/desktop/query_params_comparator.h"
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "app/src/include/firebase/variant.h"
+#include "database/src/common/query_spec.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::Lt;
+
+namespace firebase {
+namespace database {
+namespace internal {
+
+namespace {
+
+QueryParams OrderByChild(const char* child) {
+  QueryParams params;
+  params.order_by = QueryParams::kOrderByChild;
+  params.order_by_child = child;
+  return params;
+}
+
+// Returns {child: value}.
+Variant WithChild(const char* child, const Variant& value) {
+  return Variant(std::map<Variant, Variant>{{child, value}});
+}
+
+}  // namespace
+
+TEST(QueryParamsComparatorTest, OrderByChild) {
+  QueryParams params = OrderByChild("score");
+  QueryParamsComparator comparator(&params);
+
+  Variant low = WithChild("score", 1);
+  Variant high = WithChild("score", 2);
+  EXPECT_THAT(comparator.Compare("a", high, "b", low), Gt(0));
+  EXPECT_THAT(comparator.Compare("b", low, "a", high), Lt(0));
+
+  // Children that compare equal are ordered by key.
+  EXPECT_THAT(comparator.Compare("a", low, "b", low), Lt(0));
+  EXPECT_THAT(comparator.Compare("b", low, "a", low), Gt(0));
+  EXPECT_THAT(comparator.Compare("a", low, "a", low), Eq(0));
+
+  // Values of different types follow the order-by-value rules.
+  Variant text = WithChild("score", "text");
+  EXPECT_THAT(comparator.Compare("a", text, "b", high), Gt(0));
+}
+
+TEST(QueryParamsComparatorTest, OrderByMissingChild) {
+  QueryParams params = OrderByChild("score");
+  QueryParamsComparator comparator(&params);
+
+  // A missing child is null, which sorts before any other value.
+  Variant missing = WithChild("other", 1);
+  Variant present = WithChild("score", false);
+  EXPECT_THAT(comparator.Compare("z", missing, "a", present), Lt(0));
+  EXPECT_THAT(comparator.Compare("a", present, "z", missing), Gt(0));
+  EXPECT_THAT(comparator.Compare("z", Variant(5), "a", present), Lt(0));
+
+  // Two children that are both missing are ordered by key.
+  EXPECT_THAT(comparator.Compare("a", missing, "b", Variant::Null()), Lt(0));
+}
+
+TEST(QueryParamsComparatorTest, OrderByNestedChild) {
+  QueryParams params = OrderByChild("score/value");
+  QueryParamsComparator comparator(&params);
+
+  Variant low = WithChild("score", WithChild("value", 1));
+  Variant high = WithChild("score", WithChild("value", 2));
+  Variant missing = WithChild("score", 3);
+  EXPECT_THAT(comparator.Compare("a", high, "b", low), Gt(0));
+  EXPECT_THAT(comparator.Compare("a", missing, "b", low), Lt(0));
+
+  // The SortKeys give the same order as comparing the values.
+  EXPECT_THAT(comparator.Compare(comparator.MakeSortKey("a", high),
+                                 comparator.MakeSortKey("b", low)),
+              Gt(0));
+  EXPECT_THAT(comparator.Compare(comparator.MakeSortKey("a", missing),
+                                 comparator.MakeSortKey("b", low)),
+              Lt(0));
+}
+
+TEST(QueryParamsComparatorTest, CopiesCompareTheSame) {
+  QueryParams params = OrderByChild("score/value");
+  QueryParamsComparator comparator(&params);
+  QueryParamsComparator copy = comparator;
+  QueryParamsComparator assigned;
+  assigned = copy;
+
+  Variant low = WithChild("score", WithChild("value", 1));
+  Variant high = WithChild("score", WithChild("value", 2));
+  EXPECT_THAT(copy.Compare("a", high, "b", low), Gt(0));
+  EXPECT_THAT(assigned.Compare("a", high, "b", low), Gt(0));
+
+  // std::set copies its comparator.
+  std::set<std::pair<Variant, Variant>, QueryParamsLesser> children(
+      (QueryParamsLesser(&params)));
+  children.insert(std::make_pair(Variant("a"), high));
+  children.insert(std::make_pair(Variant("b"), low));
+  children.insert(std::make_pair(Variant("c"), Variant::Null()));
+  std::vector<Variant> keys;
+  for (const auto& child : children) keys.push_back(child.first);
+  EXPECT_THAT(keys, ElementsAre(Variant("c"), Variant("b"), Variant("a")));
+}
+
+}  // namespace internal
+}  // namespace database
+}  // namespace firebase
@@ -61,6 +61,9 @@ class MockPersistenceManager : public PersistenceManager {
               (const QuerySpec& query, const Variant& variant), (override));
   MOCK_METHOD(void, UpdateServerCache,
               (const Path& path, const CompoundWrite& children), (override));
+  MOCK_METHOD(bool, ImportServerCache,
+              (const Path& path, const Variant& data), (override));
+  MOCK_METHOD(bool, IsServerCacheComplete, (const Path& path), (override));
   MOCK_METHOD(void, SetQueryActive, (const QuerySpec& query), (override));
   MOCK_METHOD(void, SetQueryInactive, (const QuerySpec& query), (override));
   MOCK_METHOD(void, SetQueryComplete, (const QuerySpec& query), (override));
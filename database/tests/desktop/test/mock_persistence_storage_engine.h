@@ -42,6 +42,8 @@ class MockPersistenceStorageEngine : public PersistenceStorageEngine {
   MOCK_METHOD(Variant, ServerCache, (const Path& path), (override));
   MOCK_METHOD(void, OverwriteServerCache,
               (const Path& path, const Variant& data), (override));
+  MOCK_METHOD(bool, ImportServerCache, (const Path& path, const Variant& data),
+              (override));
   MOCK_METHOD(void, MergeIntoServerCache,
               (const Path& path, const Variant& data), (override));
   MOCK_METHOD(void, MergeIntoServerCache,
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "firebase/firestore.h"
+#include "firestore/src/common/rate_limiter.h"
+#include "firestore_integration_test.h"
+#include "util/future_test_util.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace firestore {
+namespace {
+
+TEST(RateLimiterTest, AcceptsAndRejectsRequests) {
+  // Allows 500 operations per second, starting at time 0.
+  RateLimiter limiter(500, 1.5, 5 * 60 * 1000, 10000, 0);
+
+  EXPECT_TRUE(limiter.TryMakeRequest(250, 0));
+  EXPECT_TRUE(limiter.TryMakeRequest(250, 0));
+  EXPECT_FALSE(limiter.TryMakeRequest(1, 0));
+
+  // Half a second refills 250 tokens.
+  EXPECT_FALSE(limiter.TryMakeRequest(251, 500));
+  EXPECT_TRUE(limiter.TryMakeRequest(250, 500));
+  EXPECT_FALSE(limiter.TryMakeRequest(1, 500));
+
+  // Tokens never exceed the capacity.
+  EXPECT_FALSE(limiter.TryMakeRequest(501, 10000));
+  EXPECT_TRUE(limiter.TryMakeRequest(500, 10000));
+}
+
+TEST(RateLimiterTest, CalculatesRequestDelay) {
+  RateLimiter limiter(500, 1.5, 5 * 60 * 1000, 10000, 0);
+
+  EXPECT_EQ(limiter.GetNextRequestDelayMillis(500, 0), 0);
+  EXPECT_TRUE(limiter.TryMakeRequest(500, 0));
+  EXPECT_EQ(limiter.GetNextRequestDelayMillis(100, 0), 200);
+  EXPECT_EQ(limiter.GetNextRequestDelayMillis(1, 0), 2);
+  // More than the capacity can never be requested.
+  EXPECT_EQ(limiter.GetNextRequestDelayMillis(501, 0), -1);
+}
+
+TEST(RateLimiterTest, IncreasesCapacityOverTime) {
+  RateLimiter limiter(500, 1.5, 5 * 60 * 1000, 1000, 0);
+
+  EXPECT_EQ(limiter.CalculateCapacity(0), 500);
+  EXPECT_EQ(limiter.CalculateCapacity(5 * 60 * 1000 - 1), 500);
+  EXPECT_EQ(limiter.CalculateCapacity(5 * 60 * 1000), 750);
+  // Capped at the maximum capacity.
+  EXPECT_EQ(limiter.CalculateCapacity(10 * 60 * 1000), 1000);
+  EXPECT_EQ(limiter.CalculateCapacity(60 * 60 * 1000), 1000);
+}
+
+using BulkWriterTest = FirestoreIntegrationTest;
+
+TEST_F(BulkWriterTest, WritesDocumentsInManyBatches) {
+  CollectionReference collection = Collection();
+  BulkWriterOptions options;
+  options.set_max_batch_size(10);
+  BulkWriter writer = TestFirestore()->bulk_writer(options);
+
+  std::vector<Future<void>> writes;
+  for (int i = 0; i < 95; ++i) {
+    writes.push_back(writer.Set(collection.Document(std::to_string(i)),
+                                MapFieldValue{{"i", FieldValue::Integer(i)}}));
+  }
+  EXPECT_THAT(writer.Close(), FutureSucceeds());
+
+  for (const Future<void>& write : writes) {
+    EXPECT_THAT(write, FutureSucceeds());
+  }
+  EXPECT_EQ(ReadDocuments(collection).size(), 95);
+}
+
+TEST_F(BulkWriterTest, AppliesWritesToADocumentInOrder) {
+  DocumentReference doc = Document();
+  BulkWriterOptions options;
+  options.set_max_batch_size(1);
+  BulkWriter writer = TestFirestore()->bulk_writer(options);
+
+  writer.Set(doc, MapFieldValue{{"count", FieldValue::Integer(0)}});
+  for (int i = 1; i <= 10; ++i) {
+    writer.Update(doc, MapFieldValue{{"count", FieldValue::Integer(i)}});
+  }
+  Await(writer.Close());
+
+  EXPECT_THAT(ReadDocument(doc).GetData(),
+              testing::ContainerEq(
+                  MapFieldValue{{"count", FieldValue::Integer(10)}}));
+}
+
+TEST_F(BulkWriterTest, FailedWriteDoesNotFailOtherWrites) {
+  CollectionReference collection = Collection();
+  BulkWriter writer = TestFirestore()->bulk_writer();
+
+  Future<void> first =
+      writer.Set(collection.Document("a"),
+                 MapFieldValue{{"foo", FieldValue::String("bar")}});
+  // Updating a document that doesn't exist fails.
+  Future<void> missing =
+      writer.Update(collection.Document("missing"),
+                    MapFieldValue{{"foo", FieldValue::String("bar")}});
+  Future<void> second =
+      writer.Set(collection.Document("b"),
+                 MapFieldValue{{"foo", FieldValue::String("bar")}});
+  Await(writer.Close());
+
+  EXPECT_THAT(first, FutureSucceeds());
+  EXPECT_THAT(second, FutureSucceeds());
+  Await(missing);
+  EXPECT_EQ(missing.error(), Error::kErrorNotFound);
+  EXPECT_EQ(ReadDocuments(collection).size(), 2);
+}
+
+TEST_F(BulkWriterTest, FlushWaitsForEarlierWrites) {
+  DocumentReference doc = Document();
+  BulkWriter writer = TestFirestore()->bulk_writer();
+
+  Future<void> write =
+      writer.Set(doc, MapFieldValue{{"foo", FieldValue::String("bar")}});
+  Await(writer.Flush());
+
+  EXPECT_EQ(write.status(), FutureStatus::kFutureStatusComplete);
+  EXPECT_TRUE(ReadDocument(doc).exists());
+}
+
+TEST_F(BulkWriterTest, ClosedWriterRejectsWrites) {
+  BulkWriter writer = TestFirestore()->bulk_writer();
+  Await(writer.Close());
+
+  Future<void> write = writer.Delete(Document());
+  Await(write);
+  EXPECT_EQ(write.error(), Error::kErrorFailedPrecondition);
+}
+
+TEST_F(BulkWriterTest, DefaultConstructedWriterIsInvalid) {
+  BulkWriter writer;
+  EXPECT_FALSE(writer.is_valid());
+  EXPECT_TRUE(TestFirestore()->bulk_writer().is_valid());
+}
+
+}  // namespace
+}  // namespace firestore
+}  // namespace firebase
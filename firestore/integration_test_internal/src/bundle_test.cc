@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <future>
 #include <string>
 #include <vector>
@@ -27,6 +30,11 @@
 #include "util/event_accumulator.h"
 #include "util/future_test_util.h"
 
+#if !defined(__ANDROID__)
+#include "Firestore/core/src/util/filesystem.h"
+#include "Firestore/core/src/util/path.h"
+#endif  // !defined(__ANDROID__)
+
 // These test cases are in sync with native iOS client SDK test
 //   Firestore/Example/Tests/Integration/API/FIRBundlesTests.mm
 // and native Android client SDK test
@@ -179,6 +187,68 @@ TEST_F(BundleTest, CanLoadBundlesWithProgressUpdates) {
   VerifyQueryResults(db);
 }
 
+#if !defined(__ANDROID__)
+
+TEST_F(BundleTest, CanLoadBundlesFromFile) {
+  Firestore* db = TestFirestore();
+  auto bundle = CreateTestBundle(db);
+  util::Path file =
+      util::Filesystem::Default()->TempDir().AppendUtf8("BundleTest.bundle");
+  {
+    std::ofstream out(file.native_value(), std::ios::binary);
+    out << bundle;
+  }
+
+  std::vector<LoadBundleTaskProgress> progresses;
+  std::promise<void> final_update;
+  Future<LoadBundleTaskProgress> result = db->LoadBundleFromFile(
+      file.ToUtf8String(),
+      [&progresses, &final_update](const LoadBundleTaskProgress& progress) {
+        progresses.push_back(progress);
+        SetPromiseValueWhenUpdateIsFinal(progress, final_update);
+      });
+
+  auto final_progress = AwaitResult(result);
+  final_update.get_future().wait();
+  ASSERT_EQ(progresses.size(), 4);
+  VerifySuccessProgress(progresses[3]);
+  EXPECT_EQ(progresses[3], final_progress);
+
+  VerifyQueryResults(db);
+  util::Filesystem::Default()->RecursivelyRemove(file);
+}
+
+#endif  // !defined(__ANDROID__)
+
+TEST_F(BundleTest, LoadBundleFromMissingFileShouldFail) {
+  Firestore* db = TestFirestore();
+
+  Future<LoadBundleTaskProgress> result =
+      db->LoadBundleFromFile("/this/bundle/does/not/exist.bundle");
+
+  Await(result);
+  EXPECT_EQ(result.error(), Error::kErrorNotFound);
+}
+
+TEST_F(BundleTest, CanLoadBundlesFromReader) {
+  Firestore* db = TestFirestore();
+  auto bundle = CreateTestBundle(db);
+
+  // Hand the bundle out in small chunks, so that elements span several reads.
+  size_t offset = 0;
+  Future<LoadBundleTaskProgress> result = db->LoadBundleFromReader(
+      [&bundle, &offset](char* buffer, size_t capacity) {
+        size_t size = std::min({capacity, bundle.size() - offset, size_t{7}});
+        std::memcpy(buffer, bundle.data() + offset, size);
+        offset += size;
+        return size;
+      });
+
+  VerifySuccessProgress(AwaitResult(result));
+  EXPECT_EQ(offset, bundle.size());
+  VerifyQueryResults(db);
+}
+
 TEST_F(BundleTest, CanDeleteFirestoreFromProgressUpdate) {
   Firestore* db = TestFirestore();
   auto bundle = CreateTestBundle(db);
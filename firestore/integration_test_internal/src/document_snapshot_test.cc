@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "firebase/firestore.h"
 #include "firestore_integration_test.h"
@@ -88,5 +90,72 @@ TEST_F(DocumentSnapshotTest, TestHashCode) {
   EXPECT_EQ(DocumentSnapshotHash(snap3), DocumentSnapshotHash(snap4));
 }
 
+// Records each visited field as "key=value" or, for maps and arrays, as
+// "key{" ... "}" and "key[" ... "]".
+class RecordingVisitor : public DocumentSnapshot::FieldVisitor {
+ public:
+  void OnNull(const char* key, size_t key_size) override {
+    Record(key, key_size, "null");
+  }
+  void OnBoolean(const char* key, size_t key_size, bool value) override {
+    Record(key, key_size, value ? "true" : "false");
+  }
+  void OnInteger(const char* key, size_t key_size, int64_t value) override {
+    Record(key, key_size, std::to_string(value));
+  }
+  void OnString(const char* key, size_t key_size, const char* value,
+                size_t value_size) override {
+    Record(key, key_size, "'" + std::string(value, value_size) + "'");
+  }
+  bool OnMapBegin(const char* key, size_t key_size) override {
+    events.push_back(std::string(key, key_size) + "{");
+    return true;
+  }
+  void OnMapEnd() override { events.push_back("}"); }
+  bool OnArrayBegin(const char* key, size_t key_size) override {
+    events.push_back(std::string(key, key_size) + "[");
+    return true;
+  }
+  void OnArrayEnd() override { events.push_back("]"); }
+
+  std::vector<std::string> events;
+
+ private:
+  void Record(const char* key, size_t key_size, const std::string& value) {
+    events.push_back(std::string(key, key_size) + "=" + value);
+  }
+};
+
+TEST_F(DocumentSnapshotTest, VisitDataVisitsEveryField) {
+  DocumentReference doc = Document();
+  // Each map holds a single field, as the order of map fields isn't defined.
+  FieldValue list = FieldValue::Array({FieldValue::Boolean(true),
+                                       FieldValue::Null(),
+                                       FieldValue::String("two")});
+  WriteDocument(doc, MapFieldValue{
+                         {"nested", FieldValue::Map({{"list", list}})}});
+  DocumentSnapshot snapshot = ReadDocument(doc);
+
+  RecordingVisitor visitor;
+  snapshot.VisitData(&visitor);
+  EXPECT_THAT(visitor.events,
+              testing::ElementsAre("nested{", "list[", "=true", "=null",
+                                   "='two'", "]", "}"));
+}
+
+TEST_F(DocumentSnapshotTest, VisitVisitsOneField) {
+  DocumentReference doc = Document();
+  WriteDocument(
+      doc, MapFieldValue{{"a", FieldValue::Integer(1)},
+                         {"nested", FieldValue::Map(
+                                        {{"b", FieldValue::String("two")}})}});
+  DocumentSnapshot snapshot = ReadDocument(doc);
+
+  RecordingVisitor visitor;
+  EXPECT_TRUE(snapshot.Visit(FieldPath{"nested", "b"}, &visitor));
+  EXPECT_FALSE(snapshot.Visit(FieldPath{"missing"}, &visitor));
+  EXPECT_THAT(visitor.events, testing::ElementsAre("='two'"));
+}
+
 }  // namespace firestore
 }  // namespace firebase
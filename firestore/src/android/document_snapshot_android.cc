@@ -18,6 +18,7 @@
 
 #include <utility>
 
+#include "app/src/assert.h"
 #include "firestore/src/android/document_reference_android.h"
 #include "firestore/src/android/field_path_android.h"
 #include "firestore/src/android/field_value_android.h"
@@ -61,6 +62,63 @@ Method<Object> kGet("get",
                     "ServerTimestampBehavior;)Ljava/lang/Object;");
 Method<int32_t> kHashCode("hashCode", "()I");
 
+void VisitFieldValue(const char* key, size_t key_size, const FieldValue& value,
+                     DocumentSnapshot::FieldVisitor* visitor) {
+  switch (value.type()) {
+    case FieldValue::Type::kNull:
+      visitor->OnNull(key, key_size);
+      break;
+    case FieldValue::Type::kBoolean:
+      visitor->OnBoolean(key, key_size, value.boolean_value());
+      break;
+    case FieldValue::Type::kInteger:
+      visitor->OnInteger(key, key_size, value.integer_value());
+      break;
+    case FieldValue::Type::kDouble:
+      visitor->OnDouble(key, key_size, value.double_value());
+      break;
+    case FieldValue::Type::kTimestamp:
+      visitor->OnTimestamp(key, key_size, value.timestamp_value());
+      break;
+    case FieldValue::Type::kString: {
+      const std::string& string_value = value.string_value();
+      visitor->OnString(key, key_size, string_value.data(),
+                        string_value.size());
+      break;
+    }
+    case FieldValue::Type::kBlob:
+      visitor->OnBlob(key, key_size, value.blob_value(), value.blob_size());
+      break;
+    case FieldValue::Type::kReference:
+      visitor->OnReference(key, key_size, value.reference_value());
+      break;
+    case FieldValue::Type::kGeoPoint:
+      visitor->OnGeoPoint(key, key_size, value.geo_point_value());
+      break;
+    case FieldValue::Type::kArray:
+      if (visitor->OnArrayBegin(key, key_size)) {
+        for (const FieldValue& element : value.array_value()) {
+          VisitFieldValue(nullptr, 0, element, visitor);
+        }
+        visitor->OnArrayEnd();
+      }
+      break;
+    case FieldValue::Type::kMap:
+      if (visitor->OnMapBegin(key, key_size)) {
+        for (const auto& field : value.map_value()) {
+          VisitFieldValue(field.first.data(), field.first.size(), field.second,
+                          visitor);
+        }
+        visitor->OnMapEnd();
+      }
+      break;
+    default:
+      // Sentinel values are never returned from a snapshot.
+      FIREBASE_ASSERT_MESSAGE(false, "Unexpected FieldValue type in snapshot");
+      break;
+  }
+}
+
 }  // namespace
 
 void DocumentSnapshotInternal::Initialize(jni::Loader& loader) {
@@ -130,6 +188,26 @@ FieldValue DocumentSnapshotInternal::Get(const FieldPath& field,
   return FieldValueInternal::Create(env, field_value);
 }
 
+void DocumentSnapshotInternal::VisitData(
+    DocumentSnapshot::FieldVisitor* visitor,
+    ServerTimestampBehavior stb) const {
+  MapFieldValue data = GetData(stb);
+  for (const auto& field : data) {
+    VisitFieldValue(field.first.data(), field.first.size(), field.second,
+                    visitor);
+  }
+}
+
+bool DocumentSnapshotInternal::Visit(const FieldPath& field,
+                                     DocumentSnapshot::FieldVisitor* visitor,
+                                     ServerTimestampBehavior stb) const {
+  FieldValue value = Get(field, stb);
+  if (!value.is_valid()) return false;
+
+  VisitFieldValue(nullptr, 0, value, visitor);
+  return true;
+}
+
 std::size_t DocumentSnapshotInternal::Hash() const {
   Env env = GetEnv();
   return env.Call(obj_, kHashCode);
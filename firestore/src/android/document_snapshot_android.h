@@ -60,6 +60,17 @@ class DocumentSnapshotInternal : public Wrapper {
   FieldValue Get(const FieldPath& field,
                  DocumentSnapshot::ServerTimestampBehavior stb) const;
 
+  /**
+   * Visits all data in the document. The data is converted to FieldValues
+   * first, as the underlying Java values can't be read in place.
+   */
+  void VisitData(DocumentSnapshot::FieldVisitor* visitor,
+                 DocumentSnapshot::ServerTimestampBehavior stb) const;
+
+  /** Visits a specific field from the document. */
+  bool Visit(const FieldPath& field, DocumentSnapshot::FieldVisitor* visitor,
+             DocumentSnapshot::ServerTimestampBehavior stb) const;
+
   std::size_t Hash() const;
 
  private:
@@ -16,7 +16,11 @@
 
 #include "firestore/src/android/firestore_android.h"
 
+#include <algorithm>
+#include <fstream>
 #include <utility>
+#include <vector>
+
 #include "app/src/assert.h"
 #include "app/src/embedded_file.h"
 #include "app/src/include/firebase/future.h"
@@ -59,6 +63,7 @@
 #include "firestore/src/android/transaction_options_builder_android.h"
 #include "firestore/src/android/wrapper.h"
 #include "firestore/src/android/write_batch_android.h"
+#include "firestore/src/common/futures.h"
 #include "firestore/src/common/hard_assert_common.h"
 #include "firestore/src/include/firebase/firestore.h"
 #include "firestore/src/jni/arena_ref.h"
@@ -245,16 +250,46 @@ enum class InitialLogState {
   kSetDisabled,
 } initial_log_state = InitialLogState::kUnset;
 
-Local<LoadBundleTaskInternal> CreateLoadBundleTask(Env& env,
-                                                   Object& firestore,
-                                                   const std::string& bundle) {
+// Size of the chunks that bundles are read in.
+constexpr size_t kBundleChunkSize = 64 * 1024;
+
+Local<Array<uint8_t>> ToJavaBytes(Env& env, const std::string& bundle) {
   Local<Array<uint8_t>> java_bytes = env.NewArray<uint8_t>(bundle.size());
   env.SetArrayRegion(java_bytes, 0, bundle.size(),
                      reinterpret_cast<const uint8_t*>(bundle.c_str()));
   if (!env.ok()) {
     java_bytes = env.NewArray<uint8_t>(0);
   }
-  return env.Call(firestore, kLoadBundle, java_bytes);
+  return java_bytes;
+}
+
+// Reads a bundle file straight into a Java byte array, one chunk at a time,
+// so that the file isn't also held in a native buffer. Returns false if the
+// file can't be read.
+bool ReadBundleFile(Env& env,
+                    const std::string& file_path,
+                    Local<Array<uint8_t>>* java_bytes) {
+  std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) return false;
+  std::streamoff size = file.tellg();
+  if (size < 0) return false;
+  file.seekg(0);
+
+  *java_bytes = env.NewArray<uint8_t>(static_cast<size_t>(size));
+  std::vector<char> chunk(kBundleChunkSize);
+  size_t offset = 0;
+  while (offset < static_cast<size_t>(size) && env.ok()) {
+    file.read(chunk.data(), chunk.size());
+    size_t read = static_cast<size_t>(file.gcount());
+    if (read == 0) return false;
+    env.SetArrayRegion(*java_bytes, offset, read,
+                       reinterpret_cast<const uint8_t*>(chunk.data()));
+    offset += read;
+  }
+  if (!env.ok()) {
+    *java_bytes = env.NewArray<uint8_t>(0);
+  }
+  return true;
 }
 
 }  // namespace
@@ -574,16 +609,66 @@ void FirestoreInternal::ClearListeners() {
 Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundle(
     const std::string& bundle) {
   Env env = GetEnv();
-  Local<LoadBundleTaskInternal> task = CreateLoadBundleTask(env, obj_, bundle);
-  return promises_->NewFuture<LoadBundleTaskProgress>(env, AsyncFn::kLoadBundle,
-                                                      task);
+  return LoadBundle(env, ToJavaBytes(env, bundle), nullptr);
 }
 
 Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundle(
     const std::string& bundle,
     std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
   Env env = GetEnv();
-  Local<LoadBundleTaskInternal> task = CreateLoadBundleTask(env, obj_, bundle);
+  return LoadBundle(env, ToJavaBytes(env, bundle),
+                    std::move(progress_callback));
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundleFromFile(
+    const std::string& file_path) {
+  return LoadBundleFromFile(file_path, nullptr);
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundleFromFile(
+    const std::string& file_path,
+    std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
+  Env env = GetEnv();
+  Local<Array<uint8_t>> java_bytes;
+  if (!ReadBundleFile(env, file_path, &java_bytes)) {
+    return FailedFuture<LoadBundleTaskProgress>(
+        Error::kErrorNotFound,
+        ("Could not open bundle file " + file_path).c_str());
+  }
+  return LoadBundle(env, java_bytes, std::move(progress_callback));
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundleFromReader(
+    Firestore::BundleReader reader) {
+  return LoadBundleFromReader(std::move(reader), nullptr);
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundleFromReader(
+    Firestore::BundleReader reader,
+    std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
+  // The Java SDK can only stream bundles from a Java `InputStream`, so the
+  // chunks are collected and passed on as a byte array.
+  std::string bundle;
+  std::vector<char> chunk(kBundleChunkSize);
+  for (size_t read; (read = reader(chunk.data(), chunk.size())) > 0;) {
+    bundle.append(chunk.data(), std::min(read, chunk.size()));
+  }
+  reader = nullptr;
+
+  Env env = GetEnv();
+  return LoadBundle(env, ToJavaBytes(env, bundle),
+                    std::move(progress_callback));
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundle(
+    Env& env,
+    const Array<uint8_t>& bundle,
+    std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
+  Local<LoadBundleTaskInternal> task = env.Call(obj_, kLoadBundle, bundle);
+  if (!progress_callback) {
+    return promises_->NewFuture<LoadBundleTaskProgress>(
+        env, AsyncFn::kLoadBundle, task);
+  }
 
   LambdaEventListener<LoadBundleTaskProgress> listener(
       // TODO(C++14): Move the callback into the lambda.
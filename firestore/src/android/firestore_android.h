@@ -30,6 +30,7 @@
 #include "app/src/include/firebase/app.h"
 #include "firestore/src/android/lambda_event_listener.h"
 #include "firestore/src/common/type_mapping.h"
+#include "firestore/src/include/firebase/firestore.h"
 #include "firestore/src/include/firebase/firestore/collection_reference.h"
 #include "firestore/src/include/firebase/firestore/document_reference.h"
 #include "firestore/src/include/firebase/firestore/load_bundle_task_progress.h"
@@ -143,6 +144,16 @@ class FirestoreInternal {
   Future<LoadBundleTaskProgress> LoadBundle(
       const std::string& bundle,
       std::function<void(const LoadBundleTaskProgress&)> progress_callback);
+  Future<LoadBundleTaskProgress> LoadBundleFromFile(
+      const std::string& file_path);
+  Future<LoadBundleTaskProgress> LoadBundleFromFile(
+      const std::string& file_path,
+      std::function<void(const LoadBundleTaskProgress&)> progress_callback);
+  Future<LoadBundleTaskProgress> LoadBundleFromReader(
+      Firestore::BundleReader reader);
+  Future<LoadBundleTaskProgress> LoadBundleFromReader(
+      Firestore::BundleReader reader,
+      std::function<void(const LoadBundleTaskProgress&)> progress_callback);
   Future<Query> NamedQuery(const std::string& query_name);
 
   static jni::Env GetEnv();
@@ -191,6 +202,13 @@ class FirestoreInternal {
 
   void ShutdownUserCallbackExecutor(jni::Env& env);
 
+  // Loads the bundle held in a Java byte array. `progress_callback` may be
+  // empty.
+  Future<LoadBundleTaskProgress> LoadBundle(
+      jni::Env& env,
+      const jni::Array<uint8_t>& bundle,
+      std::function<void(const LoadBundleTaskProgress&)> progress_callback);
+
   static bool Initialize(App* app);
   static void ReleaseClassesLocked(jni::Env& env);
   static void Terminate(App* app);
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "firestore/src/include/firebase/firestore/bulk_writer.h"
+
+#include <string>
+#include <utility>
+
+#include "app/src/include/firebase/future.h"
+#include "firestore/src/common/bulk_writer_internal.h"
+#include "firestore/src/common/cleanup.h"
+#include "firestore/src/common/exception_common.h"
+#include "firestore/src/common/futures.h"
+#include "firestore/src/common/hard_assert_common.h"
+#include "firestore/src/include/firebase/firestore/document_reference.h"
+
+namespace firebase {
+namespace firestore {
+
+namespace {
+
+using CleanupFnBulkWriter = CleanupFn<BulkWriter>;
+
+// The most writes the backend accepts in a single commit.
+constexpr int32_t kMaxBatchSize = 500;
+
+void ValidateReference(const DocumentReference& document) {
+  if (!document.is_valid()) {
+    SimpleThrowInvalidArgument("Invalid document reference provided.");
+  }
+}
+
+void ValidatePositive(const char* name, int32_t value) {
+  if (value <= 0) {
+    SimpleThrowInvalidArgument(std::string("invalid ") + name + ": " +
+                               std::to_string(value));
+  }
+}
+
+}  // namespace
+
+void BulkWriterOptions::set_initial_ops_per_second(int32_t ops_per_second) {
+  ValidatePositive("initial_ops_per_second", ops_per_second);
+  if (ops_per_second > max_ops_per_second_) {
+    SimpleThrowInvalidArgument(
+        "initial_ops_per_second must not be greater than max_ops_per_second");
+  }
+  initial_ops_per_second_ = ops_per_second;
+}
+
+void BulkWriterOptions::set_max_ops_per_second(int32_t ops_per_second) {
+  if (ops_per_second < initial_ops_per_second_) {
+    SimpleThrowInvalidArgument(
+        "max_ops_per_second must not be less than initial_ops_per_second");
+  }
+  max_ops_per_second_ = ops_per_second;
+}
+
+void BulkWriterOptions::set_max_batch_size(int32_t max_batch_size) {
+  ValidatePositive("max_batch_size", max_batch_size);
+  if (max_batch_size > kMaxBatchSize) {
+    SimpleThrowInvalidArgument("max_batch_size must not be greater than " +
+                               std::to_string(kMaxBatchSize));
+  }
+  max_batch_size_ = max_batch_size;
+}
+
+void BulkWriterOptions::set_max_in_flight_batches(
+    int32_t max_in_flight_batches) {
+  ValidatePositive("max_in_flight_batches", max_in_flight_batches);
+  max_in_flight_batches_ = max_in_flight_batches;
+}
+
+void BulkWriterOptions::set_max_attempts(int32_t max_attempts) {
+  ValidatePositive("max_attempts", max_attempts);
+  max_attempts_ = max_attempts;
+}
+
+BulkWriter::BulkWriter() {}
+
+BulkWriter::BulkWriter(BulkWriter&& value) {
+  CleanupFnBulkWriter::Unregister(&value, value.internal_);
+  std::swap(internal_, value.internal_);
+  CleanupFnBulkWriter::Register(this, internal_);
+}
+
+BulkWriter::BulkWriter(BulkWriterInternal* internal) : internal_(internal) {
+  SIMPLE_HARD_ASSERT(internal != nullptr);
+  CleanupFnBulkWriter::Register(this, internal_);
+}
+
+BulkWriter::~BulkWriter() {
+  if (internal_) internal_->Close();
+  CleanupFnBulkWriter::Unregister(this, internal_);
+  delete internal_;
+  internal_ = nullptr;
+}
+
+BulkWriter& BulkWriter::operator=(BulkWriter&& value) {
+  if (this == &value) {
+    return *this;
+  }
+
+  CleanupFnBulkWriter::Unregister(&value, value.internal_);
+  if (internal_) internal_->Close();
+  CleanupFnBulkWriter::Unregister(this, internal_);
+  delete internal_;
+  internal_ = value.internal_;
+  value.internal_ = nullptr;
+  CleanupFnBulkWriter::Register(this, internal_);
+  return *this;
+}
+
+Future<void> BulkWriter::Set(const DocumentReference& document,
+                             const MapFieldValue& data,
+                             const SetOptions& options) {
+  if (!internal_) return FailedFuture<void>();
+
+  ValidateReference(document);
+  return internal_->Set(document, data, options);
+}
+
+Future<void> BulkWriter::Update(const DocumentReference& document,
+                                const MapFieldValue& data) {
+  if (!internal_) return FailedFuture<void>();
+
+  ValidateReference(document);
+  return internal_->Update(document, data);
+}
+
+Future<void> BulkWriter::Update(const DocumentReference& document,
+                                const MapFieldPathValue& data) {
+  if (!internal_) return FailedFuture<void>();
+
+  ValidateReference(document);
+  return internal_->Update(document, data);
+}
+
+Future<void> BulkWriter::Delete(const DocumentReference& document) {
+  if (!internal_) return FailedFuture<void>();
+
+  ValidateReference(document);
+  return internal_->Delete(document);
+}
+
+Future<void> BulkWriter::Flush() {
+  if (!internal_) return FailedFuture<void>();
+  return internal_->Flush();
+}
+
+Future<void> BulkWriter::Close() {
+  if (!internal_) return FailedFuture<void>();
+  return internal_->Close();
+}
+
+}  // namespace firestore
+}  // namespace firebase
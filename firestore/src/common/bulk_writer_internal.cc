@@ -0,0 +1,601 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "firestore/src/common/bulk_writer_internal.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "app/src/callback.h"
+#include "app/src/include/firebase/future.h"
+#include "app/src/reference_counted_future_impl.h"
+#include "app/src/scheduler.h"
+#include "firestore/src/common/futures.h"
+#include "firestore/src/common/rate_limiter.h"
+#include "firestore/src/include/firebase/firestore/document_reference.h"
+#include "firestore/src/include/firebase/firestore/field_path.h"
+#include "firestore/src/include/firebase/firestore/field_value.h"
+#include "firestore/src/include/firebase/firestore/firestore_errors.h"
+#include "firestore/src/include/firebase/firestore/write_batch.h"
+#if defined(__ANDROID__)
+#include "firestore/src/android/firestore_android.h"
+#else
+#include "firestore/src/main/firestore_main.h"
+#endif  // defined(__ANDROID__)
+
+namespace firebase {
+namespace firestore {
+
+namespace {
+
+// The limit on writes per second is raised by 50% every 5 minutes.
+constexpr double kRateLimiterMultiplier = 1.5;
+constexpr int64_t kRateLimiterMultiplierMillis = 5 * 60 * 1000;
+
+// Retries back off exponentially, from 1 second up to 1 minute.
+constexpr int64_t kInitialBackoffMillis = 1000;
+constexpr double kBackoffFactor = 1.5;
+constexpr int64_t kMaxBackoffMillis = 60 * 1000;
+
+int64_t NowMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Runs the delayed sends and retries of all bulk writers. It is never
+// destroyed, so that its callbacks can release the last reference to a
+// writer.
+scheduler::Scheduler* GetScheduler() {
+  static auto* scheduler = new scheduler::Scheduler();
+  return scheduler;
+}
+
+bool IsRetryable(Error error) {
+  return error == Error::kErrorAborted || error == Error::kErrorUnavailable ||
+         error == Error::kErrorResourceExhausted;
+}
+
+int64_t BackoffMillis(Error error, int32_t attempts) {
+  if (error == Error::kErrorResourceExhausted) return kMaxBackoffMillis;
+  double backoff =
+      kInitialBackoffMillis * std::pow(kBackoffFactor, attempts - 1);
+  return std::min(static_cast<int64_t>(backoff), kMaxBackoffMillis);
+}
+
+// A write, and the future that reports its result.
+struct Operation {
+  enum class Type {
+    kSet,
+    kUpdate,
+    kUpdateFieldPaths,
+    kDelete,
+  };
+
+  Type type = Type::kDelete;
+  // The document is kept as a path, since copying a DocumentReference
+  // registers it with the Firestore instance, which takes a lock.
+  std::string path;
+  MapFieldValue data;
+  MapFieldPathValue field_path_data;
+  SetOptions options;
+
+  // Operations are numbered in the order they were added.
+  uint64_t id = 0;
+  SafeFutureHandle<void> handle;
+};
+
+void AddToBatch(const Operation& operation,
+                const DocumentReference& document,
+                WriteBatch& batch) {
+  switch (operation.type) {
+    case Operation::Type::kSet:
+      batch.Set(document, operation.data, operation.options);
+      break;
+    case Operation::Type::kUpdate:
+      batch.Update(document, operation.data);
+      break;
+    case Operation::Type::kUpdateFieldPaths:
+      batch.Update(document, operation.field_path_data);
+      break;
+    case Operation::Type::kDelete:
+      batch.Delete(document);
+      break;
+  }
+}
+
+// Writes that are committed together.
+struct Batch {
+  std::vector<Operation> operations;
+  // The batch the writes were added to when they were validated. A
+  // WriteBatch can only be committed once, so it is rebuilt for retries. It
+  // is held by pointer so that moving a Batch doesn't register it again.
+  std::unique_ptr<WriteBatch> write_batch;
+  int32_t attempts = 0;
+};
+
+// The result of an operation or flush. Futures are only completed once no
+// lock is held, since completing them runs user callbacks.
+struct Completion {
+  SafeFutureHandle<void> handle;
+  Error error;
+  std::string message;
+};
+
+void Complete(const std::vector<Completion>& completions) {
+  ReferenceCountedFutureImpl* api =
+      internal::GetSharedReferenceCountedFutureImpl();
+  for (const Completion& completion : completions) {
+    api->Complete(completion.handle, completion.error,
+                  completion.message.c_str());
+  }
+}
+
+}  // namespace
+
+class BulkWriterInternal::Writer
+    : public std::enable_shared_from_this<BulkWriterInternal::Writer> {
+ public:
+  Writer(FirestoreInternal* firestore, const BulkWriterOptions& options)
+      : firestore_(firestore),
+        options_(options),
+        batch_size_(options.max_batch_size()),
+        rate_limiter_(options.initial_ops_per_second(),
+                      kRateLimiterMultiplier,
+                      kRateLimiterMultiplierMillis,
+                      options.max_ops_per_second(),
+                      NowMillis()) {
+    // A batch must never need more tokens than the rate limiter can hold.
+    if (options_.throttling_enabled()) {
+      batch_size_ = std::min(batch_size_, options_.initial_ops_per_second());
+    }
+    firestore_->cleanup().RegisterObject(this, Detach);
+  }
+
+  ~Writer() {
+    std::vector<Completion> completions;
+    {
+      MutexLock firestores_lock(GetFirestoreInstancesLock());
+      FirestoreInternal* firestore = nullptr;
+      std::vector<std::unique_ptr<WriteBatch>> write_batches;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        firestore = firestore_;
+        // Writes can only be left if their commits were dropped without a
+        // result.
+        FailAllLocked(Error::kErrorCancelled,
+                      "The write was cancelled before it finished.",
+                      &completions, &write_batches);
+      }
+      write_batches.clear();
+      if (firestore) firestore->cleanup().UnregisterObject(this);
+    }
+    Complete(completions);
+  }
+
+  Future<void> Add(const DocumentReference& document, Operation operation) {
+    ReferenceCountedFutureImpl* api =
+        internal::GetSharedReferenceCountedFutureImpl();
+    Future<void> result;
+    bool batch_full = false;
+    {
+      // Also keeps pending_ from being sent or failed while the write is
+      // validated.
+      MutexLock firestores_lock(GetFirestoreInstancesLock());
+      FirestoreInternal* firestore = nullptr;
+      std::unique_ptr<WriteBatch> write_batch;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!firestore_) {
+          return FailedFuture<void>(
+              Error::kErrorFailedPrecondition,
+              "The Firestore instance of this BulkWriter was deleted.");
+        }
+        if (closed_) {
+          return FailedFuture<void>(Error::kErrorFailedPrecondition,
+                                    "The BulkWriter has been closed.");
+        }
+        firestore = firestore_;
+        write_batch = std::move(pending_.write_batch);
+      }
+
+      // Creating a WriteBatch registers it with the Firestore instance, so it
+      // is done without holding mutex_, like committing it.
+      if (!write_batch) write_batch.reset(new WriteBatch(firestore->batch()));
+      // Validates the write right away, like WriteBatch does.
+      AddToBatch(operation, document, *write_batch);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.write_batch = std::move(write_batch);
+      operation.id = next_operation_id_++;
+      operation.handle = api->SafeAlloc<void>();
+      result = Future<void>(api, operation.handle.get());
+      unfinished_operations_.insert(operation.id);
+      pending_.operations.push_back(std::move(operation));
+      if (pending_.operations.size() >= static_cast<size_t>(batch_size_)) {
+        queue_.push_back(std::move(pending_));
+        pending_ = Batch();
+        batch_full = true;
+      }
+    }
+
+    if (batch_full) SendBatches();
+    return result;
+  }
+
+  Future<void> Flush(bool close) {
+    ReferenceCountedFutureImpl* api =
+        internal::GetSharedReferenceCountedFutureImpl();
+    SafeFutureHandle<void> handle = api->SafeAlloc<void>();
+    Future<void> result(api, handle.get());
+    bool flushed = false;
+    {
+      MutexLock firestores_lock(GetFirestoreInstancesLock());
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (close) closed_ = true;
+      if (!pending_.operations.empty()) {
+        queue_.push_back(std::move(pending_));
+        pending_ = Batch();
+      }
+      flushed = IsFlushedLocked(next_operation_id_);
+      if (!flushed) flushes_.emplace_back(next_operation_id_, handle);
+    }
+
+    if (flushed) api->Complete(handle, Error::kErrorOk, "");
+    SendBatches();
+    return result;
+  }
+
+ private:
+  // The result of a commit, handled on the scheduler.
+  struct CommitResult {
+    std::shared_ptr<Writer> writer;
+    std::shared_ptr<Batch> batch;
+    Error error;
+    std::string message;
+  };
+
+  // Called when the Firestore instance is deleted, with
+  // GetFirestoreInstancesLock() held.
+  static void Detach(void* object) {
+    auto* writer = static_cast<Writer*>(object);
+    std::vector<Completion> completions;
+    std::vector<std::unique_ptr<WriteBatch>> write_batches;
+    {
+      std::lock_guard<std::mutex> lock(writer->mutex_);
+      writer->firestore_ = nullptr;
+      writer->FailAllLocked(
+          Error::kErrorFailedPrecondition,
+          "The Firestore instance was deleted before the write finished.",
+          &completions, &write_batches);
+    }
+    write_batches.clear();
+    Complete(completions);
+  }
+
+  static void HandleCommitResult(CommitResult* result) {
+    result->writer->OnCommitted(result->batch, result->error,
+                                result->message);
+  }
+
+  // Commits as many queued batches as the limits on commits in flight and on
+  // writes per second allow.
+  void SendBatches() {
+    MutexLock firestores_lock(GetFirestoreInstancesLock());
+    FirestoreInternal* firestore = nullptr;
+    std::vector<std::shared_ptr<Batch>> to_send;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      firestore = firestore_;
+      if (!firestore) return;
+
+      int64_t now = NowMillis();
+      while (!queue_.empty() &&
+             in_flight_.size() <
+                 static_cast<size_t>(options_.max_in_flight_batches())) {
+        Batch& batch = queue_.front();
+        // Writes to a document wait for earlier writes to it to finish, so
+        // that they are applied in order.
+        if (IsBusyLocked(batch)) break;
+
+        auto size = static_cast<int32_t>(batch.operations.size());
+        if (options_.throttling_enabled() &&
+            !rate_limiter_.TryMakeRequest(size, now)) {
+          int64_t delay = rate_limiter_.GetNextRequestDelayMillis(size, now);
+          ScheduleSendLocked(std::max<int64_t>(delay, 1));
+          break;
+        }
+
+        auto sending = std::make_shared<Batch>(std::move(batch));
+        queue_.pop_front();
+        MarkBusyLocked(*sending, 1);
+        in_flight_.push_back(sending);
+        to_send.push_back(std::move(sending));
+      }
+    }
+
+    // Batches are committed without holding mutex_, since creating a
+    // WriteBatch registers it with the Firestore instance, and Detach() is
+    // called while the Firestore instance holds the lock of its registry.
+    for (const std::shared_ptr<Batch>& batch : to_send) {
+      Commit(firestore, batch);
+    }
+  }
+
+  void Commit(FirestoreInternal* firestore,
+              const std::shared_ptr<Batch>& batch) {
+    if (!batch->write_batch) {
+      batch->write_batch.reset(new WriteBatch(firestore->batch()));
+      for (const Operation& operation : batch->operations) {
+        AddToBatch(operation, firestore->Document(operation.path.c_str()),
+                   *batch->write_batch);
+      }
+    }
+    ++batch->attempts;
+    Future<void> future = batch->write_batch->Commit();
+    batch->write_batch.reset();
+
+    // The result is handled on the scheduler, since the next batches are sent
+    // holding GetFirestoreInstancesLock(), and deleting the Firestore instance
+    // waits for the thread that completes the commit while holding it. The
+    // callback gives its reference to the writer to the scheduler, so that
+    // the writer isn't destroyed on that thread either.
+    std::shared_ptr<Writer> self = shared_from_this();
+    future.OnCompletion(
+        [self, batch](const Future<void>& result) mutable {
+          const char* message = result.error_message();
+          CommitResult commit_result{std::move(self), batch,
+                                     static_cast<Error>(result.error()),
+                                     message ? message : ""};
+          GetScheduler()->Schedule(
+              new callback::CallbackMoveValue1<CommitResult>(
+                  std::move(commit_result), HandleCommitResult));
+        });
+  }
+
+  void OnCommitted(const std::shared_ptr<Batch>& batch,
+                   Error error,
+                   const std::string& message) {
+    std::vector<Completion> completions;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = std::find(in_flight_.begin(), in_flight_.end(), batch);
+      // The writes were already failed when the Firestore instance was
+      // deleted.
+      if (it == in_flight_.end()) return;
+
+      if (IsRetryable(error) && batch->attempts < options_.max_attempts()) {
+        // The batch stays in flight, so later writes to its documents keep
+        // waiting.
+        ScheduleRetryLocked(batch, BackoffMillis(error, batch->attempts));
+        return;
+      }
+
+      in_flight_.erase(it);
+      MarkBusyLocked(*batch, -1);
+      if (error != Error::kErrorOk && !IsRetryable(error) &&
+          batch->operations.size() > 1) {
+        // A batch is atomic, so a single bad write fails all of them. Send
+        // each write on its own, so that only the bad ones fail.
+        for (auto operation = batch->operations.rbegin();
+             operation != batch->operations.rend(); ++operation) {
+          Batch single;
+          single.operations.push_back(std::move(*operation));
+          queue_.push_front(std::move(single));
+        }
+      } else {
+        for (const Operation& operation : batch->operations) {
+          FinishLocked(operation, error, message, &completions);
+        }
+        CollectFlushesLocked(&completions);
+      }
+    }
+
+    Complete(completions);
+    SendBatches();
+  }
+
+  void Retry(const std::shared_ptr<Batch>& batch) {
+    MutexLock firestores_lock(GetFirestoreInstancesLock());
+    FirestoreInternal* firestore = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (std::find(in_flight_.begin(), in_flight_.end(), batch) ==
+          in_flight_.end()) {
+        return;
+      }
+      firestore = firestore_;
+    }
+    Commit(firestore, batch);
+  }
+
+  void ScheduleSendLocked(int64_t delay_millis) {
+    if (send_scheduled_) return;
+    send_scheduled_ = true;
+    std::shared_ptr<Writer> self = shared_from_this();
+    GetScheduler()->Schedule(
+        [self] {
+          {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            self->send_scheduled_ = false;
+          }
+          self->SendBatches();
+        },
+        static_cast<scheduler::ScheduleTimeMs>(delay_millis));
+  }
+
+  void ScheduleRetryLocked(const std::shared_ptr<Batch>& batch,
+                           int64_t delay_millis) {
+    std::shared_ptr<Writer> self = shared_from_this();
+    GetScheduler()->Schedule([self, batch] { self->Retry(batch); },
+                             static_cast<scheduler::ScheduleTimeMs>(
+                                 delay_millis));
+  }
+
+  bool IsBusyLocked(const Batch& batch) const {
+    for (const Operation& operation : batch.operations) {
+      if (busy_documents_.count(operation.path) > 0) return true;
+    }
+    return false;
+  }
+
+  void MarkBusyLocked(const Batch& batch, int delta) {
+    for (const Operation& operation : batch.operations) {
+      auto it = busy_documents_.emplace(operation.path, 0).first;
+      it->second += delta;
+      if (it->second <= 0) busy_documents_.erase(it);
+    }
+  }
+
+  void FinishLocked(const Operation& operation,
+                    Error error,
+                    const std::string& message,
+                    std::vector<Completion>* completions) {
+    unfinished_operations_.erase(operation.id);
+    completions->push_back(Completion{operation.handle, error, message});
+  }
+
+  // Whether every operation numbered below end_id has finished.
+  bool IsFlushedLocked(uint64_t end_id) const {
+    return unfinished_operations_.empty() ||
+           *unfinished_operations_.begin() >= end_id;
+  }
+
+  void CollectFlushesLocked(std::vector<Completion>* completions) {
+    for (auto it = flushes_.begin(); it != flushes_.end();) {
+      if (IsFlushedLocked(it->first)) {
+        completions->push_back(Completion{it->second, Error::kErrorOk, ""});
+        it = flushes_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Fails every write that hasn't finished. The WriteBatches of the writes
+  // are moved to write_batches, to be destroyed without holding mutex_.
+  void FailAllLocked(Error error,
+                     const std::string& message,
+                     std::vector<Completion>* completions,
+                     std::vector<std::unique_ptr<WriteBatch>>* write_batches) {
+    for (const Operation& operation : pending_.operations) {
+      FinishLocked(operation, error, message, completions);
+    }
+    write_batches->push_back(std::move(pending_.write_batch));
+    pending_ = Batch();
+    for (Batch& batch : queue_) {
+      for (const Operation& operation : batch.operations) {
+        FinishLocked(operation, error, message, completions);
+      }
+      write_batches->push_back(std::move(batch.write_batch));
+    }
+    queue_.clear();
+    for (const std::shared_ptr<Batch>& batch : in_flight_) {
+      for (const Operation& operation : batch->operations) {
+        FinishLocked(operation, error, message, completions);
+      }
+    }
+    in_flight_.clear();
+    busy_documents_.clear();
+    CollectFlushesLocked(completions);
+  }
+
+  std::mutex mutex_;
+  // Null once the Firestore instance has been deleted.
+  FirestoreInternal* firestore_ = nullptr;
+  const BulkWriterOptions options_;
+  int32_t batch_size_ = 0;
+  RateLimiter rate_limiter_;
+
+  // The batch that writes are being added to.
+  Batch pending_;
+  // Full batches, in the order they are to be committed.
+  std::deque<Batch> queue_;
+  // Batches that are being committed, or are waiting to be retried.
+  std::vector<std::shared_ptr<Batch>> in_flight_;
+  // Paths of the documents written by in_flight_, with the number of batches
+  // that write each of them.
+  std::map<std::string, int> busy_documents_;
+
+  uint64_t next_operation_id_ = 0;
+  std::set<uint64_t> unfinished_operations_;
+  // Flushes that are waiting for the operations numbered below the first
+  // value to finish.
+  std::vector<std::pair<uint64_t, SafeFutureHandle<void>>> flushes_;
+
+  bool closed_ = false;
+  bool send_scheduled_ = false;
+};
+
+BulkWriterInternal::BulkWriterInternal(FirestoreInternal* firestore,
+                                       const BulkWriterOptions& options)
+    : firestore_(firestore),
+      writer_(std::make_shared<Writer>(firestore, options)) {}
+
+BulkWriterInternal::~BulkWriterInternal() = default;
+
+Future<void> BulkWriterInternal::Set(const DocumentReference& document,
+                                     const MapFieldValue& data,
+                                     const SetOptions& options) {
+  Operation operation;
+  operation.type = Operation::Type::kSet;
+  operation.path = document.path();
+  operation.data = data;
+  operation.options = options;
+  return writer_->Add(document, std::move(operation));
+}
+
+Future<void> BulkWriterInternal::Update(const DocumentReference& document,
+                                        const MapFieldValue& data) {
+  Operation operation;
+  operation.type = Operation::Type::kUpdate;
+  operation.path = document.path();
+  operation.data = data;
+  return writer_->Add(document, std::move(operation));
+}
+
+Future<void> BulkWriterInternal::Update(const DocumentReference& document,
+                                        const MapFieldPathValue& data) {
+  Operation operation;
+  operation.type = Operation::Type::kUpdateFieldPaths;
+  operation.path = document.path();
+  operation.field_path_data = data;
+  return writer_->Add(document, std::move(operation));
+}
+
+Future<void> BulkWriterInternal::Delete(const DocumentReference& document) {
+  Operation operation;
+  operation.type = Operation::Type::kDelete;
+  operation.path = document.path();
+  return writer_->Add(document, std::move(operation));
+}
+
+Future<void> BulkWriterInternal::Flush() { return writer_->Flush(false); }
+
+Future<void> BulkWriterInternal::Close() { return writer_->Flush(true); }
+
+}  // namespace firestore
+}  // namespace firebase
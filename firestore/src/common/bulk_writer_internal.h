@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_FIRESTORE_SRC_COMMON_BULK_WRITER_INTERNAL_H_
+#define FIREBASE_FIRESTORE_SRC_COMMON_BULK_WRITER_INTERNAL_H_
+
+#include <memory>
+
+#include "app/src/include/firebase/internal/mutex.h"
+#include "firestore/src/include/firebase/firestore/bulk_writer.h"
+#include "firestore/src/include/firebase/firestore/map_field_value.h"
+#include "firestore/src/include/firebase/firestore/set_options.h"
+
+namespace firebase {
+
+template <typename T>
+class Future;
+
+namespace firestore {
+
+class DocumentReference;
+class FirestoreInternal;
+
+// Returns the lock held while Firestore instances are created and deleted.
+// A FirestoreInternal can't be deleted while it is held.
+Mutex& GetFirestoreInstancesLock();
+
+// Implementation of BulkWriter shared by all platforms, built on WriteBatch.
+//
+// The writes are kept by a reference-counted writer, which is also held by
+// the callbacks of commits in flight and of scheduled sends. Writes added
+// before the BulkWriter is destroyed are therefore still sent. The writer
+// detaches itself when the Firestore instance is deleted, failing any writes
+// that haven't finished. Writes are added and committed while holding
+// GetFirestoreInstancesLock(), since they may run on a scheduler thread while
+// the instance is being deleted.
+class BulkWriterInternal {
+ public:
+  BulkWriterInternal(FirestoreInternal* firestore,
+                     const BulkWriterOptions& options);
+  ~BulkWriterInternal();
+
+  FirestoreInternal* firestore_internal() { return firestore_; }
+
+  Future<void> Set(const DocumentReference& document,
+                   const MapFieldValue& data,
+                   const SetOptions& options);
+  Future<void> Update(const DocumentReference& document,
+                      const MapFieldValue& data);
+  Future<void> Update(const DocumentReference& document,
+                      const MapFieldPathValue& data);
+  Future<void> Delete(const DocumentReference& document);
+
+  Future<void> Flush();
+  Future<void> Close();
+
+ private:
+  class Writer;
+
+  FirestoreInternal* firestore_ = nullptr;
+  std::shared_ptr<Writer> writer_;
+};
+
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIREBASE_FIRESTORE_SRC_COMMON_BULK_WRITER_INTERNAL_H_
@@ -143,6 +143,26 @@ FieldValue DocumentSnapshot::Get(const FieldPath& field,
   return internal_->Get(field, stb);
 }
 
+void DocumentSnapshot::VisitData(FieldVisitor* visitor,
+                                 ServerTimestampBehavior stb) const {
+  if (!visitor) {
+    SimpleThrowInvalidArgument("Visitor cannot be null.");
+  }
+
+  if (!internal_) return;
+  internal_->VisitData(visitor, stb);
+}
+
+bool DocumentSnapshot::Visit(const FieldPath& field, FieldVisitor* visitor,
+                             ServerTimestampBehavior stb) const {
+  if (!visitor) {
+    SimpleThrowInvalidArgument("Visitor cannot be null.");
+  }
+
+  if (!internal_) return false;
+  return internal_->Visit(field, visitor, stb);
+}
+
 std::string DocumentSnapshot::ToString() const {
   if (!internal_) return "DocumentSnapshot(invalid)";
 
@@ -25,6 +25,7 @@
 #include "app/src/include/firebase/version.h"
 #include "app/src/log.h"
 #include "app/src/util.h"
+#include "firestore/src/common/bulk_writer_internal.h"
 #include "firestore/src/common/compiler_info.h"
 #include "firestore/src/common/exception_common.h"
 #include "firestore/src/common/futures.h"
@@ -351,6 +352,17 @@ WriteBatch Firestore::batch() const {
   return internal_->batch();
 }
 
+Mutex& GetFirestoreInstancesLock() { return *g_firestores_lock; }
+
+BulkWriter Firestore::bulk_writer() {
+  return bulk_writer(BulkWriterOptions());
+}
+
+BulkWriter Firestore::bulk_writer(const BulkWriterOptions& options) {
+  if (!internal_) return {};
+  return BulkWriter(new BulkWriterInternal(internal_, options));
+}
+
 Future<void> Firestore::RunTransaction(
     std::function<Error(Transaction&, std::string&)> update) {
   return RunTransaction({}, std::move(update));
@@ -435,6 +447,50 @@ Future<LoadBundleTaskProgress> Firestore::LoadBundle(
   return internal_->LoadBundle(bundle, std::move(progress_callback));
 }
 
+Future<LoadBundleTaskProgress> Firestore::LoadBundleFromFile(
+    const std::string& file_path) {
+  if (!internal_) return FailedFuture<LoadBundleTaskProgress>();
+  return internal_->LoadBundleFromFile(file_path);
+}
+
+Future<LoadBundleTaskProgress> Firestore::LoadBundleFromFile(
+    const std::string& file_path,
+    std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
+  if (!progress_callback) {
+    SimpleThrowInvalidArgument(
+        "Progress callback cannot be an empty function.");
+  }
+
+  if (!internal_) return FailedFuture<LoadBundleTaskProgress>();
+  return internal_->LoadBundleFromFile(file_path, std::move(progress_callback));
+}
+
+Future<LoadBundleTaskProgress> Firestore::LoadBundleFromReader(
+    BundleReader reader) {
+  if (!reader) {
+    SimpleThrowInvalidArgument("Bundle reader cannot be an empty function.");
+  }
+
+  if (!internal_) return FailedFuture<LoadBundleTaskProgress>();
+  return internal_->LoadBundleFromReader(std::move(reader));
+}
+
+Future<LoadBundleTaskProgress> Firestore::LoadBundleFromReader(
+    BundleReader reader,
+    std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
+  if (!reader) {
+    SimpleThrowInvalidArgument("Bundle reader cannot be an empty function.");
+  }
+  if (!progress_callback) {
+    SimpleThrowInvalidArgument(
+        "Progress callback cannot be an empty function.");
+  }
+
+  if (!internal_) return FailedFuture<LoadBundleTaskProgress>();
+  return internal_->LoadBundleFromReader(std::move(reader),
+                                         std::move(progress_callback));
+}
+
 Future<Query> Firestore::NamedQuery(const std::string& query_name) {
   if (!internal_) return FailedFuture<Query>();
   return internal_->NamedQuery(query_name);
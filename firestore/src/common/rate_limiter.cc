@@ -0,0 +1,84 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "firestore/src/common/rate_limiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "firestore/src/common/hard_assert_common.h"
+
+namespace firebase {
+namespace firestore {
+
+RateLimiter::RateLimiter(int32_t initial_capacity,
+                         double multiplier,
+                         int64_t multiplier_millis,
+                         int32_t maximum_capacity,
+                         int64_t start_time_millis)
+    : initial_capacity_(initial_capacity),
+      multiplier_(multiplier),
+      multiplier_millis_(multiplier_millis),
+      maximum_capacity_(maximum_capacity),
+      start_time_millis_(start_time_millis),
+      available_tokens_(initial_capacity),
+      last_refill_time_millis_(start_time_millis) {
+  SIMPLE_HARD_ASSERT(initial_capacity > 0 && multiplier_millis > 0 &&
+                     maximum_capacity >= initial_capacity);
+}
+
+bool RateLimiter::TryMakeRequest(int32_t num_operations, int64_t now_millis) {
+  RefillTokens(now_millis);
+  if (num_operations > available_tokens_) return false;
+  available_tokens_ -= num_operations;
+  return true;
+}
+
+int64_t RateLimiter::GetNextRequestDelayMillis(int32_t num_operations,
+                                               int64_t now_millis) const {
+  if (num_operations <= available_tokens_) return 0;
+  int64_t capacity = CalculateCapacity(now_millis);
+  if (num_operations > capacity) return -1;
+  int64_t required_tokens = num_operations - available_tokens_;
+  // Round up, so that the tokens are available when the delay is over.
+  return (required_tokens * 1000 + capacity - 1) / capacity;
+}
+
+int32_t RateLimiter::CalculateCapacity(int64_t now_millis) const {
+  int64_t periods =
+      std::max<int64_t>(now_millis - start_time_millis_, 0) /
+      multiplier_millis_;
+  double capacity =
+      initial_capacity_ * std::pow(multiplier_, static_cast<double>(periods));
+  if (capacity >= maximum_capacity_) return maximum_capacity_;
+  return static_cast<int32_t>(capacity);
+}
+
+void RateLimiter::RefillTokens(int64_t now_millis) {
+  if (now_millis <= last_refill_time_millis_) return;
+  int64_t elapsed_millis = now_millis - last_refill_time_millis_;
+  int64_t capacity = CalculateCapacity(now_millis);
+  int64_t tokens_to_add = elapsed_millis * capacity / 1000;
+  // Only advance the refill time when tokens are added, so that fractions of
+  // a token aren't lost when requests are frequent.
+  if (tokens_to_add > 0) {
+    available_tokens_ = std::min(capacity, available_tokens_ + tokens_to_add);
+    last_refill_time_millis_ = now_millis;
+  }
+}
+
+}  // namespace firestore
+}  // namespace firebase
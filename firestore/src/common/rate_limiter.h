@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_FIRESTORE_SRC_COMMON_RATE_LIMITER_H_
+#define FIREBASE_FIRESTORE_SRC_COMMON_RATE_LIMITER_H_
+
+#include <cstdint>
+
+namespace firebase {
+namespace firestore {
+
+// A token bucket that limits the number of operations per second, and raises
+// the limit over time.
+//
+// The bucket starts out with `initial_capacity` tokens and refills at
+// `initial_capacity` tokens per second. Every `multiplier_millis` the
+// capacity is multiplied by `multiplier`, up to `maximum_capacity`. With the
+// defaults used by `BulkWriter` this is the "500/50/5" rule: start at 500
+// operations per second and increase by 50% every 5 minutes.
+//
+// Times are in milliseconds, from any clock that doesn't go backwards.
+class RateLimiter {
+ public:
+  RateLimiter(int32_t initial_capacity,
+              double multiplier,
+              int64_t multiplier_millis,
+              int32_t maximum_capacity,
+              int64_t start_time_millis);
+
+  // Takes tokens for `num_operations` if enough are available. Returns
+  // whether they were taken.
+  bool TryMakeRequest(int32_t num_operations, int64_t now_millis);
+
+  // Returns how long to wait until `num_operations` tokens are available, or
+  // zero if they are available now. Returns -1 if the request is larger than
+  // the current capacity.
+  int64_t GetNextRequestDelayMillis(int32_t num_operations,
+                                    int64_t now_millis) const;
+
+  // Returns the number of operations per second allowed at `now_millis`.
+  int32_t CalculateCapacity(int64_t now_millis) const;
+
+ private:
+  void RefillTokens(int64_t now_millis);
+
+  int32_t initial_capacity_;
+  double multiplier_;
+  int64_t multiplier_millis_;
+  int32_t maximum_capacity_;
+  int64_t start_time_millis_;
+
+  int64_t available_tokens_;
+  int64_t last_refill_time_millis_;
+};
+
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIREBASE_FIRESTORE_SRC_COMMON_RATE_LIMITER_H_
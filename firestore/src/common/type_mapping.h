@@ -26,6 +26,8 @@ class AggregateQuery;
 class AggregateQueryInternal;
 class AggregateQuerySnapshot;
 class AggregateQuerySnapshotInternal;
+class BulkWriter;
+class BulkWriterInternal;
 class CollectionReference;
 class CollectionReferenceInternal;
 class DocumentChange;
@@ -67,6 +69,10 @@ struct InternalTypeMap<AggregateQuerySnapshot> {
   using type = AggregateQuerySnapshotInternal;
 };
 template <>
+struct InternalTypeMap<BulkWriter> {
+  using type = BulkWriterInternal;
+};
+template <>
 struct InternalTypeMap<CollectionReference> {
   using type = CollectionReferenceInternal;
 };
@@ -30,6 +30,7 @@
 #include "firebase/firestore/aggregate_query.h"
 #include "firebase/firestore/aggregate_query_snapshot.h"
 #include "firebase/firestore/aggregate_source.h"
+#include "firebase/firestore/bulk_writer.h"
 #include "firebase/firestore/collection_reference.h"
 #include "firebase/firestore/document_change.h"
 #include "firebase/firestore/document_reference.h"
@@ -299,6 +300,27 @@ class Firestore {
    */
   virtual WriteBatch batch() const;
 
+  /**
+   * Creates a bulk writer, used for performing large numbers of independent
+   * writes.
+   *
+   * The writes are committed in batches, several at a time, and throttled so
+   * that the backend has time to scale up.
+   *
+   * @return The created BulkWriter object.
+   */
+  virtual BulkWriter bulk_writer();
+
+  /**
+   * Creates a bulk writer with the given options, used for performing large
+   * numbers of independent writes.
+   *
+   * @param options The options that control how writes are sent.
+   *
+   * @return The created BulkWriter object.
+   */
+  virtual BulkWriter bulk_writer(const BulkWriterOptions& options);
+
   /**
    * Executes the given update and then attempts to commit the changes applied
    * within the transaction. If any document read within the transaction has
@@ -460,6 +482,70 @@ class Firestore {
       const std::string& bundle,
       std::function<void(const LoadBundleTaskProgress&)> progress_callback);
 
+  /**
+   * Loads a Firestore bundle from a file into the local cache.
+   *
+   * The file is read in chunks while the bundle is loaded, so large bundles
+   * don't have to be held in memory.
+   *
+   * @param file_path Path of the file containing the bundle to be loaded.
+   * @return A `Future` that is resolved when the loading is either completed
+   * or aborted due to an error. It fails with `Error::kErrorNotFound` if the
+   * file can't be opened.
+   */
+  virtual Future<LoadBundleTaskProgress> LoadBundleFromFile(
+      const std::string& file_path);
+
+  /**
+   * Loads a Firestore bundle from a file into the local cache, with the
+   * provided callback executed for progress updates.
+   *
+   * @param file_path Path of the file containing the bundle to be loaded.
+   * @param progress_callback A callback that is called with progress
+   * updates, and completion or error updates.
+   * @return A `Future` that is resolved when the loading is either completed
+   * or aborted due to an error. It fails with `Error::kErrorNotFound` if the
+   * file can't be opened.
+   */
+  virtual Future<LoadBundleTaskProgress> LoadBundleFromFile(
+      const std::string& file_path,
+      std::function<void(const LoadBundleTaskProgress&)> progress_callback);
+
+  /**
+   * Reads the next chunk of a bundle into `buffer`, which can hold `capacity`
+   * bytes, and returns the number of bytes read. Returning 0 ends the bundle.
+   *
+   * The reader is called on a background thread, and is destroyed once the
+   * bundle has been read.
+   */
+  using BundleReader = std::function<size_t(char* buffer, size_t capacity)>;
+
+  /**
+   * Loads a Firestore bundle into the local cache, reading it in chunks from
+   * the given reader.
+   *
+   * @param reader A callback that supplies the bundle contents.
+   * @return A `Future` that is resolved when the loading is either completed
+   * or aborted due to an error.
+   */
+  virtual Future<LoadBundleTaskProgress> LoadBundleFromReader(
+      BundleReader reader);
+
+  /**
+   * Loads a Firestore bundle into the local cache, reading it in chunks from
+   * the given reader, with the provided callback executed for progress
+   * updates.
+   *
+   * @param reader A callback that supplies the bundle contents.
+   * @param progress_callback A callback that is called with progress
+   * updates, and completion or error updates.
+   * @return A `Future` that is resolved when the loading is either completed
+   * or aborted due to an error.
+   */
+  virtual Future<LoadBundleTaskProgress> LoadBundleFromReader(
+      BundleReader reader,
+      std::function<void(const LoadBundleTaskProgress&)> progress_callback);
+
   /**
    * Reads a Firestore `Query` from the local cache, identified by the given
    * name.
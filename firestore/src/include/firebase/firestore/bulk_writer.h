@@ -0,0 +1,290 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIREBASE_FIRESTORE_SRC_INCLUDE_FIREBASE_FIRESTORE_BULK_WRITER_H_
+#define FIREBASE_FIRESTORE_SRC_INCLUDE_FIREBASE_FIRESTORE_BULK_WRITER_H_
+
+#include <cstdint>
+
+#include "firebase/firestore/map_field_value.h"
+#include "firebase/firestore/set_options.h"
+
+namespace firebase {
+
+/// @cond FIREBASE_APP_INTERNAL
+template <typename T>
+class Future;
+/// @endcond
+
+namespace firestore {
+
+class BulkWriterInternal;
+class DocumentReference;
+
+/**
+ * Options to customize how a `BulkWriter` sends writes.
+ */
+class BulkWriterOptions final {
+ public:
+  /** @brief Creates the default `BulkWriterOptions`. */
+  BulkWriterOptions() = default;
+
+  /**
+   * @brief Gets whether the number of writes sent per second is limited.
+   *
+   * When enabled, the `BulkWriter` starts at `initial_ops_per_second()` and
+   * raises the limit by 50% every 5 minutes, up to `max_ops_per_second()`.
+   * This gives the backend time to scale up. The default value is true.
+   */
+  bool throttling_enabled() const { return throttling_enabled_; }
+
+  /** @brief Sets whether the number of writes sent per second is limited. */
+  void set_throttling_enabled(bool enabled) { throttling_enabled_ = enabled; }
+
+  /**
+   * @brief Gets the number of writes per second that are sent at first.
+   *
+   * The default value is 500.
+   */
+  int32_t initial_ops_per_second() const { return initial_ops_per_second_; }
+
+  /**
+   * @brief Sets the number of writes per second that are sent at first.
+   *
+   * @param[in] ops_per_second Must be greater than zero, and no more than
+   * `max_ops_per_second()`.
+   */
+  void set_initial_ops_per_second(int32_t ops_per_second);
+
+  /**
+   * @brief Gets the largest number of writes per second that are sent.
+   *
+   * The default value is 10000.
+   */
+  int32_t max_ops_per_second() const { return max_ops_per_second_; }
+
+  /**
+   * @brief Sets the largest number of writes per second that are sent.
+   *
+   * @param[in] ops_per_second Must be no less than
+   * `initial_ops_per_second()`.
+   */
+  void set_max_ops_per_second(int32_t ops_per_second);
+
+  /**
+   * @brief Gets the largest number of writes that are committed together.
+   *
+   * The default value is 500, the most the backend accepts in one commit.
+   */
+  int32_t max_batch_size() const { return max_batch_size_; }
+
+  /**
+   * @brief Sets the largest number of writes that are committed together.
+   *
+   * @param[in] max_batch_size Must be between 1 and 500.
+   */
+  void set_max_batch_size(int32_t max_batch_size);
+
+  /**
+   * @brief Gets the largest number of commits that can be in flight at once.
+   *
+   * The default value is 10.
+   */
+  int32_t max_in_flight_batches() const { return max_in_flight_batches_; }
+
+  /**
+   * @brief Sets the largest number of commits that can be in flight at once.
+   *
+   * @param[in] max_in_flight_batches Must be greater than zero.
+   */
+  void set_max_in_flight_batches(int32_t max_in_flight_batches);
+
+  /**
+   * @brief Gets the number of times a write is attempted before it fails.
+   *
+   * Only writes that fail with a transient error, such as
+   * `Error::kErrorUnavailable`, are retried. The default value is 5.
+   */
+  int32_t max_attempts() const { return max_attempts_; }
+
+  /**
+   * @brief Sets the number of times a write is attempted before it fails.
+   *
+   * @param[in] max_attempts Must be greater than zero.
+   */
+  void set_max_attempts(int32_t max_attempts);
+
+ private:
+  bool throttling_enabled_ = true;
+  int32_t initial_ops_per_second_ = 500;
+  int32_t max_ops_per_second_ = 10000;
+  int32_t max_batch_size_ = 500;
+  int32_t max_in_flight_batches_ = 10;
+  int32_t max_attempts_ = 5;
+};
+
+/**
+ * @brief A bulk writer sends large numbers of writes efficiently.
+ *
+ * Writes added to a `BulkWriter` are grouped into batches that are committed
+ * in parallel. Unlike a `WriteBatch`, the writes are not atomic: each write
+ * has its own `Future`, and succeeds or fails on its own. Writes that fail
+ * with a transient error are retried with backoff.
+ *
+ * Writes to the same document are applied in the order they were added.
+ * Writes to different documents may be applied in any order.
+ *
+ * Create a `BulkWriter` with `Firestore::bulk_writer()`, and call `Close()`
+ * once all writes have been added.
+ *
+ * @note Firestore classes are not meant to be subclassed except for use in test
+ * mocks. Subclassing is not supported in production code and new SDK releases
+ * may break code that does so.
+ */
+class BulkWriter {
+ public:
+  /**
+   * @brief Creates an invalid BulkWriter that has to be reassigned before it
+   * can be used.
+   *
+   * Calling any member function on an invalid BulkWriter will be a no-op. If
+   * the function returns a value, it will return a zero, empty, or invalid
+   * value, depending on the type of the value.
+   */
+  BulkWriter();
+
+  /**
+   * @brief Move constructor.
+   *
+   * After being moved from, a `BulkWriter` is equivalent to its
+   * default-constructed state.
+   *
+   * @param[in] other `BulkWriter` to move data from.
+   */
+  BulkWriter(BulkWriter&& other);
+
+  /**
+   * @brief Sends any writes that haven't been sent yet.
+   *
+   * Writes that are still pending keep being sent, and their futures still
+   * complete, after the `BulkWriter` is destroyed.
+   */
+  virtual ~BulkWriter();
+
+  /**
+   * @brief Move assignment operator.
+   *
+   * After being moved from, a `BulkWriter` is equivalent to its
+   * default-constructed state.
+   *
+   * @param[in] other `BulkWriter` to move data from.
+   *
+   * @return Reference to the destination `BulkWriter`.
+   */
+  BulkWriter& operator=(BulkWriter&& other);
+
+  /**
+   * @brief Writes to the document referred to by the provided reference.
+   *
+   * @param document The DocumentReference to write to.
+   * @param data A map of the fields and values to write to the document.
+   * @param[in] options An object to configure the Set() behavior (optional).
+   *
+   * @return A Future that will be resolved when this write finishes.
+   */
+  virtual Future<void> Set(const DocumentReference& document,
+                           const MapFieldValue& data,
+                           const SetOptions& options = SetOptions());
+
+  /**
+   * Updates fields in the document referred to by the provided reference. If no
+   * document exists yet, the update will fail.
+   *
+   * @param document The DocumentReference to update.
+   * @param data A map of field / value pairs to update. Fields can contain dots
+   * to reference nested fields within the document.
+   * @return A Future that will be resolved when this write finishes.
+   */
+  virtual Future<void> Update(const DocumentReference& document,
+                              const MapFieldValue& data);
+
+  /**
+   * Updates fields in the document referred to by the provided reference. If no
+   * document exists yet, the update will fail.
+   *
+   * @param document The DocumentReference to update.
+   * @param data A map from FieldPath to FieldValue to update.
+   * @return A Future that will be resolved when this write finishes.
+   */
+  virtual Future<void> Update(const DocumentReference& document,
+                              const MapFieldPathValue& data);
+
+  /**
+   * Deletes the document referred to by the provided reference.
+   *
+   * @param document The DocumentReference to delete.
+   * @return A Future that will be resolved when this write finishes.
+   */
+  virtual Future<void> Delete(const DocumentReference& document);
+
+  /**
+   * Sends all writes added so far, without waiting for their batches to fill
+   * up.
+   *
+   * @return A Future that will be resolved when all writes added before this
+   * call have finished, whether they succeeded or failed.
+   */
+  virtual Future<void> Flush();
+
+  /**
+   * Sends all writes added so far, and stops accepting new writes. Writes
+   * added after this call fail with `Error::kErrorFailedPrecondition`.
+   *
+   * @return A Future that will be resolved when all writes have finished,
+   * whether they succeeded or failed.
+   */
+  virtual Future<void> Close();
+
+  /**
+   * @brief Returns true if this `BulkWriter` is valid, false if it is not
+   * valid. An invalid `BulkWriter` could be the result of:
+   *   - Creating a `BulkWriter` using the default constructor.
+   *   - Moving from the `BulkWriter`.
+   *   - Deleting your Firestore instance, which will invalidate all the
+   *     `BulkWriter` instances associated with it.
+   *
+   * @return true if this `BulkWriter` is valid, false if this `BulkWriter` is
+   * invalid.
+   */
+  bool is_valid() const { return internal_ != nullptr; }
+
+ private:
+  BulkWriter(const BulkWriter&) = delete;
+  BulkWriter& operator=(const BulkWriter&) = delete;
+
+  friend class Firestore;
+  template <typename T, typename U, typename F>
+  friend struct CleanupFn;
+
+  explicit BulkWriter(BulkWriterInternal* internal);
+
+  BulkWriterInternal* internal_ = nullptr;
+};
+
+}  // namespace firestore
+}  // namespace firebase
+
+#endif  // FIREBASE_FIRESTORE_SRC_INCLUDE_FIREBASE_FIRESTORE_BULK_WRITER_H_
@@ -17,6 +17,8 @@
 #ifndef FIREBASE_FIRESTORE_SRC_INCLUDE_FIREBASE_FIRESTORE_DOCUMENT_SNAPSHOT_H_
 #define FIREBASE_FIRESTORE_SRC_INCLUDE_FIREBASE_FIRESTORE_DOCUMENT_SNAPSHOT_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
 #include <string>
 
@@ -24,6 +26,9 @@
 #include "firebase/firestore/snapshot_metadata.h"
 
 namespace firebase {
+
+class Timestamp;
+
 namespace firestore {
 
 class DocumentReference;
@@ -31,6 +36,7 @@ class DocumentSnapshotInternal;
 class FieldPath;
 class FieldValue;
 class Firestore;
+class GeoPoint;
 
 /**
  * @brief A DocumentSnapshot contains data read from a document in your
@@ -82,6 +88,55 @@ class DocumentSnapshot {
     kDefault = 0,
   };
 
+  /**
+   * @brief Receives the values in a document from VisitData() or Visit().
+   *
+   * Override the methods for the types of values you are interested in. Each
+   * method receives the key of the value in the map that contains it; the key
+   * is null for array elements and for the value passed to Visit(). Keys,
+   * strings and blobs point into the snapshot and are only valid during the
+   * call.
+   */
+  class FieldVisitor {
+   public:
+    virtual ~FieldVisitor() = default;
+
+    virtual void OnNull(const char* key, size_t key_size) {}
+    virtual void OnBoolean(const char* key, size_t key_size, bool value) {}
+    virtual void OnInteger(const char* key, size_t key_size, int64_t value) {}
+    virtual void OnDouble(const char* key, size_t key_size, double value) {}
+    virtual void OnTimestamp(const char* key, size_t key_size,
+                             const Timestamp& value) {}
+    virtual void OnString(const char* key, size_t key_size, const char* value,
+                          size_t value_size) {}
+    virtual void OnBlob(const char* key, size_t key_size, const uint8_t* value,
+                        size_t value_size) {}
+    virtual void OnReference(const char* key, size_t key_size,
+                             const DocumentReference& value) {}
+    virtual void OnGeoPoint(const char* key, size_t key_size,
+                            const GeoPoint& value) {}
+
+    /**
+     * @brief Called before the fields of a map are visited.
+     *
+     * @return Whether to visit the fields of the map. If false, OnMapEnd() is
+     * not called for this map.
+     */
+    virtual bool OnMapBegin(const char* key, size_t key_size) { return true; }
+    virtual void OnMapEnd() {}
+
+    /**
+     * @brief Called before the elements of an array are visited.
+     *
+     * @return Whether to visit the elements of the array. If false,
+     * OnArrayEnd() is not called for this array.
+     */
+    virtual bool OnArrayBegin(const char* key, size_t key_size) {
+      return true;
+    }
+    virtual void OnArrayEnd() {}
+  };
+
   /**
    * @brief Creates an invalid DocumentSnapshot that has to be reassigned before
    * it can be used.
@@ -229,6 +284,42 @@ class DocumentSnapshot {
       const FieldPath& field,
       ServerTimestampBehavior stb = ServerTimestampBehavior::kDefault) const;
 
+  /**
+   * @brief Visits all fields in the document without converting them to
+   * FieldValues.
+   *
+   * This is cheaper than GetData() when only some of the fields of a document
+   * are needed, as no values are copied unless the visitor copies them.
+   *
+   * @note On Android the document is converted to FieldValues first, so this
+   * is no cheaper than GetData().
+   *
+   * @param visitor Receives each top-level field of the document, followed by
+   * the contents of the field if it is a map or an array. Nothing is visited
+   * if the document doesn't exist.
+   * @param stb Configures how server timestamps that have not yet been set to
+   * their final value are passed to the visitor (optional).
+   */
+  virtual void VisitData(
+      FieldVisitor* visitor,
+      ServerTimestampBehavior stb = ServerTimestampBehavior::kDefault) const;
+
+  /**
+   * @brief Visits a specific field of the document without converting it to
+   * a FieldValue.
+   *
+   * @param field Path of the field to visit.
+   * @param visitor Receives the value of the field, with a null key, followed
+   * by its contents if it is a map or an array.
+   * @param stb Configures how server timestamps that have not yet been set to
+   * their final value are passed to the visitor (optional).
+   *
+   * @return Whether the field exists in the document.
+   */
+  virtual bool Visit(
+      const FieldPath& field, FieldVisitor* visitor,
+      ServerTimestampBehavior stb = ServerTimestampBehavior::kDefault) const;
+
   /**
    * @brief Returns true if this `DocumentSnapshot` is valid, false if it is
    * not valid. An invalid `DocumentSnapshot` could be the result of:
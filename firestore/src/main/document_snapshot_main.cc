@@ -44,6 +44,19 @@ using model::IsServerTimestamp;
 using nanopb::MakeString;
 using nanopb::Message;
 
+namespace {
+
+// Returns the contents of a nanopb string or byte array without copying them.
+const char* BytesData(const pb_bytes_array_t* bytes) {
+  return bytes ? reinterpret_cast<const char*>(bytes->bytes) : "";
+}
+
+size_t BytesSize(const pb_bytes_array_t* bytes) {
+  return bytes ? bytes->size : 0;
+}
+
+}  // namespace
+
 DocumentSnapshotInternal::DocumentSnapshotInternal(
     api::DocumentSnapshot&& snapshot)
     : snapshot_{std::move(snapshot)} {}
@@ -81,10 +94,7 @@ MapFieldValue DocumentSnapshotInternal::GetData(
       snapshot_.GetValue(model::FieldPath::EmptyPath());
   if (!data) return MapFieldValue{};
 
-  FieldValue result = ConvertObject(data->map_value, stb);
-  SIMPLE_HARD_ASSERT(result.type() == FieldValue::Type::kMap,
-                     "Expected snapshot data to parse to a map");
-  return result.map_value();
+  return ConvertMap(data->map_value, stb);
 }
 
 FieldValue DocumentSnapshotInternal::Get(const FieldPath& field,
@@ -120,23 +130,31 @@ FieldValue DocumentSnapshotInternal::ConvertAnyValue(
   }
 }
 
-FieldValue DocumentSnapshotInternal::ConvertObject(
+MapFieldValue DocumentSnapshotInternal::ConvertMap(
     const google_firestore_v1_MapValue& object,
     ServerTimestampBehavior stb) const {
   MapFieldValue result;
+  result.reserve(object.fields_count);
   for (pb_size_t i = 0; i < object.fields_count; ++i) {
     std::string key = MakeString(object.fields[i].key);
     const google_firestore_v1_Value& value = object.fields[i].value;
     result[std::move(key)] = ConvertAnyValue(value, stb);
   }
 
-  return FieldValue::Map(std::move(result));
+  return result;
+}
+
+FieldValue DocumentSnapshotInternal::ConvertObject(
+    const google_firestore_v1_MapValue& object,
+    ServerTimestampBehavior stb) const {
+  return FieldValue::Map(ConvertMap(object, stb));
 }
 
 FieldValue DocumentSnapshotInternal::ConvertArray(
     const google_firestore_v1_ArrayValue& array,
     ServerTimestampBehavior stb) const {
   std::vector<FieldValue> result;
+  result.reserve(array.values_count);
   for (pb_size_t i = 0; i < array.values_count; ++i) {
     result.push_back(ConvertAnyValue(array.values[i], stb));
   }
@@ -181,6 +199,11 @@ FieldValue DocumentSnapshotInternal::ConvertScalar(
 
 FieldValue DocumentSnapshotInternal::ConvertReference(
     const google_firestore_v1_Value& reference) const {
+  return FieldValue::Reference(MakeReference(reference));
+}
+
+DocumentReference DocumentSnapshotInternal::MakeReference(
+    const google_firestore_v1_Value& reference) const {
   std::string ref = MakeString(reference.reference_value);
   DatabaseId database_id = DatabaseId::FromName(ref);
   DocumentKey key = DocumentKey::FromName(ref);
@@ -189,7 +212,7 @@ FieldValue DocumentSnapshotInternal::ConvertReference(
                      "Converted reference is from another database");
 
   api::DocumentReference api_reference{std::move(key), snapshot_.firestore()};
-  return FieldValue::Reference(MakePublic(std::move(api_reference)));
+  return MakePublic(std::move(api_reference));
 }
 
 FieldValue DocumentSnapshotInternal::ConvertServerTimestamp(
@@ -215,6 +238,125 @@ FieldValue DocumentSnapshotInternal::ConvertServerTimestamp(
   FIRESTORE_UNREACHABLE();
 }
 
+// Visiting
+
+void DocumentSnapshotInternal::VisitData(FieldVisitor* visitor,
+                                         ServerTimestampBehavior stb) const {
+  absl::optional<google_firestore_v1_Value> data =
+      snapshot_.GetValue(model::FieldPath::EmptyPath());
+  if (data) VisitFields(data->map_value, visitor, stb);
+}
+
+bool DocumentSnapshotInternal::Visit(const FieldPath& field,
+                                     FieldVisitor* visitor,
+                                     ServerTimestampBehavior stb) const {
+  absl::optional<google_firestore_v1_Value> value =
+      snapshot_.GetValue(GetInternal(field));
+  if (!value) return false;
+
+  VisitValue(nullptr, 0, *value, visitor, stb);
+  return true;
+}
+
+void DocumentSnapshotInternal::VisitFields(
+    const google_firestore_v1_MapValue& object, FieldVisitor* visitor,
+    ServerTimestampBehavior stb) const {
+  for (pb_size_t i = 0; i < object.fields_count; ++i) {
+    const pb_bytes_array_t* key = object.fields[i].key;
+    VisitValue(BytesData(key), BytesSize(key), object.fields[i].value, visitor,
+               stb);
+  }
+}
+
+void DocumentSnapshotInternal::VisitValue(
+    const char* key, size_t key_size, const google_firestore_v1_Value& value,
+    FieldVisitor* visitor, ServerTimestampBehavior stb) const {
+  switch (value.which_value_type) {
+    case google_firestore_v1_Value_null_value_tag:
+      visitor->OnNull(key, key_size);
+      break;
+    case google_firestore_v1_Value_boolean_value_tag:
+      visitor->OnBoolean(key, key_size, value.boolean_value);
+      break;
+    case google_firestore_v1_Value_integer_value_tag:
+      visitor->OnInteger(key, key_size, value.integer_value);
+      break;
+    case google_firestore_v1_Value_double_value_tag:
+      visitor->OnDouble(key, key_size, value.double_value);
+      break;
+    case google_firestore_v1_Value_string_value_tag:
+      visitor->OnString(key, key_size, BytesData(value.string_value),
+                        BytesSize(value.string_value));
+      break;
+    case google_firestore_v1_Value_timestamp_value_tag:
+      visitor->OnTimestamp(key, key_size,
+                           Timestamp(value.timestamp_value.seconds,
+                                     value.timestamp_value.nanos));
+      break;
+    case google_firestore_v1_Value_geo_point_value_tag:
+      visitor->OnGeoPoint(key, key_size,
+                          GeoPoint(value.geo_point_value.latitude,
+                                   value.geo_point_value.longitude));
+      break;
+    case google_firestore_v1_Value_bytes_value_tag:
+      visitor->OnBlob(key, key_size,
+                      value.bytes_value ? value.bytes_value->bytes : nullptr,
+                      BytesSize(value.bytes_value));
+      break;
+    case google_firestore_v1_Value_reference_value_tag:
+      visitor->OnReference(key, key_size, MakeReference(value));
+      break;
+    case google_firestore_v1_Value_map_value_tag:
+      if (IsServerTimestamp(value)) {
+        VisitServerTimestamp(key, key_size, value, visitor, stb);
+      } else if (visitor->OnMapBegin(key, key_size)) {
+        VisitFields(value.map_value, visitor, stb);
+        visitor->OnMapEnd();
+      }
+      break;
+    case google_firestore_v1_Value_array_value_tag:
+      if (visitor->OnArrayBegin(key, key_size)) {
+        for (pb_size_t i = 0; i < value.array_value.values_count; ++i) {
+          VisitValue(nullptr, 0, value.array_value.values[i], visitor, stb);
+        }
+        visitor->OnArrayEnd();
+      }
+      break;
+    default: {
+      auto message = std::string("Unexpected kind of FieldValue");
+      SIMPLE_HARD_FAIL(message);
+    }
+  }
+}
+
+void DocumentSnapshotInternal::VisitServerTimestamp(
+    const char* key, size_t key_size,
+    const google_firestore_v1_Value& server_timestamp, FieldVisitor* visitor,
+    ServerTimestampBehavior stb) const {
+  switch (stb) {
+    case ServerTimestampBehavior::kNone:
+      visitor->OnNull(key, key_size);
+      return;
+    case ServerTimestampBehavior::kEstimate: {
+      google_protobuf_Timestamp timestamp = GetLocalWriteTime(server_timestamp);
+      visitor->OnTimestamp(key, key_size,
+                           Timestamp(timestamp.seconds, timestamp.nanos));
+      return;
+    }
+    case ServerTimestampBehavior::kPrevious: {
+      absl::optional<google_firestore_v1_Value> previous_value =
+          GetPreviousValue(server_timestamp);
+      if (previous_value) {
+        VisitValue(key, key_size, *previous_value, visitor, stb);
+      } else {
+        visitor->OnNull(key, key_size);
+      }
+      return;
+    }
+  }
+  FIRESTORE_UNREACHABLE();
+}
+
 bool operator==(const DocumentSnapshotInternal& lhs,
                 const DocumentSnapshotInternal& rhs) {
   return lhs.snapshot_ == rhs.snapshot_;
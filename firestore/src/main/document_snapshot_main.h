@@ -57,6 +57,12 @@ class DocumentSnapshotInternal {
   FieldValue Get(const FieldPath& field,
                  DocumentSnapshot::ServerTimestampBehavior stb) const;
 
+  void VisitData(DocumentSnapshot::FieldVisitor* visitor,
+                 DocumentSnapshot::ServerTimestampBehavior stb) const;
+
+  bool Visit(const FieldPath& field, DocumentSnapshot::FieldVisitor* visitor,
+             DocumentSnapshot::ServerTimestampBehavior stb) const;
+
   const api::DocumentSnapshot& document_snapshot_core() const {
     return snapshot_;
   }
@@ -69,6 +75,7 @@ class DocumentSnapshotInternal {
                          const DocumentSnapshotInternal& rhs);
 
  private:
+  using FieldVisitor = DocumentSnapshot::FieldVisitor;
   using ServerTimestampBehavior = DocumentSnapshot::ServerTimestampBehavior;
 
   FieldValue GetValue(const model::FieldPath& path,
@@ -78,17 +85,33 @@ class DocumentSnapshotInternal {
   // is needed to create a `DocumentReferenceInternal`.
   FieldValue ConvertAnyValue(const google_firestore_v1_Value& input,
                              ServerTimestampBehavior stb) const;
+  MapFieldValue ConvertMap(const google_firestore_v1_MapValue& object,
+                           ServerTimestampBehavior stb) const;
   FieldValue ConvertObject(const google_firestore_v1_MapValue& object,
                            ServerTimestampBehavior stb) const;
   FieldValue ConvertArray(const google_firestore_v1_ArrayValue& array,
                           ServerTimestampBehavior stb) const;
   FieldValue ConvertReference(const google_firestore_v1_Value& reference) const;
+  DocumentReference MakeReference(
+      const google_firestore_v1_Value& reference) const;
   FieldValue ConvertServerTimestamp(
       const google_firestore_v1_Value& server_timestamp,
       ServerTimestampBehavior stb) const;
   FieldValue ConvertScalar(const google_firestore_v1_Value& scalar,
                            ServerTimestampBehavior stb) const;
 
+  // Pass values to a FieldVisitor straight from the proto, without converting
+  // them to FieldValues.
+  void VisitValue(const char* key, size_t key_size,
+                  const google_firestore_v1_Value& value,
+                  FieldVisitor* visitor, ServerTimestampBehavior stb) const;
+  void VisitFields(const google_firestore_v1_MapValue& object,
+                   FieldVisitor* visitor, ServerTimestampBehavior stb) const;
+  void VisitServerTimestamp(const char* key, size_t key_size,
+                            const google_firestore_v1_Value& server_timestamp,
+                            FieldVisitor* visitor,
+                            ServerTimestampBehavior stb) const;
+
   api::DocumentSnapshot snapshot_;
 };
 
@@ -16,10 +16,13 @@
 
 #include "firestore/src/main/firestore_main.h"
 
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 #include "Firestore/core/src/api/document_reference.h"
 #include "Firestore/core/src/api/query_core.h"
@@ -89,6 +92,46 @@ LoadBundleTaskProgress ToApiProgress(
           ToApiProgressState(internal_progress.state())};
 }
 
+// Stream buffer that pulls a bundle from a Firestore::BundleReader one chunk
+// at a time.
+class BundleReaderStreamBuf : public std::streambuf {
+ public:
+  explicit BundleReaderStreamBuf(Firestore::BundleReader reader)
+      : reader_(std::move(reader)), buffer_(kChunkSize) {}
+
+ protected:
+  int_type underflow() override {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    size_t size = reader_ ? reader_(buffer_.data(), buffer_.size()) : 0;
+    if (size == 0) {
+      // Release anything the reader holds on to as soon as it's done.
+      reader_ = nullptr;
+      return traits_type::eof();
+    }
+    size = std::min(size, buffer_.size());
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + size);
+    return traits_type::to_int_type(*gptr());
+  }
+
+ private:
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  Firestore::BundleReader reader_;
+  std::vector<char> buffer_;
+};
+
+// Input stream over a BundleReaderStreamBuf.
+class BundleReaderStream : public std::istream {
+ public:
+  explicit BundleReaderStream(Firestore::BundleReader reader)
+      : std::istream(nullptr), buffer_(std::move(reader)) {
+    rdbuf(&buffer_);
+  }
+
+ private:
+  BundleReaderStreamBuf buffer_;
+};
+
 void ValidateDoubleSlash(const char* path) {
   if (std::strstr(path, "//") != nullptr) {
     // TODO(b/147444199): use string formatting.
@@ -391,42 +434,63 @@ void FirestoreInternal::SetClientLanguage(const std::string& language_token) {
 
 Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundle(
     const std::string& bundle) {
-  auto promise = promise_factory_.CreatePromise<LoadBundleTaskProgress>(
-      AsyncApi::kLoadBundle);
-  auto bundle_stream = std::make_unique<util::ByteStreamCpp>(
-      std::make_unique<std::stringstream>(bundle));
-
-  std::shared_ptr<api::LoadBundleTask> task =
-      firestore_core_->LoadBundle(std::move(bundle_stream));
-  task->Observe(
-      [promise, task](const api::LoadBundleTaskProgress& progress) mutable {
-        if (progress.state() == api::LoadBundleTaskState::kSuccess) {
-          promise.SetValue(ToApiProgress(progress));
-          task->RemoveAllObservers();
-
-        } else if (progress.state() == api::LoadBundleTaskState::kError) {
-          promise.SetError(progress.error_status());
-          task->RemoveAllObservers();
-        }
-      });
-
-  return promise.future();
+  return LoadBundleFromStream(std::make_unique<std::istringstream>(bundle),
+                              nullptr);
 }
 
 Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundle(
     const std::string& bundle,
     std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
+  return LoadBundleFromStream(std::make_unique<std::istringstream>(bundle),
+                              std::move(progress_callback));
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundleFromFile(
+    const std::string& file_path) {
+  return LoadBundleFromFile(file_path, nullptr);
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundleFromFile(
+    const std::string& file_path,
+    std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
+  auto file = std::make_unique<std::ifstream>(file_path, std::ios::binary);
+  if (!file->is_open()) {
+    auto promise = promise_factory_.CreatePromise<LoadBundleTaskProgress>(
+        AsyncApi::kLoadBundle);
+    promise.SetError(Status(Error::kErrorNotFound,
+                            "Could not open bundle file " + file_path));
+    return promise.future();
+  }
+  return LoadBundleFromStream(std::move(file), std::move(progress_callback));
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundleFromReader(
+    Firestore::BundleReader reader) {
+  return LoadBundleFromStream(
+      std::make_unique<BundleReaderStream>(std::move(reader)), nullptr);
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundleFromReader(
+    Firestore::BundleReader reader,
+    std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
+  return LoadBundleFromStream(
+      std::make_unique<BundleReaderStream>(std::move(reader)),
+      std::move(progress_callback));
+}
+
+Future<LoadBundleTaskProgress> FirestoreInternal::LoadBundleFromStream(
+    std::unique_ptr<std::istream> bundle,
+    std::function<void(const LoadBundleTaskProgress&)> progress_callback) {
   auto promise = promise_factory_.CreatePromise<LoadBundleTaskProgress>(
       AsyncApi::kLoadBundle);
-  auto bundle_stream = std::make_unique<util::ByteStreamCpp>(
-      std::make_unique<std::stringstream>(bundle));
+  auto bundle_stream = std::make_unique<util::ByteStreamCpp>(std::move(bundle));
 
   std::shared_ptr<api::LoadBundleTask> task =
       firestore_core_->LoadBundle(std::move(bundle_stream));
   // TODO(C++14): Move progress_callback into the lambda.
   task->Observe([promise, task, progress_callback](
                     const api::LoadBundleTaskProgress& progress) mutable {
-    progress_callback(ToApiProgress(progress));
+    if (progress_callback) progress_callback(ToApiProgress(progress));
     if (progress.state() == api::LoadBundleTaskState::kSuccess) {
       promise.SetValue(ToApiProgress(progress));
       task->RemoveAllObservers();
@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <istream>
 #include <memory>
 #include <mutex>  // NOLINT(build/c++11)
 #include <string>
@@ -31,6 +32,7 @@
 #include "app/src/future_manager.h"
 #include "app/src/include/firebase/app.h"
 #include "firestore/src/common/event_listener.h"
+#include "firestore/src/include/firebase/firestore.h"
 #include "firestore/src/include/firebase/firestore/collection_reference.h"
 #include "firestore/src/include/firebase/firestore/document_reference.h"
 #include "firestore/src/include/firebase/firestore/load_bundle_task_progress.h"
@@ -115,6 +117,16 @@ class FirestoreInternal {
   Future<LoadBundleTaskProgress> LoadBundle(
       const std::string& bundle,
       std::function<void(const LoadBundleTaskProgress&)> progress_callback);
+  Future<LoadBundleTaskProgress> LoadBundleFromFile(
+      const std::string& file_path);
+  Future<LoadBundleTaskProgress> LoadBundleFromFile(
+      const std::string& file_path,
+      std::function<void(const LoadBundleTaskProgress&)> progress_callback);
+  Future<LoadBundleTaskProgress> LoadBundleFromReader(
+      Firestore::BundleReader reader);
+  Future<LoadBundleTaskProgress> LoadBundleFromReader(
+      Firestore::BundleReader reader,
+      std::function<void(const LoadBundleTaskProgress&)> progress_callback);
   Future<Query> NamedQuery(const std::string& query_name);
 
   // Manages the ListenerRegistrationInternal objects.
@@ -173,6 +185,11 @@ class FirestoreInternal {
 
   void ApplyDefaultSettings();
 
+  // Loads the bundle read from the given stream.
+  Future<LoadBundleTaskProgress> LoadBundleFromStream(
+      std::unique_ptr<std::istream> bundle,
+      std::function<void(const LoadBundleTaskProgress&)> progress_callback);
+
   App* app_ = nullptr;
   Firestore* firestore_public_ = nullptr;
   std::shared_ptr<api::Firestore> firestore_core_;
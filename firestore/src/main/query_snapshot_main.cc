@@ -66,11 +66,12 @@ std::vector<DocumentChange> QuerySnapshotInternal::DocumentChanges(
 std::vector<DocumentSnapshot> QuerySnapshotInternal::documents() const {
   if (!documents_) {
     std::vector<DocumentSnapshot> result;
+    result.reserve(snapshot_.size());
     snapshot_.ForEachDocument([&result](api::DocumentSnapshot snapshot) {
       result.push_back(MakePublic(std::move(snapshot)));
     });
 
-    documents_ = result;
+    documents_ = std::move(result);
   }
 
   return documents_.value();
@@ -305,6 +305,7 @@ Future<HttpsCallableResult> HttpsCallableReferenceInternal::Call(
   request_.set_url(url_.data());
   request_.set_method(rest::util::kPost);
   request_.add_header(rest::util::kContentType, rest::util::kApplicationJson);
+  request_.add_header(rest::util::kAcceptEncoding, rest::util::kGzip);
 
   // Add the auth token header.
   std::string token = GetAuthToken();
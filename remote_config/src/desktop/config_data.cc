@@ -21,6 +21,82 @@ namespace firebase {
 namespace remote_config {
 namespace internal {
 
+NamespacedConfigDelta::NamespacedConfigDelta() : timestamp(0) {}
+
+std::string NamespacedConfigDelta::Serialize() const {
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Map("updated", [&]() {
+      for (const auto& key_to_map : updated) {
+        fbb.Add(key_to_map.first.c_str(), key_to_map.second);
+      }
+    });
+    fbb.Map("removed", [&]() {
+      for (const auto& key_to_set : removed) {
+        fbb.Vector(key_to_set.first.c_str(), [&]() {
+          for (const std::string& key : key_to_set.second) fbb.String(key);
+        });
+      }
+    });
+    fbb.UInt("timestamp", timestamp);
+  });
+  fbb.Finish();
+  const std::vector<uint8_t>& buffer = fbb.GetBuffer();
+  return std::string(buffer.cbegin(), buffer.cend());
+}
+
+void NamespacedConfigDelta::Deserialize(const std::string& buffer) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer.data());
+  size_t size = buffer.size();
+  auto struct_map = flexbuffers::GetRoot(data, size).AsMap();
+  flexbuffers::Map updated_map = struct_map["updated"].AsMap();
+  for (int i = 0, in = updated_map.size(); i < in; ++i) {
+    DeserializeMap(&updated[updated_map.Keys()[i].AsKey()],
+                   updated_map.Values()[i].AsMap());
+  }
+  flexbuffers::Map removed_map = struct_map["removed"].AsMap();
+  for (int i = 0, in = removed_map.size(); i < in; ++i) {
+    std::set<std::string>& keys = removed[removed_map.Keys()[i].AsKey()];
+    flexbuffers::Vector key_vector = removed_map.Values()[i].AsVector();
+    for (int j = 0, jn = key_vector.size(); j < jn; ++j) {
+      keys.insert(key_vector[j].AsString().str());
+    }
+  }
+  timestamp = struct_map["timestamp"].AsUInt64();
+}
+
+bool NamespacedConfigDelta::empty() const {
+  for (const auto& key_to_map : updated) {
+    if (!key_to_map.second.empty()) return false;
+  }
+  for (const auto& key_to_set : removed) {
+    if (!key_to_set.second.empty()) return false;
+  }
+  return true;
+}
+
+std::vector<std::string> NamespacedConfigDelta::GetUpdatedKeys(
+    const std::string& name_space) const {
+  std::set<std::string> keys;
+  auto updated_iter = updated.find(name_space);
+  if (updated_iter != updated.end()) {
+    for (const auto& key_value : updated_iter->second) {
+      keys.insert(key_value.first);
+    }
+  }
+  auto removed_iter = removed.find(name_space);
+  if (removed_iter != removed.end()) {
+    keys.insert(removed_iter->second.begin(), removed_iter->second.end());
+  }
+  return std::vector<std::string>(keys.begin(), keys.end());
+}
+
+bool NamespacedConfigDelta::operator==(
+    const NamespacedConfigDelta& right) const {
+  return updated == right.updated && removed == right.removed &&
+         timestamp == right.timestamp;
+}
+
 NamespacedConfigData::NamespacedConfigData()
     : config_(NamespaceKeyValueMap()), timestamp_(0) {}
 
@@ -105,12 +181,94 @@ void NamespacedConfigData::GetKeysByPrefix(const std::string& prefix,
   }
 }
 
+NamespacedConfigDelta NamespacedConfigData::Diff(
+    const NamespacedConfigData& to) const {
+  static const std::map<std::string, std::string> kEmptyNamespace;
+  NamespacedConfigDelta delta;
+  delta.timestamp = to.timestamp_;
+
+  // Walk the sorted namespaces and keys of both configs in step, so the diff
+  // is linear in the number of records.
+  auto from_ns = config_.begin();
+  auto to_ns = to.config_.begin();
+  while (from_ns != config_.end() || to_ns != to.config_.end()) {
+    const std::string* name_space;
+    const std::map<std::string, std::string>* from_records = &kEmptyNamespace;
+    const std::map<std::string, std::string>* to_records = &kEmptyNamespace;
+    if (to_ns == to.config_.end() ||
+        (from_ns != config_.end() && from_ns->first < to_ns->first)) {
+      // Namespace removed.
+      name_space = &from_ns->first;
+      from_records = &(from_ns++)->second;
+      delta.removed[*name_space];
+    } else if (from_ns == config_.end() || to_ns->first < from_ns->first) {
+      // Namespace added.
+      name_space = &to_ns->first;
+      to_records = &(to_ns++)->second;
+      delta.updated[*name_space];
+    } else {
+      name_space = &from_ns->first;
+      from_records = &(from_ns++)->second;
+      to_records = &(to_ns++)->second;
+      // Keep the namespace if all its records are removed.
+      if (to_records->empty() && !from_records->empty()) {
+        delta.updated[*name_space];
+      }
+    }
+
+    auto from_kv = from_records->begin();
+    auto to_kv = to_records->begin();
+    while (from_kv != from_records->end() || to_kv != to_records->end()) {
+      if (to_kv == to_records->end() ||
+          (from_kv != from_records->end() && from_kv->first < to_kv->first)) {
+        delta.removed[*name_space].insert((from_kv++)->first);
+      } else if (from_kv == from_records->end() ||
+                 to_kv->first < from_kv->first) {
+        delta.updated[*name_space].insert(*to_kv++);
+      } else {
+        if (from_kv->second != to_kv->second) {
+          delta.updated[*name_space].insert(*to_kv);
+        }
+        ++from_kv;
+        ++to_kv;
+      }
+    }
+  }
+  return delta;
+}
+
+void NamespacedConfigData::ApplyDelta(const NamespacedConfigDelta& delta) {
+  for (const auto& key_to_set : delta.removed) {
+    auto name_space_iter = config_.find(key_to_set.first);
+    if (name_space_iter == config_.end()) continue;
+    for (const std::string& key : key_to_set.second) {
+      name_space_iter->second.erase(key);
+    }
+    // Namespaces that still exist in the new version are listed in `updated`.
+    if (name_space_iter->second.empty() &&
+        delta.updated.find(key_to_set.first) == delta.updated.end()) {
+      config_.erase(name_space_iter);
+    }
+  }
+  for (const auto& key_to_map : delta.updated) {
+    std::map<std::string, std::string>& records = config_[key_to_map.first];
+    for (const auto& key_value : key_to_map.second) {
+      records[key_value.first] = key_value.second;
+    }
+  }
+  timestamp_ = delta.timestamp;
+}
+
 const NamespaceKeyValueMap& NamespacedConfigData::config() const {
   return config_;
 }
 
 uint64_t NamespacedConfigData::timestamp() const { return timestamp_; }
 
+void NamespacedConfigData::set_timestamp(uint64_t timestamp) {
+  timestamp_ = timestamp;
+}
+
 bool NamespacedConfigData::operator==(const NamespacedConfigData& right) const {
   return config_ == right.config_ && timestamp_ == right.timestamp_;
 }
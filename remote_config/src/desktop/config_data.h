@@ -19,6 +19,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "remote_config/src/desktop/metadata.h"
 
@@ -32,6 +33,34 @@ namespace internal {
 typedef std::map<std::string, std::map<std::string, std::string>>
     NamespaceKeyValueMap;
 
+// Difference between two versions of a `NamespacedConfigData`: the records
+// that were added or changed and the keys that were removed, per namespace.
+struct NamespacedConfigDelta {
+  NamespacedConfigDelta();
+
+  // Serialize to a buffer as a string.
+  std::string Serialize() const;
+  // Deserializes a string buffer previously Serialized.
+  void Deserialize(const std::string& buffer);
+
+  // Returns true if no records were added, changed or removed. Namespaces
+  // that were added or removed without any records are not counted.
+  bool empty() const;
+
+  // Keys of the records that were added, changed or removed in `name_space`.
+  std::vector<std::string> GetUpdatedKeys(const std::string& name_space) const;
+
+  bool operator==(const NamespacedConfigDelta& right) const;
+
+  // Added or changed key/value records for each namespace. Also has an empty
+  // entry for namespaces that are added, or emptied but kept, without records.
+  NamespaceKeyValueMap updated;
+  // Removed keys for each namespace.
+  std::map<std::string, std::set<std::string>> removed;
+  // Timestamp of the new version.
+  uint64_t timestamp;
+};
+
 // Use to keep and work with key/value records. Each namespace contains some
 // amount of key/value records.
 //
@@ -65,8 +94,15 @@ class NamespacedConfigData {
   void GetKeysByPrefix(const std::string& prefix, const std::string& name_space,
                        std::set<std::string>* keys) const;
 
+  // Returns the changes that turn this config into `to`.
+  NamespacedConfigDelta Diff(const NamespacedConfigData& to) const;
+
+  // Apply changes previously computed by `Diff`.
+  void ApplyDelta(const NamespacedConfigDelta& delta);
+
   const NamespaceKeyValueMap& config() const;
   uint64_t timestamp() const;
+  void set_timestamp(uint64_t timestamp);
 
   bool operator==(const NamespacedConfigData& right) const;
 
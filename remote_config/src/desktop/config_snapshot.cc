@@ -0,0 +1,93 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "remote_config/src/desktop/config_snapshot.h"
+
+#include <utility>
+
+namespace firebase {
+namespace remote_config {
+namespace internal {
+
+ConfigSnapshot::ConfigSnapshot(std::vector<Value> values)
+    : values_(std::move(values)) {
+  size_t slot_count = 2;
+  while (slot_count < values_.size() * 2) slot_count *= 2;
+  slots_.resize(slot_count, 0);
+  slot_mask_ = slot_count - 1;
+
+  for (size_t i = 0; i < values_.size(); ++i) {
+    Value& value = values_[i];
+    value.hash = HashKey(value.key.c_str());
+    uint64_t slot = value.hash & slot_mask_;
+    while (slots_[slot] != 0) slot = (slot + 1) & slot_mask_;
+    slots_[slot] = static_cast<uint32_t>(i + 1);
+  }
+}
+
+const ConfigSnapshot::Value* ConfigSnapshot::Find(const char* key) const {
+  if (!key) return nullptr;
+  const uint64_t hash = HashKey(key);
+  for (uint64_t slot = hash & slot_mask_; slots_[slot] != 0;
+       slot = (slot + 1) & slot_mask_) {
+    const Value& value = values_[slots_[slot] - 1];
+    if (value.hash == hash && value.key == key) return &value;
+  }
+  return nullptr;
+}
+
+// FNV-1a.
+uint64_t ConfigSnapshot::HashKey(const char* key) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (; *key; ++key) {
+    hash ^= static_cast<unsigned char>(*key);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+ConfigSnapshotHolder::Reader::Reader(ConfigSnapshotHolder* holder)
+    : holder_(holder) {
+  // Register before loading the snapshot, so that Publish() either sees this
+  // reader or has already swapped in the snapshot we load.
+  holder_->readers_.fetch_add(1);
+  snapshot_ = holder_->current_.load();
+}
+
+ConfigSnapshotHolder::Reader::~Reader() { holder_->readers_.fetch_sub(1); }
+
+ConfigSnapshotHolder::ConfigSnapshotHolder()
+    : current_(new ConfigSnapshot(std::vector<ConfigSnapshot::Value>())),
+      readers_(0) {}
+
+ConfigSnapshotHolder::~ConfigSnapshotHolder() {
+  delete current_.load();
+  for (ConfigSnapshot* snapshot : retired_) delete snapshot;
+}
+
+void ConfigSnapshotHolder::Publish(std::unique_ptr<ConfigSnapshot> snapshot) {
+  MutexLock lock(mutex_);
+  retired_.push_back(current_.exchange(snapshot.release()));
+  // Readers that start from now on see the new snapshot, so once there are no
+  // readers none of the old snapshots can be in use. If there are readers,
+  // the old snapshots are freed by a later call.
+  if (readers_.load() == 0) {
+    for (ConfigSnapshot* retired : retired_) delete retired;
+    retired_.clear();
+  }
+}
+
+}  // namespace internal
+}  // namespace remote_config
+}  // namespace firebase
@@ -0,0 +1,132 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_REMOTE_CONFIG_SRC_DESKTOP_CONFIG_SNAPSHOT_H_
+#define FIREBASE_REMOTE_CONFIG_SRC_DESKTOP_CONFIG_SNAPSHOT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/src/include/firebase/internal/mutex.h"
+#include "remote_config/src/include/firebase/remote_config.h"
+
+namespace firebase {
+namespace remote_config {
+namespace internal {
+
+// Immutable view of the values visible to the getters, with each value
+// converted to every type up front.
+//
+// Values are stored in an open addressing hash table keyed by the config key,
+// so a lookup neither locks nor allocates.
+class ConfigSnapshot {
+ public:
+  // A config value and its conversions.
+  struct Value {
+    Value()
+        : long_value(0),
+          double_value(0.0),
+          bool_value(false),
+          is_long(false),
+          is_double(false),
+          is_bool(false),
+          source(kValueSourceStaticValue),
+          hash(0) {}
+
+    std::string key;
+    std::string string_value;
+    int64_t long_value;
+    double double_value;
+    bool bool_value;
+    // Whether string_value could be converted to each type.
+    bool is_long;
+    bool is_double;
+    bool is_bool;
+    // Config layer the value came from.
+    ValueSource source;
+    // Hash of key, set by the constructor.
+    uint64_t hash;
+  };
+
+  // Create a snapshot from a set of values with unique keys.
+  explicit ConfigSnapshot(std::vector<Value> values);
+
+  // Returns the value for key, or nullptr if there is none.
+  const Value* Find(const char* key) const;
+
+  // Number of values in the snapshot.
+  size_t size() const { return values_.size(); }
+
+ private:
+  static uint64_t HashKey(const char* key);
+
+  std::vector<Value> values_;
+  // Each slot holds an index into values_ plus one, or zero if it's empty.
+  // The table is kept at most half full so probe sequences stay short.
+  std::vector<uint32_t> slots_;
+  uint64_t slot_mask_;
+};
+
+// Publishes ConfigSnapshots to readers without locking.
+//
+// Readers pin the current snapshot with a Reader. Replaced snapshots are
+// deleted by Publish() once no Reader is active, so a snapshot is never freed
+// while it is being read.
+class ConfigSnapshotHolder {
+ public:
+  // Pins the snapshot that is current when it is created.
+  class Reader {
+   public:
+    explicit Reader(ConfigSnapshotHolder* holder);
+    ~Reader();
+
+    const ConfigSnapshot* operator->() const { return snapshot_; }
+    const ConfigSnapshot& operator*() const { return *snapshot_; }
+
+   private:
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    ConfigSnapshotHolder* holder_;
+    const ConfigSnapshot* snapshot_;
+  };
+
+  // Starts out holding an empty snapshot.
+  ConfigSnapshotHolder();
+  ~ConfigSnapshotHolder();
+
+  // Replace the current snapshot.
+  void Publish(std::unique_ptr<ConfigSnapshot> snapshot);
+
+ private:
+  ConfigSnapshotHolder(const ConfigSnapshotHolder&) = delete;
+  ConfigSnapshotHolder& operator=(const ConfigSnapshotHolder&) = delete;
+
+  std::atomic<ConfigSnapshot*> current_;
+  // Number of active Readers.
+  std::atomic<int> readers_;
+  // Guards retired_.
+  Mutex mutex_;
+  // Snapshots that have been replaced but may still be in use by a Reader.
+  std::vector<ConfigSnapshot*> retired_;
+};
+
+}  // namespace internal
+}  // namespace remote_config
+}  // namespace firebase
+
+#endif  // FIREBASE_REMOTE_CONFIG_SRC_DESKTOP_CONFIG_SNAPSHOT_H_
@@ -15,17 +15,23 @@
 #include "remote_config/src/desktop/file_manager.h"
 
 #include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <map>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "app/src/filesystem.h"
 #include "app/src/include/firebase/internal/platform.h"
+#include "flatbuffers/flexbuffers.h"
 #include "remote_config/src/desktop/config_data.h"
+#include "remote_config/src/desktop/metadata.h"
 
 #if FIREBASE_PLATFORM_WINDOWS
+#include <windows.h>
+
 #include <codecvt>
 #include <locale>
 #endif
@@ -34,18 +40,43 @@ namespace firebase {
 namespace remote_config {
 namespace internal {
 
+static const char kJournalSuffix[] = ".journal";
+static const char kTempSuffix[] = ".tmp";
+
+// Journal records are stored as a 4 byte little endian length followed by
+// the serialized record.
+static const size_t kJournalRecordHeaderSize = 4;
+
+// 64-bit FNV-1a hash of the file contents, used to tell which file a journal
+// record was written against.
+static uint64_t Fingerprint(const std::string& contents) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : contents) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
 RemoteConfigFileManager::RemoteConfigFileManager(const std::string& filename,
-                                                 const firebase::App& app) {
+                                                 const firebase::App& app)
+    : file_fingerprint_(Fingerprint(std::string())) {
   std::string app_data_prefix =
       std::string(app.options().package_name()) + "/" + app.name();
   std::string file_path =
       AppDataDir(app_data_prefix.c_str(), /*should_create=*/true) + "/" +
       filename;
+  std::string journal_path = file_path + kJournalSuffix;
+  std::string temp_path = file_path + kTempSuffix;
 #if FIREBASE_PLATFORM_WINDOWS
   std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> utf8_to_wstring;
   file_path_ = utf8_to_wstring.from_bytes(file_path);
+  journal_path_ = utf8_to_wstring.from_bytes(journal_path);
+  temp_path_ = utf8_to_wstring.from_bytes(temp_path);
 #else
   file_path_ = file_path;
+  journal_path_ = journal_path;
+  temp_path_ = temp_path;
 #endif
 }
 
@@ -53,17 +84,85 @@ bool RemoteConfigFileManager::Load(LayeredConfigs* configs) const {
   std::fstream input(file_path_, std::ios::in | std::ios::binary);
   std::stringstream ss;
   ss << input.rdbuf();
-  configs->Deserialize(ss.str());
+  const std::string contents = ss.str();
+  configs->Deserialize(contents);
+  file_fingerprint_ = Fingerprint(contents);
+
+  std::fstream journal(journal_path_, std::ios::in | std::ios::binary);
+  unsigned char header[kJournalRecordHeaderSize];
+  while (journal.read(reinterpret_cast<char*>(header), sizeof(header))) {
+    size_t record_size = 0;
+    for (size_t i = 0; i < kJournalRecordHeaderSize; ++i) {
+      record_size |= static_cast<size_t>(header[i]) << (8 * i);
+    }
+    std::string record(record_size, '\0');
+    // Stop at a record that was only partially written.
+    if (!journal.read(&record[0], record_size)) break;
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(record.data());
+    auto struct_map = flexbuffers::GetRoot(data, record.size()).AsMap();
+    // Skip records that were written against an older file, which happens
+    // when a save was interrupted before the journal was emptied.
+    if (struct_map["file"].AsUInt64() != file_fingerprint_) continue;
+    NamespacedConfigDelta delta;
+    delta.Deserialize(struct_map["delta"].AsString().str());
+    // Activation copies the fetched config to the active one.
+    configs->active.ApplyDelta(delta);
+    configs->fetched = configs->active;
+    configs->metadata.Deserialize(struct_map["metadata"].AsString().str());
+  }
   return true;
 }
 
 bool RemoteConfigFileManager::Save(const LayeredConfigs& configs) const {
   std::string buffer = configs.Serialize();
-  std::fstream output(file_path_, std::ios::out | std::ios::binary);
+  // Write to a temporary file and move it over the old one, so that the file
+  // is never left half written.
+  std::fstream output(temp_path_,
+                      std::ios::out | std::ios::binary | std::ios::trunc);
   output.write(buffer.c_str(), buffer.size());
+  output.close();
+  if (output.fail()) return false;
+#if FIREBASE_PLATFORM_WINDOWS
+  if (!MoveFileExW(temp_path_.c_str(), file_path_.c_str(),
+                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    return false;
+  }
+#else
+  if (std::rename(temp_path_.c_str(), file_path_.c_str()) != 0) return false;
+#endif
+  file_fingerprint_ = Fingerprint(buffer);
+  // The saved state includes everything in the journal. Should this step not
+  // happen, the records no longer match the file and are ignored on load.
+  std::fstream journal(journal_path_,
+                       std::ios::out | std::ios::binary | std::ios::trunc);
   return true;
 }
 
+bool RemoteConfigFileManager::SaveActivation(
+    const NamespacedConfigDelta& delta,
+    const RemoteConfigMetadata& metadata) const {
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.UInt("file", file_fingerprint_);
+    fbb.String("delta", delta.Serialize());
+    fbb.String("metadata", metadata.Serialize());
+  });
+  fbb.Finish();
+  const std::vector<uint8_t>& record = fbb.GetBuffer();
+
+  unsigned char header[kJournalRecordHeaderSize];
+  for (size_t i = 0; i < kJournalRecordHeaderSize; ++i) {
+    header[i] = static_cast<unsigned char>(record.size() >> (8 * i));
+  }
+  std::fstream journal(journal_path_,
+                       std::ios::out | std::ios::binary | std::ios::app);
+  journal.write(reinterpret_cast<const char*>(header), sizeof(header));
+  journal.write(reinterpret_cast<const char*>(record.data()), record.size());
+  journal.flush();
+  return !journal.fail();
+}
+
 }  // namespace internal
 }  // namespace remote_config
 }  // namespace firebase
@@ -15,6 +15,7 @@
 #ifndef FIREBASE_REMOTE_CONFIG_SRC_DESKTOP_FILE_MANAGER_H_
 #define FIREBASE_REMOTE_CONFIG_SRC_DESKTOP_FILE_MANAGER_H_
 
+#include <cstdint>
 #include <string>
 
 #include "app/src/include/firebase/app.h"
@@ -27,24 +28,47 @@ namespace internal {
 
 // Use this class to save Remote Config Client `LayeredConfigs` to file and
 // load from file.
+//
+// Activations are appended to a journal next to the file as the difference
+// from the previously active config, rather than rewriting the whole file.
+// `Save` atomically replaces the file with the complete state and empties the
+// journal. Each journal record carries a fingerprint of the file it applies
+// to, so that records left behind by a `Save` interrupted before the journal
+// was emptied are not replayed over the newer state.
 class RemoteConfigFileManager {
  public:
   RemoteConfigFileManager(const std::string& file_path,
                           const firebase::App& app);
 
-  // Load `configs` from file. Will return `true` if success.
+  // Load `configs` from file and replay the journal. Will return `true` if
+  // success.
   bool Load(LayeredConfigs* configs) const;
 
   // Save `configs` to file. Will return `true` if success.
   bool Save(const LayeredConfigs& configs) const;
 
+  // Record that the fetched config was activated, where `delta` is the
+  // difference between the previously active config and the fetched one and
+  // `metadata` is the metadata at the time. Will return `true` if success.
+  bool SaveActivation(const NamespacedConfigDelta& delta,
+                      const RemoteConfigMetadata& metadata) const;
+
  private:
-  // Path to file with data. On Windows, use a UTF-16 path string.
+  // Paths to the file with data, the journal and the temporary file the data
+  // is written to before replacing the file. On Windows, use UTF-16 path
+  // strings.
 #if FIREBASE_PLATFORM_WINDOWS
   std::wstring file_path_;
+  std::wstring journal_path_;
+  std::wstring temp_path_;
 #else
   std::string file_path_;
+  std::string journal_path_;
+  std::string temp_path_;
 #endif
+  // Fingerprint of the contents of the file last loaded or saved, written to
+  // every journal record.
+  mutable uint64_t file_fingerprint_;
 };
 
 }  // namespace internal
@@ -43,6 +43,8 @@ std::string RemoteConfigMetadata::Serialize() const {
     });
 
     fbb.Add("digest_by_namespace", digest_by_namespace_);
+    fbb.Add("etag_by_namespace", etag_by_namespace_);
+    fbb.Add("template_version_by_namespace", template_version_by_namespace_);
 
     fbb.Map("settings", [&]() {
       for (const auto& setting : settings_) {
@@ -72,6 +74,14 @@ void RemoteConfigMetadata::Deserialize(const std::string& buffer) {
   flexbuffers::Map digests = struct_map["digest_by_namespace"].AsMap();
   DeserializeMap(&digest_by_namespace_, digests);
 
+  // Files written by earlier versions don't have these maps, and read as
+  // empty ones.
+  etag_by_namespace_.clear();
+  DeserializeMap(&etag_by_namespace_, struct_map["etag_by_namespace"].AsMap());
+  template_version_by_namespace_.clear();
+  DeserializeMap(&template_version_by_namespace_,
+                 struct_map["template_version_by_namespace"].AsMap());
+
   settings_.clear();
   flexbuffers::Map settings = struct_map["settings"].AsMap();
   for (int i = 0, n = settings.size(); i < n; ++i) {
@@ -96,6 +106,9 @@ std::string RemoteConfigMetadata::GetSetting(
 
 bool RemoteConfigMetadata::operator==(const RemoteConfigMetadata& right) const {
   return digest_by_namespace_ == right.digest_by_namespace_ &&
+         etag_by_namespace_ == right.etag_by_namespace_ &&
+         template_version_by_namespace_ ==
+             right.template_version_by_namespace_ &&
          settings_ == right.settings_ &&
          info_.fetch_time == right.info_.fetch_time &&
          info_.last_fetch_status == right.info_.last_fetch_status &&
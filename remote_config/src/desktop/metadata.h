@@ -38,6 +38,8 @@ typedef std::map<ConfigSetting, std::string> MetaSettingsMap;
 //  * settings map: corresponds to a single supported setting, "developer mode"
 //  * digest map: Server computed digest (hash) of the config entries, stored
 //                per config namespace.
+//  * ETag and template version maps: Identify the last template fetched for
+//                each config namespace, so fetches can be conditional on it.
 class RemoteConfigMetadata {
  public:
   RemoteConfigMetadata();
@@ -56,6 +58,21 @@ class RemoteConfigMetadata {
     digest_by_namespace_ = digest_by_namespace;
   }
 
+  // Returns a map from namespace to the ETag of the last fetched template.
+  const MetaDigestMap& etag_by_namespace() const { return etag_by_namespace_; }
+  void set_etag_by_namespace(const MetaDigestMap& etag_by_namespace) {
+    etag_by_namespace_ = etag_by_namespace;
+  }
+
+  // Returns a map from namespace to the version of the last fetched template.
+  const MetaDigestMap& template_version_by_namespace() const {
+    return template_version_by_namespace_;
+  }
+  void set_template_version_by_namespace(
+      const MetaDigestMap& template_version_by_namespace) {
+    template_version_by_namespace_ = template_version_by_namespace;
+  }
+
   // Set setting with value.
   const MetaSettingsMap& settings() const { return settings_; }
   void AddSetting(const ConfigSetting& setting, const std::string& value);
@@ -75,6 +92,14 @@ class RemoteConfigMetadata {
   // response size (e.g. case when namespace doesn't have change).
   MetaDigestMap digest_by_namespace_;
 
+  // The ETag the server returned with the last template fetched for each
+  // namespace. It is sent back in If-None-Match, and the server replies with
+  // "304 Not Modified" if the template hasn't changed since.
+  MetaDigestMap etag_by_namespace_;
+
+  // The version of the last template fetched for each namespace.
+  MetaDigestMap template_version_by_namespace_;
+
   // Developers settings.
   //
   // For now it's only one key: kConfigSettingDeveloperMode. Set "1" to enable
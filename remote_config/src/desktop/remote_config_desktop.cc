@@ -23,12 +23,15 @@
 #include <sstream>
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "app/src/callback.h"
 #include "app/src/include/firebase/internal/platform.h"
+#include "app/src/mutex_profiler.h"
 #include "app/src/time.h"
 #include "remote_config/src/common.h"
+#include "remote_config/src/config_update_listener_registration_internal.h"
 #include "remote_config/src/include/firebase/remote_config.h"
 
 #ifndef SWIG
@@ -49,6 +52,10 @@ const bool RemoteConfigInternal::kDefaultValueForBool = false;
 
 static const char* kFilePathSuffix = "remote_config_data";
 
+// Number of activations the file's journal may hold before it is compacted by
+// saving the whole config.
+static const int kMaxJournalSize = 32;
+
 template <typename T>
 struct RCDataHandle {
   RCDataHandle(
@@ -70,8 +77,13 @@ RemoteConfigInternal::RemoteConfigInternal(
     const firebase::App& app, const RemoteConfigFileManager& file_manager)
     : app_(app),
       file_manager_(file_manager),
+      // The journal may end with a partial record from a previous run, so
+      // start with a full save.
+      needs_full_save_(true),
+      journal_size_(0),
       is_fetch_process_have_task_(false),
       future_impl_(kRemoteConfigFnCount),
+      next_listener_id_(0),
       safe_this_(this),
       rest_(app.options(), configs_, kDefaultNamespace),
       initialized_(false) {
@@ -81,8 +93,13 @@ RemoteConfigInternal::RemoteConfigInternal(
 RemoteConfigInternal::RemoteConfigInternal(const firebase::App& app)
     : app_(app),
       file_manager_(kFilePathSuffix, app),
+      // The journal may end with a partial record from a previous run, so
+      // start with a full save.
+      needs_full_save_(true),
+      journal_size_(0),
       is_fetch_process_have_task_(false),
       future_impl_(kRemoteConfigFnCount),
+      next_listener_id_(0),
       safe_this_(this),
       rest_(app.options(), configs_, kDefaultNamespace),
       initialized_(false) {
@@ -99,7 +116,15 @@ RemoteConfigInternal::~RemoteConfigInternal() {
 }
 
 void RemoteConfigInternal::InternalInit() {
+  mutex_profiler::NameMutex(&internal_mutex_, "RemoteConfigInternal");
   file_manager_.Load(&configs_);
+  {
+    MutexLock lock(internal_mutex_);
+    // Fetches start from the loaded config, and are conditional on the
+    // template it was fetched with.
+    rest_.SetConfigs(configs_);
+    UpdateSnapshot();
+  }
   AsyncSaveToFile();
   initialized_ = true;
 }
@@ -171,20 +196,25 @@ Future<bool> RemoteConfigInternal::FetchAndActivate() {
         [](ThisRef ref, std::shared_ptr<RCDataHandle<bool>> handle) {
           ThisRefLock lock(&ref);
           if (lock.GetReference() != nullptr) {
-            MutexLock lock(handle->rc_internal->internal_mutex_);
-
-            handle->rc_internal->FetchInternal();
-
-            FutureStatus futureResult =
-                (handle->rc_internal->GetInfo().last_fetch_status ==
-                 kLastFetchStatusSuccess)
-                    ? kFutureStatusSuccess
-                    : kFutureStatusFailure;
-
-            bool activated = handle->rc_internal->ActivateFetched();
-            handle->future_api->CompleteWithResult(
-                handle->future_handle, futureResult, kFutureNoErrorMessage,
-                activated);
+            std::vector<std::string> updated_keys;
+            {
+              MutexLock lock(handle->rc_internal->internal_mutex_);
+
+              handle->rc_internal->FetchInternal();
+
+              FutureStatus futureResult =
+                  (handle->rc_internal->GetInfo().last_fetch_status ==
+                   kLastFetchStatusSuccess)
+                      ? kFutureStatusSuccess
+                      : kFutureStatusFailure;
+
+              updated_keys = handle->rc_internal->GetUpdatedKeys();
+              bool activated = handle->rc_internal->ActivateFetched();
+              handle->future_api->CompleteWithResult(
+                  handle->future_handle, futureResult, kFutureNoErrorMessage,
+                  activated);
+            }
+            handle->rc_internal->NotifyConfigUpdateListeners(updated_keys);
           }
         },
         safe_this_, data_handle);
@@ -230,11 +260,32 @@ void RemoteConfigInternal::AsyncSaveToFile() {
   save_thread_ = std::thread([this]() {
     while (save_channel_.Get()) {
       LayeredConfigs copy;
+      std::vector<PendingActivation> activations;
+      bool full_save;
       {
         MutexLock lock(internal_mutex_);
-        copy = configs_;
+        full_save = needs_full_save_ ||
+                    journal_size_ + static_cast<int>(
+                                        pending_activations_.size()) >
+                        kMaxJournalSize;
+        if (full_save) {
+          copy = configs_;
+          needs_full_save_ = false;
+          pending_activations_.clear();
+        } else {
+          activations.swap(pending_activations_);
+        }
+      }
+      if (full_save) {
+        file_manager_.Save(copy);
+        journal_size_ = 0;
+      } else {
+        // Only write what changed since the last save.
+        for (const PendingActivation& activation : activations) {
+          file_manager_.SaveActivation(activation.delta, activation.metadata);
+          journal_size_++;
+        }
       }
-      file_manager_.Save(copy);
     }
   });
 }
@@ -311,6 +362,8 @@ void RemoteConfigInternal::SetDefaults(
   {
     MutexLock lock(internal_mutex_);
     configs_.defaults.SetNamespace(defaults_map, kDefaultNamespace);
+    UpdateSnapshot();
+    needs_full_save_ = true;
   }
   save_channel_.Put();
 }
@@ -328,34 +381,51 @@ void RemoteConfigInternal::SetConfigSetting(ConfigSetting setting,
   {
     MutexLock lock(internal_mutex_);
     configs_.metadata.AddSetting(setting, value);
+    needs_full_save_ = true;
   }
   save_channel_.Put();
 }
 
-bool RemoteConfigInternal::CheckValueInActiveAndDefault(const char* key,
-                                                        ValueInfo* info,
-                                                        std::string* value) {
-  return CheckValueInConfig(configs_.active, kValueSourceRemoteValue, key, info,
-                            value) ||
-         CheckValueInConfig(configs_.defaults, kValueSourceDefaultValue, key,
-                            info, value);
+void RemoteConfigInternal::UpdateSnapshot() {
+  std::vector<ConfigSnapshot::Value> values;
+  std::set<std::string> keys;
+  // Active values take precedence over defaults.
+  const NamespacedConfigData* layers[] = {&configs_.active,
+                                          &configs_.defaults};
+  const ValueSource sources[] = {kValueSourceRemoteValue,
+                                 kValueSourceDefaultValue};
+  for (size_t i = 0; i < sizeof(layers) / sizeof(layers[0]); ++i) {
+    auto name_space = layers[i]->config().find(kDefaultNamespace);
+    if (name_space == layers[i]->config().end()) continue;
+    for (const auto& key_value : name_space->second) {
+      if (!keys.insert(key_value.first).second) continue;
+      values.push_back(ConfigSnapshot::Value());
+      ConfigSnapshot::Value& value = values.back();
+      value.key = key_value.first;
+      value.string_value = key_value.second;
+      value.is_long = ConvertToLong(value.string_value, &value.long_value);
+      value.is_double =
+          ConvertToDouble(value.string_value, &value.double_value);
+      value.is_bool = ConvertToBool(value.string_value, &value.bool_value);
+      value.source = sources[i];
+    }
+  }
+  snapshot_.Publish(
+      std::unique_ptr<ConfigSnapshot>(new ConfigSnapshot(std::move(values))));
 }
 
-bool RemoteConfigInternal::CheckValueInConfig(
-    const NamespacedConfigData& config, ValueSource source, const char* key,
-    ValueInfo* info, std::string* value) {
-  if (!key) return false;
-
-  {
-    MutexLock lock(internal_mutex_);
-    if (!config.HasValue(key, kDefaultNamespace)) {
-      return false;
+const ConfigSnapshot::Value* RemoteConfigInternal::FindValue(
+    const ConfigSnapshot& snapshot, const char* key, ValueInfo* info) {
+  const ConfigSnapshot::Value* value = snapshot.Find(key);
+  if (info) {
+    if (value) {
+      info->source = value->source;
+    } else {
+      info->source = kValueSourceStaticValue;
+      info->conversion_successful = true;
     }
-    *value = config.GetValue(key, kDefaultNamespace);
   }
-
-  if (info) info->source = source;
-  return true;
+  return value;
 }
 
 bool RemoteConfigInternal::IsBoolTrue(const std::string& str) {
@@ -406,34 +476,21 @@ bool RemoteConfigInternal::ConvertToBool(const std::string& from, bool* out) {
 }
 
 bool RemoteConfigInternal::GetBoolean(const char* key, ValueInfo* info) {
-  std::string value;
-  if (!CheckValueInActiveAndDefault(key, info, &value)) {
-    if (info) {
-      info->source = kValueSourceStaticValue;
-      info->conversion_successful = true;
-    }
-    return kDefaultValueForBool;
-  }
+  ConfigSnapshotHolder::Reader snapshot(&snapshot_);
+  const ConfigSnapshot::Value* value = FindValue(*snapshot, key, info);
+  if (!value) return kDefaultValueForBool;
 
-  bool bool_value;
-  bool conversion_successful = ConvertToBool(value, &bool_value);
-
-  if (info) info->conversion_successful = conversion_successful;
-  return bool_value;
+  if (info) info->conversion_successful = value->is_bool;
+  return value->bool_value;
 }
 
 std::string RemoteConfigInternal::GetString(const char* key, ValueInfo* info) {
-  std::string value;
-  if (!CheckValueInActiveAndDefault(key, info, &value)) {
-    if (info) {
-      info->source = kValueSourceStaticValue;
-      info->conversion_successful = true;
-    }
-    return kDefaultValueForString;
-  }
+  ConfigSnapshotHolder::Reader snapshot(&snapshot_);
+  const ConfigSnapshot::Value* value = FindValue(*snapshot, key, info);
+  if (!value) return kDefaultValueForString;
 
   if (info) info->conversion_successful = true;
-  return value;
+  return value->string_value;
 }
 
 bool RemoteConfigInternal::ConvertToLong(const std::string& from,
@@ -451,19 +508,12 @@ bool RemoteConfigInternal::ConvertToLong(const std::string& from,
 }
 
 int64_t RemoteConfigInternal::GetLong(const char* key, ValueInfo* info) {
-  std::string value;
-  if (!CheckValueInActiveAndDefault(key, info, &value)) {
-    if (info) {
-      info->source = kValueSourceStaticValue;
-      info->conversion_successful = true;
-    }
-    return kDefaultValueForLong;
-  }
+  ConfigSnapshotHolder::Reader snapshot(&snapshot_);
+  const ConfigSnapshot::Value* value = FindValue(*snapshot, key, info);
+  if (!value) return kDefaultValueForLong;
 
-  int64_t long_value = kDefaultValueForLong;
-  bool conversion_successful = ConvertToLong(value, &long_value);
-  if (info) info->conversion_successful = conversion_successful;
-  return long_value;
+  if (info) info->conversion_successful = value->is_long;
+  return value->long_value;
 }
 
 bool RemoteConfigInternal::ConvertToDouble(const std::string& from,
@@ -481,37 +531,22 @@ bool RemoteConfigInternal::ConvertToDouble(const std::string& from,
 }
 
 double RemoteConfigInternal::GetDouble(const char* key, ValueInfo* info) {
-  std::string value;
-  if (!CheckValueInActiveAndDefault(key, info, &value)) {
-    if (info) {
-      info->source = kValueSourceStaticValue;
-      info->conversion_successful = true;
-    }
-    return kDefaultValueForDouble;
-  }
-
-  double double_value = kDefaultValueForDouble;
-  bool conversion_successful = ConvertToDouble(value, &double_value);
+  ConfigSnapshotHolder::Reader snapshot(&snapshot_);
+  const ConfigSnapshot::Value* value = FindValue(*snapshot, key, info);
+  if (!value) return kDefaultValueForDouble;
 
-  if (info) info->conversion_successful = conversion_successful;
-  return double_value;
+  if (info) info->conversion_successful = value->is_double;
+  return value->double_value;
 }
 
 std::vector<unsigned char> RemoteConfigInternal::GetData(const char* key,
                                                          ValueInfo* info) {
-  std::string value;
-  if (!CheckValueInActiveAndDefault(key, info, &value)) {
-    if (info) {
-      info->source = kValueSourceStaticValue;
-      info->conversion_successful = true;
-    }
-    return kDefaultValueForData;
-  }
+  ConfigSnapshotHolder::Reader snapshot(&snapshot_);
+  const ConfigSnapshot::Value* value = FindValue(*snapshot, key, info);
+  if (!value) return kDefaultValueForData;
 
-  std::vector<unsigned char> data_value;
-  data_value.reserve(value.size());
-  for (const char& ch : value)
-    data_value.push_back(static_cast<unsigned char>(ch));
+  std::vector<unsigned char> data_value(value->string_value.begin(),
+                                        value->string_value.end());
 
   if (info) info->conversion_successful = true;
   return data_value;
@@ -573,7 +608,12 @@ bool RemoteConfigInternal::ActivateFetched() {
     // Fetched config not found or already activated.
     if (configs_.fetched.timestamp() <= configs_.active.timestamp())
       return false;
+    PendingActivation activation;
+    activation.delta = configs_.active.Diff(configs_.fetched);
+    activation.metadata = configs_.metadata;
+    pending_activations_.push_back(activation);
     configs_.active = configs_.fetched;
+    UpdateSnapshot();
   }
   save_channel_.Put();
   return true;
@@ -588,21 +628,83 @@ ConfigUpdateListenerRegistration
 RemoteConfigInternal::AddOnConfigUpdateListener(
     std::function<void(ConfigUpdate&&, RemoteConfigError)>
         config_update_listener) {
-  // Realtime RC is not yet implemented on desktop, so just return a
-  // registration object that is no-op.
-  return ConfigUpdateListenerRegistration();
+  // Realtime RC is not yet implemented on desktop, so listeners are notified
+  // when a fetch returns values that differ from the active ones.
+  int listener_id;
+  {
+    MutexLock lock(listeners_mutex_);
+    listener_id = next_listener_id_++;
+    config_update_listeners_[listener_id] = config_update_listener;
+  }
+  ConfigUpdateListenerRegistrationInternal* registration_internal =
+      new ConfigUpdateListenerRegistrationInternal(
+          this,
+          [this, listener_id]() { RemoveConfigUpdateListener(listener_id); });
+  // Delete the internal registration when RemoteConfigInternal is cleaned up.
+  cleanup_notifier().RegisterObject(
+      registration_internal, [](void* registration) {
+        delete reinterpret_cast<ConfigUpdateListenerRegistrationInternal*>(
+            registration);
+      });
+  ConfigUpdateListenerRegistration registration_wrapper(registration_internal);
+  return registration_wrapper;
+}
+
+void RemoteConfigInternal::RemoveConfigUpdateListener(int listener_id) {
+  MutexLock lock(listeners_mutex_);
+  config_update_listeners_.erase(listener_id);
+}
+
+std::vector<std::string> RemoteConfigInternal::GetUpdatedKeys() {
+  if (GetInfo().last_fetch_status != kLastFetchStatusSuccess) {
+    return std::vector<std::string>();
+  }
+  return configs_.active.Diff(configs_.fetched)
+      .GetUpdatedKeys(kDefaultNamespace);
+}
+
+void RemoteConfigInternal::NotifyConfigUpdateListeners(
+    const std::vector<std::string>& keys) {
+  if (keys.empty()) return;
+  std::vector<std::function<void(ConfigUpdate&&, RemoteConfigError)>>
+      listeners;
+  {
+    MutexLock lock(listeners_mutex_);
+    for (const auto& id_and_listener : config_update_listeners_) {
+      listeners.push_back(id_and_listener.second);
+    }
+  }
+  for (const auto& listener : listeners) {
+    ConfigUpdate config_update;
+    config_update.updated_keys = keys;
+    listener(std::move(config_update), kRemoteConfigErrorNone);
+  }
 }
 
 void RemoteConfigInternal::FetchInternal() {
   // Fetch fresh config from server.
   rest_.Fetch(app_, config_settings_.fetch_timeout_in_milliseconds);
-  // Need to copy everything to `configs_.fetched`.
-  configs_.fetched = rest_.fetched();
+  if (rest_.fetch_not_modified()) {
+    // The template is unchanged, so only the time it was fetched moves. If it
+    // was already activated, the active config is still the latest one.
+    uint64_t fetch_timestamp = rest_.fetched().timestamp();
+    if (configs_.fetched.timestamp() <= configs_.active.timestamp()) {
+      configs_.active.set_timestamp(fetch_timestamp);
+    }
+    configs_.fetched.set_timestamp(fetch_timestamp);
+  } else {
+    // Need to copy everything to `configs_.fetched`.
+    configs_.fetched = rest_.fetched();
+  }
 
-  // Need to copy only info and digests to `configs_.metadata`.
+  // Need to copy only info, digests and the template version to
+  // `configs_.metadata`.
   const RemoteConfigMetadata& metadata = rest_.metadata();
   configs_.metadata.set_info(metadata.info());
   configs_.metadata.set_digest_by_namespace(metadata.digest_by_namespace());
+  configs_.metadata.set_etag_by_namespace(metadata.etag_by_namespace());
+  configs_.metadata.set_template_version_by_namespace(
+      metadata.template_version_by_namespace());
 
   is_fetch_process_have_task_ = false;
 }
@@ -639,16 +741,22 @@ Future<void> RemoteConfigInternal::Fetch(uint64_t cache_expiration_in_seconds) {
         [](ThisRef ref, std::shared_ptr<RCDataHandle<void>> handle) {
           ThisRefLock lock(&ref);
           if (lock.GetReference() != nullptr) {
-            MutexLock lock(handle->rc_internal->internal_mutex_);
-
-            handle->rc_internal->FetchInternal();
-
-            FutureStatus futureResult =
-                (handle->rc_internal->GetInfo().last_fetch_status ==
-                 kLastFetchStatusSuccess)
-                    ? kFutureStatusSuccess
-                    : kFutureStatusFailure;
-            handle->future_api->Complete(handle->future_handle, futureResult);
+            std::vector<std::string> updated_keys;
+            {
+              MutexLock lock(handle->rc_internal->internal_mutex_);
+
+              handle->rc_internal->FetchInternal();
+
+              FutureStatus futureResult =
+                  (handle->rc_internal->GetInfo().last_fetch_status ==
+                   kLastFetchStatusSuccess)
+                      ? kFutureStatusSuccess
+                      : kFutureStatusFailure;
+              updated_keys = handle->rc_internal->GetUpdatedKeys();
+              handle->future_api->Complete(handle->future_handle,
+                                           futureResult);
+            }
+            handle->rc_internal->NotifyConfigUpdateListeners(updated_keys);
           }
         },
         safe_this_, data_handle);
@@ -16,8 +16,11 @@
 #define FIREBASE_REMOTE_CONFIG_SRC_DESKTOP_REMOTE_CONFIG_DESKTOP_H_
 
 #include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "app/src/cleanup_notifier.h"
 #include "app/src/include/firebase/internal/mutex.h"
@@ -27,6 +30,7 @@
 #include "firebase/app.h"
 #include "firebase/future.h"
 #include "remote_config/src/desktop/config_data.h"
+#include "remote_config/src/desktop/config_snapshot.h"
 #include "remote_config/src/desktop/file_manager.h"
 #include "remote_config/src/desktop/notification_channel.h"
 #include "remote_config/src/desktop/rest.h"
@@ -159,23 +163,29 @@ class RemoteConfigInternal {
   // Set default values to `configs_.defaults` holder.
   void SetDefaults(const std::map<std::string, std::string>& defaults_map);
 
-  // Returns true and assigns the found record to the `value` if the `active` or
-  // `defaults` holders contains a record for the key.
-  //
-  // Assign `info->source` If info is not nullptr.
-  bool CheckValueInActiveAndDefault(const char* key, ValueInfo* info,
-                                    std::string* value);
+  // Rebuild `snapshot_` from the `active` and `defaults` holders. Must be
+  // called with `internal_mutex_` held, after either of them changes.
+  void UpdateSnapshot();
 
-  // Returns true and assigns the found record to the `value` if the `holder`
-  // contains a record for the key.
+  // Returns the value for the key from `snapshot_`, or nullptr if there is
+  // none, in which case `info` is filled in for the static default value.
   //
   // Assign `info->source` If info is not nullptr.
-  bool CheckValueInConfig(const NamespacedConfigData& config,
-                          ValueSource source, const char* key, ValueInfo* info,
-                          std::string* value);
+  static const ConfigSnapshot::Value* FindValue(const ConfigSnapshot& snapshot,
+                                                const char* key,
+                                                ValueInfo* info);
 
   void FetchInternal();
 
+  // Returns the keys whose fetched values differ from the active ones. Must be
+  // called with `internal_mutex_` held.
+  std::vector<std::string> GetUpdatedKeys();
+
+  // Call each config update listener with the given keys.
+  void NotifyConfigUpdateListeners(const std::vector<std::string>& keys);
+
+  void RemoveConfigUpdateListener(int listener_id);
+
   static const char* const kDefaultNamespace;
   static const char* const kDefaultValueForString;
   static const int64_t kDefaultValueForLong;
@@ -190,6 +200,10 @@ class RemoteConfigInternal {
   // Contains all config records and metadata variables.
   LayeredConfigs configs_;
 
+  // Values from the `active` and `defaults` holders of `configs_`, converted
+  // to each type, so getters can read them without locking or parsing.
+  ConfigSnapshotHolder snapshot_;
+
   // Provides saving to the file and load from the tile the `configs_` variable.
   RemoteConfigFileManager file_manager_;
 
@@ -205,6 +219,23 @@ class RemoteConfigInternal {
   // `configs_` variable. Call `save_channel_.Close()` to close the channel.
   NotificationChannel save_channel_;
 
+  // An activation that is yet to be written to the file.
+  struct PendingActivation {
+    NamespacedConfigDelta delta;
+    RemoteConfigMetadata metadata;
+  };
+
+  // Activations to append to the file's journal on the next save.
+  std::vector<PendingActivation> pending_activations_;
+
+  // Whether the next save must write all of `configs_`, because it changed
+  // other than through activation. Set it before `save_channel_.Put()`.
+  bool needs_full_save_;
+
+  // Number of activations in the journal since the last full save. Only used
+  // by `save_thread_`, which compacts the journal when it gets too long.
+  int journal_size_;
+
   // Last value of `Fetch` function argument. Update only if we will fetch.
   uint64_t cache_expiration_in_seconds_;
 
@@ -220,6 +251,14 @@ class RemoteConfigInternal {
   // Handle calls from Futures that the API returns.
   ReferenceCountedFutureImpl future_impl_;
 
+  // Guards `config_update_listeners_` and `next_listener_id_`.
+  Mutex listeners_mutex_;
+
+  // Listeners added with `AddOnConfigUpdateListener`, by ID.
+  std::map<int, std::function<void(ConfigUpdate&&, RemoteConfigError)>>
+      config_update_listeners_;
+  int next_listener_id_;
+
   CleanupNotifier cleanup_;
 
   scheduler::Scheduler scheduler_;
@@ -51,6 +51,12 @@ class RemoteConfigResponse
     return application_data_->state == status_name;
   }
 
+  // Returns the version of the template in the response, or an empty string
+  // if it has none.
+  const std::string& GetTemplateVersion() const {
+    return application_data_->templateVersion;
+  }
+
  private:
   Variant entries_;
 };
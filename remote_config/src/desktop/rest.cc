@@ -54,7 +54,9 @@ RemoteConfigREST::RemoteConfigREST(const firebase::AppOptions& app_options,
       api_key_(app_options.api_key()),
       namespaces_(std::move(namespaces)),
       configs_(configs),
-      fetch_future_sem_(0) {
+      fetch_future_sem_(0),
+      fetch_not_modified_(false),
+      rc_response_(new RemoteConfigResponse()) {
   rest::util::Initialize();
   firebase::rest::InitTransportCurl();
 }
@@ -69,10 +71,15 @@ void RemoteConfigREST::Fetch(const App& app,
   TryGetInstallationsAndToken(app);
 
   SetupRestRequest(app, fetch_timeout_in_milliseconds);
-  firebase::rest::CreateTransport()->Perform(rc_request_, &rc_response_);
+  rc_response_.reset(new RemoteConfigResponse());
+  firebase::rest::CreateTransport()->Perform(rc_request_, rc_response_.get());
   ParseRestResponse();
 }
 
+void RemoteConfigREST::SetConfigs(const LayeredConfigs& configs) {
+  configs_ = configs;
+}
+
 static std::string GenerateFakeId() {
   firebase::internal::Uuid uuid;
   uuid.Generate();
@@ -119,6 +126,15 @@ void RemoteConfigREST::SetupRestRequest(
   rc_request_.set_method(kHTTPMethodPost);
   rc_request_.add_header(kContentTypeHeaderName, kJSONContentTypeValue);
   rc_request_.add_header(kAcceptHeaderName, kJSONContentTypeValue);
+  rc_request_.add_header(rest::util::kAcceptEncoding, rest::util::kGzip);
+  // Only ask for the template if it changed since the last one fetched.
+  const MetaDigestMap& etags = configs_.metadata.etag_by_namespace();
+  auto etag = etags.find(namespaces_);
+  if (etag != etags.end() && !etag->second.empty()) {
+    rc_request_.add_header(kIfNoneMatchHeader, etag->second.c_str());
+  } else {
+    rc_request_.options().header.erase(kIfNoneMatchHeader);
+  }
   rc_request_.options().timeout_ms = fetch_timeout_in_milliseconds;
 
   rc_request_.SetAppId(app_gmp_project_id_);
@@ -142,25 +158,38 @@ void RemoteConfigREST::SetupRestRequest(
 }
 
 void RemoteConfigREST::ParseRestResponse() {
-  if (rc_response_.status() != kHTTPStatusOk) {
-    FetchFailure(kFetchFailureReasonError);
-    LogError("fetching failure: http code %d", rc_response_.status());
+  fetch_not_modified_ = false;
+  if (rc_response_->status() == rest::util::HttpNotModified) {
+    // The template hasn't changed since the one with the ETag we sent.
+    LogDebug("Not modified: ns=%s", namespaces_.c_str());
+    FetchNotModified();
     return;
   }
 
-  if (strlen(rc_response_.GetBody()) == 0) {
+  if (rc_response_->status() != kHTTPStatusOk) {
     FetchFailure(kFetchFailureReasonError);
-    LogError("fetching failure: http code %d", rc_response_.status());
+    LogError("fetching failure: http code %d", rc_response_->status());
     return;
   }
 
-  Variant entries = rc_response_.GetEntries();
+  if (strlen(rc_response_->GetBody()) == 0) {
+    FetchFailure(kFetchFailureReasonError);
+    LogError("fetching failure: http code %d", rc_response_->status());
+    return;
+  }
 
-  NamespaceKeyValueMap config_map(configs_.fetched.config());
   LogDebug("Parsing config response...");
-  if (rc_response_.StatusMatch("NO_CHANGE")) {
+  if (rc_response_->StatusMatch("NO_CHANGE")) {
     LogDebug("No change");
-  } else if (rc_response_.StatusMatch("UPDATE")) {
+    UpdateTemplateVersion();
+    FetchNotModified();
+    return;
+  }
+
+  Variant entries = rc_response_->GetEntries();
+
+  NamespaceKeyValueMap config_map(configs_.fetched.config());
+  if (rc_response_->StatusMatch("UPDATE")) {
     config_map[namespaces_].clear();
     for (const auto& keyvalue : entries.map()) {
       config_map[namespaces_][keyvalue.first.mutable_string()] =
@@ -169,18 +198,47 @@ void RemoteConfigREST::ParseRestResponse() {
                keyvalue.first.mutable_string().c_str(),
                keyvalue.second.mutable_string().c_str());
     }
-  } else if (rc_response_.StatusMatch("NO_TEMPLATE")) {
+  } else if (rc_response_->StatusMatch("NO_TEMPLATE")) {
     LogDebug("NotAuthorized: ns=%s", namespaces_.c_str());
     config_map.erase(namespaces_);
-  } else if (rc_response_.StatusMatch("EMPTY_CONFIG")) {
+  } else if (rc_response_->StatusMatch("EMPTY_CONFIG")) {
     LogDebug("EmptyConfig: ns=%s", namespaces_.c_str());
     config_map[namespaces_].clear();
   }
 
   configs_.fetched = NamespacedConfigData(config_map, MillisecondsSinceEpoch());
+  UpdateTemplateVersion();
+  FetchSuccess(kLastFetchStatusSuccess);
+}
+
+void RemoteConfigREST::FetchNotModified() {
+  // Keep the fetched config, but count it as fetched now so it doesn't expire.
+  fetch_not_modified_ = true;
+  configs_.fetched.set_timestamp(MillisecondsSinceEpoch());
   FetchSuccess(kLastFetchStatusSuccess);
 }
 
+void RemoteConfigREST::UpdateTemplateVersion() {
+  // HTTP/2 servers send lower case header names.
+  const char* etag = rc_response_->GetHeader(kEtagHeader);
+  if (!etag) etag = rc_response_->GetHeader("etag");
+  MetaDigestMap etags(configs_.metadata.etag_by_namespace());
+  if (etag && *etag != '\0') {
+    etags[namespaces_] = etag;
+  } else {
+    // Without an ETag the next fetch can't be conditional.
+    etags.erase(namespaces_);
+  }
+  configs_.metadata.set_etag_by_namespace(etags);
+
+  const std::string& version = rc_response_->GetTemplateVersion();
+  if (!version.empty()) {
+    MetaDigestMap versions(configs_.metadata.template_version_by_namespace());
+    versions[namespaces_] = version;
+    configs_.metadata.set_template_version_by_namespace(versions);
+  }
+}
+
 void RemoteConfigREST::FetchSuccess(LastFetchStatus status) {
   ConfigInfo info(configs_.metadata.info());
   info.last_fetch_status = status;
@@ -16,6 +16,7 @@
 #define FIREBASE_REMOTE_CONFIG_SRC_DESKTOP_REST_H_
 
 #include <cstdint>
+#include <memory>
 
 #include "app/rest/request_json.h"
 #include "app/rest/response_json.h"
@@ -77,6 +78,10 @@ class RemoteConfigREST {
   FRIEND_TEST(RemoteConfigRESTTest, Fetch);
   FRIEND_TEST(RemoteConfigRESTTest, ParseRestResponseProtoFailure);
   FRIEND_TEST(RemoteConfigRESTTest, ParseRestResponseSuccess);
+  FRIEND_TEST(RemoteConfigRESTTest, SetupRESTRequestWithEtag);
+  FRIEND_TEST(RemoteConfigRESTTest, ParseRestResponseStoresEtag);
+  FRIEND_TEST(RemoteConfigRESTTest, ParseRestResponseNotModified);
+  FRIEND_TEST(RemoteConfigRESTTest, ParseRestResponseNoChange);
 #endif  // FIREBASE_TESTING
 
   RemoteConfigREST(const firebase::AppOptions& app_options,
@@ -98,6 +103,15 @@ class RemoteConfigREST {
   // updated metadata.
   const RemoteConfigMetadata& metadata() const { return configs_.metadata; }
 
+  // Replace the fetched config and metadata that fetches start from, e.g.
+  // with the ones loaded from disk. The ETag of the fetched template in the
+  // metadata makes the next fetch conditional on it.
+  void SetConfigs(const LayeredConfigs& configs);
+
+  // Whether the last Fetch() found the template unchanged. Only the timestamp
+  // of the fetched config was updated then.
+  bool fetch_not_modified() const { return fetch_not_modified_; }
+
  private:
   // Attempt to get Installations and Auth Token from app synchronously.  This
   // will block the current thread and wait until the futures are complete.
@@ -116,6 +130,13 @@ class RemoteConfigREST {
   // Update metadata after successful fetching.
   void FetchSuccess(LastFetchStatus status);
 
+  // Update fetched config and metadata after the server found the template
+  // unchanged.
+  void FetchNotModified();
+
+  // Store the ETag and version of the template in the response in metadata.
+  void UpdateTemplateVersion();
+
   // Update metadata after failed fetching.
   void FetchFailure(FetchFailureReason reason);
 
@@ -135,8 +156,12 @@ class RemoteConfigREST {
   // The semaphore to block the thread and wait for.
   Semaphore fetch_future_sem_;
 
+  // Whether the last fetch found the template unchanged.
+  bool fetch_not_modified_;
+
   RemoteConfigRequest rc_request_;
-  RemoteConfigResponse rc_response_;
+  // Recreated for every fetch, as a response can't be reused.
+  std::unique_ptr<RemoteConfigResponse> rc_response_;
 };
 
 }  // namespace internal
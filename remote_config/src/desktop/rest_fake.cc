@@ -36,7 +36,8 @@ RemoteConfigREST::RemoteConfigREST(const firebase::AppOptions& app_options,
       api_key_(app_options.api_key()),
       namespaces_(std::move(namespaces)),
       configs_(configs),
-      fetch_future_sem_(0) {
+      fetch_future_sem_(0),
+      fetch_not_modified_(false) {
   configs_.fetched = NamespacedConfigData(
       NamespaceKeyValueMap({{"namespace", {{"key", "value"}}}}), 1000000);
 
@@ -51,6 +52,8 @@ RemoteConfigREST::~RemoteConfigREST() {}
 void RemoteConfigREST::Fetch(const App& app,
                              uint64_t fetch_timeout_in_milliseconds) {}
 
+void RemoteConfigREST::SetConfigs(const LayeredConfigs& configs) {}
+
 void RemoteConfigREST::SetupRestRequest(
     const App& app, uint64_t fetch_timeout_in_milliseconds) {}
 
@@ -60,6 +63,10 @@ void RemoteConfigREST::FetchSuccess(LastFetchStatus status) {}
 
 void RemoteConfigREST::FetchFailure(FetchFailureReason reason) {}
 
+void RemoteConfigREST::FetchNotModified() {}
+
+void RemoteConfigREST::UpdateTemplateVersion() {}
+
 uint64_t RemoteConfigREST::MillisecondsSinceEpoch() { return 0; }
 
 }  // namespace internal
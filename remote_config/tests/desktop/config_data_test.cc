@@ -152,6 +152,80 @@ TEST(NamespacedConfigDataTest, GetTimestamp) {
   EXPECT_EQ(holder.timestamp(), 1498757224);
 }
 
+TEST(NamespacedConfigDataTest, Diff) {
+  NamespacedConfigData from(
+      NamespaceKeyValueMap(
+          {{"namespace1",
+            {{"key1", "value1"}, {"key2", "value2"}, {"key3", "value3"}}},
+           {"namespace2", {{"key1", "value1"}}}}),
+      1234567);
+  NamespacedConfigData to(
+      NamespaceKeyValueMap({{"namespace1",
+                             {{"key1", "value1"},
+                              {"key2", "new value2"},
+                              {"key4", "value4"}}},
+                            {"namespace3", {{"key1", "value1"}}}}),
+      5555555);
+
+  NamespacedConfigDelta delta = from.Diff(to);
+  EXPECT_FALSE(delta.empty());
+  EXPECT_EQ(delta.timestamp, 5555555);
+  EXPECT_THAT(delta.GetUpdatedKeys("namespace1"),
+              ::testing::ElementsAre("key2", "key3", "key4"));
+  EXPECT_THAT(delta.GetUpdatedKeys("namespace2"),
+              ::testing::ElementsAre("key1"));
+  EXPECT_THAT(delta.GetUpdatedKeys("namespace3"),
+              ::testing::ElementsAre("key1"));
+  EXPECT_THAT(delta.GetUpdatedKeys("namespace4"), ::testing::ElementsAre());
+
+  from.ApplyDelta(delta);
+  EXPECT_EQ(from, to);
+}
+
+TEST(NamespacedConfigDataTest, DiffUnchanged) {
+  NamespaceKeyValueMap m({{"namespace1", {{"key1", "value1"}}}});
+  NamespacedConfigData from(m, 1234567);
+  NamespacedConfigData to(m, 5555555);
+
+  NamespacedConfigDelta delta = from.Diff(to);
+  EXPECT_TRUE(delta.empty());
+  EXPECT_THAT(delta.GetUpdatedKeys("namespace1"), ::testing::ElementsAre());
+
+  from.ApplyDelta(delta);
+  EXPECT_EQ(from, to);
+}
+
+TEST(NamespacedConfigDataTest, DiffEmptyNamespaces) {
+  NamespacedConfigData from(
+      NamespaceKeyValueMap({{"namespace1", {{"key1", "value1"}}},
+                            {"namespace2", {}},
+                            {"namespace3", {{"key1", "value1"}}}}),
+      1234567);
+  NamespacedConfigData to(
+      NamespaceKeyValueMap({{"namespace1", {}}, {"namespace4", {}}}),
+      5555555);
+
+  from.ApplyDelta(from.Diff(to));
+  EXPECT_EQ(from, to);
+}
+
+TEST(NamespacedConfigDeltaTest, ConversionToFlexbuffer) {
+  NamespacedConfigData from(
+      NamespaceKeyValueMap(
+          {{"namespace1", {{"key1", "value1"}, {"key2", "value2"}}}}),
+      1234567);
+  NamespacedConfigData to(
+      NamespaceKeyValueMap(
+          {{"namespace1", {{"key1", "new value1"}, {"key3", "value3"}}}}),
+      5555555);
+  NamespacedConfigDelta delta = from.Diff(to);
+
+  NamespacedConfigDelta new_delta;
+  new_delta.Deserialize(delta.Serialize());
+
+  EXPECT_EQ(delta, new_delta);
+}
+
 }  // namespace internal
 }  // namespace remote_config
 }  // namespace firebase
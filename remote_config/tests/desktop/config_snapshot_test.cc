@@ -0,0 +1,103 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "remote_config/src/desktop/config_snapshot.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace firebase {
+namespace remote_config {
+namespace internal {
+
+static ConfigSnapshot::Value MakeValue(const std::string& key,
+                                       const std::string& string_value) {
+  ConfigSnapshot::Value value;
+  value.key = key;
+  value.string_value = string_value;
+  value.source = kValueSourceRemoteValue;
+  return value;
+}
+
+TEST(ConfigSnapshotTest, FindInEmptySnapshot) {
+  ConfigSnapshot snapshot((std::vector<ConfigSnapshot::Value>()));
+  EXPECT_EQ(snapshot.size(), 0u);
+  EXPECT_EQ(snapshot.Find("key"), nullptr);
+  EXPECT_EQ(snapshot.Find(""), nullptr);
+  EXPECT_EQ(snapshot.Find(nullptr), nullptr);
+}
+
+TEST(ConfigSnapshotTest, FindValues) {
+  std::vector<ConfigSnapshot::Value> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(
+        MakeValue("key" + std::to_string(i), "value" + std::to_string(i)));
+  }
+  ConfigSnapshot snapshot(values);
+  EXPECT_EQ(snapshot.size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    std::string key = "key" + std::to_string(i);
+    const ConfigSnapshot::Value* value = snapshot.Find(key.c_str());
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(value->key, key);
+    EXPECT_EQ(value->string_value, "value" + std::to_string(i));
+    EXPECT_EQ(value->source, kValueSourceRemoteValue);
+  }
+  EXPECT_EQ(snapshot.Find("key100"), nullptr);
+  EXPECT_EQ(snapshot.Find("key"), nullptr);
+}
+
+TEST(ConfigSnapshotTest, EmptyKey) {
+  std::vector<ConfigSnapshot::Value> values;
+  values.push_back(MakeValue("", "empty"));
+  ConfigSnapshot snapshot(values);
+  const ConfigSnapshot::Value* value = snapshot.Find("");
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(value->string_value, "empty");
+}
+
+TEST(ConfigSnapshotHolderTest, PublishReplacesSnapshot) {
+  ConfigSnapshotHolder holder;
+  {
+    ConfigSnapshotHolder::Reader reader(&holder);
+    EXPECT_EQ(reader->size(), 0u);
+  }
+
+  std::vector<ConfigSnapshot::Value> values;
+  values.push_back(MakeValue("key", "first"));
+  holder.Publish(std::unique_ptr<ConfigSnapshot>(new ConfigSnapshot(values)));
+  {
+    ConfigSnapshotHolder::Reader reader(&holder);
+    ASSERT_NE(reader->Find("key"), nullptr);
+    EXPECT_EQ(reader->Find("key")->string_value, "first");
+
+    // A reader keeps seeing the snapshot it started with.
+    values[0].string_value = "second";
+    holder.Publish(
+        std::unique_ptr<ConfigSnapshot>(new ConfigSnapshot(values)));
+    EXPECT_EQ(reader->Find("key")->string_value, "first");
+  }
+  {
+    ConfigSnapshotHolder::Reader reader(&holder);
+    EXPECT_EQ(reader->Find("key")->string_value, "second");
+  }
+}
+
+}  // namespace internal
+}  // namespace remote_config
+}  // namespace firebase
@@ -14,7 +14,9 @@
 
 #include "remote_config/src/desktop/file_manager.h"
 
+#include <fstream>
 #include <map>
+#include <sstream>
 #include <string>
 
 #include "file/base/path.h"
@@ -61,6 +63,81 @@ TEST(RemoteConfigFileManagerTest, SaveAndLoadSuccess) {
   EXPECT_EQ(configs, new_configs);
 }
 
+TEST(RemoteConfigFileManagerTest, SaveActivationAndLoad) {
+  std::string file_path =
+      file::JoinPath(FLAGS_test_tmpdir, "remote_config_journal_data");
+
+  RemoteConfigFileManager file_manager(file_path);
+  NamespacedConfigData active(
+      NamespaceKeyValueMap(
+          {{"namespace1", {{"key1", "value1"}, {"key2", "value2"}}}}),
+      1234567);
+  NamespacedConfigData defaults(
+      NamespaceKeyValueMap({{"namespace1", {{"key3", "value3"}}}}), 9999999);
+  RemoteConfigMetadata metadata;
+  metadata.AddSetting(kConfigSettingDeveloperMode, "0");
+
+  LayeredConfigs configs(active, active, defaults, metadata);
+  EXPECT_TRUE(file_manager.Save(configs));
+
+  // Activate two new versions of the config.
+  NamespacedConfigData fetched1(
+      NamespaceKeyValueMap(
+          {{"namespace1", {{"key1", "new value1"}, {"key2", "value2"}}}}),
+      5555555);
+  NamespacedConfigData fetched2(
+      NamespaceKeyValueMap({{"namespace1", {{"key1", "new value1"}}}}),
+      7777777);
+  metadata.set_info(ConfigInfo({1498757224, kLastFetchStatusSuccess,
+                                kFetchFailureReasonInvalid, 0}));
+  EXPECT_TRUE(file_manager.SaveActivation(active.Diff(fetched1), metadata));
+  EXPECT_TRUE(file_manager.SaveActivation(fetched1.Diff(fetched2), metadata));
+
+  LayeredConfigs expected(fetched2, fetched2, defaults, metadata);
+  LayeredConfigs loaded_configs;
+  EXPECT_TRUE(file_manager.Load(&loaded_configs));
+  EXPECT_EQ(expected, loaded_configs);
+
+  // Saving everything empties the journal.
+  EXPECT_TRUE(file_manager.Save(configs));
+  LayeredConfigs saved_configs;
+  EXPECT_TRUE(file_manager.Load(&saved_configs));
+  EXPECT_EQ(configs, saved_configs);
+}
+
+TEST(RemoteConfigFileManagerTest, InterruptedSaveIgnoresStaleJournal) {
+  std::string file_path =
+      file::JoinPath(FLAGS_test_tmpdir, "remote_config_stale_journal_data");
+  std::string journal_path = file_path + ".journal";
+
+  RemoteConfigFileManager file_manager(file_path);
+  NamespacedConfigData active(
+      NamespaceKeyValueMap({{"namespace1", {{"key1", "value1"}}}}), 1234567);
+  RemoteConfigMetadata metadata;
+  LayeredConfigs configs(active, active, NamespacedConfigData(), metadata);
+  EXPECT_TRUE(file_manager.Save(configs));
+
+  NamespacedConfigData fetched(
+      NamespaceKeyValueMap({{"namespace1", {{"key1", "new value1"}}}}),
+      5555555);
+  EXPECT_TRUE(file_manager.SaveActivation(active.Diff(fetched), metadata));
+  std::stringstream journal;
+  journal << std::ifstream(journal_path, std::ios::binary).rdbuf();
+
+  // Save a newer state, then put the old journal back as if the save had been
+  // interrupted before emptying it.
+  NamespacedConfigData newer(
+      NamespaceKeyValueMap({{"namespace1", {{"key2", "value2"}}}}), 7777777);
+  LayeredConfigs newer_configs(newer, newer, NamespacedConfigData(),
+                               metadata);
+  EXPECT_TRUE(file_manager.Save(newer_configs));
+  std::ofstream(journal_path, std::ios::binary) << journal.str();
+
+  LayeredConfigs loaded_configs;
+  EXPECT_TRUE(file_manager.Load(&loaded_configs));
+  EXPECT_EQ(newer_configs, loaded_configs);
+}
+
 }  // namespace internal
 }  // namespace remote_config
 }  // namespace firebase
@@ -16,7 +16,9 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
+#include "flatbuffers/flexbuffers.h"
 #include "gtest/gtest.h"
 #include "remote_config/src/include/firebase/remote_config.h"
 
@@ -38,6 +40,10 @@ TEST(RemoteConfigMetadataTest, Serialization) {
                   kFetchFailureReasonThrottled, 1498758888}));
   remote_config_metadata.set_digest_by_namespace(
       MetaDigestMap({{"namespace1", "digest1"}, {"namespace2", "digest2"}}));
+  remote_config_metadata.set_etag_by_namespace(
+      MetaDigestMap({{"namespace1", "etag-1"}}));
+  remote_config_metadata.set_template_version_by_namespace(
+      MetaDigestMap({{"namespace1", "12"}}));
   remote_config_metadata.AddSetting(kConfigSettingDeveloperMode, "0");
 
   std::string buffer = remote_config_metadata.Serialize();
@@ -47,6 +53,28 @@ TEST(RemoteConfigMetadataTest, Serialization) {
   EXPECT_EQ(remote_config_metadata, new_remote_config_metadata);
 }
 
+// Metadata written before the ETag and template version were stored has
+// neither.
+TEST(RemoteConfigMetadataTest, DeserializeWithoutTemplateEtag) {
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Map("info", [&]() {});
+    fbb.Add("digest_by_namespace", MetaDigestMap({{"namespace1", "digest1"}}));
+    fbb.Map("settings", [&]() {});
+  });
+  fbb.Finish();
+  const std::vector<uint8_t>& buffer = fbb.GetBuffer();
+
+  RemoteConfigMetadata m;
+  m.set_etag_by_namespace(MetaDigestMap({{"namespace1", "etag-1"}}));
+  m.Deserialize(std::string(buffer.cbegin(), buffer.cend()));
+
+  EXPECT_EQ(m.digest_by_namespace(),
+            MetaDigestMap({{"namespace1", "digest1"}}));
+  EXPECT_TRUE(m.etag_by_namespace().empty());
+  EXPECT_TRUE(m.template_version_by_namespace().empty());
+}
+
 TEST(RemoteConfigMetadataTest, GetInfoDefaultValues) {
   RemoteConfigMetadata m;
   ExpectEqualConfigInfo(m.info(), ConfigInfo({0, kLastFetchStatusSuccess,
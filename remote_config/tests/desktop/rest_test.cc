@@ -88,9 +88,9 @@ class RemoteConfigRESTTest : public ::testing::Test {
 
   //  Check all values in case when fetch failed.
   void ExpectFetchFailure(const RemoteConfigREST& rest, int code) {
-    EXPECT_EQ(rest.rc_response_.status(), code);
-    EXPECT_TRUE(rest.rc_response_.header_completed());
-    EXPECT_TRUE(rest.rc_response_.body_completed());
+    EXPECT_EQ(rest.rc_response_->status(), code);
+    EXPECT_TRUE(rest.rc_response_->header_completed());
+    EXPECT_TRUE(rest.rc_response_->body_completed());
 
     EXPECT_EQ(rest.fetched().config(), configs_.fetched.config());
     EXPECT_EQ(rest.metadata().digest_by_namespace(),
@@ -193,6 +193,24 @@ TEST_F(RemoteConfigRESTTest, SetupRESTRequest) {
   // TODO(cynthiajiang) verify installations id and token.
 }
 
+// The request is conditional on the ETag of the last fetched template.
+TEST_F(RemoteConfigRESTTest, SetupRESTRequestWithEtag) {
+  RemoteConfigREST rest(app_->options(), configs_, kTestNamespaces);
+  rest.SetupRestRequest(*app_, kDefaultTimeoutInMilliseconds);
+  EXPECT_EQ(rest.rc_request_.options().header.count(kIfNoneMatchHeader), 0);
+
+  configs_.metadata.set_etag_by_namespace(
+      MetaDigestMap({{kTestNamespaces, "etag-1"}}));
+  rest.SetConfigs(configs_);
+  rest.SetupRestRequest(*app_, kDefaultTimeoutInMilliseconds);
+  EXPECT_EQ(rest.rc_request_.options().header[kIfNoneMatchHeader], "etag-1");
+
+  configs_.metadata.set_etag_by_namespace(MetaDigestMap());
+  rest.SetConfigs(configs_);
+  rest.SetupRestRequest(*app_, kDefaultTimeoutInMilliseconds);
+  EXPECT_EQ(rest.rc_request_.options().header.count(kIfNoneMatchHeader), 0);
+}
+
 // Verify the rest request with mock project will return code 404
 TEST_F(RemoteConfigRESTTest, Fetch) {
   int codes[] = {404};
@@ -224,10 +242,10 @@ TEST_F(RemoteConfigRESTTest, ParseRestResponseProtoFailure) {
   std::string body = "";
 
   RemoteConfigREST rest(app_->options(), configs_, kTestNamespaces);
-  rest.rc_response_.ProcessHeader(header.data(), header.length());
-  rest.rc_response_.ProcessBody(body.data(), body.length());
-  rest.rc_response_.MarkCompleted();
-  EXPECT_EQ(rest.rc_response_.status(), 200);
+  rest.rc_response_->ProcessHeader(header.data(), header.length());
+  rest.rc_response_->ProcessBody(body.data(), body.length());
+  rest.rc_response_->MarkCompleted();
+  EXPECT_EQ(rest.rc_response_->status(), 200);
 
   rest.ParseRestResponse();
 
@@ -238,10 +256,11 @@ TEST_F(RemoteConfigRESTTest, ParseRestResponseSuccess) {
   std::string header = "HTTP/1.1 200 Ok";
 
   RemoteConfigREST rest(app_->options(), configs_, kTestNamespaces);
-  rest.rc_response_.ProcessHeader(header.data(), header.length());
-  rest.rc_response_.ProcessBody(response_body_.data(), response_body_.length());
-  rest.rc_response_.MarkCompleted();
-  EXPECT_EQ(rest.rc_response_.status(), 200);
+  rest.rc_response_->ProcessHeader(header.data(), header.length());
+  rest.rc_response_->ProcessBody(response_body_.data(),
+                                 response_body_.length());
+  rest.rc_response_->MarkCompleted();
+  EXPECT_EQ(rest.rc_response_->status(), 200);
 
   rest.ParseRestResponse();
 
@@ -262,6 +281,69 @@ TEST_F(RemoteConfigRESTTest, ParseRestResponseSuccess) {
   EXPECT_GE(info.fetch_time, MillisecondsSinceEpoch() - 10000);
 }
 
+TEST_F(RemoteConfigRESTTest, ParseRestResponseStoresEtag) {
+  std::string header = "HTTP/1.1 200 Ok";
+  std::string etag_header = "ETag: etag-2\r\n";
+  std::string body = R"({
+    "entries": {"TestData": "4321"},
+    "state": "UPDATE",
+    "templateVersion": "12"
+  })";
+
+  RemoteConfigREST rest(app_->options(), configs_, kTestNamespaces);
+  rest.rc_response_->ProcessHeader(header.data(), header.length());
+  rest.rc_response_->ProcessHeader(etag_header.data(), etag_header.length());
+  rest.rc_response_->ProcessBody(body.data(), body.length());
+  rest.rc_response_->MarkCompleted();
+
+  rest.ParseRestResponse();
+
+  EXPECT_FALSE(rest.fetch_not_modified());
+  EXPECT_EQ(rest.metadata().etag_by_namespace(),
+            MetaDigestMap({{kTestNamespaces, "etag-2"}}));
+  EXPECT_EQ(rest.metadata().template_version_by_namespace(),
+            MetaDigestMap({{kTestNamespaces, "12"}}));
+}
+
+// "304 Not Modified" keeps the fetched config, and only updates its timestamp.
+TEST_F(RemoteConfigRESTTest, ParseRestResponseNotModified) {
+  std::string header = "HTTP/1.1 304 Not Modified";
+  configs_.metadata.set_etag_by_namespace(
+      MetaDigestMap({{kTestNamespaces, "etag-1"}}));
+
+  RemoteConfigREST rest(app_->options(), configs_, kTestNamespaces);
+  rest.rc_response_->ProcessHeader(header.data(), header.length());
+  rest.rc_response_->MarkCompleted();
+
+  rest.ParseRestResponse();
+
+  EXPECT_TRUE(rest.fetch_not_modified());
+  EXPECT_EQ(rest.fetched().config(), configs_.fetched.config());
+  EXPECT_GT(rest.fetched().timestamp(), configs_.fetched.timestamp());
+  EXPECT_EQ(rest.metadata().etag_by_namespace(),
+            configs_.metadata.etag_by_namespace());
+
+  ConfigInfo info = rest.metadata().info();
+  EXPECT_EQ(info.last_fetch_status, kLastFetchStatusSuccess);
+  EXPECT_GE(info.fetch_time, MillisecondsSinceEpoch() - 10000);
+}
+
+TEST_F(RemoteConfigRESTTest, ParseRestResponseNoChange) {
+  std::string header = "HTTP/1.1 200 Ok";
+  std::string body = R"({"state": "NO_CHANGE"})";
+
+  RemoteConfigREST rest(app_->options(), configs_, kTestNamespaces);
+  rest.rc_response_->ProcessHeader(header.data(), header.length());
+  rest.rc_response_->ProcessBody(body.data(), body.length());
+  rest.rc_response_->MarkCompleted();
+
+  rest.ParseRestResponse();
+
+  EXPECT_TRUE(rest.fetch_not_modified());
+  EXPECT_EQ(rest.fetched().config(), configs_.fetched.config());
+  EXPECT_EQ(rest.metadata().info().last_fetch_status, kLastFetchStatusSuccess);
+}
+
 }  // namespace internal
 }  // namespace remote_config
 }  // namespace firebase
@@ -105,6 +105,7 @@ enum StorageReferenceFn {
   kStorageReferenceFnUpdateMetadata,
   kStorageReferenceFnPutBytes,
   kStorageReferenceFnPutFile,
+  kStorageReferenceFnPutStream,
   kStorageReferenceFnCount,
 };
 
@@ -687,6 +688,27 @@ Future<Metadata> StorageReferenceInternal::PutFileLastResult() {
       future()->LastResult(kStorageReferenceFnPutFile));
 }
 
+Future<Metadata> StorageReferenceInternal::PutStream(
+    StreamSource* source, Listener* listener, Controller* controller_out) {
+  return PutStream(source, nullptr, listener, controller_out);
+}
+
+Future<Metadata> StorageReferenceInternal::PutStream(
+    StreamSource* /*source*/, const Metadata* /*metadata*/,
+    Listener* /*listener*/, Controller* /*controller_out*/) {
+  ReferenceCountedFutureImpl* future_impl = future();
+  FutureHandle handle =
+      future_impl->Alloc<Metadata>(kStorageReferenceFnPutStream);
+  future_impl->Complete(handle, kErrorUnknown,
+                        "PutStream() is not supported on Android.");
+  return PutStreamLastResult();
+}
+
+Future<Metadata> StorageReferenceInternal::PutStreamLastResult() {
+  return static_cast<const Future<Metadata>&>(
+      future()->LastResult(kStorageReferenceFnPutStream));
+}
+
 ReferenceCountedFutureImpl* StorageReferenceInternal::future() {
   return storage_->future_manager().GetFutureApi(this);
 }
@@ -129,6 +129,16 @@ class StorageReferenceInternal {
   // Returns the result of the most recent call to PutFile();
   Future<Metadata> PutFileLastResult();
 
+  // Stream uploads are not supported on Android, these complete the returned
+  // future with an error.
+  Future<Metadata> PutStream(StreamSource* source, Listener* listener,
+                             Controller* controller_out);
+  Future<Metadata> PutStream(StreamSource* source, const Metadata* metadata,
+                             Listener* listener, Controller* controller_out);
+
+  // Returns the result of the most recent call to PutStream();
+  Future<Metadata> PutStreamLastResult();
+
   // Initialize JNI bindings for this class.
   static bool Initialize(App* app);
   static void Terminate(App* app);
@@ -25,6 +25,7 @@
 #include "app/src/include/firebase/app.h"
 #include "app/src/include/firebase/internal/platform.h"
 #include "app/src/include/firebase/version.h"
+#include "app/src/log.h"
 #include "app/src/util.h"
 #include "storage/src/common/storage_uri_parser.h"
 
@@ -208,6 +209,18 @@ void Storage::set_max_download_retry_time(double max_transfer_retry_seconds) {
     internal_->set_max_download_retry_time(max_transfer_retry_seconds);
 }
 
+void Storage::set_download_cache(const char* directory,
+                                 size_t max_size_bytes) {
+#if FIREBASE_PLATFORM_ANDROID || FIREBASE_PLATFORM_IOS || FIREBASE_PLATFORM_TVOS
+  (void)directory;
+  (void)max_size_bytes;
+  LogWarning("Storage download cache is only supported on desktop.");
+#else
+  if (internal_) internal_->set_download_cache(directory, max_size_bytes);
+#endif  // FIREBASE_PLATFORM_ANDROID || FIREBASE_PLATFORM_IOS ||
+        // FIREBASE_PLATFORM_TVOS
+}
+
 double Storage::max_upload_retry_time() {
   return internal_ ? internal_->max_upload_retry_time() : 0;
 }
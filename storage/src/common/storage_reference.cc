@@ -246,6 +246,27 @@ Future<Metadata> StorageReference::PutFileLastResult() {
   return internal_ ? internal_->PutFileLastResult() : Future<Metadata>();
 }
 
+Future<Metadata> StorageReference::PutStream(StreamSource* source,
+                                             Listener* listener,
+                                             Controller* controller_out) {
+  return internal_ ? internal_->PutStream(source, listener, controller_out)
+                   : Future<Metadata>();
+}
+
+Future<Metadata> StorageReference::PutStream(StreamSource* source,
+                                             const Metadata& metadata,
+                                             Listener* listener,
+                                             Controller* controller_out) {
+  AssertMetadataIsValid(metadata);
+  return internal_
+             ? internal_->PutStream(source, &metadata, listener, controller_out)
+             : Future<Metadata>();
+}
+
+Future<Metadata> StorageReference::PutStreamLastResult() {
+  return internal_ ? internal_->PutStreamLastResult() : Future<Metadata>();
+}
+
 bool StorageReference::is_valid() const { return internal_ != nullptr; }
 
 }  // namespace storage
@@ -16,6 +16,8 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <string>
 
 #include "app/rest/util.h"
@@ -32,6 +34,9 @@ static const char* kInvalidJsonResponse =
     "The server did not return a valid JSON response.  "
     "Contact Firebase support if this issue persists.";
 
+static const char* kBufferTooSmall =
+    "The object is larger than the buffer it is downloaded into.";
+
 // Utility function to map HTTP status requests onto Firebase Error Codes.
 // Note that the mapping is not 1:1, so not all Firebase error codes can be
 // returned.  (A lot of them end up as kErrorUnknown, due to ambiguity.)
@@ -62,7 +67,7 @@ Error HttpToErrorCode(int http_status) {
 // remains valid while the future handle isn't complete.
 BlockingResponse::BlockingResponse(FutureHandle handle,
                                    ReferenceCountedFutureImpl* ref_future)
-    : handle_(handle), ref_future_(ref_future) {}
+    : handle_(handle), ref_future_(ref_future), should_resend_(false) {}
 
 BlockingResponse::~BlockingResponse() {
   // If the response isn't complete, cancel it.
@@ -241,6 +246,184 @@ void GetFileResponse::MarkCompleted() {
   BlockingResponse::NotifyComplete();
 }
 
+CachedGetResponse::CachedGetResponse(std::shared_ptr<DownloadCache> cache,
+                                     const std::string& key,
+                                     const DownloadCache::Entry* cached,
+                                     const char* filename,
+                                     SafeFutureHandle<size_t> handle,
+                                     ReferenceCountedFutureImpl* ref_future)
+    : BlockingResponse(handle.get(), ref_future),
+      cache_(cache),
+      key_(key),
+      has_cached_entry_(cached != nullptr),
+      filename_(filename),
+      output_buffer_(nullptr),
+      buffer_size_(0),
+      bytes_received_(0),
+      overflowed_(false) {
+  if (cached) cached_entry_ = *cached;
+}
+
+CachedGetResponse::CachedGetResponse(std::shared_ptr<DownloadCache> cache,
+                                     const std::string& key,
+                                     const DownloadCache::Entry* cached,
+                                     void* buffer, size_t buffer_size,
+                                     SafeFutureHandle<size_t> handle,
+                                     ReferenceCountedFutureImpl* ref_future)
+    : BlockingResponse(handle.get(), ref_future),
+      cache_(cache),
+      key_(key),
+      has_cached_entry_(cached != nullptr),
+      output_buffer_(buffer),
+      buffer_size_(buffer_size),
+      bytes_received_(0),
+      overflowed_(false) {
+  if (cached) cached_entry_ = *cached;
+}
+
+// Since buffer may NOT necessarily end with \0, pass in length.
+bool CachedGetResponse::ProcessBody(const char* buffer, size_t length) {
+  if (status() != rest::util::HttpSuccess) {
+    // Not modified responses have no body, so this is an error to parse
+    // later.
+    error_buffer_.append(buffer, length);
+  } else if (output_buffer_) {
+    size_t bytes_to_copy =
+        (std::min)(length, buffer_size_ - bytes_received_);
+    // If the object doesn't fit, return false to abort the transfer.
+    if (bytes_to_copy == 0 && length != 0) {
+      overflowed_ = true;
+      return false;
+    }
+    memcpy(static_cast<char*>(output_buffer_) + bytes_received_, buffer,
+           bytes_to_copy);
+    bytes_received_ += bytes_to_copy;
+  } else {
+    if (!file_.is_open()) {
+      file_.open(filename_, std::ios::out | std::ios::binary);
+    }
+    file_.write(buffer, length);
+    bytes_received_ += length;
+  }
+  NotifyProgress();
+  return true;
+}
+
+void CachedGetResponse::MarkCompleted() {
+  BlockingResponse::MarkCompleted();
+  SafeFutureHandle<size_t> handle(handle_);
+  if (status() == rest::util::HttpSuccess) {
+    if (file_.is_open()) file_.close();
+    if (overflowed_) {
+      ref_future_->CompleteWithResult(handle, kErrorDownloadSizeExceeded,
+                                      kBufferTooSmall, bytes_received_);
+    } else if (!ReceivedWholeObject()) {
+      // A truncated object must never be cached, or every later request
+      // would be told it is up to date.
+      ref_future_->CompleteWithResult(handle, kErrorUnknown,
+                                      "The download was incomplete.",
+                                      bytes_received_);
+    } else {
+      AddToCache();
+      ref_future_->CompleteWithResult(handle, kErrorNone, bytes_received_);
+    }
+  } else if (status() == rest::util::HttpNotModified && has_cached_entry_) {
+    if (output_buffer_ && cached_entry_.size > buffer_size_) {
+      // The cached copy is fine, it just doesn't fit.
+      ref_future_->CompleteWithResult(handle, kErrorDownloadSizeExceeded,
+                                      kBufferTooSmall, bytes_received_);
+    } else if (Materialize(cached_entry_)) {
+      ref_future_->CompleteWithResult(handle, kErrorNone, bytes_received_);
+    } else {
+      // The cached copy couldn't be copied, e.g. it was evicted after the
+      // request was sent. Drop it if it is gone and nothing replaced it, and
+      // download the object again.
+      if (!std::ifstream(cached_entry_.path, std::ios::binary).is_open()) {
+        cache_->RemoveIfUnchanged(key_, cached_entry_);
+      }
+      should_resend_ = true;
+      ref_future_->CompleteWithResult(handle, kErrorUnknown,
+                                      "Failed to read the cached object.",
+                                      bytes_received_);
+    }
+  } else {
+    StorageNetworkError response;
+    if (response.Parse(error_buffer_.c_str())) {
+      ref_future_->CompleteWithResult(handle, HttpToErrorCode(status()),
+                                      response.error_message().c_str(),
+                                      bytes_received_);
+    } else {
+      ref_future_->CompleteWithResult(handle, HttpToErrorCode(status()),
+                                      kInvalidJsonResponse, bytes_received_);
+    }
+  }
+  NotifyProgress();
+  BlockingResponse::NotifyComplete();
+}
+
+bool CachedGetResponse::ReceivedWholeObject() {
+  std::string content_length = GetHeaderValue("Content-Length",
+                                               "content-length");
+  // Chunked transfers have no length to check.
+  if (content_length.empty()) return true;
+  char* end;
+  unsigned long long expected =  // NOLINT
+      strtoull(content_length.c_str(), &end, 10);
+  return *end == '\0' && expected == bytes_received_;
+}
+
+bool CachedGetResponse::Materialize(const DownloadCache::Entry& entry) {
+  if (output_buffer_) {
+    if (entry.size > buffer_size_) return false;
+    bytes_received_ =
+        DownloadCache::ReadIntoBuffer(entry, output_buffer_, entry.size);
+    return bytes_received_ == entry.size;
+  }
+  if (!DownloadCache::MaterializeFile(entry, filename_)) return false;
+  bytes_received_ = entry.size;
+  return true;
+}
+
+void CachedGetResponse::AddToCache() {
+  std::string etag = GetHeaderValue("ETag", "etag");
+  if (etag.empty()) {
+    // Without an ETag the object can't be revalidated, so any stale copy
+    // must go.
+    cache_->Remove(key_);
+    return;
+  }
+  std::string temp_filename = cache_->CreateTempFilePath();
+  bool written;
+  if (output_buffer_) {
+    std::ofstream temp_file(temp_filename, std::ios::out | std::ios::binary);
+    temp_file.write(static_cast<const char*>(output_buffer_),
+                    static_cast<std::streamsize>(bytes_received_));
+    temp_file.close();
+    written = !temp_file.fail();
+  } else {
+    DownloadCache::Entry downloaded;
+    downloaded.path = filename_;
+    downloaded.size = bytes_received_;
+    written = DownloadCache::MaterializeFile(downloaded, temp_filename);
+  }
+  if (!written) {
+    DownloadCache::RemoveFile(temp_filename);
+    cache_->Remove(key_);
+    return;
+  }
+  cache_->Insert(key_, etag,
+                 GetHeaderValue("X-Goog-Generation", "x-goog-generation"),
+                 temp_filename, bytes_received_, nullptr);
+}
+
+std::string CachedGetResponse::GetHeaderValue(const char* name,
+                                              const char* lower_name) {
+  // HTTP/2 servers send lower case header names.
+  const char* value = GetHeader(name);
+  if (!value) value = GetHeader(lower_name);
+  return value ? std::string(value) : std::string();
+}
+
 ReturnedMetadataResponse::ReturnedMetadataResponse(
     SafeFutureHandle<Metadata> handle, ReferenceCountedFutureImpl* ref_future,
     const StorageReference& storage_reference)
@@ -248,7 +431,7 @@ ReturnedMetadataResponse::ReturnedMetadataResponse(
       storage_reference_(storage_reference) {}
 
 bool ReturnedMetadataResponse::ProcessBody(const char* buffer, size_t length) {
-  buffer_ += std::string(buffer, length);
+  if (!DecodeBody(buffer, length, &buffer_)) return false;
   NotifyProgress();
   return true;
 }
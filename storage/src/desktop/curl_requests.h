@@ -16,21 +16,25 @@
 #define FIREBASE_STORAGE_SRC_DESKTOP_CURL_REQUESTS_H_
 
 #include <fstream>
+#include <memory>
 
 #include "app/rest/request_binary.h"
 #include "app/rest/request_file.h"
+#include "app/rest/request_stream.h"
 #include "app/rest/response_binary.h"
 #include "app/rest/transport_builder.h"
 #include "app/rest/util.h"
 #include "app/src/include/firebase/internal/mutex.h"
 #include "app/src/reference_counted_future_impl.h"
 #include "app/src/semaphore.h"
+#include "storage/src/desktop/download_cache.h"
 #include "storage/src/desktop/listener_desktop.h"
 #include "storage/src/desktop/storage_desktop.h"
 #include "storage/src/include/firebase/storage/common.h"
 #include "storage/src/include/firebase/storage/controller.h"
 #include "storage/src/include/firebase/storage/listener.h"
 #include "storage/src/include/firebase/storage/storage_reference.h"
+#include "storage/src/include/firebase/storage/stream_source.h"
 
 namespace firebase {
 namespace storage {
@@ -142,6 +146,26 @@ class RequestFile : public rest::RequestFile {
   FIREBASE_STORAGE_REQUEST_CLASS_BODY(rest::RequestFile);
 };
 
+// Reads from a user supplied StreamSource.
+class RequestStream : public rest::RequestStream {
+ public:
+  explicit RequestStream(StreamSource* source)
+      : rest::RequestStream(ReadFromSource, source, source->size()) {
+    static_assert(
+        StreamSource::kSizeUnknown == rest::RequestStream::kUnknownSize,
+        "StreamSource and RequestStream must agree on the unknown size");
+  }
+
+  FIREBASE_STORAGE_REQUEST_CLASS_BODY(rest::RequestStream);
+
+ private:
+  static size_t ReadFromSource(char* buffer, size_t length, bool* abort,
+                               void* callback_data) {
+    return static_cast<StreamSource*>(callback_data)
+        ->Read(buffer, length, abort);
+  }
+};
+
 // TODO(b/68854714): merge with the blocking response in query_desktop.
 // b/68854714
 class BlockingResponse : public rest::Response {
@@ -165,6 +189,10 @@ class BlockingResponse : public rest::Response {
     notifier_.set_update_callback(callback, callback_data);
   }
 
+  // Whether the request should be sent again right away, whatever its
+  // result, e.g. because a cached copy it relied on turned out to be gone.
+  bool should_resend() const { return should_resend_; }
+
  protected:
   // Report completion of this response.
   // This should be the last thing a request calls.  This *must* be performed at
@@ -184,6 +212,7 @@ class BlockingResponse : public rest::Response {
  protected:
   FutureHandle handle_;
   ReferenceCountedFutureImpl* ref_future_;
+  bool should_resend_;
 };
 
 // Response class for operations that don't return any data.  (i. e. delete.)
@@ -233,6 +262,59 @@ class GetFileResponse : public BlockingResponse {
   size_t bytes_written_;
 };
 
+// Response for downloading a storage resource through the download cache,
+// either into memory or into a file.
+// When a cached copy of the object exists the request is sent with its ETag,
+// and a "304 Not Modified" reply is served from the cache. Otherwise the
+// object is downloaded to the destination as usual and a copy of it is added
+// to the cache once the whole object has been received.
+// If the cached copy can't be read when the server replies "304 Not
+// Modified", the request should be sent again without the ETag.
+class CachedGetResponse : public BlockingResponse {
+ public:
+  // Download into filename.
+  CachedGetResponse(std::shared_ptr<DownloadCache> cache,
+                    const std::string& key, const DownloadCache::Entry* cached,
+                    const char* filename, SafeFutureHandle<size_t> handle,
+                    ReferenceCountedFutureImpl* ref_future);
+  // Download into buffer.
+  CachedGetResponse(std::shared_ptr<DownloadCache> cache,
+                    const std::string& key, const DownloadCache::Entry* cached,
+                    void* buffer, size_t buffer_size,
+                    SafeFutureHandle<size_t> handle,
+                    ReferenceCountedFutureImpl* ref_future);
+  bool ProcessBody(const char* buffer, size_t length) override;
+  void MarkCompleted() override;
+
+ private:
+  // Copy the cached object to the destination, returning false if the copy
+  // failed.
+  bool Materialize(const DownloadCache::Entry& entry);
+
+  // Whether the whole object was received, as announced by Content-Length.
+  bool ReceivedWholeObject();
+
+  // Add the downloaded object to the cache.
+  void AddToCache();
+
+  // Returns the value of a response header, ignoring the case of the name.
+  std::string GetHeaderValue(const char* name, const char* lower_name);
+
+  std::shared_ptr<DownloadCache> cache_;
+  std::string key_;
+  bool has_cached_entry_;
+  DownloadCache::Entry cached_entry_;
+  // Destination file, empty when downloading into output_buffer_.
+  std::string filename_;
+  void* output_buffer_;
+  size_t buffer_size_;
+  std::fstream file_;
+  size_t bytes_received_;
+  // Whether the object didn't fit in output_buffer_.
+  bool overflowed_;
+  std::string error_buffer_;
+};
+
 // Response for any operation that returns a blob of text that we need
 // to interpret as metadata.
 class ReturnedMetadataResponse : public BlockingResponse {
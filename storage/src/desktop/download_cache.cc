@@ -0,0 +1,304 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "storage/src/desktop/download_cache.h"
+
+#include "app/src/include/firebase/internal/platform.h"
+
+#if FIREBASE_PLATFORM_WINDOWS
+#include <direct.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif  // FIREBASE_PLATFORM_WINDOWS
+
+#if FIREBASE_PLATFORM_LINUX
+#include <linux/fs.h>
+#elif FIREBASE_PLATFORM_OSX
+#include <sys/clonefile.h>
+#endif  // FIREBASE_PLATFORM_LINUX, FIREBASE_PLATFORM_OSX
+
+#include <errno.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "app/src/log.h"
+
+namespace firebase {
+namespace storage {
+namespace internal {
+
+#if FIREBASE_PLATFORM_WINDOWS
+static const char kDirectorySeparator[] = "\\";
+#define unlink _unlink
+#define mkdir(x, y) _mkdir(x)
+#else
+static const char kDirectorySeparator[] = "/";
+#endif  // FIREBASE_PLATFORM_WINDOWS
+
+static const char kIndexFilename[] = "index";
+static const char kIndexHeader[] = "firebase-storage-download-cache 1";
+static const char kTempFilePrefix[] = "tmp-";
+
+// FNV-1a, used to derive stable file names from cache keys.
+static uint64_t HashString(const std::string& s) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : s) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static std::string ToHex(uint64_t value) {
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx",
+           static_cast<unsigned long long>(value));  // NOLINT
+  return buffer;
+}
+
+DownloadCache::DownloadCache(const std::string& directory,
+                             size_t max_size_bytes)
+    : directory_(directory),
+      index_path_(directory + kDirectorySeparator + kIndexFilename),
+      max_size_bytes_(max_size_bytes),
+      total_size_(0),
+      next_file_id_(0),
+      initialized_(false) {
+  if (mkdir(directory_.c_str(), 0700) < 0 && errno != EEXIST) {
+    LogWarning("Storage: Couldn't create download cache directory %s: %d",
+               directory_.c_str(), errno);
+    return;
+  }
+  initialized_ = true;
+  MutexLock lock(mutex_);
+  LoadIndex();
+  EvictLocked();
+}
+
+DownloadCache::~DownloadCache() {
+  MutexLock lock(mutex_);
+  // Persist the latest LRU order.
+  if (initialized_) SaveIndex();
+}
+
+std::string DownloadCache::MakeKey(const std::string& bucket,
+                                   const std::string& path) {
+  return bucket + "/" + path;
+}
+
+bool DownloadCache::Lookup(const std::string& key, Entry* entry) {
+  MutexLock lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  lru_.splice(lru_.end(), lru_, it->second.lru_position);
+  *entry = it->second.entry;
+  return true;
+}
+
+std::string DownloadCache::CreateTempFilePath() {
+  MutexLock lock(mutex_);
+  return directory_ + kDirectorySeparator + kTempFilePrefix +
+         UniqueFileSuffixLocked();
+}
+
+std::string DownloadCache::UniqueFileSuffixLocked() {
+  // Include the time so that files left behind by another process using the
+  // same directory are never reused.
+  uint64_t now = static_cast<uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+  return ToHex(now) + "-" + std::to_string(next_file_id_++);
+}
+
+bool DownloadCache::Insert(const std::string& key, const std::string& etag,
+                           const std::string& generation,
+                           const std::string& temp_file, size_t size,
+                           Entry* entry) {
+  MutexLock lock(mutex_);
+  auto existing = entries_.find(key);
+  if (existing != entries_.end()) RemoveLocked(existing);
+  if (!initialized_ || size > max_size_bytes_ || etag.empty()) {
+    // Objects that would evict everything else, or can't be revalidated, are
+    // not worth caching.
+    RemoveFile(temp_file);
+    return false;
+  }
+
+  Entry new_entry;
+  new_entry.etag = etag;
+  new_entry.generation = generation;
+  new_entry.size = size;
+  new_entry.path = directory_ + kDirectorySeparator + ToHex(HashString(key)) +
+                   "-" + ToHex(HashString(generation)) + "-" +
+                   UniqueFileSuffixLocked();
+  if (rename(temp_file.c_str(), new_entry.path.c_str()) != 0) {
+    LogWarning("Storage: Couldn't add %s to the download cache: %d",
+               key.c_str(), errno);
+    RemoveFile(temp_file);
+    return false;
+  }
+
+  IndexEntry& index_entry = entries_[key];
+  index_entry.entry = new_entry;
+  index_entry.lru_position = lru_.insert(lru_.end(), key);
+  total_size_ += size;
+  EvictLocked();
+  SaveIndex();
+  if (entry) *entry = new_entry;
+  return true;
+}
+
+void DownloadCache::Remove(const std::string& key) {
+  MutexLock lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return;
+  RemoveLocked(it);
+  SaveIndex();
+}
+
+void DownloadCache::RemoveIfUnchanged(const std::string& key,
+                                      const Entry& entry) {
+  MutexLock lock(mutex_);
+  auto it = entries_.find(key);
+  // Every inserted copy gets a file with a unique name, even for the same
+  // object and generation, so the path identifies it.
+  if (it == entries_.end() || it->second.entry.path != entry.path) return;
+  RemoveLocked(it);
+  SaveIndex();
+}
+
+size_t DownloadCache::size() const {
+  MutexLock lock(mutex_);
+  return total_size_;
+}
+
+void DownloadCache::RemoveLocked(
+    std::map<std::string, IndexEntry>::iterator it) {
+  total_size_ -= it->second.entry.size;
+  RemoveFile(it->second.entry.path);
+  lru_.erase(it->second.lru_position);
+  entries_.erase(it);
+}
+
+void DownloadCache::EvictLocked() {
+  while (total_size_ > max_size_bytes_ && !lru_.empty()) {
+    RemoveLocked(entries_.find(lru_.front()));
+  }
+}
+
+// The index is a text file with a header line followed by one line per entry,
+// in least to most recently used order:
+//   <size>\t<etag>\t<generation>\t<file>\t<key>
+// The key is last as it's the only field that may contain tabs.
+void DownloadCache::LoadIndex() {
+  std::ifstream index(index_path_, std::ios::binary);
+  if (index.fail()) return;
+  std::string line;
+  if (!std::getline(index, line) || line != kIndexHeader) return;
+  while (std::getline(index, line)) {
+    std::istringstream fields(line);
+    std::string size_str, filename, key;
+    Entry entry;
+    if (!std::getline(fields, size_str, '\t') ||
+        !std::getline(fields, entry.etag, '\t') ||
+        !std::getline(fields, entry.generation, '\t') ||
+        !std::getline(fields, filename, '\t') || !std::getline(fields, key)) {
+      continue;
+    }
+    entry.size = static_cast<size_t>(strtoull(size_str.c_str(), nullptr, 10));
+    entry.path = directory_ + kDirectorySeparator + filename;
+    // Skip entries whose file has been removed behind our back.
+    std::ifstream file(entry.path, std::ios::binary);
+    if (file.fail()) continue;
+    auto existing = entries_.find(key);
+    if (existing != entries_.end()) {
+      total_size_ -= existing->second.entry.size;
+      lru_.erase(existing->second.lru_position);
+    }
+    IndexEntry& index_entry = entries_[key];
+    index_entry.entry = entry;
+    index_entry.lru_position = lru_.insert(lru_.end(), key);
+    total_size_ += entry.size;
+  }
+}
+
+void DownloadCache::SaveIndex() {
+  std::string temp_path = index_path_ + ".tmp";
+  {
+    std::ofstream index(temp_path, std::ios::binary | std::ios::trunc);
+    if (index.fail()) return;
+    index << kIndexHeader << '\n';
+    size_t directory_prefix_length = directory_.size() + 1;
+    for (const std::string& key : lru_) {
+      const Entry& entry = entries_[key].entry;
+      index << entry.size << '\t' << entry.etag << '\t' << entry.generation
+            << '\t' << entry.path.substr(directory_prefix_length) << '\t'
+            << key << '\n';
+    }
+  }
+  RemoveFile(index_path_);
+  rename(temp_path.c_str(), index_path_.c_str());
+}
+
+bool DownloadCache::MaterializeFile(const Entry& entry,
+                                    const std::string& destination) {
+#if FIREBASE_PLATFORM_LINUX
+  // Share the cached file's extents when the filesystem supports reflinks.
+  int source_fd = open(entry.path.c_str(), O_RDONLY);
+  if (source_fd >= 0) {
+    int destination_fd =
+        open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool cloned =
+        destination_fd >= 0 && ioctl(destination_fd, FICLONE, source_fd) == 0;
+    if (destination_fd >= 0) close(destination_fd);
+    close(source_fd);
+    if (cloned) return true;
+  }
+#elif FIREBASE_PLATFORM_OSX
+  unlink(destination.c_str());
+  if (clonefile(entry.path.c_str(), destination.c_str(), 0) == 0) return true;
+#endif  // FIREBASE_PLATFORM_LINUX, FIREBASE_PLATFORM_OSX
+  std::ifstream source(entry.path, std::ios::in | std::ios::binary);
+  if (source.fail()) return false;
+  std::ofstream output(destination,
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  if (output.fail()) return false;
+  if (entry.size) output << source.rdbuf();
+  output.close();
+  return !output.fail();
+}
+
+size_t DownloadCache::ReadIntoBuffer(const Entry& entry, void* buffer,
+                                     size_t buffer_size) {
+  std::ifstream source(entry.path, std::ios::in | std::ios::binary);
+  if (source.fail()) return 0;
+  source.read(static_cast<char*>(buffer),
+              static_cast<std::streamsize>(buffer_size));
+  return static_cast<size_t>(source.gcount());
+}
+
+void DownloadCache::RemoveFile(const std::string& path) {
+  unlink(path.c_str());
+}
+
+}  // namespace internal
+}  // namespace storage
+}  // namespace firebase
@@ -0,0 +1,151 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_STORAGE_SRC_DESKTOP_DOWNLOAD_CACHE_H_
+#define FIREBASE_STORAGE_SRC_DESKTOP_DOWNLOAD_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+
+#include "app/src/include/firebase/internal/mutex.h"
+
+namespace firebase {
+namespace storage {
+namespace internal {
+
+// On-disk cache of downloaded objects.
+//
+// Objects are keyed by bucket and path, and each entry records the ETag and
+// generation the server returned with it so that later downloads can be sent
+// as conditional requests. When the server replies that the object has not
+// changed, the cached copy is used instead of downloading it again.
+//
+// Entries are evicted in least recently used order to keep the total size of
+// the cache within a byte budget. The index is persisted in the cache
+// directory so the cache survives restarts.
+class DownloadCache {
+ public:
+  // A cached object.
+  struct Entry {
+    Entry() : size(0) {}
+
+    // ETag returned by the server when the object was downloaded.
+    std::string etag;
+    // Generation of the object, if the server reported it.
+    std::string generation;
+    // Size of the object in bytes.
+    size_t size;
+    // Path of the cached copy of the object.
+    std::string path;
+  };
+
+  // Create a cache rooted at directory, which is created if it doesn't
+  // exist, holding at most max_size_bytes of data.
+  DownloadCache(const std::string& directory, size_t max_size_bytes);
+  ~DownloadCache();
+
+  // Whether the cache directory is usable.
+  bool initialized() const { return initialized_; }
+
+  // Directory the cache is stored in.
+  const std::string& directory() const { return directory_; }
+
+  // Build the cache key for an object.
+  static std::string MakeKey(const std::string& bucket,
+                             const std::string& path);
+
+  // Look up the cached copy of an object, marking it as the most recently
+  // used entry. Returns false if the object is not cached.
+  bool Lookup(const std::string& key, Entry* entry);
+
+  // Returns the path of a new, unique file in the cache directory to download
+  // an object into before it is added with Insert().
+  std::string CreateTempFilePath();
+
+  // Move temp_file into the cache as the copy of the object at key, replacing
+  // any existing entry, then evict entries until the cache fits its budget.
+  // The resulting entry is written to entry if it's not null.
+  // Returns false, and deletes temp_file, if the object couldn't be cached.
+  bool Insert(const std::string& key, const std::string& etag,
+              const std::string& generation, const std::string& temp_file,
+              size_t size, Entry* entry);
+
+  // Remove the object at key from the cache.
+  void Remove(const std::string& key);
+
+  // Remove the object at key from the cache if it is still the copy in
+  // entry, and hasn't been replaced since entry was looked up.
+  void RemoveIfUnchanged(const std::string& key, const Entry& entry);
+
+  // Total size in bytes of all cached objects.
+  size_t size() const;
+
+  // Write a copy of a cached object to destination, using a copy-on-write
+  // clone when the filesystem supports it. Returns false on failure.
+  static bool MaterializeFile(const Entry& entry,
+                              const std::string& destination);
+
+  // Read up to buffer_size bytes of a cached object into buffer. Returns the
+  // number of bytes read, or 0 if the file couldn't be read.
+  static size_t ReadIntoBuffer(const Entry& entry, void* buffer,
+                               size_t buffer_size);
+
+  // Delete a file, ignoring errors.
+  static void RemoveFile(const std::string& path);
+
+ private:
+  typedef std::list<std::string> LruList;
+
+  struct IndexEntry {
+    Entry entry;
+    // Position of this entry in lru_, most recently used entries are at the
+    // back of the list.
+    LruList::iterator lru_position;
+  };
+
+  // Read and write the persisted index. Must be called with mutex_ held.
+  void LoadIndex();
+  void SaveIndex();
+
+  // Remove an entry and delete its file. Must be called with mutex_ held.
+  void RemoveLocked(std::map<std::string, IndexEntry>::iterator it);
+
+  // Evict least recently used entries until the cache fits within
+  // max_size_bytes_. Must be called with mutex_ held.
+  void EvictLocked();
+
+  // Returns a string that is part of the name of every file created in the
+  // cache directory, so no two files share a name. Must be called with mutex_
+  // held.
+  std::string UniqueFileSuffixLocked();
+
+  mutable Mutex mutex_;
+  std::string directory_;
+  std::string index_path_;
+  size_t max_size_bytes_;
+  size_t total_size_;
+  uint64_t next_file_id_;
+  bool initialized_;
+  std::map<std::string, IndexEntry> entries_;
+  LruList lru_;
+};
+
+}  // namespace internal
+}  // namespace storage
+}  // namespace firebase
+
+#endif  // FIREBASE_STORAGE_SRC_DESKTOP_DOWNLOAD_CACHE_H_
@@ -103,6 +103,22 @@ std::string StorageInternal::GetAuthToken() {
   return result;
 }
 
+void StorageInternal::set_download_cache(const char* directory,
+                                         size_t max_size_bytes) {
+  std::shared_ptr<DownloadCache> cache;
+  if (directory && *directory && max_size_bytes) {
+    cache = std::make_shared<DownloadCache>(directory, max_size_bytes);
+    if (!cache->initialized()) cache.reset();
+  }
+  MutexLock lock(download_cache_mutex_);
+  download_cache_ = cache;
+}
+
+std::shared_ptr<DownloadCache> StorageInternal::download_cache() {
+  MutexLock lock(download_cache_mutex_);
+  return download_cache_;
+}
+
 // Add an operation to the list of outstanding operations.
 void StorageInternal::AddOperation(RestOperation* operation) {
   MutexLock lock(operations_mutex_);
@@ -15,11 +15,13 @@
 #ifndef FIREBASE_STORAGE_SRC_DESKTOP_STORAGE_DESKTOP_H_
 #define FIREBASE_STORAGE_SRC_DESKTOP_STORAGE_DESKTOP_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "app/src/future_manager.h"
 #include "app/src/include/firebase/internal/mutex.h"
+#include "storage/src/desktop/download_cache.h"
 #include "storage/src/desktop/storage_path.h"
 #include "storage/src/desktop/storage_reference_desktop.h"
 #include "storage/src/include/firebase/storage/common.h"
@@ -79,6 +81,13 @@ class StorageInternal {
     max_operation_retry_time_ = max_operation_retry_time;
   }
 
+  // Enable the on-disk download cache in directory, limited to max_size_bytes.
+  // An empty directory or a size of zero disables the cache.
+  void set_download_cache(const char* directory, size_t max_size_bytes);
+
+  // Returns the download cache, or null if it's disabled.
+  std::shared_ptr<DownloadCache> download_cache();
+
   // Whether this object was successfully initialized by the constructor.
   bool initialized() const { return app_ != nullptr; }
 
@@ -119,6 +128,11 @@ class StorageInternal {
   std::string user_agent_;
   Mutex operations_mutex_;
   std::vector<RestOperation*> operations_;
+
+  // Shared with in-flight downloads so the cache can be replaced while they
+  // complete.
+  Mutex download_cache_mutex_;
+  std::shared_ptr<DownloadCache> download_cache_;
 };
 
 }  // namespace internal
@@ -269,6 +269,20 @@ void StorageReferenceInternal::PrepareRequestBlocking(
   }
 }
 
+// Looks up this object in the download cache.  If there is a cached copy,
+// the request is made conditional on it so the server can reply with
+// "304 Not Modified" instead of sending the object again.
+std::string StorageReferenceInternal::PrepareCachedRequest(
+    DownloadCache* cache, rest::Request* request,
+    DownloadCache::Entry* cached) {
+  std::string key =
+      DownloadCache::MakeKey(bucket(), storageUri_.GetPath().str());
+  if (cache->Lookup(key, cached)) {
+    request->add_header("If-None-Match", cached->etag.c_str());
+  }
+  return key;
+}
+
 // Asynchronously downloads the object from this StorageReference.
 Future<size_t> StorageReferenceInternal::GetFile(const char* path,
                                                  Listener* listener,
@@ -283,8 +297,18 @@ Future<size_t> StorageReferenceInternal::GetFile(const char* path,
         storage::internal::Request* request = new storage::internal::Request();
         PrepareRequestBlocking(request, storageUri_.AsHttpUrl().c_str(),
                                rest::util::kGet);
-        GetFileResponse* response =
-            new GetFileResponse(final_path.c_str(), handle, future_api);
+        BlockingResponse* response;
+        std::shared_ptr<DownloadCache> cache = storage_->download_cache();
+        if (cache) {
+          DownloadCache::Entry cached;
+          std::string key = PrepareCachedRequest(cache.get(), request, &cached);
+          response = new CachedGetResponse(
+              cache, key, cached.etag.empty() ? nullptr : &cached,
+              final_path.c_str(), handle, future_api);
+        } else {
+          response =
+              new GetFileResponse(final_path.c_str(), handle, future_api);
+        }
         RestCall(request, request->notifier(), response, handle.get(), listener,
                  controller_out);
         return response;
@@ -314,8 +338,17 @@ Future<size_t> StorageReferenceInternal::GetBytes(void* buffer,
     storage::internal::Request* request = new storage::internal::Request();
     PrepareRequestBlocking(request, storageUri_.AsHttpUrl().c_str(),
                            rest::util::kGet);
-    GetBytesResponse* response =
-        new GetBytesResponse(buffer, buffer_size, handle, future_api);
+    BlockingResponse* response;
+    std::shared_ptr<DownloadCache> cache = storage_->download_cache();
+    if (cache) {
+      DownloadCache::Entry cached;
+      std::string key = PrepareCachedRequest(cache.get(), request, &cached);
+      response = new CachedGetResponse(
+          cache, key, cached.etag.empty() ? nullptr : &cached, buffer,
+          buffer_size, handle, future_api);
+    } else {
+      response = new GetBytesResponse(buffer, buffer_size, handle, future_api);
+    }
     RestCall(request, request->notifier(), response, handle.get(), listener,
              controller_out);
     return response;
@@ -356,11 +389,22 @@ void StorageReferenceInternal::AsyncSendRequestWithRetry(
                   std::chrono::duration<double>(max_retry_time_seconds);
   auto current_sleep_time = std::chrono::milliseconds(kInitialSleepTimeMillis);
   auto max_sleep_time = std::chrono::milliseconds(kMaxSleepTimeMillis);
+  bool resent = false;
   while (true) {
     internal_future = future_api->LastResult(internal_function_reference);
-    // Wait for completion, then check status and error.
-    while (internal_future.status() == firebase::kFutureStatusPending) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Wait for completion, then check status and error. Waiting on a
+    // completion callback wakes up as soon as the request finishes, rather
+    // than on the next poll.
+    if (internal_future.status() == firebase::kFutureStatusPending) {
+      internal_future.Wait(firebase::FutureBase::kWaitTimeoutInfinite);
+    }
+    // A request that relied on a cached copy that turned out to be gone is
+    // sent again once, right away.
+    if (response != nullptr && response->should_resend() && !resent &&
+        internal_future.status() == firebase::kFutureStatusComplete) {
+      resent = true;
+      response = send_request_funct();
+      continue;
     }
     // For any request that succeeds or fails in a non-retryable way, don't
     // bother retrying. Response can be null if the request failed to create.
@@ -559,6 +603,76 @@ Future<Metadata> StorageReferenceInternal::PutFileLastResult() {
       future()->LastResult(kStorageReferenceFnPutFile));
 }
 
+// Asynchronously uploads data read from source to the currently specified
+// StorageReference, without additional metadata.
+Future<Metadata> StorageReferenceInternal::PutStream(
+    StreamSource* source, Listener* listener, Controller* controller_out) {
+  return PutStream(source, nullptr, listener, controller_out);
+}
+
+Future<Metadata> StorageReferenceInternal::PutStreamInternal(
+    StreamSource* source, Listener* listener, Controller* controller_out,
+    const char* content_type) {
+  auto* future_api = future();
+  auto handle = future_api->SafeAlloc<Metadata>(kStorageReferenceFnPutStream);
+
+  std::string content_type_str = content_type ? content_type : "";
+  auto send_request_funct{[&, source, content_type_str, listener,
+                           controller_out]() -> BlockingResponse* {
+    auto* future_api = future();
+    auto handle =
+        future_api->SafeAlloc<Metadata>(kStorageReferenceFnPutStreamInternal);
+    if (source == nullptr) {
+      future_api->Complete(handle, kErrorUnknown, "No stream source.");
+      return nullptr;
+    }
+
+    // The body is pulled from the source by the transport as it is sent.
+    storage::internal::RequestStream* request =
+        new storage::internal::RequestStream(source);
+    ReturnedMetadataResponse* response =
+        new ReturnedMetadataResponse(handle, future_api, AsStorageReference());
+    PrepareRequestBlocking(request, storageUri_.AsHttpUrl().c_str(),
+                           rest::util::kPost, content_type_str.c_str());
+    RestCall(request, request->notifier(), response, handle.get(), listener,
+             controller_out);
+    return response;
+  }};
+  // Data already consumed from a stream can't be read again, so never retry.
+  SendRequestWithRetry(kStorageReferenceFnPutStreamInternal, send_request_funct,
+                       handle, 0.0);
+  return PutStreamLastResult();
+}
+
+// Asynchronously uploads data read from source to the currently specified
+// StorageReference, with metadata included.
+Future<Metadata> StorageReferenceInternal::PutStream(
+    StreamSource* source, const Metadata* metadata, Listener* listener,
+    Controller* controller_out) {
+  // This is the handle for the actual future returned to the user.
+  auto* future_api = future();
+  auto handle = future_api->SafeAlloc<Metadata>(kStorageReferenceFnPutStream);
+  MetadataChainData* data =
+      new MetadataChainData(handle, metadata, AsStorageReference(), future_api);
+  // This is the future to do the actual upload.  Note that it is on a
+  // different storage reference than the original, so the caller of this
+  // function can't access it via PutStreamLastResult.
+  Future<Metadata> putstream_internal =
+      data->storage_ref.internal_->PutStreamInternal(
+          source, listener, controller_out,
+          metadata ? metadata->content_type() : nullptr);
+
+  SetupMetadataChain(putstream_internal, data);
+
+  return PutStreamLastResult();
+}
+
+// Returns the result of the most recent call to PutStream();
+Future<Metadata> StorageReferenceInternal::PutStreamLastResult() {
+  return static_cast<const Future<Metadata>&>(
+      future()->LastResult(kStorageReferenceFnPutStream));
+}
+
 // Retrieves metadata associated with an object at this StorageReference.
 Future<Metadata> StorageReferenceInternal::GetMetadata() {
   auto* future_api = future();
@@ -574,6 +688,7 @@ Future<Metadata> StorageReferenceInternal::GetMetadata() {
     storage::internal::Request* request = new storage::internal::Request();
     PrepareRequestBlocking(request, storageUri_.AsHttpMetadataUrl().c_str(),
                            rest::util::kGet);
+    request->add_header(rest::util::kAcceptEncoding, rest::util::kGzip);
 
     RestCall(request, request->notifier(), response, handle.get(), nullptr,
              nullptr);
@@ -610,6 +725,7 @@ Future<Metadata> StorageReferenceInternal::UpdateMetadata(
     storage::internal::Request* request = new storage::internal::Request();
     PrepareRequestBlocking(request, storageUri_.AsHttpUrl().c_str(), "PATCH",
                            "application/json");
+    request->add_header(rest::util::kAcceptEncoding, rest::util::kGzip);
 
     std::string metadata_json = metadata->internal_->ExportAsJson();
     request->set_post_fields(metadata_json.c_str(), metadata_json.length());
@@ -21,6 +21,7 @@
 #include "app/src/include/firebase/future.h"
 #include "app/src/reference_counted_future_impl.h"
 #include "storage/src/desktop/curl_requests.h"
+#include "storage/src/desktop/download_cache.h"
 #include "storage/src/desktop/storage_path.h"
 #include "storage/src/include/firebase/storage/storage_reference.h"
 
@@ -44,6 +45,8 @@ enum StorageReferenceFn {
   kStorageReferenceFnPutBytesInternal,
   kStorageReferenceFnPutFile,
   kStorageReferenceFnPutFileInternal,
+  kStorageReferenceFnPutStream,
+  kStorageReferenceFnPutStreamInternal,
   kStorageReferenceFnCount,
 };
 
@@ -145,6 +148,19 @@ class StorageReferenceInternal {
   // Returns the result of the most recent call to Write();
   Future<Metadata> PutFileLastResult();
 
+  // Asynchronously uploads data read from source to the currently specified
+  // StorageReference, without additional metadata.
+  Future<Metadata> PutStream(StreamSource* source, Listener* listener,
+                             Controller* controller_out);
+
+  // Asynchronously uploads data read from source to the currently specified
+  // StorageReference, with metadata included.
+  Future<Metadata> PutStream(StreamSource* source, const Metadata* metadata,
+                             Listener* listener, Controller* controller_out);
+
+  // Returns the result of the most recent call to PutStream();
+  Future<Metadata> PutStreamLastResult();
+
   // Pointer to the StorageInternal instance we are a part of.
   StorageInternal* storage_internal() const { return storage_; }
 
@@ -182,11 +198,20 @@ class StorageReferenceInternal {
   Future<Metadata> PutFileInternal(const char* path, Listener* listener,
                                    Controller* controller_out,
                                    const char* content_type = nullptr);
+  // Upload stream without metadata.
+  Future<Metadata> PutStreamInternal(StreamSource* source, Listener* listener,
+                                     Controller* controller_out,
+                                     const char* content_type = nullptr);
 
   void RestCall(rest::Request* request, internal::Notifier* request_notifier,
                 BlockingResponse* response, FutureHandle handle,
                 Listener* listener, Controller* controller_out);
 
+  // Make request conditional on the cached copy of this object, if any.
+  // Returns the object's cache key.
+  std::string PrepareCachedRequest(DownloadCache* cache, rest::Request* request,
+                                   DownloadCache::Entry* cached);
+
   void PrepareRequestBlocking(rest::Request* request, const char* url,
                               const char* method,
                               const char* content_type = nullptr);
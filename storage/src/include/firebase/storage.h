@@ -24,6 +24,7 @@
 #include "firebase/storage/listener.h"
 #include "firebase/storage/metadata.h"
 #include "firebase/storage/storage_reference.h"
+#include "firebase/storage/stream_source.h"
 
 #if !defined(DOXYGEN)
 #ifndef SWIG
@@ -139,6 +140,22 @@ class Storage {
   /// download if a failure occurs. Defaults to 120 seconds (2 minutes).
   void set_max_operation_retry_time(double max_transfer_retry_seconds);
 
+  /// @brief Enables an on-disk cache of objects downloaded with
+  /// StorageReference::GetBytes() and StorageReference::GetFile().
+  ///
+  /// When an object is in the cache, downloading it again sends a
+  /// conditional request and the cached copy is used if the object has not
+  /// changed on the server. The least recently used objects are evicted to
+  /// keep the cache within max_size_bytes.
+  ///
+  /// @note This is currently only supported on desktop platforms.
+  ///
+  /// @param[in] directory Directory to store cached objects in. It is created
+  /// if it doesn't exist. Pass nullptr to disable the cache.
+  /// @param[in] max_size_bytes Maximum total size of the cached objects. Pass
+  /// 0 to disable the cache.
+  void set_download_cache(const char* directory, size_t max_size_bytes);
+
  private:
   /// @cond FIREBASE_APP_INTERNAL
   friend class Metadata;
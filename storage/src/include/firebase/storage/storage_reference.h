@@ -28,6 +28,7 @@ namespace storage {
 class Controller;
 class Listener;
 class Storage;
+class StreamSource;
 
 /// @cond FIREBASE_APP_INTERNAL
 namespace internal {
@@ -330,6 +331,62 @@ class StorageReference {
   /// @returns The result of the most recent call to PutFile();
   Future<Metadata> PutFileLastResult();
 
+  /// @brief Asynchronously uploads data read from a StreamSource to the
+  /// currently specified StorageReference, without additional metadata.
+  ///
+  /// Data is pulled from the source as the upload progresses, so memory usage
+  /// does not depend on the size of the object. Since a stream can't be
+  /// rewound, failed stream uploads are not retried.
+  ///
+  /// @note This is currently only supported on desktop platforms. On other
+  /// platforms the returned future fails with kErrorUnknown.
+  ///
+  /// @param[in] source The source to read the object's data from. The caller
+  /// is responsible for allocating and deallocating the source, and it must
+  /// remain valid until the returned future completes.
+  /// @param[in] listener A listener that will respond to events on this read
+  /// operation. If not nullptr, a listener that will respond to events on this
+  /// write operation. The caller is responsible for allocating and deallocating
+  /// the listener. The same listener can be used for multiple operations.
+  /// @param[out] controller_out Controls the write operation, providing the
+  /// ability to pause, resume or cancel an ongoing write operation. If not
+  /// nullptr, this method will output a Controller here that you can use to
+  /// control the write operation.
+  ///
+  /// @returns A future that returns the Metadata.
+  Future<Metadata> PutStream(StreamSource* source, Listener* listener = nullptr,
+                             Controller* controller_out = nullptr);
+
+  /// @brief Asynchronously uploads data read from a StreamSource to the
+  /// currently specified StorageReference, with metadata included.
+  ///
+  /// @note This is currently only supported on desktop platforms. On other
+  /// platforms the returned future fails with kErrorUnknown.
+  ///
+  /// @param[in] source The source to read the object's data from. The caller
+  /// is responsible for allocating and deallocating the source, and it must
+  /// remain valid until the returned future completes.
+  /// @param[in] metadata Metadata containing additional information (MIME type,
+  /// etc.) about the object being uploaded.
+  /// @param[in] listener A listener that will respond to events on this read
+  /// operation. If not nullptr, a listener that will respond to events on this
+  /// write operation. The caller is responsible for allocating and deallocating
+  /// the listener. The same listener can be used for multiple operations.
+  /// @param[out] controller_out Controls the write operation, providing the
+  /// ability to pause, resume or cancel an ongoing write operation. If not
+  /// nullptr, this method will output a Controller here that you can use to
+  /// control the write operation.
+  ///
+  /// @returns A future that returns the Metadata.
+  Future<Metadata> PutStream(StreamSource* source, const Metadata& metadata,
+                             Listener* listener = nullptr,
+                             Controller* controller_out = nullptr);
+
+  /// @brief Returns the result of the most recent call to PutStream();
+  ///
+  /// @returns The result of the most recent call to PutStream();
+  Future<Metadata> PutStreamLastResult();
+
   /// @brief Returns true if this StorageReference is valid, false if it is not
   /// valid. An invalid StorageReference indicates that the reference is
   /// uninitialized (created with the default constructor) or that there was an
@@ -0,0 +1,63 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FIREBASE_STORAGE_SRC_INCLUDE_FIREBASE_STORAGE_STREAM_SOURCE_H_
+#define FIREBASE_STORAGE_SRC_INCLUDE_FIREBASE_STORAGE_STREAM_SOURCE_H_
+
+#include <cstddef>
+
+namespace firebase {
+namespace storage {
+
+/// @brief Base class used to supply the data uploaded by
+/// StorageReference::PutStream().
+///
+/// Subclasses of this class produce the object's contents on demand, so the
+/// data does not need to be held in memory or written to a file before it is
+/// uploaded. For example, a subclass can read from a pipe or file descriptor
+/// or generate the data as it goes.
+///
+/// Read() is called from the thread that performs the transfer, not the thread
+/// that started it.
+class StreamSource {
+ public:
+  /// @brief Value returned by size() when the length of the stream is not
+  /// known before the upload starts.
+  static const size_t kSizeUnknown = ~static_cast<size_t>(0);
+
+  /// @brief Virtual destructor.
+  virtual ~StreamSource() {}
+
+  /// @brief Reads the next chunk of data to upload.
+  ///
+  /// @param[out] buffer Buffer to copy the data into.
+  /// @param[in] buffer_size Maximum number of bytes to copy into buffer.
+  /// @param[out] abort Set to true to cancel the upload, for example if the
+  /// underlying source reported an error. Initially false.
+  ///
+  /// @returns The number of bytes copied into buffer, or 0 when the end of the
+  /// stream has been reached.
+  virtual size_t Read(void* buffer, size_t buffer_size, bool* abort) = 0;
+
+  /// @brief Returns the total number of bytes this stream will produce, or
+  /// kSizeUnknown if it isn't known in advance.
+  ///
+  /// Streams of unknown size are uploaded using chunked transfer encoding.
+  virtual size_t size() const { return kSizeUnknown; }
+};
+
+}  // namespace storage
+}  // namespace firebase
+
+#endif  // FIREBASE_STORAGE_SRC_INCLUDE_FIREBASE_STORAGE_STREAM_SOURCE_H_
@@ -160,6 +160,19 @@ class StorageReferenceInternal {
   // Returns the result of the most recent call to PutFile();
   Future<Metadata> PutFileLastResult();
 
+  // Stream uploads are not supported on iOS, these complete the returned
+  // future with an error.
+  Future<Metadata> PutStream(StreamSource* _Nullable source,
+                             Listener* _Nullable listener,
+                             Controller* _Nullable controller_out);
+  Future<Metadata> PutStream(StreamSource* _Nullable source,
+                             const Metadata* _Nullable metadata,
+                             Listener* _Nullable listener,
+                             Controller* _Nullable controller_out);
+
+  // Returns the result of the most recent call to PutStream();
+  Future<Metadata> PutStreamLastResult();
+
   // StorageInternal instance we are associated with.
   StorageInternal* _Nullable storage_internal() const { return storage_; }
 
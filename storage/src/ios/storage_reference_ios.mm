@@ -42,6 +42,7 @@ enum StorageReferenceFn {
   kStorageReferenceFnUpdateMetadata,
   kStorageReferenceFnPutBytes,
   kStorageReferenceFnPutFile,
+  kStorageReferenceFnPutStream,
   kStorageReferenceFnCount,
 };
 
@@ -437,6 +438,26 @@ Future<Metadata> StorageReferenceInternal::PutFileLastResult() {
   return static_cast<const Future<Metadata>&>(future()->LastResult(kStorageReferenceFnPutFile));
 }
 
+Future<Metadata> StorageReferenceInternal::PutStream(StreamSource* source, Listener* listener,
+                                                     Controller* controller_out) {
+  return PutStream(source, nullptr, listener, controller_out);
+}
+
+Future<Metadata> StorageReferenceInternal::PutStream(StreamSource* source,
+                                                     const Metadata* metadata,
+                                                     Listener* listener,
+                                                     Controller* controller_out) {
+  ReferenceCountedFutureImpl* future_impl = future();
+  SafeFutureHandle<Metadata> handle =
+      future_impl->SafeAlloc<Metadata>(kStorageReferenceFnPutStream);
+  future_impl->Complete(handle, kErrorUnknown, "PutStream() is not supported on iOS.");
+  return PutStreamLastResult();
+}
+
+Future<Metadata> StorageReferenceInternal::PutStreamLastResult() {
+  return static_cast<const Future<Metadata>&>(future()->LastResult(kStorageReferenceFnPutStream));
+}
+
 ReferenceCountedFutureImpl* StorageReferenceInternal::future() {
   return storage_->future_manager().GetFutureApi(this);
 }
@@ -14,7 +14,10 @@
 
 #include <stdio.h>
 
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <string>
 
 #include "app/rest/util.h"
 #include "app/src/include/firebase/app.h"
@@ -22,6 +25,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "storage/src/desktop/controller_desktop.h"
+#include "storage/src/desktop/download_cache.h"
 #include "storage/src/desktop/metadata_desktop.h"
 #include "storage/src/desktop/storage_path.h"
 #include "storage/src/desktop/storage_reference_desktop.h"
@@ -30,6 +34,7 @@
 namespace {
 
 using firebase::App;
+using firebase::storage::internal::DownloadCache;
 using firebase::storage::internal::MetadataInternal;
 using firebase::storage::internal::StorageInternal;
 using firebase::storage::internal::StoragePath;
@@ -185,6 +190,119 @@ TEST_F(StorageDesktopUtilsTests, testMetadataJsonExporter) {
   // clang-format=on
 }
 
+// Write contents to a new temporary file in the cache directory.
+static std::string WriteTempFile(DownloadCache* cache,
+                                 const std::string& contents) {
+  std::string path = cache->CreateTempFilePath();
+  std::ofstream file(path, std::ios::out | std::ios::binary);
+  file << contents;
+  return path;
+}
+
+static std::string ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+TEST_F(StorageDesktopUtilsTests, testDownloadCacheInsertAndLookup) {
+  std::string directory = ::testing::TempDir() + "/download_cache_lookup";
+  DownloadCache cache(directory, 1024);
+  ASSERT_TRUE(cache.initialized());
+  std::string key = DownloadCache::MakeKey("bucket", "path/object");
+
+  DownloadCache::Entry entry;
+  EXPECT_FALSE(cache.Lookup(key, &entry));
+  EXPECT_TRUE(cache.Insert(key, "\"etag1\"", "1",
+                           WriteTempFile(&cache, "hello"), 5, nullptr));
+  ASSERT_TRUE(cache.Lookup(key, &entry));
+  EXPECT_EQ(entry.etag, "\"etag1\"");
+  EXPECT_EQ(entry.generation, "1");
+  EXPECT_EQ(entry.size, 5u);
+  EXPECT_EQ(ReadFile(entry.path), "hello");
+
+  char buffer[5];
+  EXPECT_EQ(DownloadCache::ReadIntoBuffer(entry, buffer, sizeof(buffer)), 5u);
+  EXPECT_EQ(std::string(buffer, sizeof(buffer)), "hello");
+
+  std::string destination = directory + "/materialized";
+  EXPECT_TRUE(DownloadCache::MaterializeFile(entry, destination));
+  EXPECT_EQ(ReadFile(destination), "hello");
+  DownloadCache::RemoveFile(destination);
+
+  cache.Remove(key);
+  EXPECT_FALSE(cache.Lookup(key, &entry));
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_F(StorageDesktopUtilsTests, testDownloadCacheEvictsLeastRecentlyUsed) {
+  std::string directory = ::testing::TempDir() + "/download_cache_evict";
+  DownloadCache cache(directory, 10);
+  ASSERT_TRUE(cache.initialized());
+  DownloadCache::Entry entry;
+  EXPECT_TRUE(cache.Insert("a", "ea", "1", WriteTempFile(&cache, "aaaa"), 4,
+                           nullptr));
+  EXPECT_TRUE(cache.Insert("b", "eb", "1", WriteTempFile(&cache, "bbbb"), 4,
+                           nullptr));
+  // Touch "a" so that "b" is the least recently used entry.
+  EXPECT_TRUE(cache.Lookup("a", &entry));
+  EXPECT_TRUE(cache.Insert("c", "ec", "1", WriteTempFile(&cache, "cccc"), 4,
+                           nullptr));
+  EXPECT_TRUE(cache.Lookup("a", &entry));
+  EXPECT_FALSE(cache.Lookup("b", &entry));
+  EXPECT_TRUE(cache.Lookup("c", &entry));
+  EXPECT_EQ(cache.size(), 8u);
+
+  // Objects larger than the whole cache are never stored.
+  EXPECT_FALSE(cache.Insert("d", "ed", "1",
+                            WriteTempFile(&cache, "ddddddddddd"), 11,
+                            nullptr));
+  EXPECT_FALSE(cache.Lookup("d", &entry));
+  cache.Remove("a");
+  cache.Remove("c");
+}
+
+TEST_F(StorageDesktopUtilsTests,
+       testDownloadCacheRemoveIfUnchangedKeepsNewerCopy) {
+  std::string directory = ::testing::TempDir() + "/download_cache_unchanged";
+  DownloadCache cache(directory, 1024);
+  ASSERT_TRUE(cache.initialized());
+  DownloadCache::Entry stale;
+  EXPECT_TRUE(cache.Insert("bucket/object", "etag", "1",
+                           WriteTempFile(&cache, "old"), 3, &stale));
+  // The same object and generation is cached again, e.g. after a download
+  // that found the first copy unreadable.
+  DownloadCache::Entry current;
+  EXPECT_TRUE(cache.Insert("bucket/object", "etag", "1",
+                           WriteTempFile(&cache, "new"), 3, &current));
+  EXPECT_NE(stale.path, current.path);
+
+  cache.RemoveIfUnchanged("bucket/object", stale);
+  DownloadCache::Entry entry;
+  ASSERT_TRUE(cache.Lookup("bucket/object", &entry));
+  EXPECT_EQ(ReadFile(entry.path), "new");
+
+  cache.RemoveIfUnchanged("bucket/object", current);
+  EXPECT_FALSE(cache.Lookup("bucket/object", &entry));
+}
+
+TEST_F(StorageDesktopUtilsTests, testDownloadCachePersistsIndex) {
+  std::string directory = ::testing::TempDir() + "/download_cache_persist";
+  {
+    DownloadCache cache(directory, 1024);
+    ASSERT_TRUE(cache.initialized());
+    EXPECT_TRUE(cache.Insert("bucket/object", "etag", "42",
+                             WriteTempFile(&cache, "data"), 4, nullptr));
+  }
+  DownloadCache cache(directory, 1024);
+  DownloadCache::Entry entry;
+  ASSERT_TRUE(cache.Lookup("bucket/object", &entry));
+  EXPECT_EQ(entry.etag, "etag");
+  EXPECT_EQ(entry.generation, "42");
+  EXPECT_EQ(ReadFile(entry.path), "data");
+  cache.Remove("bucket/object");
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {